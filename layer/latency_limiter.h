@@ -0,0 +1,141 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include <vulkan/vulkan_core.h>
+
+// Software implementation of VK_NV_low_latency2 sleep semantics for devices whose driver doesn't expose the extension.
+// Frame pacing is derived from the application's latency markers and from the timing of vkQueuePresentKHR calls:
+// the CPU is put to sleep before simulation start so that the next present lands just before the previous frame
+// is done on the GPU, which keeps the queue depth at (slightly less than) one frame. minimumIntervalUs is honoured
+// as a frame cap. The clock is a template parameter so the pacing logic can be driven by a virtual clock.
+
+struct LatencyLimiterSteadyClock {
+    [[nodiscard]] uint64_t Now() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void SleepUntil(uint64_t timestamp) const {
+        std::this_thread::sleep_until(std::chrono::steady_clock::time_point{std::chrono::nanoseconds{timestamp}});
+    }
+};
+
+template <typename Clock = LatencyLimiterSteadyClock>
+class LatencyLimiter {
+  public:
+    // Aim slightly ahead of the measured frame interval, so that the estimate keeps shrinking when the GPU speeds up
+    static constexpr uint64_t slackDivisor = 32;
+    // Samples larger than this (loading screens, alt-tab, ...) are discarded instead of skewing the estimates
+    static constexpr uint64_t maxSample = 1'000'000'000;
+    // Upper bound for a single sleep, protects against bogus estimates
+    static constexpr uint64_t maxSleep = 100'000'000;
+
+    explicit LatencyLimiter(Clock clock = Clock{})
+        : clock(std::move(clock)) {}
+
+    void SetSleepMode(bool lowLatencyMode, uint32_t minimumIntervalUs) {
+        std::scoped_lock lock{mutex};
+        this->lowLatencyMode = lowLatencyMode;
+        this->minimumInterval = uint64_t{minimumIntervalUs} * 1000;
+    }
+
+    void SetMarker(uint64_t presentID, VkLatencyMarkerNV marker) {
+        auto now = clock.Now();
+
+        std::scoped_lock lock{mutex};
+        switch (marker) {
+            case VK_LATENCY_MARKER_SIMULATION_START_NV:
+                simulationStart = now;
+                simulationPresentID = presentID;
+                break;
+            case VK_LATENCY_MARKER_PRESENT_START_NV:
+                if (simulationStart && presentID == simulationPresentID)
+                    Accumulate(cpuTime, now - simulationStart);
+
+                simulationStart = 0;
+                break;
+            default:
+                break;
+        }
+    }
+
+    void Present() {
+        auto now = clock.Now();
+
+        std::scoped_lock lock{mutex};
+        if (lastPresent)
+            Accumulate(frameInterval, now - lastPresent);
+
+        lastPresent = now;
+    }
+
+    void Sleep() {
+        auto target = GetWakeupTime();
+        auto now = clock.Now();
+
+        if (target > now)
+            clock.SleepUntil(std::min(target, now + maxSleep));
+
+        std::scoped_lock lock{mutex};
+        // Use the intended wakeup time as reference for the frame cap, this way oversleeping doesn't accumulate
+        lastWakeup = std::max(target, now);
+    }
+
+    // Timestamp until which the next Sleep() blocks, 0 when no sleep is necessary
+    [[nodiscard]] uint64_t GetWakeupTime() {
+        std::scoped_lock lock{mutex};
+        uint64_t target = 0;
+
+        if (lowLatencyMode && lastPresent && frameInterval && cpuTime) {
+            auto interval = frameInterval - frameInterval / slackDivisor;
+            if (interval > cpuTime)
+                target = lastPresent + interval - cpuTime;
+        }
+
+        if (minimumInterval && lastWakeup)
+            target = std::max(target, lastWakeup + minimumInterval);
+
+        return target;
+    }
+
+    [[nodiscard]] uint64_t GetFrameInterval() {
+        std::scoped_lock lock{mutex};
+        return frameInterval;
+    }
+
+    [[nodiscard]] uint64_t GetCpuTime() {
+        std::scoped_lock lock{mutex};
+        return cpuTime;
+    }
+
+  private:
+    Clock clock;
+    std::mutex mutex;
+
+    bool lowLatencyMode{false};
+    uint64_t minimumInterval{0};
+
+    uint64_t simulationStart{0};
+    uint64_t simulationPresentID{0};
+    uint64_t lastPresent{0};
+    uint64_t lastWakeup{0};
+
+    uint64_t frameInterval{0};
+    uint64_t cpuTime{0};
+
+    static void Accumulate(uint64_t& average, uint64_t sample) {
+        if (sample > maxSample)
+            return;
+
+        // Exponentially weighted moving average with alpha = 1/8
+        if (!average)
+            average = sample;
+        else
+            average = static_cast<uint64_t>(static_cast<int64_t>(average) + (static_cast<int64_t>(sample) - static_cast<int64_t>(average)) / 8);
+    }
+};
@@ -0,0 +1,135 @@
+#include "section_listener.h"
+#include "latency_limiter.h"
+
+#include <algorithm>
+#include <memory>
+
+namespace {
+    struct VirtualClockState {
+        uint64_t now{1'000'000'000};
+        uint64_t sleptUntil{0};
+        uint32_t sleepCount{0};
+        uint64_t lastPresent{0};
+    };
+
+    // Advances time only when told to, sleeping jumps straight to the wakeup time
+    struct VirtualClock {
+        std::shared_ptr<VirtualClockState> state = std::make_shared<VirtualClockState>();
+
+        [[nodiscard]] uint64_t Now() const {
+            return state->now;
+        }
+
+        void SleepUntil(uint64_t timestamp) const {
+            state->sleepCount++;
+            state->sleptUntil = timestamp;
+            state->now = std::max(state->now, timestamp);
+        }
+    };
+
+    constexpr uint64_t ms = 1'000'000;
+
+    // Simulates a frame with cpuTime between simulation start and present start, the GPU needs gpuTime per frame
+    void RunFrame(LatencyLimiter<VirtualClock>& limiter, VirtualClockState& clock, uint64_t presentID, uint64_t cpuTime, uint64_t gpuTime) {
+        limiter.Sleep();
+
+        limiter.SetMarker(presentID, VK_LATENCY_MARKER_SIMULATION_START_NV);
+        clock.now += cpuTime;
+        limiter.SetMarker(presentID, VK_LATENCY_MARKER_PRESENT_START_NV);
+
+        // vkQueuePresentKHR blocks until the GPU is done with the previous frame
+        clock.now = std::max(clock.now, clock.lastPresent + gpuTime);
+        clock.lastPresent = clock.now;
+        limiter.Present();
+    }
+}
+
+TEST_CASE("Software latency limiter", "[layer]") {
+    VirtualClock clock;
+    LatencyLimiter<VirtualClock> limiter{clock};
+
+    SECTION("Doesn't sleep without low latency mode or frame limit") {
+        for (auto i = 1u; i <= 10; ++i)
+            RunFrame(limiter, *clock.state, i, 4 * ms, 10 * ms);
+
+        REQUIRE(limiter.GetWakeupTime() == 0);
+        REQUIRE(clock.state->sleepCount == 0);
+    }
+
+    SECTION("Tracks frame interval and CPU time") {
+        for (auto i = 1u; i <= 10; ++i)
+            RunFrame(limiter, *clock.state, i, 4 * ms, 10 * ms);
+
+        REQUIRE(limiter.GetFrameInterval() == 10 * ms);
+        REQUIRE(limiter.GetCpuTime() == 4 * ms);
+    }
+
+    SECTION("Ignores markers with mismatching present IDs") {
+        limiter.SetMarker(1, VK_LATENCY_MARKER_SIMULATION_START_NV);
+        clock.state->now += 4 * ms;
+        limiter.SetMarker(2, VK_LATENCY_MARKER_PRESENT_START_NV);
+
+        REQUIRE(limiter.GetCpuTime() == 0);
+    }
+
+    SECTION("Discards outliers") {
+        limiter.Present();
+        clock.state->now += 10 * ms;
+        limiter.Present();
+        clock.state->now += 5'000 * ms;
+        limiter.Present();
+
+        REQUIRE(limiter.GetFrameInterval() == 10 * ms);
+    }
+
+    SECTION("Delays simulation start in low latency mode when GPU bound") {
+        limiter.SetSleepMode(true, 0);
+
+        for (auto i = 1u; i <= 10; ++i)
+            RunFrame(limiter, *clock.state, i, 4 * ms, 10 * ms);
+
+        REQUIRE(clock.state->sleepCount > 0);
+
+        auto lastPresent = clock.state->now;
+        auto wakeup = limiter.GetWakeupTime();
+        auto interval = limiter.GetFrameInterval() - limiter.GetFrameInterval() / decltype(limiter)::slackDivisor;
+        REQUIRE(wakeup == lastPresent + interval - limiter.GetCpuTime());
+
+        // Next present lands just before the previous frame is done on the GPU
+        REQUIRE(wakeup + limiter.GetCpuTime() < lastPresent + 10 * ms);
+    }
+
+    SECTION("Doesn't sleep when CPU bound") {
+        limiter.SetSleepMode(true, 0);
+
+        for (auto i = 1u; i <= 10; ++i)
+            RunFrame(limiter, *clock.state, i, 12 * ms, 10 * ms);
+
+        REQUIRE(limiter.GetWakeupTime() == 0);
+        REQUIRE(clock.state->sleepCount == 0);
+    }
+
+    SECTION("Honours the minimum interval") {
+        limiter.SetSleepMode(false, 20'000);
+
+        for (auto i = 1u; i <= 10; ++i)
+            RunFrame(limiter, *clock.state, i, 4 * ms, 10 * ms);
+
+        auto start = clock.state->now;
+        for (auto i = 11u; i <= 20; ++i)
+            RunFrame(limiter, *clock.state, i, 4 * ms, 10 * ms);
+
+        REQUIRE(clock.state->now - start >= 10 * 20 * ms - 20 * ms);
+        REQUIRE(limiter.GetFrameInterval() >= 19 * ms);
+    }
+
+    SECTION("Limits single sleeps") {
+        limiter.SetSleepMode(false, 1'000'000);
+
+        limiter.Sleep();
+        auto start = clock.state->now;
+        limiter.Sleep();
+
+        REQUIRE(clock.state->sleptUntil == start + decltype(limiter)::maxSleep);
+    }
+}
@@ -0,0 +1,118 @@
+#include "mock_driver.h"
+
+#include <array>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+
+// Measures the per-call overhead of the layer's overrides by calling each command once through the
+// layer and once directly on the mock driver. The layer configuration (e.g. frame ID injection) is
+// taken from the environment, same as when the layer is loaded by the Vulkan loader.
+
+namespace {
+    double Measure(uint32_t iterations, const std::function<void(uint32_t)>& fn) {
+        // Warm up caches and branch predictors before measuring
+        for (auto i = 0u; i < iterations / 10; ++i)
+            fn(i);
+
+        auto begin = std::chrono::steady_clock::now();
+
+        for (auto i = 0u; i < iterations; ++i)
+            fn(i);
+
+        auto end = std::chrono::steady_clock::now();
+
+        return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count()) / iterations;
+    }
+
+    template <typename T>
+    T GetMockProc(VkDevice device, const char* pName) {
+        return reinterpret_cast<T>(MockGetDeviceProcAddr(device, pName));
+    }
+
+    void Report(const char* name, double layered, double direct) {
+        std::printf("%-24s %10.1f %10.1f %10.1f\n", name, layered, direct, layered - direct);
+    }
+}
+
+int main(int argc, char** argv) {
+    uint32_t iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1'000'000;
+
+    if (!iterations)
+        iterations = 1'000'000;
+
+    LayerHarness harness;
+
+    if (harness.result != VK_SUCCESS) {
+        std::fprintf(stderr, "Failed to set up the layer: %d\n", harness.result);
+        return EXIT_FAILURE;
+    }
+
+    auto device = harness.device;
+    auto queue = harness.queue;
+    auto swapchain = harness.CreateSwapchain();
+
+    auto sleepModeInfo = VkLatencySleepModeInfoNV{
+        .sType = VK_STRUCTURE_TYPE_LATENCY_SLEEP_MODE_INFO_NV,
+        .lowLatencyMode = VK_TRUE,
+    };
+
+    harness.GetDeviceProc<PFN_vkSetLatencySleepModeNV>("vkSetLatencySleepModeNV")(device, swapchain, &sleepModeInfo);
+
+    auto submitInfo = VkSubmitInfo{.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO};
+    auto submitInfo2 = VkSubmitInfo2{.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2};
+    uint32_t imageIndex = 0;
+    auto presentInfo = VkPresentInfoKHR{
+        .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+        .swapchainCount = 1,
+        .pSwapchains = &swapchain,
+        .pImageIndices = &imageIndex,
+    };
+    auto sleepInfo = VkLatencySleepInfoNV{.sType = VK_STRUCTURE_TYPE_LATENCY_SLEEP_INFO_NV};
+    auto waitInfo = VkSemaphoreWaitInfo{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO};
+
+    // Keep a frame ID available, so that injection (when enabled) takes its full path
+    auto setMarker = harness.GetDeviceProc<PFN_vkSetLatencyMarkerNV>("vkSetLatencyMarkerNV");
+    for (auto marker : {VK_LATENCY_MARKER_SIMULATION_START_NV, VK_LATENCY_MARKER_RENDERSUBMIT_START_NV, VK_LATENCY_MARKER_PRESENT_START_NV}) {
+        auto markerInfo = VkSetLatencyMarkerInfoNV{
+            .sType = VK_STRUCTURE_TYPE_SET_LATENCY_MARKER_INFO_NV,
+            .presentID = 1,
+            .marker = marker,
+        };
+
+        setMarker(device, swapchain, &markerInfo);
+    }
+
+    std::printf("%" PRIu32 " iterations\n", iterations);
+    std::printf("%-24s %10s %10s %10s\n", "ns/call", "layer", "direct", "overhead");
+
+#define BENCHMARK_COMMAND(name, type, ...)                                                             \
+    do {                                                                                               \
+        auto layered = harness.GetDeviceProc<type>("vk" #name);                                        \
+        auto direct = GetMockProc<type>(device, "vk" #name);                                           \
+        Report(#name, Measure(iterations, [&]([[maybe_unused]] uint32_t i) { layered(__VA_ARGS__); }), \
+            Measure(iterations, [&]([[maybe_unused]] uint32_t i) { direct(__VA_ARGS__); }));           \
+    } while (0)
+
+    BENCHMARK_COMMAND(QueueSubmit, PFN_vkQueueSubmit, queue, 1, &submitInfo, VK_NULL_HANDLE);
+    BENCHMARK_COMMAND(QueueSubmit2, PFN_vkQueueSubmit2, queue, 1, &submitInfo2, VK_NULL_HANDLE);
+    BENCHMARK_COMMAND(QueuePresentKHR, PFN_vkQueuePresentKHR, queue, &presentInfo);
+    BENCHMARK_COMMAND(LatencySleepNV, PFN_vkLatencySleepNV, device, swapchain, &sleepInfo);
+    BENCHMARK_COMMAND(WaitSemaphores, PFN_vkWaitSemaphores, device, &waitInfo, 0);
+
+    // Alternate between start and end markers of a submit range so that the injection state keeps changing
+    auto renderSubmitMarkers = std::array{
+        VkSetLatencyMarkerInfoNV{.sType = VK_STRUCTURE_TYPE_SET_LATENCY_MARKER_INFO_NV, .presentID = 1, .marker = VK_LATENCY_MARKER_RENDERSUBMIT_START_NV},
+        VkSetLatencyMarkerInfoNV{.sType = VK_STRUCTURE_TYPE_SET_LATENCY_MARKER_INFO_NV, .presentID = 1, .marker = VK_LATENCY_MARKER_RENDERSUBMIT_END_NV},
+    };
+
+    BENCHMARK_COMMAND(SetLatencyMarkerNV, PFN_vkSetLatencyMarkerNV, device, swapchain, &renderSubmitMarkers[i & 1]);
+
+#undef BENCHMARK_COMMAND
+
+    harness.DestroySwapchain(swapchain);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,4 @@
+#define CATCH_CONFIG_MAIN
+#include "section_listener.h"
+
+CATCH_REGISTER_LISTENER(SectionListener)
@@ -0,0 +1,491 @@
+#include "section_listener.h"
+
+#include <algorithm>
+#include <array>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+    struct LayerProcs {
+        explicit LayerProcs(const LayerHarness& harness)
+            : QueueSubmit(harness.GetDeviceProc<PFN_vkQueueSubmit>("vkQueueSubmit")),
+              QueueSubmit2(harness.GetDeviceProc<PFN_vkQueueSubmit2>("vkQueueSubmit2")),
+              QueueSubmit2KHR(harness.GetDeviceProc<PFN_vkQueueSubmit2KHR>("vkQueueSubmit2KHR")),
+              QueuePresentKHR(harness.GetDeviceProc<PFN_vkQueuePresentKHR>("vkQueuePresentKHR")),
+              SetLatencySleepModeNV(harness.GetDeviceProc<PFN_vkSetLatencySleepModeNV>("vkSetLatencySleepModeNV")),
+              LatencySleepNV(harness.GetDeviceProc<PFN_vkLatencySleepNV>("vkLatencySleepNV")),
+              SetLatencyMarkerNV(harness.GetDeviceProc<PFN_vkSetLatencyMarkerNV>("vkSetLatencyMarkerNV")),
+              GetLatencyTimingsNV(harness.GetDeviceProc<PFN_vkGetLatencyTimingsNV>("vkGetLatencyTimingsNV")),
+              QueueNotifyOutOfBandNV(harness.GetDeviceProc<PFN_vkQueueNotifyOutOfBandNV>("vkQueueNotifyOutOfBandNV")) {}
+
+        PFN_vkQueueSubmit QueueSubmit;
+        PFN_vkQueueSubmit2 QueueSubmit2;
+        PFN_vkQueueSubmit2KHR QueueSubmit2KHR;
+        PFN_vkQueuePresentKHR QueuePresentKHR;
+        PFN_vkSetLatencySleepModeNV SetLatencySleepModeNV;
+        PFN_vkLatencySleepNV LatencySleepNV;
+        PFN_vkSetLatencyMarkerNV SetLatencyMarkerNV;
+        PFN_vkGetLatencyTimingsNV GetLatencyTimingsNV;
+        PFN_vkQueueNotifyOutOfBandNV QueueNotifyOutOfBandNV;
+    };
+
+    bool IsExtensionEnabled(std::string_view name) {
+        auto& state = GetMockDriverState();
+        std::scoped_lock lock{state.mutex};
+        return std::find(state.enabledDeviceExtensions.begin(), state.enabledDeviceExtensions.end(), name) != state.enabledDeviceExtensions.end();
+    }
+
+    void SetLowLatencyMode(const LayerHarness& harness, const LayerProcs& procs, bool enable) {
+        auto sleepModeInfo = VkLatencySleepModeInfoNV{
+            .sType = VK_STRUCTURE_TYPE_LATENCY_SLEEP_MODE_INFO_NV,
+            .lowLatencyMode = enable,
+        };
+
+        REQUIRE(procs.SetLatencySleepModeNV(harness.device, VK_NULL_HANDLE, &sleepModeInfo) == VK_SUCCESS);
+    }
+
+    void SetMarker(const LayerHarness& harness, const LayerProcs& procs, VkLatencyMarkerNV marker, uint64_t presentID) {
+        auto markerInfo = VkSetLatencyMarkerInfoNV{
+            .sType = VK_STRUCTURE_TYPE_SET_LATENCY_MARKER_INFO_NV,
+            .presentID = presentID,
+            .marker = marker,
+        };
+
+        procs.SetLatencyMarkerNV(harness.device, VK_NULL_HANDLE, &markerInfo);
+    }
+
+    void NotifyOutOfBand(const LayerProcs& procs, VkQueue queue, VkOutOfBandQueueTypeNV queueType) {
+        auto queueTypeInfo = VkOutOfBandQueueTypeInfoNV{
+            .sType = VK_STRUCTURE_TYPE_OUT_OF_BAND_QUEUE_TYPE_INFO_NV,
+            .queueType = queueType,
+        };
+
+        procs.QueueNotifyOutOfBandNV(queue, &queueTypeInfo);
+    }
+
+    VkResult Submit(const LayerProcs& procs, VkQueue queue) {
+        auto submitInfo = VkSubmitInfo{.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO};
+        return procs.QueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
+    }
+
+    VkResult Submit2(const LayerProcs& procs, VkQueue queue) {
+        auto submitInfo = VkSubmitInfo2{.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2};
+        return procs.QueueSubmit2(queue, 1, &submitInfo, VK_NULL_HANDLE);
+    }
+
+    VkResult Present(const LayerProcs& procs, VkQueue queue, VkSwapchainKHR swapchain) {
+        uint32_t imageIndex = 0;
+        auto presentInfo = VkPresentInfoKHR{
+            .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+            .swapchainCount = 1,
+            .pSwapchains = &swapchain,
+            .pImageIndices = &imageIndex,
+        };
+
+        return procs.QueuePresentKHR(queue, &presentInfo);
+    }
+}
+
+TEST_CASE("Vulkan Reflex layer", "[layer]") {
+    auto& state = GetMockDriverState();
+
+    SECTION("CreateDevice enables VK_NV_low_latency2 and timeline semaphores") {
+        LayerHarness harness;
+        REQUIRE(harness.result == VK_SUCCESS);
+        REQUIRE(IsExtensionEnabled(VK_KHR_SWAPCHAIN_EXTENSION_NAME));
+        REQUIRE(IsExtensionEnabled(VK_NV_LOW_LATENCY_2_EXTENSION_NAME));
+        REQUIRE_FALSE(IsExtensionEnabled(VK_KHR_PRESENT_ID_EXTENSION_NAME));
+        REQUIRE(state.timelineSemaphoreEnabled);
+        REQUIRE_FALSE(state.presentIdEnabled);
+    }
+
+    SECTION("CreateDevice enables VK_KHR_timeline_semaphore for Vulkan 1.0 applications") {
+        LayerHarness harness{VK_API_VERSION_1_0};
+        REQUIRE(harness.result == VK_SUCCESS);
+        REQUIRE(IsExtensionEnabled(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME));
+        REQUIRE(IsExtensionEnabled(VK_NV_LOW_LATENCY_2_EXTENSION_NAME));
+    }
+
+    SECTION("CreateDevice skips setup when VK_NV_low_latency2 is not supported") {
+        state.supportsLowLatency2 = false;
+
+        LayerHarness harness;
+        REQUIRE(harness.result == VK_SUCCESS);
+        REQUIRE(IsExtensionEnabled(VK_KHR_SWAPCHAIN_EXTENSION_NAME));
+        REQUIRE_FALSE(IsExtensionEnabled(VK_NV_LOW_LATENCY_2_EXTENSION_NAME));
+        REQUIRE_FALSE(state.timelineSemaphoreEnabled);
+    }
+
+    SECTION("CreateSwapchainKHR enables latency mode") {
+        LayerHarness harness;
+        REQUIRE(harness.result == VK_SUCCESS);
+        REQUIRE(harness.CreateSwapchain() != VK_NULL_HANDLE);
+        REQUIRE(state.swapchainLatencyCreateInfo);
+    }
+
+    SECTION("SetLatencySleepModeNV is deferred until a swapchain exists and uses the layer's swapchain") {
+        LayerHarness harness;
+        REQUIRE(harness.result == VK_SUCCESS);
+        LayerProcs procs{harness};
+
+        auto sleepModeInfo = VkLatencySleepModeInfoNV{
+            .sType = VK_STRUCTURE_TYPE_LATENCY_SLEEP_MODE_INFO_NV,
+            .lowLatencyMode = VK_TRUE,
+            .minimumIntervalUs = 1000,
+        };
+
+        REQUIRE(procs.SetLatencySleepModeNV(harness.device, VK_NULL_HANDLE, &sleepModeInfo) == VK_SUCCESS);
+        REQUIRE(state.setLatencySleepModeCount == 0);
+
+        auto swapchain = harness.CreateSwapchain();
+        REQUIRE(state.setLatencySleepModeCount == 1);
+        REQUIRE(state.lastSleepModeSwapchain == swapchain);
+        REQUIRE(state.lastSleepModeInfo.lowLatencyMode == VK_TRUE);
+        REQUIRE(state.lastSleepModeInfo.minimumIntervalUs == 1000);
+
+        sleepModeInfo.minimumIntervalUs = 2000;
+        REQUIRE(procs.SetLatencySleepModeNV(harness.device, VK_NULL_HANDLE, &sleepModeInfo) == VK_SUCCESS);
+        REQUIRE(state.setLatencySleepModeCount == 2);
+        REQUIRE(state.lastSleepModeSwapchain == swapchain);
+        REQUIRE(state.lastSleepModeInfo.minimumIntervalUs == 2000);
+
+        harness.DestroySwapchain(swapchain);
+        REQUIRE(procs.SetLatencySleepModeNV(harness.device, VK_NULL_HANDLE, &sleepModeInfo) == VK_SUCCESS);
+        REQUIRE(state.setLatencySleepModeCount == 2);
+    }
+
+    SECTION("LatencySleepNV signals the semaphore when no swapchain exists") {
+        LayerHarness harness;
+        REQUIRE(harness.result == VK_SUCCESS);
+        LayerProcs procs{harness};
+
+        auto sleepInfo = VkLatencySleepInfoNV{
+            .sType = VK_STRUCTURE_TYPE_LATENCY_SLEEP_INFO_NV,
+            .value = 5,
+        };
+
+        REQUIRE(procs.LatencySleepNV(harness.device, VK_NULL_HANDLE, &sleepInfo) == VK_SUCCESS);
+        REQUIRE(state.latencySleepCount == 0);
+        REQUIRE(state.signalSemaphoreCount == 1);
+        REQUIRE(state.lastSignalValue == 5);
+
+        auto swapchain = harness.CreateSwapchain();
+        REQUIRE(swapchain != VK_NULL_HANDLE);
+
+        sleepInfo.value = 6;
+        REQUIRE(procs.LatencySleepNV(harness.device, VK_NULL_HANDLE, &sleepInfo) == VK_SUCCESS);
+        REQUIRE(state.latencySleepCount == 1);
+        REQUIRE(state.signalSemaphoreCount == 1);
+        REQUIRE(state.lastSignalValue == 6);
+
+        REQUIRE(procs.LatencySleepNV(harness.device, VK_NULL_HANDLE, nullptr) == VK_ERROR_UNKNOWN);
+    }
+
+    SECTION("SetLatencyMarkerNV and GetLatencyTimingsNV are forwarded once a swapchain exists") {
+        LayerHarness harness;
+        REQUIRE(harness.result == VK_SUCCESS);
+        LayerProcs procs{harness};
+
+        VkLatencyTimingsFrameReportNV timings[4]{};
+        auto markerInfo = VkGetLatencyMarkerInfoNV{
+            .sType = VK_STRUCTURE_TYPE_GET_LATENCY_MARKER_INFO_NV,
+            .timingCount = 4,
+            .pTimings = timings,
+        };
+
+        SetMarker(harness, procs, VK_LATENCY_MARKER_SIMULATION_START_NV, 1);
+        procs.GetLatencyTimingsNV(harness.device, VK_NULL_HANDLE, &markerInfo);
+        REQUIRE(state.setLatencyMarkerCount == 0);
+        REQUIRE(state.getLatencyTimingsCount == 0);
+        REQUIRE(markerInfo.timingCount == 0);
+
+        REQUIRE(harness.CreateSwapchain() != VK_NULL_HANDLE);
+
+        markerInfo.timingCount = 4;
+        SetMarker(harness, procs, VK_LATENCY_MARKER_SIMULATION_START_NV, 2);
+        procs.GetLatencyTimingsNV(harness.device, VK_NULL_HANDLE, &markerInfo);
+        REQUIRE(state.setLatencyMarkerCount == 1);
+        REQUIRE(state.getLatencyTimingsCount == 1);
+        REQUIRE(markerInfo.timingCount == 4);
+    }
+
+    SECTION("Submits and presents are passed through unchanged") {
+        LayerHarness harness;
+        REQUIRE(harness.result == VK_SUCCESS);
+        LayerProcs procs{harness};
+
+        auto swapchain = harness.CreateSwapchain();
+        SetLowLatencyMode(harness, procs, true);
+        SetMarker(harness, procs, VK_LATENCY_MARKER_SIMULATION_START_NV, 42);
+        SetMarker(harness, procs, VK_LATENCY_MARKER_RENDERSUBMIT_START_NV, 42);
+
+        REQUIRE(Submit(procs, harness.queue) == VK_SUCCESS);
+        REQUIRE(Submit2(procs, harness.queue) == VK_SUCCESS);
+
+        auto submitInfo = VkSubmitInfo2{.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2};
+        REQUIRE(procs.QueueSubmit2KHR(harness.queue, 1, &submitInfo, VK_NULL_HANDLE) == VK_SUCCESS);
+
+        REQUIRE(state.queueSubmitCount == 1);
+        REQUIRE(state.queueSubmit2Count == 2);
+        REQUIRE(state.lastSubmitPresentID == 0);
+
+        SetMarker(harness, procs, VK_LATENCY_MARKER_PRESENT_START_NV, 42);
+        REQUIRE(Present(procs, harness.queue, swapchain) == VK_SUCCESS);
+        REQUIRE(state.queuePresentCount == 1);
+        REQUIRE(state.lastPresentID == 0);
+
+        NotifyOutOfBand(procs, harness.GetQueue(1), VK_OUT_OF_BAND_QUEUE_TYPE_RENDER_NV);
+        REQUIRE(state.queueNotifyOutOfBandCount == 1);
+    }
+
+    SECTION("Concurrent submits and presents on multiple queues") {
+        LayerHarness harness;
+        REQUIRE(harness.result == VK_SUCCESS);
+        LayerProcs procs{harness};
+
+        auto swapchain = harness.CreateSwapchain();
+        auto queues = std::array{harness.GetQueue(0), harness.GetQueue(1), harness.GetQueue(2), harness.GetQueue(3)};
+        constexpr auto iterations = 1000u;
+
+        std::vector<std::thread> threads;
+        for (auto queue : queues) {
+            threads.emplace_back([&, queue] {
+                for (auto i = 0u; i < iterations; ++i) {
+                    Submit(procs, queue);
+                    Submit2(procs, queue);
+                    Present(procs, queue, swapchain);
+                }
+            });
+        }
+
+        for (auto& thread : threads)
+            thread.join();
+
+        REQUIRE(state.queueSubmitCount == queues.size() * iterations);
+        REQUIRE(state.queueSubmit2Count == queues.size() * iterations);
+        REQUIRE(state.queuePresentCount == queues.size() * iterations);
+    }
+}
+
+TEST_CASE("Vulkan Reflex layer frame ID injection", "[.inject-frame-ids]") {
+    auto& state = GetMockDriverState();
+
+    SECTION("CreateDevice enables VK_KHR_present_id") {
+        LayerHarness harness;
+        REQUIRE(harness.result == VK_SUCCESS);
+        REQUIRE(IsExtensionEnabled(VK_NV_LOW_LATENCY_2_EXTENSION_NAME));
+        REQUIRE(IsExtensionEnabled(VK_KHR_PRESENT_ID_EXTENSION_NAME));
+        REQUIRE(state.presentIdEnabled);
+    }
+
+    SECTION("Submits and presents carry the Reflex frame ID in low latency mode") {
+        LayerHarness harness;
+        REQUIRE(harness.result == VK_SUCCESS);
+        LayerProcs procs{harness};
+
+        auto swapchain = harness.CreateSwapchain();
+
+        SetMarker(harness, procs, VK_LATENCY_MARKER_RENDERSUBMIT_START_NV, 1);
+        REQUIRE(Submit(procs, harness.queue) == VK_SUCCESS);
+        REQUIRE(state.lastSubmitPresentID == 0);
+
+        SetLowLatencyMode(harness, procs, true);
+
+        SetMarker(harness, procs, VK_LATENCY_MARKER_RENDERSUBMIT_START_NV, 2);
+        REQUIRE(Submit(procs, harness.queue) == VK_SUCCESS);
+        REQUIRE(state.lastSubmitPresentID == 2);
+        REQUIRE(Submit2(procs, harness.queue) == VK_SUCCESS);
+        REQUIRE(state.lastSubmitPresentID == 2);
+        SetMarker(harness, procs, VK_LATENCY_MARKER_RENDERSUBMIT_END_NV, 2);
+
+        SetMarker(harness, procs, VK_LATENCY_MARKER_PRESENT_START_NV, 2);
+        REQUIRE(Present(procs, harness.queue, swapchain) == VK_SUCCESS);
+        REQUIRE(state.lastPresentID == 2);
+        SetMarker(harness, procs, VK_LATENCY_MARKER_PRESENT_END_NV, 2);
+
+        SetMarker(harness, procs, VK_LATENCY_MARKER_SIMULATION_START_NV, 3);
+        REQUIRE(Submit(procs, harness.queue) == VK_SUCCESS);
+        REQUIRE(state.lastSubmitPresentID == 3);
+    }
+
+    SECTION("Out-of-band queues take the frame ID from the out-of-band markers") {
+        LayerHarness harness;
+        REQUIRE(harness.result == VK_SUCCESS);
+        LayerProcs procs{harness};
+
+        auto swapchain = harness.CreateSwapchain();
+        auto outOfBandQueue = harness.GetQueue(1);
+
+        SetLowLatencyMode(harness, procs, true);
+        NotifyOutOfBand(procs, outOfBandQueue, VK_OUT_OF_BAND_QUEUE_TYPE_RENDER_NV);
+        NotifyOutOfBand(procs, outOfBandQueue, VK_OUT_OF_BAND_QUEUE_TYPE_PRESENT_NV);
+        REQUIRE(state.queueNotifyOutOfBandCount == 2);
+
+        SetMarker(harness, procs, VK_LATENCY_MARKER_RENDERSUBMIT_START_NV, 10);
+        SetMarker(harness, procs, VK_LATENCY_MARKER_OUT_OF_BAND_RENDERSUBMIT_START_NV, 11);
+
+        REQUIRE(Submit(procs, harness.queue) == VK_SUCCESS);
+        REQUIRE(state.lastSubmitPresentID == 10);
+        REQUIRE(Submit(procs, outOfBandQueue) == VK_SUCCESS);
+        REQUIRE(state.lastSubmitPresentID == 11);
+
+        SetMarker(harness, procs, VK_LATENCY_MARKER_PRESENT_START_NV, 10);
+        SetMarker(harness, procs, VK_LATENCY_MARKER_OUT_OF_BAND_PRESENT_START_NV, 11);
+
+        REQUIRE(Present(procs, harness.queue, swapchain) == VK_SUCCESS);
+        REQUIRE(state.lastPresentID == 10);
+        REQUIRE(Present(procs, outOfBandQueue, swapchain) == VK_SUCCESS);
+        REQUIRE(state.lastPresentID == 11);
+    }
+
+    SECTION("Any number of queues can be out-of-band") {
+        LayerHarness harness;
+        REQUIRE(harness.result == VK_SUCCESS);
+        LayerProcs procs{harness};
+
+        SetLowLatencyMode(harness, procs, true);
+        for (auto i = 1u; i < 32u; ++i)
+            NotifyOutOfBand(procs, harness.GetQueue(i), VK_OUT_OF_BAND_QUEUE_TYPE_RENDER_NV);
+
+        REQUIRE(state.queueNotifyOutOfBandCount == 31);
+
+        SetMarker(harness, procs, VK_LATENCY_MARKER_RENDERSUBMIT_START_NV, 30);
+        SetMarker(harness, procs, VK_LATENCY_MARKER_OUT_OF_BAND_RENDERSUBMIT_START_NV, 31);
+
+        REQUIRE(Submit(procs, harness.queue) == VK_SUCCESS);
+        REQUIRE(state.lastSubmitPresentID == 30);
+        REQUIRE(Submit(procs, harness.GetQueue(31)) == VK_SUCCESS);
+        REQUIRE(state.lastSubmitPresentID == 31);
+    }
+
+    SECTION("Concurrent submits and out-of-band notifications") {
+        LayerHarness harness;
+        REQUIRE(harness.result == VK_SUCCESS);
+        LayerProcs procs{harness};
+
+        REQUIRE(harness.CreateSwapchain() != VK_NULL_HANDLE);
+        SetLowLatencyMode(harness, procs, true);
+        SetMarker(harness, procs, VK_LATENCY_MARKER_RENDERSUBMIT_START_NV, 20);
+        SetMarker(harness, procs, VK_LATENCY_MARKER_OUT_OF_BAND_RENDERSUBMIT_START_NV, 20);
+
+        auto queues = std::array{harness.GetQueue(0), harness.GetQueue(1), harness.GetQueue(2), harness.GetQueue(3)};
+        constexpr auto iterations = 1000u;
+
+        std::vector<std::thread> threads;
+        for (auto queue : queues) {
+            threads.emplace_back([&, queue] {
+                for (auto i = 0u; i < iterations; ++i) {
+                    if (queue != queues[0] && i == iterations / 2)
+                        NotifyOutOfBand(procs, queue, VK_OUT_OF_BAND_QUEUE_TYPE_RENDER_NV);
+
+                    Submit(procs, queue);
+                }
+            });
+        }
+
+        for (auto& thread : threads)
+            thread.join();
+
+        REQUIRE(state.queueSubmitCount == queues.size() * iterations);
+        REQUIRE(state.queueNotifyOutOfBandCount == queues.size() - 1);
+        REQUIRE(state.lastSubmitPresentID == 20);
+    }
+}
+
+TEST_CASE("Vulkan Reflex layer software latency limiter", "[.software-latency-limiter]") {
+    auto& state = GetMockDriverState();
+
+    SECTION("CreateDevice enables the limiter when VK_NV_low_latency2 is not supported") {
+        state.supportsLowLatency2 = false;
+
+        LayerHarness harness;
+        REQUIRE(harness.result == VK_SUCCESS);
+        REQUIRE_FALSE(IsExtensionEnabled(VK_NV_LOW_LATENCY_2_EXTENSION_NAME));
+        REQUIRE_FALSE(IsExtensionEnabled(VK_KHR_PRESENT_ID_EXTENSION_NAME));
+        REQUIRE(state.timelineSemaphoreEnabled);
+
+        REQUIRE(harness.CreateSwapchain() != VK_NULL_HANDLE);
+        REQUIRE_FALSE(state.swapchainLatencyCreateInfo);
+    }
+
+    SECTION("EnumerateDeviceExtensionProperties advertises VK_NV_low_latency2 when emulated") {
+        state.supportsLowLatency2 = false;
+
+        LayerHarness harness;
+        REQUIRE(harness.result == VK_SUCCESS);
+
+        auto extensions = harness.EnumerateDeviceExtensions();
+        REQUIRE(std::ranges::count_if(extensions, [](auto& ext) { return ext.extensionName == std::string_view{VK_NV_LOW_LATENCY_2_EXTENSION_NAME} && ext.specVersion == 2; }) == 1);
+        REQUIRE(std::ranges::any_of(extensions, [](auto& ext) { return ext.extensionName == std::string_view{VK_KHR_SWAPCHAIN_EXTENSION_NAME}; }));
+    }
+
+    SECTION("CreateDevice accepts the emulated VK_NV_low_latency2 without passing it to the driver") {
+        state.supportsLowLatency2 = false;
+
+        LayerHarness harness{VK_API_VERSION_1_3, {VK_KHR_SWAPCHAIN_EXTENSION_NAME, VK_NV_LOW_LATENCY_2_EXTENSION_NAME}};
+        REQUIRE(harness.result == VK_SUCCESS);
+        REQUIRE_FALSE(IsExtensionEnabled(VK_NV_LOW_LATENCY_2_EXTENSION_NAME));
+        REQUIRE(IsExtensionEnabled(VK_KHR_SWAPCHAIN_EXTENSION_NAME));
+
+        LayerProcs procs{harness};
+        SetLowLatencyMode(harness, procs, true);
+        REQUIRE(state.setLatencySleepModeCount == 0);
+    }
+
+    SECTION("VK_NV_low_latency2 commands are handled by the layer") {
+        state.supportsLowLatency2 = false;
+
+        LayerHarness harness;
+        REQUIRE(harness.result == VK_SUCCESS);
+        LayerProcs procs{harness};
+
+        auto swapchain = harness.CreateSwapchain();
+        SetLowLatencyMode(harness, procs, true);
+        NotifyOutOfBand(procs, harness.GetQueue(1), VK_OUT_OF_BAND_QUEUE_TYPE_RENDER_NV);
+
+        for (auto i = 1u; i <= 3; ++i) {
+            SetMarker(harness, procs, VK_LATENCY_MARKER_SIMULATION_START_NV, i);
+            SetMarker(harness, procs, VK_LATENCY_MARKER_PRESENT_START_NV, i);
+            REQUIRE(Present(procs, harness.queue, swapchain) == VK_SUCCESS);
+
+            auto sleepInfo = VkLatencySleepInfoNV{
+                .sType = VK_STRUCTURE_TYPE_LATENCY_SLEEP_INFO_NV,
+                .value = i,
+            };
+
+            REQUIRE(procs.LatencySleepNV(harness.device, VK_NULL_HANDLE, &sleepInfo) == VK_SUCCESS);
+            REQUIRE(state.lastSignalValue == i);
+        }
+
+        VkLatencyTimingsFrameReportNV timings[4]{};
+        auto markerInfo = VkGetLatencyMarkerInfoNV{
+            .sType = VK_STRUCTURE_TYPE_GET_LATENCY_MARKER_INFO_NV,
+            .timingCount = 4,
+            .pTimings = timings,
+        };
+
+        procs.GetLatencyTimingsNV(harness.device, VK_NULL_HANDLE, &markerInfo);
+        REQUIRE(markerInfo.timingCount == 0);
+
+        REQUIRE(state.queuePresentCount == 3);
+        REQUIRE(state.signalSemaphoreCount == 3);
+        REQUIRE(state.setLatencySleepModeCount == 0);
+        REQUIRE(state.latencySleepCount == 0);
+        REQUIRE(state.setLatencyMarkerCount == 0);
+        REQUIRE(state.getLatencyTimingsCount == 0);
+        REQUIRE(state.queueNotifyOutOfBandCount == 0);
+    }
+
+    SECTION("The limiter stays inactive when VK_NV_low_latency2 is supported") {
+        LayerHarness harness;
+        REQUIRE(harness.result == VK_SUCCESS);
+        REQUIRE(IsExtensionEnabled(VK_NV_LOW_LATENCY_2_EXTENSION_NAME));
+
+        auto extensions = harness.EnumerateDeviceExtensions();
+        REQUIRE(std::ranges::count_if(extensions, [](auto& ext) { return ext.extensionName == std::string_view{VK_NV_LOW_LATENCY_2_EXTENSION_NAME}; }) == 1);
+
+        REQUIRE(harness.CreateSwapchain() != VK_NULL_HANDLE);
+        REQUIRE(state.swapchainLatencyCreateInfo);
+    }
+}
@@ -0,0 +1,455 @@
+#include "mock_driver.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <string_view>
+#include <unordered_map>
+
+// Exported by the layer, this is the entrypoint the Vulkan loader uses
+extern "C" VKAPI_ATTR VkResult VKAPI_CALL vkNegotiateLoaderLayerInterfaceVersion(VkNegotiateLayerInterface* pVersionStruct);
+
+namespace {
+    struct MockObject {
+        void* loaderData;
+    };
+
+    struct MockInstance : MockObject {
+        MockObject physicalDevice;
+    };
+
+    struct MockDevice : MockObject {
+        std::array<MockObject, 32> queues;
+        bool lowLatency2;
+    };
+
+    MockDriverState state;
+
+    std::vector<VkExtensionProperties> GetDeviceExtensions() {
+        auto extensions = std::vector<VkExtensionProperties>{
+            {VK_KHR_SWAPCHAIN_EXTENSION_NAME, VK_KHR_SWAPCHAIN_SPEC_VERSION},
+            {VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME, VK_KHR_TIMELINE_SEMAPHORE_SPEC_VERSION},
+            {VK_KHR_PRESENT_ID_EXTENSION_NAME, VK_KHR_PRESENT_ID_SPEC_VERSION},
+        };
+
+        if (state.supportsLowLatency2)
+            extensions.push_back({VK_NV_LOW_LATENCY_2_EXTENSION_NAME, 2});
+
+        return extensions;
+    }
+
+    template <typename T>
+    const T* FindInChain(const void* pNext, VkStructureType sType) {
+        for (auto s = static_cast<const VkBaseInStructure*>(pNext); s; s = s->pNext) {
+            if (s->sType == sType)
+                return reinterpret_cast<const T*>(s);
+        }
+
+        return nullptr;
+    }
+
+    uint64_t GetSubmitPresentID(const void* pNext) {
+        auto presentId = FindInChain<VkLatencySubmissionPresentIdNV>(pNext, VK_STRUCTURE_TYPE_LATENCY_SUBMISSION_PRESENT_ID_NV);
+        return presentId ? presentId->presentID : 0;
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL CreateInstance(const VkInstanceCreateInfo*, const VkAllocationCallbacks*, VkInstance* pInstance) {
+        *pInstance = reinterpret_cast<VkInstance>(new MockInstance{});
+        return VK_SUCCESS;
+    }
+
+    VKAPI_ATTR void VKAPI_CALL DestroyInstance(VkInstance instance, const VkAllocationCallbacks*) {
+        delete reinterpret_cast<MockInstance*>(instance);
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL EnumeratePhysicalDevices(VkInstance instance, uint32_t* pPhysicalDeviceCount, VkPhysicalDevice* pPhysicalDevices) {
+        if (!pPhysicalDevices) {
+            *pPhysicalDeviceCount = 1;
+            return VK_SUCCESS;
+        }
+
+        if (!*pPhysicalDeviceCount)
+            return VK_INCOMPLETE;
+
+        *pPhysicalDevices = reinterpret_cast<VkPhysicalDevice>(&reinterpret_cast<MockInstance*>(instance)->physicalDevice);
+        *pPhysicalDeviceCount = 1;
+        return VK_SUCCESS;
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL EnumerateDeviceExtensionProperties(VkPhysicalDevice, const char*, uint32_t* pPropertyCount, VkExtensionProperties* pProperties) {
+        auto extensions = GetDeviceExtensions();
+
+        if (!pProperties) {
+            *pPropertyCount = extensions.size();
+            return VK_SUCCESS;
+        }
+
+        auto count = std::min<uint32_t>(*pPropertyCount, extensions.size());
+        std::copy_n(extensions.begin(), count, pProperties);
+        *pPropertyCount = count;
+
+        return count < extensions.size() ? VK_INCOMPLETE : VK_SUCCESS;
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL CreateDevice(VkPhysicalDevice, const VkDeviceCreateInfo* pCreateInfo, const VkAllocationCallbacks*, VkDevice* pDevice) {
+        auto supported = GetDeviceExtensions();
+        auto enabled = std::vector<std::string>{};
+
+        for (auto i = 0u; i < pCreateInfo->enabledExtensionCount; ++i) {
+            auto name = std::string{pCreateInfo->ppEnabledExtensionNames[i]};
+
+            if (std::ranges::none_of(supported, [&](auto& ext) { return ext.extensionName == name; }))
+                return VK_ERROR_EXTENSION_NOT_PRESENT;
+
+            enabled.push_back(std::move(name));
+        }
+
+        auto timelineSemaphoreFeatures = FindInChain<VkPhysicalDeviceTimelineSemaphoreFeatures>(pCreateInfo->pNext, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES);
+        auto vulkan12Features = FindInChain<VkPhysicalDeviceVulkan12Features>(pCreateInfo->pNext, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES);
+        auto presentIdFeatures = FindInChain<VkPhysicalDevicePresentIdFeaturesKHR>(pCreateInfo->pNext, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR);
+
+        std::scoped_lock lock{state.mutex};
+        state.timelineSemaphoreEnabled = (timelineSemaphoreFeatures && timelineSemaphoreFeatures->timelineSemaphore) || (vulkan12Features && vulkan12Features->timelineSemaphore);
+        state.presentIdEnabled = presentIdFeatures && presentIdFeatures->presentId;
+
+        auto device = new MockDevice{};
+        device->lowLatency2 = std::find(enabled.begin(), enabled.end(), VK_NV_LOW_LATENCY_2_EXTENSION_NAME) != enabled.end();
+        state.enabledDeviceExtensions = std::move(enabled);
+
+        *pDevice = reinterpret_cast<VkDevice>(device);
+        return VK_SUCCESS;
+    }
+
+    VKAPI_ATTR void VKAPI_CALL DestroyDevice(VkDevice device, const VkAllocationCallbacks*) {
+        delete reinterpret_cast<MockDevice*>(device);
+    }
+
+    VKAPI_ATTR void VKAPI_CALL GetDeviceQueue(VkDevice device, uint32_t, uint32_t queueIndex, VkQueue* pQueue) {
+        auto& queues = reinterpret_cast<MockDevice*>(device)->queues;
+        *pQueue = reinterpret_cast<VkQueue>(&queues[std::min<size_t>(queueIndex, queues.size() - 1)]);
+    }
+
+    VKAPI_ATTR void VKAPI_CALL GetDeviceQueue2(VkDevice device, const VkDeviceQueueInfo2* pQueueInfo, VkQueue* pQueue) {
+        GetDeviceQueue(device, pQueueInfo->queueFamilyIndex, pQueueInfo->queueIndex, pQueue);
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL QueueSubmit(VkQueue, uint32_t submitCount, const VkSubmitInfo* pSubmits, VkFence) {
+        state.queueSubmitCount++;
+        state.lastSubmitPresentID = submitCount ? GetSubmitPresentID(pSubmits[0].pNext) : 0;
+        return VK_SUCCESS;
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL QueueSubmit2(VkQueue, uint32_t submitCount, const VkSubmitInfo2* pSubmits, VkFence) {
+        state.queueSubmit2Count++;
+        state.lastSubmitPresentID = submitCount ? GetSubmitPresentID(pSubmits[0].pNext) : 0;
+        return VK_SUCCESS;
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL QueuePresentKHR(VkQueue, const VkPresentInfoKHR* pPresentInfo) {
+        auto presentId = FindInChain<VkPresentIdKHR>(pPresentInfo->pNext, VK_STRUCTURE_TYPE_PRESENT_ID_KHR);
+
+        state.queuePresentCount++;
+        state.lastPresentID = presentId && presentId->pPresentIds ? presentId->pPresentIds[0] : 0;
+        return VK_SUCCESS;
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL CreateSwapchainKHR(VkDevice, const VkSwapchainCreateInfoKHR* pCreateInfo, const VkAllocationCallbacks*, VkSwapchainKHR* pSwapchain) {
+        static std::atomic<uintptr_t> nextSwapchain = 0x1000;
+
+        auto latencyCreateInfo = FindInChain<VkSwapchainLatencyCreateInfoNV>(pCreateInfo->pNext, VK_STRUCTURE_TYPE_SWAPCHAIN_LATENCY_CREATE_INFO_NV);
+
+        std::scoped_lock lock{state.mutex};
+        state.swapchainLatencyCreateInfo = latencyCreateInfo && latencyCreateInfo->latencyModeEnable;
+
+        *pSwapchain = VkSwapchainKHR(nextSwapchain++);
+        return VK_SUCCESS;
+    }
+
+    VKAPI_ATTR void VKAPI_CALL DestroySwapchainKHR(VkDevice, VkSwapchainKHR, const VkAllocationCallbacks*) {}
+
+    VKAPI_ATTR VkResult VKAPI_CALL SetLatencySleepModeNV(VkDevice, VkSwapchainKHR swapchain, const VkLatencySleepModeInfoNV* pSleepModeInfo) {
+        std::scoped_lock lock{state.mutex};
+        state.setLatencySleepModeCount++;
+        state.lastSleepModeSwapchain = swapchain;
+        state.lastSleepModeInfo = pSleepModeInfo ? *pSleepModeInfo : VkLatencySleepModeInfoNV{};
+        return VK_SUCCESS;
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL LatencySleepNV(VkDevice, VkSwapchainKHR, const VkLatencySleepInfoNV* pSleepInfo) {
+        state.latencySleepCount++;
+        state.lastSignalValue = pSleepInfo->value;
+        return VK_SUCCESS;
+    }
+
+    VKAPI_ATTR void VKAPI_CALL SetLatencyMarkerNV(VkDevice, VkSwapchainKHR, const VkSetLatencyMarkerInfoNV*) {
+        state.setLatencyMarkerCount++;
+    }
+
+    VKAPI_ATTR void VKAPI_CALL GetLatencyTimingsNV(VkDevice, VkSwapchainKHR, VkGetLatencyMarkerInfoNV*) {
+        state.getLatencyTimingsCount++;
+    }
+
+    VKAPI_ATTR void VKAPI_CALL QueueNotifyOutOfBandNV(VkQueue, const VkOutOfBandQueueTypeInfoNV*) {
+        state.queueNotifyOutOfBandCount++;
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL SignalSemaphore(VkDevice, const VkSemaphoreSignalInfo* pSignalInfo) {
+        state.signalSemaphoreCount++;
+        state.lastSignalValue = pSignalInfo->value;
+        return VK_SUCCESS;
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL WaitSemaphores(VkDevice, const VkSemaphoreWaitInfo*, uint64_t) {
+        state.waitSemaphoresCount++;
+        return VK_SUCCESS;
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL SetInstanceLoaderData(VkInstance, void*) {
+        return VK_SUCCESS;
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL SetDeviceLoaderData(VkDevice, void*) {
+        return VK_SUCCESS;
+    }
+
+#define MOCK_PROC(name, proc) {"vk" name, reinterpret_cast<PFN_vkVoidFunction>(&proc)}
+    const std::unordered_map<std::string_view, PFN_vkVoidFunction> instanceProcs = {
+        MOCK_PROC("CreateInstance", CreateInstance),
+        MOCK_PROC("DestroyInstance", DestroyInstance),
+        MOCK_PROC("EnumeratePhysicalDevices", EnumeratePhysicalDevices),
+        MOCK_PROC("EnumerateDeviceExtensionProperties", EnumerateDeviceExtensionProperties),
+        MOCK_PROC("CreateDevice", CreateDevice),
+        MOCK_PROC("GetInstanceProcAddr", MockGetInstanceProcAddr),
+    };
+
+    const std::unordered_map<std::string_view, PFN_vkVoidFunction> deviceProcs = {
+        MOCK_PROC("GetDeviceProcAddr", MockGetDeviceProcAddr),
+        MOCK_PROC("DestroyDevice", DestroyDevice),
+        MOCK_PROC("GetDeviceQueue", GetDeviceQueue),
+        MOCK_PROC("GetDeviceQueue2", GetDeviceQueue2),
+        MOCK_PROC("QueueSubmit", QueueSubmit),
+        MOCK_PROC("QueueSubmit2", QueueSubmit2),
+        MOCK_PROC("QueueSubmit2KHR", QueueSubmit2),
+        MOCK_PROC("QueuePresentKHR", QueuePresentKHR),
+        MOCK_PROC("CreateSwapchainKHR", CreateSwapchainKHR),
+        MOCK_PROC("DestroySwapchainKHR", DestroySwapchainKHR),
+        MOCK_PROC("SignalSemaphore", SignalSemaphore),
+        MOCK_PROC("SignalSemaphoreKHR", SignalSemaphore),
+        MOCK_PROC("WaitSemaphores", WaitSemaphores),
+        MOCK_PROC("WaitSemaphoresKHR", WaitSemaphores),
+    };
+
+    // Only resolvable when VK_NV_low_latency2 was enabled on the device, just like with a real driver
+    const std::unordered_map<std::string_view, PFN_vkVoidFunction> lowLatency2Procs = {
+        MOCK_PROC("SetLatencySleepModeNV", SetLatencySleepModeNV),
+        MOCK_PROC("LatencySleepNV", LatencySleepNV),
+        MOCK_PROC("SetLatencyMarkerNV", SetLatencyMarkerNV),
+        MOCK_PROC("GetLatencyTimingsNV", GetLatencyTimingsNV),
+        MOCK_PROC("QueueNotifyOutOfBandNV", QueueNotifyOutOfBandNV),
+    };
+#undef MOCK_PROC
+
+    PFN_vkVoidFunction FindProc(const std::unordered_map<std::string_view, PFN_vkVoidFunction>& procs, const char* pName) {
+        auto it = procs.find(pName);
+        return it != procs.end() ? it->second : nullptr;
+    }
+}
+
+void MockDriverState::Reset() {
+    std::scoped_lock lock{mutex};
+
+    supportsLowLatency2 = true;
+    enabledDeviceExtensions.clear();
+    timelineSemaphoreEnabled = false;
+    presentIdEnabled = false;
+    swapchainLatencyCreateInfo = false;
+    queueSubmitCount = 0;
+    queueSubmit2Count = 0;
+    queuePresentCount = 0;
+    lastSubmitPresentID = 0;
+    lastPresentID = 0;
+    setLatencySleepModeCount = 0;
+    lastSleepModeSwapchain = VK_NULL_HANDLE;
+    lastSleepModeInfo = VkLatencySleepModeInfoNV{};
+    latencySleepCount = 0;
+    signalSemaphoreCount = 0;
+    lastSignalValue = 0;
+    setLatencyMarkerCount = 0;
+    getLatencyTimingsCount = 0;
+    queueNotifyOutOfBandCount = 0;
+    waitSemaphoresCount = 0;
+}
+
+MockDriverState& GetMockDriverState() {
+    return state;
+}
+
+PFN_vkVoidFunction VKAPI_CALL MockGetInstanceProcAddr(VkInstance, const char* pName) {
+    if (auto proc = FindProc(instanceProcs, pName))
+        return proc;
+
+    if (auto proc = FindProc(deviceProcs, pName))
+        return proc;
+
+    return FindProc(lowLatency2Procs, pName);
+}
+
+PFN_vkVoidFunction VKAPI_CALL MockGetDeviceProcAddr(VkDevice device, const char* pName) {
+    if (auto proc = FindProc(deviceProcs, pName))
+        return proc;
+
+    if (device && reinterpret_cast<MockDevice*>(device)->lowLatency2)
+        return FindProc(lowLatency2Procs, pName);
+
+    return nullptr;
+}
+
+LayerHarness::LayerHarness(uint32_t apiVersion, std::vector<const char*> deviceExtensions) {
+    auto negotiateLayerInterface = VkNegotiateLayerInterface{
+        .sType = LAYER_NEGOTIATE_INTERFACE_STRUCT,
+        .pNext = nullptr,
+        .loaderLayerInterfaceVersion = CURRENT_LOADER_LAYER_INTERFACE_VERSION,
+    };
+
+    if ((result = vkNegotiateLoaderLayerInterfaceVersion(&negotiateLayerInterface)) != VK_SUCCESS)
+        return;
+
+    m_vkGetInstanceProcAddr = negotiateLayerInterface.pfnGetInstanceProcAddr;
+    m_vkGetDeviceProcAddr = negotiateLayerInterface.pfnGetDeviceProcAddr;
+
+    auto instanceLink = VkLayerInstanceLink{
+        .pNext = nullptr,
+        .pfnNextGetInstanceProcAddr = &MockGetInstanceProcAddr,
+        .pfnNextGetPhysicalDeviceProcAddr = nullptr,
+    };
+
+    auto instanceLoaderDataCallback = VkLayerInstanceCreateInfo{
+        .sType = VK_STRUCTURE_TYPE_LOADER_INSTANCE_CREATE_INFO,
+        .pNext = nullptr,
+        .function = VK_LOADER_DATA_CALLBACK,
+        .u = {.pfnSetInstanceLoaderData = &SetInstanceLoaderData},
+    };
+
+    auto instanceLayerLinkInfo = VkLayerInstanceCreateInfo{
+        .sType = VK_STRUCTURE_TYPE_LOADER_INSTANCE_CREATE_INFO,
+        .pNext = &instanceLoaderDataCallback,
+        .function = VK_LAYER_LINK_INFO,
+        .u = {.pLayerInfo = &instanceLink},
+    };
+
+    auto applicationInfo = VkApplicationInfo{
+        .sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
+        .pApplicationName = "dxvk-nvapi-vkreflex-layer-tests",
+        .pEngineName = "dxvk-nvapi",
+        .apiVersion = apiVersion,
+    };
+
+    auto instanceCreateInfo = VkInstanceCreateInfo{
+        .sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
+        .pNext = &instanceLayerLinkInfo,
+        .pApplicationInfo = &applicationInfo,
+    };
+
+    auto vkCreateInstance = reinterpret_cast<PFN_vkCreateInstance>(m_vkGetInstanceProcAddr(nullptr, "vkCreateInstance"));
+    if ((result = vkCreateInstance(&instanceCreateInfo, nullptr, &instance)) != VK_SUCCESS)
+        return;
+
+    auto vkEnumeratePhysicalDevices = reinterpret_cast<PFN_vkEnumeratePhysicalDevices>(m_vkGetInstanceProcAddr(instance, "vkEnumeratePhysicalDevices"));
+    uint32_t physicalDeviceCount = 1;
+    if ((result = vkEnumeratePhysicalDevices(instance, &physicalDeviceCount, &physicalDevice)) != VK_SUCCESS)
+        return;
+
+    auto deviceLink = VkLayerDeviceLink{
+        .pNext = nullptr,
+        .pfnNextGetInstanceProcAddr = &MockGetInstanceProcAddr,
+        .pfnNextGetDeviceProcAddr = &MockGetDeviceProcAddr,
+    };
+
+    auto deviceLoaderDataCallback = VkLayerDeviceCreateInfo{
+        .sType = VK_STRUCTURE_TYPE_LOADER_DEVICE_CREATE_INFO,
+        .pNext = nullptr,
+        .function = VK_LOADER_DATA_CALLBACK,
+        .u = {.pfnSetDeviceLoaderData = &SetDeviceLoaderData},
+    };
+
+    auto deviceLayerLinkInfo = VkLayerDeviceCreateInfo{
+        .sType = VK_STRUCTURE_TYPE_LOADER_DEVICE_CREATE_INFO,
+        .pNext = &deviceLoaderDataCallback,
+        .function = VK_LAYER_LINK_INFO,
+        .u = {.pLayerInfo = &deviceLink},
+    };
+
+    float queuePriorities[] = {1.0f, 1.0f};
+
+    auto queueCreateInfo = VkDeviceQueueCreateInfo{
+        .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+        .queueFamilyIndex = 0,
+        .queueCount = 2,
+        .pQueuePriorities = queuePriorities,
+    };
+
+    auto deviceCreateInfo = VkDeviceCreateInfo{
+        .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+        .pNext = &deviceLayerLinkInfo,
+        .queueCreateInfoCount = 1,
+        .pQueueCreateInfos = &queueCreateInfo,
+        .enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size()),
+        .ppEnabledExtensionNames = deviceExtensions.data(),
+    };
+
+    auto vkCreateDevice = reinterpret_cast<PFN_vkCreateDevice>(m_vkGetInstanceProcAddr(instance, "vkCreateDevice"));
+    if ((result = vkCreateDevice(physicalDevice, &deviceCreateInfo, nullptr, &device)) != VK_SUCCESS)
+        return;
+
+    queue = GetQueue(0);
+}
+
+LayerHarness::~LayerHarness() {
+    if (device)
+        GetDeviceProc<PFN_vkDestroyDevice>("vkDestroyDevice")(device, nullptr);
+
+    if (instance)
+        reinterpret_cast<PFN_vkDestroyInstance>(m_vkGetInstanceProcAddr(instance, "vkDestroyInstance"))(instance, nullptr);
+}
+
+PFN_vkVoidFunction LayerHarness::GetDeviceProcAddr(const char* pName) const {
+    return m_vkGetDeviceProcAddr(device, pName);
+}
+
+std::vector<VkExtensionProperties> LayerHarness::EnumerateDeviceExtensions() const {
+    auto vkEnumerateDeviceExtensionProperties = reinterpret_cast<PFN_vkEnumerateDeviceExtensionProperties>(m_vkGetInstanceProcAddr(instance, "vkEnumerateDeviceExtensionProperties"));
+
+    uint32_t count = 0;
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &count, nullptr);
+
+    auto extensions = std::vector<VkExtensionProperties>(count);
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &count, extensions.data());
+    extensions.resize(count);
+    return extensions;
+}
+
+VkSwapchainKHR LayerHarness::CreateSwapchain() {
+    auto swapchainCreateInfo = VkSwapchainCreateInfoKHR{
+        .sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
+        .minImageCount = 3,
+        .imageFormat = VK_FORMAT_B8G8R8A8_UNORM,
+        .imageExtent = {1920, 1080},
+        .imageArrayLayers = 1,
+        .imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+        .presentMode = VK_PRESENT_MODE_FIFO_KHR,
+    };
+
+    VkSwapchainKHR swapchain{};
+    GetDeviceProc<PFN_vkCreateSwapchainKHR>("vkCreateSwapchainKHR")(device, &swapchainCreateInfo, nullptr, &swapchain);
+    return swapchain;
+}
+
+void LayerHarness::DestroySwapchain(VkSwapchainKHR swapchain) {
+    GetDeviceProc<PFN_vkDestroySwapchainKHR>("vkDestroySwapchainKHR")(device, swapchain, nullptr);
+}
+
+VkQueue LayerHarness::GetQueue(uint32_t queueIndex) const {
+    VkQueue deviceQueue{};
+    GetDeviceProc<PFN_vkGetDeviceQueue>("vkGetDeviceQueue")(device, 0, queueIndex, &deviceQueue);
+    return deviceQueue;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#define VK_NO_PROTOTYPES
+
+#include <vulkan/vulkan_core.h>
+#include <vulkan/vk_layer.h>
+
+// Minimal Vulkan driver that sits below the layer in the call chain and records what the layer forwards
+struct MockDriverState {
+    bool supportsLowLatency2{true};
+
+    std::mutex mutex;
+    std::vector<std::string> enabledDeviceExtensions;
+    bool timelineSemaphoreEnabled{};
+    bool presentIdEnabled{};
+    bool swapchainLatencyCreateInfo{};
+
+    std::atomic<uint32_t> queueSubmitCount{};
+    std::atomic<uint32_t> queueSubmit2Count{};
+    std::atomic<uint32_t> queuePresentCount{};
+    std::atomic<uint64_t> lastSubmitPresentID{}; // from VkLatencySubmissionPresentIdNV, 0 when absent
+    std::atomic<uint64_t> lastPresentID{};       // from VkPresentIdKHR, 0 when absent
+
+    std::atomic<uint32_t> setLatencySleepModeCount{};
+    VkSwapchainKHR lastSleepModeSwapchain{};
+    VkLatencySleepModeInfoNV lastSleepModeInfo{};
+    std::atomic<uint32_t> latencySleepCount{};
+    std::atomic<uint32_t> signalSemaphoreCount{};
+    std::atomic<uint64_t> lastSignalValue{};
+    std::atomic<uint32_t> setLatencyMarkerCount{};
+    std::atomic<uint32_t> getLatencyTimingsCount{};
+    std::atomic<uint32_t> queueNotifyOutOfBandCount{};
+    std::atomic<uint32_t> waitSemaphoresCount{};
+
+    void Reset();
+};
+
+MockDriverState& GetMockDriverState();
+
+PFN_vkVoidFunction VKAPI_CALL MockGetInstanceProcAddr(VkInstance instance, const char* pName);
+PFN_vkVoidFunction VKAPI_CALL MockGetDeviceProcAddr(VkDevice device, const char* pName);
+
+// Drives the layer the way the Vulkan loader does: negotiates the interface, passes the layer link
+// info to vkCreateInstance and vkCreateDevice and calls all commands through the layer's entrypoints
+class LayerHarness {
+  public:
+    explicit LayerHarness(uint32_t apiVersion = VK_API_VERSION_1_3, std::vector<const char*> deviceExtensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME});
+    ~LayerHarness();
+
+    LayerHarness(const LayerHarness&) = delete;
+    LayerHarness& operator=(const LayerHarness&) = delete;
+
+    [[nodiscard]] PFN_vkVoidFunction GetDeviceProcAddr(const char* pName) const;
+
+    template <typename T>
+    [[nodiscard]] T GetDeviceProc(const char* pName) const {
+        return reinterpret_cast<T>(GetDeviceProcAddr(pName));
+    }
+
+    // Device extensions as reported through the layer to the application
+    [[nodiscard]] std::vector<VkExtensionProperties> EnumerateDeviceExtensions() const;
+
+    [[nodiscard]] VkSwapchainKHR CreateSwapchain();
+    void DestroySwapchain(VkSwapchainKHR swapchain);
+
+    [[nodiscard]] VkQueue GetQueue(uint32_t queueIndex) const;
+
+    VkResult result{VK_ERROR_INITIALIZATION_FAILED};
+    VkInstance instance{};
+    VkPhysicalDevice physicalDevice{};
+    VkDevice device{};
+    VkQueue queue{};
+
+  private:
+    PFN_vkGetInstanceProcAddr m_vkGetInstanceProcAddr{};
+    PFN_vkGetDeviceProcAddr m_vkGetDeviceProcAddr{};
+};
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <catch_amalgamated.hpp>
+#include "mock_driver.h"
+
+class SectionListener : public Catch::EventListenerBase {
+
+  public:
+    using Catch::EventListenerBase::EventListenerBase;
+
+    void sectionStarting(Catch::SectionInfo const& sectionInfo) override {
+        GetMockDriverState().Reset();
+    }
+};
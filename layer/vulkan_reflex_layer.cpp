@@ -1,8 +1,11 @@
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cinttypes>
 #include <cstdint>
 #include <cstdlib>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <string_view>
@@ -36,6 +39,7 @@
 
 #define LOG_CHANNEL "vkreflex_layer"
 #include "log.h"
+#include "latency_limiter.h"
 #include "config.h"
 #include "version.h"
 
@@ -63,6 +67,7 @@ static bool injectFrameIDs = injectSubmitFrameIDs || injectPresentFrameIDs;
 static bool allowFallbackToOutOfBandFrameID = true;
 static bool allowFallbackToPresentFrameID = true;
 static bool allowFallbackToSimulationFrameID = true;
+static bool softwareLatencyLimiter = false;
 
 static void Init() {
     ::InitLogger("DXVK_NVAPI_VKREFLEX_LAYER_LOG_LEVEL");
@@ -81,6 +86,7 @@ static void Init() {
     READ_FLAG(allowFallbackToOutOfBandFrameID, "ALLOW_FALLBACK_TO_OOB_FRAME_ID");
     READ_FLAG(allowFallbackToPresentFrameID, "ALLOW_FALLBACK_TO_PRESENT_FRAME_ID");
     READ_FLAG(allowFallbackToSimulationFrameID, "ALLOW_FALLBACK_TO_SIMULATION_FRAME_ID");
+    READ_FLAG(softwareLatencyLimiter, "SOFTWARE_LATENCY_LIMITER");
 #undef READ_FLAG
 
 #define LOG_FLAG(var) INFO("%s = %s", #var, var ? "1" : "0")
@@ -89,6 +95,7 @@ static void Init() {
     LOG_FLAG(allowFallbackToOutOfBandFrameID);
     LOG_FLAG(allowFallbackToPresentFrameID);
     LOG_FLAG(allowFallbackToSimulationFrameID);
+    LOG_FLAG(softwareLatencyLimiter);
 #undef LOG_FLAG
 }
 
@@ -103,48 +110,116 @@ struct ReflexMarker {
     bool ongoing;
 };
 
+struct ReflexMarkers {
+    ReflexMarker simulation;
+    ReflexMarker renderSubmit;
+    ReflexMarker present;
+    ReflexMarker outOfBandRenderSubmit;
+    ReflexMarker outOfBandPresent;
+};
+
+// Markers to take the frame ID from, in order of preference
+struct ReflexFrameIdMarkers {
+    uint32_t count;
+    std::array<ReflexMarker ReflexMarkers::*, 5> markers;
+};
+
+enum ReflexQueueFlags : uint32_t {
+    ReflexQueueFlags_None = 0,
+    ReflexQueueFlags_OutOfBandRenderSubmit = 1,
+    ReflexQueueFlags_OutOfBandPresent = 2,
+    ReflexQueueFlags_Count = 4,
+};
+
+struct ReflexDeviceContextData;
+struct ReflexQueueFunctions;
+
+using PFN_VkQueueDispatchQueueSubmit2 = decltype(&vkroots::VkQueueDispatch::QueueSubmit2);
+
+using PFN_ReflexQueueSubmit = VkResult (*)(
+    const vkroots::VkQueueDispatch& dispatch,
+    ReflexDeviceContextData& deviceContext,
+    const ReflexQueueFunctions& functions,
+    VkQueue queue,
+    uint32_t submitCount,
+    const VkSubmitInfo* pSubmits,
+    VkFence fence);
+
+using PFN_ReflexQueueSubmit2 = VkResult (*)(
+    PFN_VkQueueDispatchQueueSubmit2 queueSubmit2,
+    const vkroots::VkQueueDispatch& dispatch,
+    ReflexDeviceContextData& deviceContext,
+    const ReflexQueueFunctions& functions,
+    VkQueue queue,
+    uint32_t submitCount,
+    const VkSubmitInfo2* pSubmits,
+    VkFence fence);
+
+using PFN_ReflexQueuePresentKHR = VkResult (*)(
+    const vkroots::VkQueueDispatch& dispatch,
+    ReflexDeviceContextData& deviceContext,
+    const ReflexQueueFunctions& functions,
+    VkQueue queue,
+    const VkPresentInfoKHR* pPresentInfo);
+
+// Submit and present implementations specialised at device creation for the enabled features and the
+// out-of-band state of the queue, so that the hot path doesn't need to check any flags
+struct ReflexQueueFunctions {
+    uint32_t flags;
+    PFN_ReflexQueueSubmit queueSubmit;
+    PFN_ReflexQueueSubmit2 queueSubmit2;
+    PFN_ReflexQueuePresentKHR queuePresentKHR;
+    ReflexFrameIdMarkers submitFrameIdMarkers;
+    ReflexFrameIdMarkers presentFrameIdMarkers;
+};
+
 struct ReflexDeviceContextData {
     VkSwapchainKHR swapchain;
     VkLatencySleepModeInfoNV latencySleepModeInfo;
-    struct
-    {
-        ReflexMarker simulation;
-        ReflexMarker renderSubmit;
-        ReflexMarker present;
-        ReflexMarker outOfBandRenderSubmit;
-        ReflexMarker outOfBandPresent;
-    } markers;
-};
+    ReflexMarkers markers;
+    std::array<ReflexQueueFunctions, ReflexQueueFlags_Count> queueFunctions;
+    // Set when the driver lacks VK_NV_low_latency2 and the layer emulates it, VK_NV_low_latency2 commands must not be forwarded in this case
+    std::shared_ptr<LatencyLimiter<>> limiter;
+
+    // Queues keep a pointer to their functions in their UserData, vkQueueNotifyOutOfBandNV may swap it while other threads submit
+    const ReflexQueueFunctions& GetQueueFunctions(const vkroots::VkQueueDispatch& queueDispatch) const {
+        if (!queueDispatch.UserData)
+            return queueFunctions[ReflexQueueFlags_None];
 
-struct ReflexQueueContextData {
-    bool outOfBandRenderSubmit;
-    bool outOfBandPresent;
+        return *std::atomic_ref{queueDispatch.UserData.cast<const ReflexQueueFunctions*>()}.load(std::memory_order_acquire);
+    }
 };
 
-static uint64_t GetFrameId(const ReflexDeviceContextData& deviceContext, bool present, bool outOfBand) {
-#define TRY_MARKER(marker)       \
-    do {                         \
-        if ((marker)->ongoing)   \
-            return (marker)->id; \
-    } while (0)
+static ReflexFrameIdMarkers GetFrameIdMarkers(bool present, bool outOfBand) {
+    auto frameIdMarkers = ReflexFrameIdMarkers{};
+    auto add = [&frameIdMarkers](ReflexMarker ReflexMarkers::* marker) { frameIdMarkers.markers[frameIdMarkers.count++] = marker; };
+
     if (!present) {
         if (!outOfBand)
-            TRY_MARKER(&deviceContext.markers.renderSubmit);
+            add(&ReflexMarkers::renderSubmit);
 
         if (outOfBand || allowFallbackToOutOfBandFrameID)
-            TRY_MARKER(&deviceContext.markers.outOfBandRenderSubmit);
+            add(&ReflexMarkers::outOfBandRenderSubmit);
 
         if (allowFallbackToSimulationFrameID)
-            TRY_MARKER(&deviceContext.markers.simulation);
+            add(&ReflexMarkers::simulation);
     }
     if (present || allowFallbackToPresentFrameID) {
         if (!outOfBand)
-            TRY_MARKER(&deviceContext.markers.present);
+            add(&ReflexMarkers::present);
 
         if (outOfBand || allowFallbackToOutOfBandFrameID)
-            TRY_MARKER(&deviceContext.markers.outOfBandPresent);
+            add(&ReflexMarkers::outOfBandPresent);
+    }
+
+    return frameIdMarkers;
+}
+
+static uint64_t GetFrameId(const ReflexMarkers& markers, const ReflexFrameIdMarkers& frameIdMarkers) {
+    for (auto i = 0u; i < frameIdMarkers.count; ++i) {
+        if (auto& marker = markers.*frameIdMarkers.markers[i]; marker.ongoing)
+            return marker.id;
     }
-#undef TRY_MARKER
 
     return 0;
 }
@@ -192,51 +267,203 @@ static VkResult WaitSemaphores(
     return result;
 }
 
-using PFN_VkQueueDispatchQueueSubmit2 = decltype(&vkroots::VkQueueDispatch::QueueSubmit2);
+static VkResult QueueSubmitPassthrough(
+    const vkroots::VkQueueDispatch& dispatch,
+    ReflexDeviceContextData&,
+    const ReflexQueueFunctions&,
+    VkQueue queue,
+    uint32_t submitCount,
+    const VkSubmitInfo* pSubmits,
+    VkFence fence) {
+    return dispatch.QueueSubmit(queue, submitCount, pSubmits, fence);
+}
+
+static VkResult QueueSubmitInjectFrameIDs(
+    const vkroots::VkQueueDispatch& dispatch,
+    ReflexDeviceContextData& deviceContext,
+    const ReflexQueueFunctions& functions,
+    VkQueue queue,
+    uint32_t submitCount,
+    const VkSubmitInfo* pSubmits,
+    VkFence fence) {
+    if (!deviceContext.latencySleepModeInfo.lowLatencyMode || !pSubmits || !submitCount)
+        return dispatch.QueueSubmit(queue, submitCount, pSubmits, fence);
+
+    uint64_t id = ::GetFrameId(deviceContext.markers, functions.submitFrameIdMarkers);
+
+    TRACE("(%p, %" PRIu32 ", %p, %p) frameID = %" PRIu64 ", oob = %d",
+        queue, submitCount, pSubmits, fence, id, (functions.flags & ReflexQueueFlags_OutOfBandRenderSubmit) != 0);
+
+    if (!id)
+        return dispatch.QueueSubmit(queue, submitCount, pSubmits, fence);
+
+    auto submitInfos = std::vector<VkSubmitInfo>{
+        pSubmits,
+        pSubmits + submitCount,
+    };
+
+    auto latencySubmissionPresentIds = std::vector<VkLatencySubmissionPresentIdNV>{submitCount};
+
+    for (auto i = 0u; i < submitCount; ++i) {
+        auto info = &latencySubmissionPresentIds[i];
 
-static VkResult QueueSubmit2(
+        info->sType = VK_STRUCTURE_TYPE_LATENCY_SUBMISSION_PRESENT_ID_NV;
+        info->pNext = std::exchange(submitInfos[i].pNext, info);
+        info->presentID = id;
+    }
+
+    return dispatch.QueueSubmit(queue, submitCount, submitInfos.data(), fence);
+}
+
+static VkResult QueueSubmit2Passthrough(
+    PFN_VkQueueDispatchQueueSubmit2 queueSubmit2,
+    const vkroots::VkQueueDispatch& dispatch,
+    ReflexDeviceContextData&,
+    const ReflexQueueFunctions&,
+    VkQueue queue,
+    uint32_t submitCount,
+    const VkSubmitInfo2* pSubmits,
+    VkFence fence) {
+    return std::invoke(queueSubmit2, dispatch, queue, submitCount, pSubmits, fence);
+}
+
+static VkResult QueueSubmit2InjectFrameIDs(
     PFN_VkQueueDispatchQueueSubmit2 queueSubmit2,
     const vkroots::VkQueueDispatch& dispatch,
+    ReflexDeviceContextData& deviceContext,
+    const ReflexQueueFunctions& functions,
     VkQueue queue,
     uint32_t submitCount,
     const VkSubmitInfo2* pSubmits,
     VkFence fence) {
-    if (!injectSubmitFrameIDs)
+    if (!deviceContext.latencySleepModeInfo.lowLatencyMode || !pSubmits || !submitCount)
         return std::invoke(queueSubmit2, dispatch, queue, submitCount, pSubmits, fence);
 
-    if (!dispatch.pDeviceDispatch->UserData)
+    uint64_t id = ::GetFrameId(deviceContext.markers, functions.submitFrameIdMarkers);
+
+    TRACE("(%p, %" PRIu32 ", %p, %p) frameID = %" PRIu64 ", oob = %d",
+        queue, submitCount, pSubmits, fence, id, (functions.flags & ReflexQueueFlags_OutOfBandRenderSubmit) != 0);
+
+    if (!id)
         return std::invoke(queueSubmit2, dispatch, queue, submitCount, pSubmits, fence);
 
-    auto& deviceContext = dispatch.pDeviceDispatch->UserData.cast<ReflexDeviceContextData>();
-    auto outOfBandRenderSubmit = dispatch.UserData ? dispatch.UserData.cast<ReflexQueueContextData>().outOfBandRenderSubmit : false;
+    auto submitInfos = std::vector<VkSubmitInfo2>{
+        pSubmits,
+        pSubmits + submitCount,
+    };
 
-    if (deviceContext.latencySleepModeInfo.lowLatencyMode && pSubmits && submitCount) {
-        uint64_t id = ::GetFrameId(deviceContext, false, outOfBandRenderSubmit);
+    auto latencySubmissionPresentIds = std::vector<VkLatencySubmissionPresentIdNV>{submitCount};
 
-        TRACE("(%p, %" PRIu32 ", %p, %p) frameID = %" PRIu64 ", oob = %d",
-            queue, submitCount, pSubmits, fence, id, outOfBandRenderSubmit);
+    for (auto i = 0u; i < submitCount; ++i) {
+        auto info = &latencySubmissionPresentIds[i];
 
-        if (id) {
-            auto submitInfos = std::vector<VkSubmitInfo2>{
-                pSubmits,
-                pSubmits + submitCount,
-            };
+        info->sType = VK_STRUCTURE_TYPE_LATENCY_SUBMISSION_PRESENT_ID_NV;
+        info->pNext = std::exchange(submitInfos[i].pNext, info);
+        info->presentID = id;
+    }
 
-            auto latencySubmissionPresentIds = std::vector<VkLatencySubmissionPresentIdNV>{submitCount};
+    return std::invoke(queueSubmit2, dispatch, queue, submitCount, submitInfos.data(), fence);
+}
 
-            for (auto i = 0u; i < submitCount; ++i) {
-                auto info = &latencySubmissionPresentIds[i];
+static VkResult QueuePresentKHRPassthrough(
+    const vkroots::VkQueueDispatch& dispatch,
+    ReflexDeviceContextData&,
+    const ReflexQueueFunctions&,
+    VkQueue queue,
+    const VkPresentInfoKHR* pPresentInfo) {
+    return dispatch.QueuePresentKHR(queue, pPresentInfo);
+}
 
-                info->sType = VK_STRUCTURE_TYPE_LATENCY_SUBMISSION_PRESENT_ID_NV;
-                info->pNext = std::exchange(submitInfos[i].pNext, info);
-                info->presentID = id;
-            }
+static VkResult QueuePresentKHRInjectFrameIDs(
+    const vkroots::VkQueueDispatch& dispatch,
+    ReflexDeviceContextData& deviceContext,
+    const ReflexQueueFunctions& functions,
+    VkQueue queue,
+    const VkPresentInfoKHR* pPresentInfo) {
+    if (!deviceContext.latencySleepModeInfo.lowLatencyMode || !pPresentInfo || !pPresentInfo->pSwapchains || !pPresentInfo->swapchainCount)
+        return dispatch.QueuePresentKHR(queue, pPresentInfo);
 
-            return std::invoke(queueSubmit2, dispatch, queue, submitCount, submitInfos.data(), fence);
-        }
+    uint32_t i;
+    uint64_t id = ::GetFrameId(deviceContext.markers, functions.presentFrameIdMarkers);
+
+    TRACE("(%p, %p) frameID = %" PRIu64 ", oob = %d",
+        queue, pPresentInfo, id, (functions.flags & ReflexQueueFlags_OutOfBandPresent) != 0);
+
+    if (!id)
+        return dispatch.QueuePresentKHR(queue, pPresentInfo);
+
+    for (i = 0; i < pPresentInfo->swapchainCount; ++i) {
+        if (pPresentInfo->pSwapchains[i] == deviceContext.swapchain)
+            break;
     }
 
-    return std::invoke(queueSubmit2, dispatch, queue, submitCount, pSubmits, fence);
+    if (i == pPresentInfo->swapchainCount)
+        return dispatch.QueuePresentKHR(queue, pPresentInfo);
+
+    if (auto pid = vkroots::FindInChain<VkPresentIdKHR>(pPresentInfo->pNext)) {
+        if (pid->swapchainCount <= i)
+            WARN("found VkPresentIdKHR with unexpected swapchain count (%" PRIu32 " <= %" PRIu32 ")", pid->swapchainCount, i);
+        else if (!pid->pPresentIds)
+            WARN("found VkPresentIdKHR with NULL pPresentIds");
+        else if (pid->pPresentIds[i] != id)
+            WARN("found VkPresentIdKHR (%" PRIu64 ") that does not match Reflex frame ID (%" PRIu64 ")", pid->pPresentIds[i], id);
+
+        return dispatch.QueuePresentKHR(queue, pPresentInfo);
+    }
+
+    auto presentIds = std::vector<uint64_t>{pPresentInfo->swapchainCount};
+
+    presentIds[i] = id;
+
+    auto presentId = VkPresentIdKHR{
+        .sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR,
+        .pNext = pPresentInfo->pNext,
+        .swapchainCount = pPresentInfo->swapchainCount,
+        .pPresentIds = presentIds.data(),
+    };
+
+    auto info = *pPresentInfo;
+    info.pNext = &presentId;
+
+    return dispatch.QueuePresentKHR(queue, &info);
+}
+
+static VkResult QueuePresentKHRLatencyLimiter(
+    const vkroots::VkQueueDispatch& dispatch,
+    ReflexDeviceContextData& deviceContext,
+    const ReflexQueueFunctions&,
+    VkQueue queue,
+    const VkPresentInfoKHR* pPresentInfo) {
+    auto vr = dispatch.QueuePresentKHR(queue, pPresentInfo);
+
+    if (pPresentInfo && pPresentInfo->pSwapchains && std::ranges::find(pPresentInfo->pSwapchains, pPresentInfo->pSwapchains + pPresentInfo->swapchainCount, deviceContext.swapchain) != pPresentInfo->pSwapchains + pPresentInfo->swapchainCount)
+        deviceContext.limiter->Present();
+
+    return vr;
+}
+
+static void InitQueueFunctions(ReflexDeviceContextData& deviceContext) {
+    // VkLatencySubmissionPresentIdNV is part of VK_NV_low_latency2 and VK_KHR_present_id isn't enabled when emulating it
+    auto injectSubmit = injectSubmitFrameIDs && !deviceContext.limiter;
+    auto injectPresent = injectPresentFrameIDs && !deviceContext.limiter;
+
+    for (auto flags = 0u; flags < ReflexQueueFlags_Count; ++flags) {
+        auto& functions = deviceContext.queueFunctions[flags];
+
+        functions.flags = flags;
+        functions.queueSubmit = injectSubmit ? &::QueueSubmitInjectFrameIDs : &::QueueSubmitPassthrough;
+        functions.queueSubmit2 = injectSubmit ? &::QueueSubmit2InjectFrameIDs : &::QueueSubmit2Passthrough;
+        functions.queuePresentKHR = deviceContext.limiter ? &::QueuePresentKHRLatencyLimiter
+            : injectPresent                               ? &::QueuePresentKHRInjectFrameIDs
+                                                          : &::QueuePresentKHRPassthrough;
+        functions.submitFrameIdMarkers = ::GetFrameIdMarkers(false, flags & ReflexQueueFlags_OutOfBandRenderSubmit);
+        functions.presentFrameIdMarkers = ::GetFrameIdMarkers(true, flags & ReflexQueueFlags_OutOfBandPresent);
+    }
+}
+
+static void InitQueueContext(const ReflexDeviceContextData& deviceContext, const vkroots::VkQueueDispatch* queueDispatch) {
+    if (queueDispatch && !queueDispatch->UserData)
+        queueDispatch->UserData.emplace<const ReflexQueueFunctions*>(&deviceContext.queueFunctions[ReflexQueueFlags_None]);
 }
 
 static constexpr auto gpdp2 = std::string_view{VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME};
@@ -245,6 +472,27 @@ static constexpr auto ll2 = std::string_view{VK_NV_LOW_LATENCY_2_EXTENSION_NAME}
 static constexpr auto ts = std::string_view{VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME};
 static constexpr auto pid = std::string_view{VK_KHR_PRESENT_ID_EXTENSION_NAME};
 
+static std::optional<std::vector<VkExtensionProperties>> GetDeviceExtensions(const vkroots::VkPhysicalDeviceDispatch& dispatch, VkPhysicalDevice physicalDevice) {
+    uint32_t count;
+    auto vr = dispatch.EnumerateDeviceExtensionProperties(physicalDevice, nullptr, &count, nullptr);
+
+    if (vr != VK_SUCCESS)
+        return std::nullopt;
+
+    std::vector<VkExtensionProperties> properties{count};
+    vr = dispatch.EnumerateDeviceExtensionProperties(physicalDevice, nullptr, &count, properties.data());
+
+    if (vr != VK_SUCCESS)
+        return std::nullopt;
+
+    properties.resize(count);
+    return properties;
+}
+
+static bool SupportsLowLatency2(const std::vector<VkExtensionProperties>& properties) {
+    return std::ranges::any_of(properties, [&](auto& prop) { return prop.extensionName == ll2 && prop.specVersion >= 2; });
+}
+
 // Similar to vkroots::AddToChain but with const_cast
 template <typename Type, typename AnyStruct>
 static inline void AddToChain(AnyStruct* pParent, Type* pType) {
@@ -307,27 +555,27 @@ struct VkInstanceOverrides {
 
         auto& context = dispatch.pInstanceDispatch->UserData.cast<ReflexInstanceContextData>();
 
-        uint32_t count;
-        auto vr = dispatch.EnumerateDeviceExtensionProperties(physicalDevice, nullptr, &count, nullptr);
+        auto properties = ::GetDeviceExtensions(dispatch, physicalDevice);
 
-        if (vr != VK_SUCCESS)
+        if (!properties)
             return dispatch.CreateDevice(physicalDevice, pCreateInfo, pAllocator, pDevice);
 
-        std::vector<VkExtensionProperties> properties{count};
-        vr = dispatch.EnumerateDeviceExtensionProperties(physicalDevice, nullptr, &count, properties.data());
+        bool emulateLL2 = false;
 
-        if (vr != VK_SUCCESS)
-            return dispatch.CreateDevice(physicalDevice, pCreateInfo, pAllocator, pDevice);
+        if (!::SupportsLowLatency2(*properties)) {
+            if (!softwareLatencyLimiter) {
+                INFO("%s not supported by physical device, skipping setup of compatibility layer (%s/%s)", ll2.data(), context.applicationName.c_str(), context.engineName.c_str());
+                return dispatch.CreateDevice(physicalDevice, pCreateInfo, pAllocator, pDevice);
+            }
 
-        if (std::ranges::none_of(properties, [&](auto& prop) { return prop.extensionName == ll2 && prop.specVersion >= 2; })) {
-            INFO("%s not supported by physical device, skipping setup of compatibility layer (%s/%s)", ll2.data(), context.applicationName.c_str(), context.engineName.c_str());
-            return dispatch.CreateDevice(physicalDevice, pCreateInfo, pAllocator, pDevice);
+            INFO("%s not supported by physical device, using software latency limiter (%s/%s)", ll2.data(), context.applicationName.c_str(), context.engineName.c_str());
+            emulateLL2 = true;
         }
 
         auto info = *pCreateInfo;
 
         for (auto ext = info.ppEnabledExtensionNames; ext && ext < info.ppEnabledExtensionNames + info.enabledExtensionCount; ++ext) {
-            if (*ext == ll2) {
+            if (*ext == ll2 && !emulateLL2) {
                 INFO("%s already requested by the application, skipping setup of compatibility layer (%s/%s)", ll2.data(), context.applicationName.c_str(), context.engineName.c_str());
                 return dispatch.CreateDevice(physicalDevice, pCreateInfo, pAllocator, pDevice);
             }
@@ -337,6 +585,7 @@ struct VkInstanceOverrides {
             ? std::vector<const char*>{
                   info.ppEnabledExtensionNames,
                   info.ppEnabledExtensionNames + info.enabledExtensionCount}
+            : emulateLL2     ? std::vector<const char*>{{ts.data()}}
             : injectFrameIDs ? std::vector<const char*>{{ts.data(), ll2.data(), pid.data()}}
                              : std::vector<const char*>{{ts.data(), ll2.data()}};
 
@@ -350,25 +599,30 @@ struct VkInstanceOverrides {
             .timelineSemaphore = VK_TRUE,
         };
 
-        bool hasLL2 = false;
+        // The application may have enabled the advertised VK_NV_low_latency2, the driver must not see it though
+        if (emulateLL2)
+            std::erase_if(extensions, [](auto ext) { return ext == ll2; });
+        else {
+            bool hasLL2 = false;
 
-        for (auto& ext : extensions) {
-            static constexpr auto llSize = ll.size();
+            for (auto& ext : extensions) {
+                static constexpr auto llSize = ll.size();
 
-            if (!strncmp(ext, ll.data(), llSize)) {
-                auto c = ext[llSize];
+                if (!strncmp(ext, ll.data(), llSize)) {
+                    auto c = ext[llSize];
 
-                if (!c)
-                    ext = ll2.data();
-                else if (c != '2' || ext[llSize + 1])
-                    continue;
+                    if (!c)
+                        ext = ll2.data();
+                    else if (c != '2' || ext[llSize + 1])
+                        continue;
 
-                hasLL2 = true;
+                    hasLL2 = true;
+                }
             }
-        }
 
-        if (!hasLL2)
-            extensions.push_back(ll2.data());
+            if (!hasLL2)
+                extensions.push_back(ll2.data());
+        }
 
         if (context.apiVersion < VK_API_VERSION_1_2) {
             if (std::ranges::find(extensions, ts) == extensions.end())
@@ -377,7 +631,7 @@ struct VkInstanceOverrides {
 
         auto pNext = const_cast<void*>(info.pNext);
 
-        if (injectFrameIDs) {
+        if (injectFrameIDs && !emulateLL2) {
             if (std::ranges::find(extensions, pid) == extensions.end())
                 extensions.push_back(pid.data());
 
@@ -397,16 +651,56 @@ struct VkInstanceOverrides {
         info.ppEnabledExtensionNames = extensions.data();
         info.enabledExtensionCount = extensions.size();
 
-        vr = dispatch.CreateDevice(physicalDevice, &info, pAllocator, pDevice);
+        auto vr = dispatch.CreateDevice(physicalDevice, &info, pAllocator, pDevice);
 
         if (vr != VK_SUCCESS)
             return vr;
 
-        vkroots::LookupDispatch(*pDevice)->UserData.emplace<ReflexDeviceContextData>();
+        auto deviceDispatch = vkroots::LookupDispatch(*pDevice);
+        deviceDispatch->UserData.emplace<ReflexDeviceContextData>();
+
+        auto& deviceContext = deviceDispatch->UserData.cast<ReflexDeviceContextData>();
+
+        if (emulateLL2)
+            deviceContext.limiter = std::make_shared<LatencyLimiter<>>();
+
+        ::InitQueueFunctions(deviceContext);
 
         INFO("Setup of compatibility layer succeeded (%s/%s)", context.applicationName.c_str(), context.engineName.c_str());
         return VK_SUCCESS;
     }
+
+    static VkResult EnumerateDeviceExtensionProperties(
+        const vkroots::VkPhysicalDeviceDispatch& dispatch,
+        VkPhysicalDevice physicalDevice,
+        const char* pLayerName,
+        uint32_t* pPropertyCount,
+        VkExtensionProperties* pProperties) {
+        if (!softwareLatencyLimiter || pLayerName || !pPropertyCount)
+            return dispatch.EnumerateDeviceExtensionProperties(physicalDevice, pLayerName, pPropertyCount, pProperties);
+
+        auto properties = ::GetDeviceExtensions(dispatch, physicalDevice);
+
+        if (!properties || ::SupportsLowLatency2(*properties))
+            return dispatch.EnumerateDeviceExtensionProperties(physicalDevice, pLayerName, pPropertyCount, pProperties);
+
+        // Applications only use the software latency limiter when they see VK_NV_low_latency2
+        std::erase_if(*properties, [](auto& prop) { return prop.extensionName == ll2; });
+
+        auto& emulated = properties->emplace_back(VkExtensionProperties{.specVersion = 2});
+        ll2.copy(emulated.extensionName, ll2.size());
+
+        if (!pProperties) {
+            *pPropertyCount = properties->size();
+            return VK_SUCCESS;
+        }
+
+        auto count = std::min<uint32_t>(*pPropertyCount, properties->size());
+        std::copy_n(properties->begin(), count, pProperties);
+        *pPropertyCount = count;
+
+        return count < properties->size() ? VK_INCOMPLETE : VK_SUCCESS;
+    }
 };
 
 struct VkDeviceOverrides {
@@ -420,6 +714,16 @@ struct VkDeviceOverrides {
             return dispatch.CreateSwapchainKHR(device, pCreateInfo, pAllocator, pSwapchain);
 
         auto& context = dispatch.UserData.cast<ReflexDeviceContextData>();
+
+        if (context.limiter) {
+            auto vr = dispatch.CreateSwapchainKHR(device, pCreateInfo, pAllocator, pSwapchain);
+
+            if (vr == VK_SUCCESS)
+                context.swapchain = *pSwapchain;
+
+            return vr;
+        }
+
         auto info = *pCreateInfo;
 
         auto swapchainLatencyCreateInfo = VkSwapchainLatencyCreateInfoNV{
@@ -478,48 +782,42 @@ struct VkDeviceOverrides {
         return ::WaitSemaphores(&vkroots::VkDeviceDispatch::WaitSemaphoresKHR, dispatch, device, pWaitInfo, timeout);
     }
 
+    static void GetDeviceQueue(
+        const vkroots::VkDeviceDispatch& dispatch,
+        VkDevice device,
+        uint32_t queueFamilyIndex,
+        uint32_t queueIndex,
+        VkQueue* pQueue) {
+        dispatch.GetDeviceQueue(device, queueFamilyIndex, queueIndex, pQueue);
+
+        if (dispatch.UserData && *pQueue)
+            ::InitQueueContext(dispatch.UserData.cast<ReflexDeviceContextData>(), vkroots::LookupDispatch(*pQueue));
+    }
+
+    static void GetDeviceQueue2(
+        const vkroots::VkDeviceDispatch& dispatch,
+        VkDevice device,
+        const VkDeviceQueueInfo2* pQueueInfo,
+        VkQueue* pQueue) {
+        dispatch.GetDeviceQueue2(device, pQueueInfo, pQueue);
+
+        if (dispatch.UserData && *pQueue)
+            ::InitQueueContext(dispatch.UserData.cast<ReflexDeviceContextData>(), vkroots::LookupDispatch(*pQueue));
+    }
+
     static VkResult QueueSubmit(
         const vkroots::VkQueueDispatch& dispatch,
         VkQueue queue,
         uint32_t submitCount,
         const VkSubmitInfo* pSubmits,
         VkFence fence) {
-        if (!injectSubmitFrameIDs)
-            return dispatch.QueueSubmit(queue, submitCount, pSubmits, fence);
-
         if (!dispatch.pDeviceDispatch->UserData)
             return dispatch.QueueSubmit(queue, submitCount, pSubmits, fence);
 
         auto& deviceContext = dispatch.pDeviceDispatch->UserData.cast<ReflexDeviceContextData>();
-        auto outOfBandRenderSubmit = dispatch.UserData ? dispatch.UserData.cast<ReflexQueueContextData>().outOfBandRenderSubmit : false;
-
-        if (deviceContext.latencySleepModeInfo.lowLatencyMode && pSubmits && submitCount) {
-            uint64_t id = ::GetFrameId(deviceContext, false, outOfBandRenderSubmit);
-
-            TRACE("(%p, %" PRIu32 ", %p, %p) frameID = %" PRIu64 ", oob = %d",
-                queue, submitCount, pSubmits, fence, id, outOfBandRenderSubmit);
-
-            if (id) {
-                auto submitInfos = std::vector<VkSubmitInfo>{
-                    pSubmits,
-                    pSubmits + submitCount,
-                };
-
-                auto latencySubmissionPresentIds = std::vector<VkLatencySubmissionPresentIdNV>{submitCount};
-
-                for (auto i = 0u; i < submitCount; ++i) {
-                    auto info = &latencySubmissionPresentIds[i];
-
-                    info->sType = VK_STRUCTURE_TYPE_LATENCY_SUBMISSION_PRESENT_ID_NV;
-                    info->pNext = std::exchange(submitInfos[i].pNext, info);
-                    info->presentID = id;
-                }
-
-                return dispatch.QueueSubmit(queue, submitCount, submitInfos.data(), fence);
-            }
-        }
+        auto& functions = deviceContext.GetQueueFunctions(dispatch);
 
-        return dispatch.QueueSubmit(queue, submitCount, pSubmits, fence);
+        return functions.queueSubmit(dispatch, deviceContext, functions, queue, submitCount, pSubmits, fence);
     }
 
     static VkResult QueueSubmit2(
@@ -528,7 +826,13 @@ struct VkDeviceOverrides {
         uint32_t submitCount,
         const VkSubmitInfo2* pSubmits,
         VkFence fence) {
-        return ::QueueSubmit2(&vkroots::VkQueueDispatch::QueueSubmit2, dispatch, queue, submitCount, pSubmits, fence);
+        if (!dispatch.pDeviceDispatch->UserData)
+            return dispatch.QueueSubmit2(queue, submitCount, pSubmits, fence);
+
+        auto& deviceContext = dispatch.pDeviceDispatch->UserData.cast<ReflexDeviceContextData>();
+        auto& functions = deviceContext.GetQueueFunctions(dispatch);
+
+        return functions.queueSubmit2(&vkroots::VkQueueDispatch::QueueSubmit2, dispatch, deviceContext, functions, queue, submitCount, pSubmits, fence);
     }
 
     static VkResult QueueSubmit2KHR(
@@ -537,68 +841,26 @@ struct VkDeviceOverrides {
         uint32_t submitCount,
         const VkSubmitInfo2KHR* pSubmits,
         VkFence fence) {
-        return ::QueueSubmit2(&vkroots::VkQueueDispatch::QueueSubmit2KHR, dispatch, queue, submitCount, pSubmits, fence);
+        if (!dispatch.pDeviceDispatch->UserData)
+            return dispatch.QueueSubmit2KHR(queue, submitCount, pSubmits, fence);
+
+        auto& deviceContext = dispatch.pDeviceDispatch->UserData.cast<ReflexDeviceContextData>();
+        auto& functions = deviceContext.GetQueueFunctions(dispatch);
+
+        return functions.queueSubmit2(&vkroots::VkQueueDispatch::QueueSubmit2KHR, dispatch, deviceContext, functions, queue, submitCount, pSubmits, fence);
     }
 
     static VkResult QueuePresentKHR(
         const vkroots::VkQueueDispatch& dispatch,
         VkQueue queue,
         const VkPresentInfoKHR* pPresentInfo) {
-        if (!injectPresentFrameIDs)
-            return dispatch.QueuePresentKHR(queue, pPresentInfo);
-
         if (!dispatch.pDeviceDispatch->UserData)
             return dispatch.QueuePresentKHR(queue, pPresentInfo);
 
         auto& deviceContext = dispatch.pDeviceDispatch->UserData.cast<ReflexDeviceContextData>();
-        auto outOfBandPresent = dispatch.UserData ? dispatch.UserData.cast<ReflexQueueContextData>().outOfBandPresent : false;
-
-        if (deviceContext.latencySleepModeInfo.lowLatencyMode && pPresentInfo && pPresentInfo->pSwapchains && pPresentInfo->swapchainCount) {
-            uint32_t i;
-            uint64_t id = ::GetFrameId(deviceContext, true, outOfBandPresent);
+        auto& functions = deviceContext.GetQueueFunctions(dispatch);
 
-            TRACE("(%p, %p) frameID = %" PRIu64 ", oob = %d",
-                queue, pPresentInfo, id, outOfBandPresent);
-
-            if (!id)
-                goto end;
-
-            for (i = 0; i < pPresentInfo->swapchainCount; ++i) {
-                if (pPresentInfo->pSwapchains[i] == deviceContext.swapchain)
-                    break;
-            }
-
-            if (i == pPresentInfo->swapchainCount)
-                goto end;
-
-            if (auto pid = vkroots::FindInChain<VkPresentIdKHR>(pPresentInfo->pNext)) {
-                if (pid->swapchainCount <= i)
-                    WARN("found VkPresentIdKHR with unexpected swapchain count (%" PRIu32 " <= %" PRIu32 ")", pid->swapchainCount, i);
-                else if (!pid->pPresentIds)
-                    WARN("found VkPresentIdKHR with NULL pPresentIds");
-                else if (pid->pPresentIds[i] != id)
-                    WARN("found VkPresentIdKHR (%" PRIu64 ") that does not match Reflex frame ID (%" PRIu64 ")", pid->pPresentIds[i], id);
-            } else {
-                auto presentIds = std::vector<uint64_t>{pPresentInfo->swapchainCount};
-
-                presentIds[i] = id;
-
-                auto presentId = VkPresentIdKHR{
-                    .sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR,
-                    .pNext = pPresentInfo->pNext,
-                    .swapchainCount = pPresentInfo->swapchainCount,
-                    .pPresentIds = presentIds.data(),
-                };
-
-                auto info = *pPresentInfo;
-                info.pNext = &presentId;
-
-                return dispatch.QueuePresentKHR(queue, &info);
-            }
-        }
-
-    end:
-        return dispatch.QueuePresentKHR(queue, pPresentInfo);
+        return functions.queuePresentKHR(dispatch, deviceContext, functions, queue, pPresentInfo);
     }
 
     static VkResult SetLatencySleepModeNV(
@@ -622,7 +884,9 @@ struct VkDeviceOverrides {
 
         auto vr = VK_SUCCESS;
 
-        if (swapchain)
+        if (context.limiter)
+            context.limiter->SetSleepMode(pSleepModeInfo && pSleepModeInfo->lowLatencyMode, pSleepModeInfo ? pSleepModeInfo->minimumIntervalUs : 0);
+        else if (swapchain)
             vr = dispatch.SetLatencySleepModeNV(device, swapchain, pSleepModeInfo);
 
         if (vr == VK_SUCCESS) {
@@ -655,7 +919,9 @@ struct VkDeviceOverrides {
 
         swapchain = context.swapchain;
 
-        if (swapchain)
+        if (context.limiter)
+            context.limiter->Sleep();
+        else if (swapchain)
             return dispatch.LatencySleepNV(device, swapchain, pSleepInfo);
 
         auto semaphoreSignalInfo = VkSemaphoreSignalInfo{
@@ -687,7 +953,9 @@ struct VkDeviceOverrides {
 
         swapchain = context.swapchain;
 
-        if (swapchain)
+        if (context.limiter)
+            context.limiter->SetMarker(pLatencyMarkerInfo->presentID, pLatencyMarkerInfo->marker);
+        else if (swapchain)
             dispatch.SetLatencyMarkerNV(device, swapchain, pLatencyMarkerInfo);
 
         if (!injectFrameIDs)
@@ -758,7 +1026,7 @@ struct VkDeviceOverrides {
 
         swapchain = context.swapchain;
 
-        if (swapchain)
+        if (swapchain && !context.limiter)
             dispatch.GetLatencyTimingsNV(device, swapchain, pLatencyMarkerInfo);
         else
             pLatencyMarkerInfo->timingCount = 0;
@@ -774,26 +1042,39 @@ struct VkDeviceOverrides {
         TRACE("(%p, %p { %s })",
             queue, pQueueTypeInfo, vkroots::helpers::enumString(pQueueTypeInfo->queueType));
 
-        dispatch.QueueNotifyOutOfBandNV(queue, pQueueTypeInfo);
+        if (!dispatch.pDeviceDispatch->UserData) {
+            dispatch.QueueNotifyOutOfBandNV(queue, pQueueTypeInfo);
+            return;
+        }
+
+        auto& deviceContext = dispatch.pDeviceDispatch->UserData.cast<ReflexDeviceContextData>();
+
+        if (!deviceContext.limiter)
+            dispatch.QueueNotifyOutOfBandNV(queue, pQueueTypeInfo);
 
         if (!injectFrameIDs)
             return;
 
-        if (!dispatch.UserData)
-            dispatch.UserData.emplace<ReflexQueueContextData>();
-
-        auto& context = dispatch.UserData.cast<ReflexQueueContextData>();
+        uint32_t flags;
 
         switch (pQueueTypeInfo->queueType) {
             case VK_OUT_OF_BAND_QUEUE_TYPE_RENDER_NV:
-                context.outOfBandRenderSubmit = true;
+                flags = ReflexQueueFlags_OutOfBandRenderSubmit;
                 break;
             case VK_OUT_OF_BAND_QUEUE_TYPE_PRESENT_NV:
-                context.outOfBandPresent = true;
+                flags = ReflexQueueFlags_OutOfBandPresent;
                 break;
             default:
-                break;
+                return;
         }
+
+        ::InitQueueContext(deviceContext, &dispatch);
+
+        auto functions = std::atomic_ref{dispatch.UserData.cast<const ReflexQueueFunctions*>()};
+        auto current = functions.load(std::memory_order_relaxed);
+        auto desired = &deviceContext.queueFunctions[current->flags | flags];
+        while (!functions.compare_exchange_weak(current, desired, std::memory_order_release, std::memory_order_relaxed))
+            desired = &deviceContext.queueFunctions[current->flags | flags];
     }
 };
 
@@ -54,6 +54,101 @@ IDXGIVkInteropAdapter : public IUnknown {
         VkPhysicalDevice * pPhysDev) = 0;
 };
 
+struct IDXGIVkInteropDevice;
+
+/**
+ * \brief Private DXGI surface interface for Vulkan interop
+ *
+ * Implemented by DXVK resources, provides access
+ * to the Vulkan image that backs the resource.
+ */
+MIDL_INTERFACE("5546cf8c-77e7-4341-b05d-8d4d5000e77d")
+IDXGIVkInteropSurface : public IUnknown {
+    /**
+     * \brief Retrieves device interop interfaces
+     *
+     * \param [out] ppDevice The device interface
+     * \returns \c S_OK on success
+     */
+    virtual HRESULT STDMETHODCALLTYPE GetDevice(
+        IDXGIVkInteropDevice * *ppDevice) = 0;
+
+    /**
+     * \brief Retrieves Vulkan image info
+     *
+     * \param [out] pHandle Vulkan image handle
+     * \param [out] pLayout Image layout
+     * \param [out] pInfo Image properties
+     * \returns \c S_OK on success
+     */
+    virtual HRESULT STDMETHODCALLTYPE GetVulkanImageInfo(
+        VkImage * pHandle,
+        VkImageLayout * pLayout,
+        VkImageCreateInfo * pInfo) = 0;
+};
+
+/**
+ * \brief Private DXGI device interface for Vulkan interop
+ *
+ * Provides access to the Vulkan device and the
+ * queue that DXVK submits its command buffers to.
+ */
+MIDL_INTERFACE("e2ef5fa5-dc21-4af7-90c4-f67ef6a09323")
+IDXGIVkInteropDevice : public IUnknown {
+    /**
+     * \brief Queries Vulkan handles used by DXVK
+     *
+     * \param [out] pInstance The Vulkan instance
+     * \param [out] pPhysDev The physical device
+     * \param [out] pDevice The device handle
+     */
+    virtual void STDMETHODCALLTYPE GetVulkanHandles(
+        VkInstance * pInstance,
+        VkPhysicalDevice * pPhysDev,
+        VkDevice * pDevice) = 0;
+
+    /**
+     * \brief Queries the rendering queue used by DXVK
+     *
+     * \param [out] pQueue The Vulkan queue handle
+     * \param [out] pQueueFamilyIndex Queue family index
+     */
+    virtual void STDMETHODCALLTYPE GetSubmissionQueue(
+        VkQueue * pQueue,
+        uint32_t * pQueueFamilyIndex) = 0;
+
+    /**
+     * \brief Transitions a surface to a given layout
+     *
+     * \param [in] pSurface The image to transform
+     * \param [in] pSubresources Subresources to transform
+     * \param [in] OldLayout Current image layout
+     * \param [in] NewLayout Desired image layout
+     */
+    virtual void STDMETHODCALLTYPE TransitionSurfaceLayout(
+        IDXGIVkInteropSurface * pSurface,
+        const VkImageSubresourceRange* pSubresources,
+        VkImageLayout OldLayout,
+        VkImageLayout NewLayout) = 0;
+
+    /**
+     * \brief Flushes outstanding D3D rendering commands
+     */
+    virtual void STDMETHODCALLTYPE FlushRenderingCommands() = 0;
+
+    /**
+     * \brief Locks submission queue
+     *
+     * Must be held while submitting to the queue returned by GetSubmissionQueue.
+     */
+    virtual void STDMETHODCALLTYPE LockSubmissionQueue() = 0;
+
+    /**
+     * \brief Releases submission queue
+     */
+    virtual void STDMETHODCALLTYPE ReleaseSubmissionQueue() = 0;
+};
+
 MIDL_INTERFACE("8a6e3c42-f74c-45b7-8265-a231b677ca17")
 ID3D11VkExtDevice : public IUnknown {
     /**
@@ -174,6 +269,8 @@ IDXGIVkInteropFactory1 : public IDXGIVkInteropFactory {
 __CRT_UUID_DECL(IDXGIVkInteropFactory, 0x4c5e1b0d, 0xb0c8, 0x4131, 0xbf, 0xd8, 0x9b, 0x24, 0x76, 0xf7, 0xf4, 0x08);
 __CRT_UUID_DECL(IDXGIVkInteropFactory1, 0x2a289dbd, 0x2d0a, 0x4a51, 0x89, 0xf7, 0xf2, 0xad, 0xce, 0x46, 0x5c, 0xd6);
 __CRT_UUID_DECL(IDXGIVkInteropAdapter, 0x3a6d8f2c, 0xb0e8, 0x4ab4, 0xb4, 0xdc, 0x4f, 0xd2, 0x48, 0x91, 0xbf, 0xa5);
+__CRT_UUID_DECL(IDXGIVkInteropSurface, 0x5546cf8c, 0x77e7, 0x4341, 0xb0, 0x5d, 0x8d, 0x4d, 0x50, 0x00, 0xe7, 0x7d);
+__CRT_UUID_DECL(IDXGIVkInteropDevice, 0xe2ef5fa5, 0xdc21, 0x4af7, 0x90, 0xc4, 0xf6, 0x7e, 0xf6, 0xa0, 0x93, 0x23);
 __CRT_UUID_DECL(ID3D11VkExtDevice, 0x8a6e3c42, 0xf74c, 0x45b7, 0x82, 0x65, 0xa2, 0x31, 0xb6, 0x77, 0xca, 0x17);
 __CRT_UUID_DECL(ID3D11VkExtDevice1, 0xcfcf64ef, 0x9586, 0x46d0, 0xbc, 0xa4, 0x97, 0xcf, 0x2c, 0xa6, 0x1b, 0x06);
 __CRT_UUID_DECL(ID3D11VkExtContext, 0xfd0bca13, 0x5cb6, 0x4c3a, 0x98, 0x7e, 0x47, 0x50, 0xde, 0x2c, 0xa7, 0x91);
@@ -0,0 +1,53 @@
+#include "low_latency_frame_pacer.h"
+#include "../util/util_log.h"
+#include "../util/util_string.h"
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+namespace dxvk {
+    LowLatencyFramePacerClock::LowLatencyFramePacerClock() {
+        m_timer = ::CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+        m_highResolutionTimer = m_timer != nullptr;
+
+        // High resolution timers are not available on older Windows and Wine versions
+        if (!m_timer)
+            m_timer = ::CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+
+        log::info(str::format("Using frame pacer for Reflex frame rate limiting, high resolution timer: ", m_highResolutionTimer ? "yes" : "no"));
+    }
+
+    LowLatencyFramePacerClock::~LowLatencyFramePacerClock() {
+        if (m_timer)
+            ::CloseHandle(m_timer);
+    }
+
+    LowLatencyFramePacerClock::LowLatencyFramePacerClock(LowLatencyFramePacerClock&& other) noexcept
+        : m_timer(std::exchange(other.m_timer, nullptr)),
+          m_highResolutionTimer(other.m_highResolutionTimer) {}
+
+    uint64_t LowLatencyFramePacerClock::Now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void LowLatencyFramePacerClock::SleepUntil(uint64_t target) const {
+        auto now = Now();
+        if (target <= now)
+            return;
+
+        // Let the timer do the coarse part and spin for the last few hundred microseconds, timer wakeups
+        // are too imprecise for sub-100µs jitter
+        auto spinThreshold = m_highResolutionTimer ? spinThresholdNs : lowResolutionSpinThresholdNs;
+        if (m_timer && target - now > spinThreshold) {
+            LARGE_INTEGER dueTime;
+            dueTime.QuadPart = -static_cast<LONGLONG>((target - now - spinThreshold) / 100);
+
+            if (::SetWaitableTimer(m_timer, &dueTime, 0, nullptr, nullptr, FALSE))
+                ::WaitForSingleObject(m_timer, INFINITE);
+        }
+
+        while (Now() < target)
+            YieldProcessor();
+    }
+}
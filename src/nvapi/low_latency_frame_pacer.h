@@ -0,0 +1,128 @@
+#pragma once
+
+#include "../nvapi_private.h"
+#include "../util/util_env.h"
+
+namespace dxvk {
+    // Waits on a high resolution waitable timer where available and spins for the last few hundred microseconds
+    class LowLatencyFramePacerClock {
+
+      public:
+        static constexpr uint64_t spinThresholdNs = 300'000;
+        static constexpr uint64_t lowResolutionSpinThresholdNs = 2'000'000;
+
+        LowLatencyFramePacerClock();
+        ~LowLatencyFramePacerClock();
+
+        LowLatencyFramePacerClock(LowLatencyFramePacerClock&& other) noexcept;
+        LowLatencyFramePacerClock(const LowLatencyFramePacerClock&) = delete;
+        LowLatencyFramePacerClock& operator=(const LowLatencyFramePacerClock&) = delete;
+
+        [[nodiscard]] static uint64_t Now();
+        void SleepUntil(uint64_t target) const;
+
+      private:
+        HANDLE m_timer{};
+        bool m_highResolutionTimer{};
+    };
+
+    // Enforces the Reflex frame rate limit by sleeping until the next frame is due. The clock is a template
+    // parameter so the pacing logic can be driven by a virtual clock.
+    template <typename Clock = LowLatencyFramePacerClock>
+    class LowLatencyFramePacer {
+
+      public:
+        static constexpr uint64_t maxSleepNs = 1'000'000'000;
+
+        [[nodiscard]] static bool IsEnabled() {
+            static bool enabled = env::getEnvVariable("DXVK_NVAPI_FRAME_PACER") == "1";
+            return enabled;
+        }
+
+        explicit LowLatencyFramePacer(Clock clock = Clock{})
+            : m_clock(std::move(clock)) {}
+
+        LowLatencyFramePacer(const LowLatencyFramePacer&) = delete;
+        LowLatencyFramePacer& operator=(const LowLatencyFramePacer&) = delete;
+
+        void SetMinimumInterval(uint32_t minimumIntervalUs) {
+            std::scoped_lock lock{m_mutex};
+            m_minimumInterval = static_cast<uint64_t>(minimumIntervalUs) * 1000;
+        }
+
+        void SetMarker(VkLatencyMarkerNV marker) {
+            SetMarker(marker, m_clock.Now());
+        }
+
+        void SetMarker(VkLatencyMarkerNV marker, uint64_t timestamp) {
+            std::scoped_lock lock{m_mutex};
+
+            switch (marker) {
+                case VK_LATENCY_MARKER_SIMULATION_START_NV:
+                    m_simulationStart = timestamp;
+                    break;
+                case VK_LATENCY_MARKER_PRESENT_START_NV: {
+                    if (!m_simulationStart || timestamp < m_simulationStart)
+                        break;
+
+                    auto frameTime = timestamp - m_simulationStart;
+                    if (frameTime > maxSleepNs)
+                        break; // Discard outliers like loading screens
+
+                    // Exponentially weighted moving average with alpha = 1/8
+                    m_predictedFrameTime = m_predictedFrameTime
+                        ? static_cast<uint64_t>(static_cast<int64_t>(m_predictedFrameTime) + (static_cast<int64_t>(frameTime) - static_cast<int64_t>(m_predictedFrameTime)) / 8)
+                        : frameTime;
+                    m_lastPresentStart = timestamp;
+                    m_simulationStart = 0;
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+
+        void Sleep() {
+            auto now = m_clock.Now();
+            auto target = ScheduleWakeup(now);
+            if (target > now)
+                m_clock.SleepUntil(target);
+        }
+
+        [[nodiscard]] uint64_t ScheduleWakeup(uint64_t now) {
+            std::scoped_lock lock{m_mutex};
+
+            if (!m_minimumInterval) {
+                m_lastWakeup = now;
+                return now;
+            }
+
+            // Without markers simply keep the wakeups one interval apart, otherwise wake up in time for the
+            // predicted simulation-to-present duration to put the next present one interval after the previous one
+            auto target = m_lastWakeup ? m_lastWakeup + m_minimumInterval : now;
+            if (m_predictedFrameTime && m_lastPresentStart && m_lastPresentStart + m_minimumInterval > m_predictedFrameTime)
+                target = std::max(m_lastPresentStart + m_minimumInterval - m_predictedFrameTime, m_lastWakeup);
+
+            // Falling behind, start over from now instead of trying to catch up
+            target = std::clamp(target, now, now + maxSleepNs);
+
+            m_lastWakeup = target;
+            return target;
+        }
+
+        [[nodiscard]] uint64_t GetPredictedFrameTime() {
+            std::scoped_lock lock{m_mutex};
+            return m_predictedFrameTime;
+        }
+
+      private:
+        Clock m_clock;
+        std::mutex m_mutex;
+
+        uint64_t m_minimumInterval{};
+        uint64_t m_lastWakeup{};
+        uint64_t m_lastPresentStart{};
+        uint64_t m_simulationStart{};
+        uint64_t m_predictedFrameTime{};
+    };
+}
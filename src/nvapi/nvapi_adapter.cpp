@@ -42,6 +42,10 @@ namespace dxvk {
         if (m_vkExtensions.empty())
             return false;
 
+        // CuBIN64 support depends on the revision of VK_NVX_image_view_handle
+        if (auto it = m_vkExtensions.find(VK_NVX_IMAGE_VIEW_HANDLE_EXTENSION_NAME); it != m_vkExtensions.end())
+            m_vkImageViewHandleSpecVersion = it->second;
+
         // Query Properties for this device. Per section 4.1.2. Extending Physical Device From Device Extensions of the Vulkan
         // 1.2.177 Specification, we must first query that a device extension is
         // supported before requesting information on its physical-device-level
@@ -312,6 +316,10 @@ namespace dxvk {
         return m_vkExtensions.find(name) != m_vkExtensions.end();
     }
 
+    uint32_t NvapiAdapter::GetVkImageViewHandleSpecVersion() const {
+        return m_vkImageViewHandleSpecVersion;
+    }
+
     Nvml* NvapiAdapter::GetNvml() const {
         if (!this->m_nvml.IsAvailable())
             return nullptr;
@@ -41,6 +41,7 @@ namespace dxvk {
         [[nodiscard]] NV_GPU_ARCHITECTURE_ID GetArchitectureId() const;
         [[nodiscard]] VkRayTracingInvocationReorderModeNV GetReorderingHint() const;
         [[nodiscard]] bool IsVkDeviceExtensionSupported(const std::string& name) const;
+        [[nodiscard]] uint32_t GetVkImageViewHandleSpecVersion() const;
         [[nodiscard]] const MemoryInfo& GetMemoryInfo() const;
         [[nodiscard]] MemoryBudgetInfo GetCurrentMemoryBudgetInfo() const;
         [[nodiscard]] Nvml* GetNvml() const;
@@ -52,7 +53,8 @@ namespace dxvk {
         Nvml& m_nvml;
         Com<IDXGIAdapter3> m_dxgiAdapter;
 
-        std::set<std::string> m_vkExtensions;
+        std::map<std::string, uint32_t> m_vkExtensions;
+        uint32_t m_vkImageViewHandleSpecVersion{};
         VkPhysicalDeviceProperties m_vkProperties{};
         VkPhysicalDeviceIDProperties m_vkIdProperties{};
         VkPhysicalDevicePCIBusInfoPropertiesEXT m_vkPciBusProperties{};
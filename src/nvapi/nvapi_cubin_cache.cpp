@@ -0,0 +1,98 @@
+#include "nvapi_cubin_cache.h"
+#include "../util/util_hash.h"
+
+namespace dxvk {
+    bool NvapiCubinCache::IsCacheable(const Key& key) {
+        return key.cubinData && key.cubinSize;
+    }
+
+    uint64_t NvapiCubinCache::Hash(const Key& key) {
+        auto keyHash = hash::bytes(key.cubinData, key.cubinSize);
+        if (key.shaderName)
+            keyHash = hash::combine(keyHash, hash::bytes(key.shaderName, std::strlen(key.shaderName)));
+
+        keyHash = hash::combine(keyHash, (uint64_t{key.blockX} << 32) | key.blockY);
+        keyHash = hash::combine(keyHash, (uint64_t{key.blockZ} << 32) | key.smemSize);
+        return hash::combine(keyHash, key.flags);
+    }
+
+    bool NvapiCubinCache::Matches(const Entry& entry, const Key& key) {
+        return entry.blockX == key.blockX
+            && entry.blockY == key.blockY
+            && entry.blockZ == key.blockZ
+            && entry.smemSize == key.smemSize
+            && entry.flags == key.flags
+            && entry.shaderName == (key.shaderName ? key.shaderName : "")
+            && entry.cubinData.size() == key.cubinSize
+            && std::memcmp(entry.cubinData.data(), key.cubinData, key.cubinSize) == 0;
+    }
+
+    NVDX_ObjectHandle NvapiCubinCache::Find(uint64_t hash, const Key& key) const {
+        auto [begin, end] = m_shaders.equal_range(hash);
+        for (auto it = begin; it != end; ++it) {
+            if (Matches(m_entries.at(it->second), key))
+                return it->second;
+        }
+
+        return nullptr;
+    }
+
+    NVDX_ObjectHandle NvapiCubinCache::Acquire(const Key& key) {
+        if (!IsCacheable(key))
+            return nullptr;
+
+        auto keyHash = Hash(key);
+
+        std::scoped_lock lock(m_mutex);
+        auto shader = Find(keyHash, key);
+        if (shader)
+            m_entries.at(shader).refCount++;
+
+        return shader;
+    }
+
+    void NvapiCubinCache::Insert(const Key& key, NVDX_ObjectHandle shader) {
+        if (!IsCacheable(key) || !shader)
+            return;
+
+        auto keyHash = Hash(key);
+
+        std::scoped_lock lock(m_mutex);
+        // Another thread may have created the same shader in the meantime, the later one stays untracked and is destroyed directly
+        if (Find(keyHash, key) || m_entries.contains(shader))
+            return;
+
+        auto cubinData = static_cast<const uint8_t*>(key.cubinData);
+        m_entries.emplace(shader, Entry{
+            .hash = keyHash,
+            .cubinData = std::vector<uint8_t>(cubinData, cubinData + key.cubinSize),
+            .shaderName = key.shaderName ? key.shaderName : "",
+            .blockX = key.blockX,
+            .blockY = key.blockY,
+            .blockZ = key.blockZ,
+            .smemSize = key.smemSize,
+            .flags = key.flags,
+            .refCount = 1,
+        });
+        m_shaders.emplace(keyHash, shader);
+    }
+
+    bool NvapiCubinCache::Release(NVDX_ObjectHandle shader) {
+        std::scoped_lock lock(m_mutex);
+
+        auto it = m_entries.find(shader);
+        if (it == m_entries.end())
+            return true;
+
+        if (--it->second.refCount > 0)
+            return false;
+
+        auto [begin, end] = m_shaders.equal_range(it->second.hash);
+        auto itS = std::find_if(begin, end, [shader](const auto& entry) { return entry.second == shader; });
+        if (itS != end)
+            m_shaders.erase(itS);
+
+        m_entries.erase(it);
+        return true;
+    }
+}
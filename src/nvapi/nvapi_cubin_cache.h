@@ -0,0 +1,50 @@
+#pragma once
+
+#include "../nvapi_private.h"
+
+namespace dxvk {
+    // Hands out the same CuBIN shader handle for identical creation parameters and keeps track of how often it was handed out
+    class NvapiCubinCache {
+
+      public:
+        struct Key {
+            const void* cubinData;
+            NvU32 cubinSize;
+            NvU32 blockX;
+            NvU32 blockY;
+            NvU32 blockZ;
+            NvU32 smemSize;
+            NvU32 flags;
+            const char* shaderName;
+        };
+
+        [[nodiscard]] static bool IsCacheable(const Key& key);
+
+        // Returns an existing handle with an additional reference, or nullptr when the shader needs to be created
+        [[nodiscard]] NVDX_ObjectHandle Acquire(const Key& key);
+        void Insert(const Key& key, NVDX_ObjectHandle shader);
+        // Returns true when the last reference is gone and the underlying shader should be destroyed
+        [[nodiscard]] bool Release(NVDX_ObjectHandle shader);
+
+      private:
+        struct Entry {
+            uint64_t hash;
+            std::vector<uint8_t> cubinData;
+            std::string shaderName;
+            NvU32 blockX;
+            NvU32 blockY;
+            NvU32 blockZ;
+            NvU32 smemSize;
+            NvU32 flags;
+            uint32_t refCount;
+        };
+
+        [[nodiscard]] static uint64_t Hash(const Key& key);
+        [[nodiscard]] static bool Matches(const Entry& entry, const Key& key);
+        [[nodiscard]] NVDX_ObjectHandle Find(uint64_t hash, const Key& key) const;
+
+        std::mutex m_mutex;
+        std::unordered_multimap<uint64_t, NVDX_ObjectHandle> m_shaders;
+        std::unordered_map<NVDX_ObjectHandle, Entry> m_entries;
+    };
+}
@@ -2,61 +2,59 @@
 #include "../util/com_pointer.h"
 
 namespace dxvk {
-    std::unordered_map<IUnknown*, std::shared_ptr<NvapiD3d11Device>> NvapiD3d11Device::m_nvapiDeviceMap;
-    std::mutex NvapiD3d11Device::m_mutex;
+    // {8630abce-0b2d-43e6-8c6e-f46203fdf8d7}
+    static constexpr GUID nvapiD3d11DevicePrivateDataGuid = {0x8630abce, 0x0b2d, 0x43e6, {0x8c, 0x6e, 0xf4, 0x62, 0x03, 0xfd, 0xf8, 0xd7}};
+
+    // Functions take either the device or one of its contexts, the private data lives on whichever it is
+    static HRESULT SetDeviceOrContextPrivateData(IUnknown* deviceOrContext, REFGUID guid, const IUnknown* data) {
+        if (Com<ID3D11Device> d3d11Device; SUCCEEDED(deviceOrContext->QueryInterface(IID_PPV_ARGS(&d3d11Device))))
+            return d3d11Device->SetPrivateDataInterface(guid, data);
+
+        if (Com<ID3D11DeviceContext> d3d11DeviceContext; SUCCEEDED(deviceOrContext->QueryInterface(IID_PPV_ARGS(&d3d11DeviceContext))))
+            return d3d11DeviceContext->SetPrivateDataInterface(guid, data);
+
+        return E_NOINTERFACE;
+    }
+
+    NvapiWrapperRegistry<IUnknown, NvapiD3d11Device> NvapiD3d11Device::m_nvapiDeviceMap{nvapiD3d11DevicePrivateDataGuid, &SetDeviceOrContextPrivateData};
 
     void NvapiD3d11Device::Reset() {
-        std::scoped_lock lock{m_mutex};
-        m_nvapiDeviceMap.clear();
+        m_nvapiDeviceMap.Clear();
     }
 
-    std::pair<Com<ID3D11VkExtDevice>, Com<ID3D11VkExtContext>> GetDxvkDevice(IUnknown* deviceOrContext) {
+    struct D3D11Objects {
         Com<ID3D11Device> d3d11Device;
         Com<ID3D11DeviceContext> d3d11DeviceContext;
-
-        if (SUCCEEDED(deviceOrContext->QueryInterface(IID_PPV_ARGS(&d3d11Device))))
-            d3d11Device->GetImmediateContext(&d3d11DeviceContext);
-        else if (SUCCEEDED(deviceOrContext->QueryInterface(IID_PPV_ARGS(&d3d11DeviceContext))))
-            d3d11DeviceContext->GetDevice(&d3d11Device);
-
-        if (d3d11Device == nullptr || d3d11DeviceContext == nullptr)
-            return {};
-
         Com<ID3D11VkExtDevice> dxvkDevice;
         Com<ID3D11VkExtContext> dxvkContext;
-        if (SUCCEEDED(d3d11Device->QueryInterface(IID_PPV_ARGS(&dxvkDevice))) && SUCCEEDED(d3d11DeviceContext->QueryInterface(IID_PPV_ARGS(&dxvkContext))))
-            return std::make_pair(dxvkDevice, dxvkContext);
-
-        return {};
-    }
+    };
 
-    NvapiD3d11Device* NvapiD3d11Device::GetOrCreate(IUnknown* deviceOrContext) {
-        std::scoped_lock lock{m_mutex};
+    static D3D11Objects GetDxvkDevice(IUnknown* deviceOrContext) {
+        D3D11Objects objects;
 
-        if (auto nvapiD3D11Device = Get(deviceOrContext))
-            return nvapiD3D11Device;
+        if (SUCCEEDED(deviceOrContext->QueryInterface(IID_PPV_ARGS(&objects.d3d11Device))))
+            objects.d3d11Device->GetImmediateContext(&objects.d3d11DeviceContext);
+        else if (SUCCEEDED(deviceOrContext->QueryInterface(IID_PPV_ARGS(&objects.d3d11DeviceContext))))
+            objects.d3d11DeviceContext->GetDevice(&objects.d3d11Device);
 
-        auto [dxvkDevice, dxvkContext] = GetDxvkDevice(deviceOrContext);
-        if (dxvkDevice == nullptr || dxvkContext == nullptr)
-            return nullptr;
-
-        // Look for a cache entry where NvapiD3d11Device's m_dxvkDevice and m_dxvkContext matches the ones we found
-        auto itF = std::find_if(m_nvapiDeviceMap.begin(), m_nvapiDeviceMap.end(),
-            [&dxvkDevice, &dxvkContext](auto& item) { return item.second->m_dxvkDevice == dxvkDevice.ptr() && item.second->m_dxvkContext == dxvkContext.ptr(); });
-
-        auto [itI, inserted] = itF == m_nvapiDeviceMap.end()
-            ? m_nvapiDeviceMap.emplace(deviceOrContext, std::make_shared<NvapiD3d11Device>(dxvkDevice.ptr(), dxvkContext.ptr()))
-            : m_nvapiDeviceMap.emplace(deviceOrContext, itF->second);
+        if (objects.d3d11Device == nullptr || objects.d3d11DeviceContext == nullptr)
+            return {};
 
-        if (!inserted)
-            return nullptr;
+        if (FAILED(objects.d3d11Device->QueryInterface(IID_PPV_ARGS(&objects.dxvkDevice))) || FAILED(objects.d3d11DeviceContext->QueryInterface(IID_PPV_ARGS(&objects.dxvkContext))))
+            return {};
 
-        return itI->second.get();
+        return objects;
     }
 
-    NvapiD3d11Device* NvapiD3d11Device::Get(IUnknown* deviceOrContext) {
-        auto it = m_nvapiDeviceMap.find(deviceOrContext);
-        return it == m_nvapiDeviceMap.end() ? nullptr : it->second.get();
+    NvapiD3d11Device* NvapiD3d11Device::GetOrCreate(IUnknown* deviceOrContext) {
+        // Draw calls like multi draw indirect come in hundreds of times per frame for the same context, the registry skips the lock for those
+        return m_nvapiDeviceMap.GetOrCreate(deviceOrContext, [deviceOrContext]() -> std::unique_ptr<NvapiD3d11Device> {
+            auto objects = GetDxvkDevice(deviceOrContext);
+            if (objects.dxvkDevice == nullptr || objects.dxvkContext == nullptr)
+                return nullptr;
+
+            return std::make_unique<NvapiD3d11Device>(objects.dxvkDevice.ptr(), objects.dxvkContext.ptr());
+        });
     }
 
     NvapiD3d11Device::NvapiD3d11Device(ID3D11VkExtDevice* dxvkDevice, ID3D11VkExtContext* dxvkContext)
@@ -101,6 +99,10 @@ namespace dxvk {
         if (!m_supportsExtMultiDrawIndirect)
             return E_NOTIMPL;
 
+        // Empty material buckets are common, there is nothing to record for those
+        if (drawCount == 0)
+            return S_OK;
+
         m_dxvkContext->MultiDrawIndirect(drawCount, buffer, alignedByteOffsetForArgs, alignedByteStrideForArgs);
         return S_OK;
     }
@@ -109,16 +111,29 @@ namespace dxvk {
         if (!m_supportsExtMultiDrawIndirect)
             return E_NOTIMPL;
 
+        if (drawCount == 0)
+            return S_OK;
+
         m_dxvkContext->MultiDrawIndexedIndirect(drawCount, buffer, alignedByteOffsetForArgs, alignedByteStrideForArgs);
         return S_OK;
     }
 
-    HRESULT NvapiD3d11Device::CreateCubinComputeShaderWithName(const void* pCubin, NvU32 size, NvU32 blockX, NvU32 blockY, NvU32 blockZ, const char* pShaderName, NVDX_ObjectHandle* phShader) const {
+    HRESULT NvapiD3d11Device::CreateCubinComputeShaderWithName(const void* pCubin, NvU32 size, NvU32 blockX, NvU32 blockY, NvU32 blockZ, const char* pShaderName, NVDX_ObjectHandle* phShader) {
         if (!m_supportsExtDevice1 || !m_supportsNvxBinaryImport)
             return E_NOTIMPL;
 
+        auto key = NvapiCubinCache::Key{pCubin, size, blockX, blockY, blockZ, 0 /* smemSize */, 0 /* flags */, pShaderName};
+        if (auto shader = m_cubinCache.Acquire(key)) {
+            *phShader = shader;
+            return S_OK;
+        }
+
         auto success = m_dxvkDevice->CreateCubinComputeShaderWithNameNVX(pCubin, size, blockX, blockY, blockZ, pShaderName, reinterpret_cast<IUnknown**>(phShader));
-        return success ? S_OK : E_FAIL;
+        if (!success)
+            return E_FAIL;
+
+        m_cubinCache.Insert(key, *phShader);
+        return S_OK;
     }
 
     HRESULT NvapiD3d11Device::LaunchCubinShader(NVDX_ObjectHandle hShader, NvU32 gridX, NvU32 gridY, NvU32 gridZ, const void* pParams, NvU32 paramSize, const NVDX_ObjectHandle* pReadResources, NvU32 numReadResources, const NVDX_ObjectHandle* pWriteResources, NvU32 numWriteResources) const {
@@ -131,7 +146,10 @@ namespace dxvk {
 
     HRESULT NvapiD3d11Device::DestroyCubinShader(NVDX_ObjectHandle hShader) {
         if (auto cubinShader = reinterpret_cast<IUnknown*>(hShader)) {
-            cubinShader->Release();
+            // Identical shaders are handed out multiple times, only the last release destroys it
+            if (m_cubinCache.Release(hShader))
+                cubinShader->Release();
+
             return S_OK;
         }
 
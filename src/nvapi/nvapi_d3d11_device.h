@@ -1,5 +1,7 @@
 #pragma once
 
+#include "nvapi_cubin_cache.h"
+#include "nvapi_wrapper_registry.h"
 #include "../nvapi_private.h"
 #include "../interfaces/dxvk_interfaces.h"
 
@@ -18,7 +20,7 @@ namespace dxvk {
         [[nodiscard]] HRESULT MultiDrawInstancedIndirect(NvU32 drawCount, ID3D11Buffer* buffer, NvU32 alignedByteOffsetForArgs, NvU32 alignedByteStrideForArgs) const;
         [[nodiscard]] HRESULT MultiDrawIndexedInstancedIndirect(NvU32 drawCount, ID3D11Buffer* buffer, NvU32 alignedByteOffsetForArgs, NvU32 alignedByteStrideForArgs) const;
 
-        [[nodiscard]] HRESULT CreateCubinComputeShaderWithName(const void* pCubin, NvU32 size, NvU32 blockX, NvU32 blockY, NvU32 blockZ, const char* pShaderName, NVDX_ObjectHandle* phShader) const;
+        [[nodiscard]] HRESULT CreateCubinComputeShaderWithName(const void* pCubin, NvU32 size, NvU32 blockX, NvU32 blockY, NvU32 blockZ, const char* pShaderName, NVDX_ObjectHandle* phShader);
         [[nodiscard]] HRESULT LaunchCubinShader(NVDX_ObjectHandle hShader, NvU32 gridX, NvU32 gridY, NvU32 gridZ, const void* pParams, NvU32 paramSize, const NVDX_ObjectHandle* pReadResources, NvU32 numReadResources, const NVDX_ObjectHandle* pWriteResources, NvU32 numWriteResources) const;
         [[nodiscard]] HRESULT DestroyCubinShader(NVDX_ObjectHandle hShader);
 
@@ -31,10 +33,7 @@ namespace dxvk {
         [[nodiscard]] bool IsFatbinPTXSupported() const;
 
       private:
-        [[nodiscard]] static NvapiD3d11Device* Get(IUnknown* deviceOrContext);
-
-        static std::unordered_map<IUnknown*, std::shared_ptr<NvapiD3d11Device>> m_nvapiDeviceMap;
-        static std::mutex m_mutex;
+        static NvapiWrapperRegistry<IUnknown, NvapiD3d11Device> m_nvapiDeviceMap;
 
         ID3D11VkExtDevice1* m_dxvkDevice{};
         ID3D11VkExtContext1* m_dxvkContext{};
@@ -46,5 +45,7 @@ namespace dxvk {
         bool m_supportsExtMultiDrawIndirect;
         bool m_supportsExtDevice1;
         bool m_supportsExtContext1;
+
+        NvapiCubinCache m_cubinCache;
     };
 }
@@ -2,34 +2,23 @@
 #include "../util/com_pointer.h"
 
 namespace dxvk {
-    std::unordered_map<ID3D12CommandQueue*, NvapiD3d12CommandQueue> NvapiD3d12CommandQueue::m_nvapiDeviceMap;
-    std::mutex NvapiD3d12CommandQueue::m_mutex;
+    // {8bd62803-b8ce-4cb6-a9f0-ff730ceedb75}
+    static constexpr GUID nvapiD3d12CommandQueuePrivateDataGuid = {0x8bd62803, 0xb8ce, 0x4cb6, {0xa9, 0xf0, 0xff, 0x73, 0x0c, 0xee, 0xdb, 0x75}};
+
+    NvapiWrapperRegistry<ID3D12CommandQueue, NvapiD3d12CommandQueue> NvapiD3d12CommandQueue::m_nvapiDeviceMap{nvapiD3d12CommandQueuePrivateDataGuid};
 
     void NvapiD3d12CommandQueue::Reset() {
-        std::scoped_lock lock{m_mutex};
-        m_nvapiDeviceMap.clear();
+        m_nvapiDeviceMap.Clear();
     }
 
     NvapiD3d12CommandQueue* NvapiD3d12CommandQueue::GetOrCreate(ID3D12CommandQueue* commandQueue) {
-        std::scoped_lock lock{m_mutex};
-
-        auto itF = m_nvapiDeviceMap.find(commandQueue);
-        if (itF != m_nvapiDeviceMap.end())
-            return &itF->second;
-
-        Com<ID3D12CommandQueueExt> commandQueueExt;
-        if (FAILED(commandQueue->QueryInterface(IID_PPV_ARGS(&commandQueueExt))))
-            return nullptr;
-
-        auto [itI, inserted] = m_nvapiDeviceMap.emplace(
-            std::piecewise_construct,
-            std::forward_as_tuple(commandQueue),
-            std::forward_as_tuple(commandQueueExt.ptr()));
-
-        if (!inserted)
-            return nullptr;
+        return m_nvapiDeviceMap.GetOrCreate(commandQueue, [commandQueue]() -> std::unique_ptr<NvapiD3d12CommandQueue> {
+            Com<ID3D12CommandQueueExt> commandQueueExt;
+            if (FAILED(commandQueue->QueryInterface(IID_PPV_ARGS(&commandQueueExt))))
+                return nullptr;
 
-        return &itI->second;
+            return std::make_unique<NvapiD3d12CommandQueue>(commandQueueExt.ptr());
+        });
     }
 
     NvapiD3d12CommandQueue::NvapiD3d12CommandQueue(ID3D12CommandQueueExt* vkd3dCommandQueue)
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "nvapi_wrapper_registry.h"
 #include "../nvapi_private.h"
 #include "../interfaces/vkd3d-proton_interfaces.h"
 
@@ -15,8 +16,7 @@ namespace dxvk {
         [[nodiscard]] HRESULT NotifyOutOfBandCommandQueue(D3D12_OUT_OF_BAND_CQ_TYPE type) const;
 
       private:
-        static std::unordered_map<ID3D12CommandQueue*, NvapiD3d12CommandQueue> m_nvapiDeviceMap;
-        static std::mutex m_mutex;
+        static NvapiWrapperRegistry<ID3D12CommandQueue, NvapiD3d12CommandQueue> m_nvapiDeviceMap;
 
         ID3D12CommandQueueExt* m_vkd3dCommandQueue{};
     };
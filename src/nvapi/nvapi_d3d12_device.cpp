@@ -3,81 +3,76 @@
 #include "../util/util_log.h"
 
 namespace dxvk {
-    std::unordered_map<ID3D12Device*, NvapiD3d12Device> NvapiD3d12Device::m_nvapiDeviceMap;
-    std::mutex NvapiD3d12Device::m_mutex;
+    // {d2df49b7-d900-437e-a417-3f888a22ac77}
+    static constexpr GUID nvapiD3d12DevicePrivateDataGuid = {0xd2df49b7, 0xd900, 0x437e, {0xa4, 0x17, 0x3f, 0x88, 0x8a, 0x22, 0xac, 0x77}};
+
+    NvapiWrapperRegistry<ID3D12Device, NvapiD3d12Device> NvapiD3d12Device::m_nvapiDeviceMap{nvapiD3d12DevicePrivateDataGuid};
 
     std::unordered_map<NVDX_ObjectHandle, NvU32> NvapiD3d12Device::m_cubinSmemMap;
-    std::mutex NvapiD3d12Device::m_cubinSmemMutex;
+    std::shared_mutex NvapiD3d12Device::m_cubinSmemMutex;
+    std::atomic<uint64_t> NvapiD3d12Device::m_cubinSmemGeneration;
+
+    std::atomic<NvapiD3d12Device::Cubin64bitSupport> NvapiD3d12Device::m_cubin64bitSupport = Cubin64bitSupport::Unknown;
+    std::atomic<uint64_t> NvapiD3d12Device::m_lastId;
 
-    std::optional<bool> NvapiD3d12Device::m_cubin64bitSupportAvailable;
+    thread_local std::unordered_map<uint64_t, NvapiD3d12Device::NvShaderExtnSlotSpace> NvapiD3d12Device::m_localThreadNvShaderExtnSlotSpaces;
 
     void NvapiD3d12Device::Reset() {
-        std::scoped_lock lock{m_mutex, m_cubinSmemMutex};
-        m_nvapiDeviceMap.clear();
+        m_nvapiDeviceMap.Clear();
+
+        std::scoped_lock lock{m_cubinSmemMutex};
         m_cubinSmemMap.clear();
-        m_cubin64bitSupportAvailable.reset();
+        m_cubinSmemGeneration.fetch_add(1, std::memory_order_release);
+        m_cubin64bitSupport.store(Cubin64bitSupport::Unknown, std::memory_order_release);
     }
 
-    bool NvapiD3d12Device::Cubin64bitSupportAvailable(NvapiResourceFactory* factory, NvapiAdapterRegistry* registry) {
-        if (m_cubin64bitSupportAvailable.has_value())
-            return m_cubin64bitSupportAvailable.value();
+    bool NvapiD3d12Device::Cubin64bitSupportAvailable(NvapiAdapterRegistry* registry) {
+        // Also set by every wrapped device that supports CuBIN64
+        if (auto support = m_cubin64bitSupport.load(std::memory_order_acquire); support != Cubin64bitSupport::Unknown)
+            return support == Cubin64bitSupport::Available;
 
-        if (!factory || !registry)
+        if (!registry)
             return false;
 
+        // vkd3d-proton supports CuBIN64 when the driver exposes VK_NVX_binary_import and 64-bit image view handles
         uint32_t adapterCount = registry->GetAdapterCount();
         for (uint32_t i = 0; i < adapterCount; ++i) {
-            auto dxgiAdapter = registry->GetAdapter(i)->GetDxgiAdapter();
-
-            auto d3d12Device = factory->CreateD3D12Device(dxgiAdapter, D3D_FEATURE_LEVEL_12_0);
-            if (d3d12Device == nullptr)
-                continue;
-
-            Com<ID3D12DeviceExt2> d3d12DeviceExt2;
-            if (FAILED(d3d12Device->QueryInterface(IID_PPV_ARGS(&d3d12DeviceExt2))))
-                continue;
-
-            if (d3d12DeviceExt2->SupportsCubin64bit())
-                return m_cubin64bitSupportAvailable.emplace(true);
+            auto adapter = registry->GetAdapter(i);
+            if (adapter->IsVkDeviceExtensionSupported(VK_NVX_BINARY_IMPORT_EXTENSION_NAME)
+                && adapter->GetVkImageViewHandleSpecVersion() >= ImageViewHandle64SpecVersion) {
+                m_cubin64bitSupport.store(Cubin64bitSupport::Available, std::memory_order_release);
+                return true;
+            }
         }
 
-        return m_cubin64bitSupportAvailable.emplace(false);
+        // A device wrapped in the meantime may have proven support already
+        auto expected = Cubin64bitSupport::Unknown;
+        m_cubin64bitSupport.compare_exchange_strong(expected, Cubin64bitSupport::Unavailable, std::memory_order_acq_rel);
+        return expected == Cubin64bitSupport::Available;
     }
 
     NvapiD3d12Device* NvapiD3d12Device::GetOrCreate(ID3D12Device* device) {
-        std::scoped_lock lock{m_mutex};
-
-        auto itF = m_nvapiDeviceMap.find(device);
-        if (itF != m_nvapiDeviceMap.end())
-            return &itF->second;
-
-        Com<ID3D12DeviceExt> deviceExt;
-        if (FAILED(device->QueryInterface(IID_PPV_ARGS(&deviceExt))))
-            return nullptr;
+        return m_nvapiDeviceMap.GetOrCreate(device, [device]() -> std::unique_ptr<NvapiD3d12Device> {
+            Com<ID3D12DeviceExt> deviceExt;
+            if (FAILED(device->QueryInterface(IID_PPV_ARGS(&deviceExt))))
+                return nullptr;
 
-        auto [itI, inserted] = m_nvapiDeviceMap.emplace(
-            std::piecewise_construct,
-            std::forward_as_tuple(device),
-            std::forward_as_tuple(deviceExt.ptr()));
-
-        if (!inserted)
-            return nullptr;
-
-        return &itI->second;
+            return std::make_unique<NvapiD3d12Device>(deviceExt.ptr());
+        });
     }
 
-    uint32_t NvapiD3d12Device::FindCubinSmem(NVDX_ObjectHandle pShader) {
-        std::scoped_lock lock(m_cubinSmemMutex);
+    std::optional<uint32_t> NvapiD3d12Device::FindCubinSmem(NVDX_ObjectHandle pShader) {
+        std::shared_lock lock(m_cubinSmemMutex);
         auto it = m_cubinSmemMap.find(pShader);
         if (it != m_cubinSmemMap.end())
             return it->second;
 
-        log::info("Failed to find CuBIN in m_cubinSmemMap, defaulting to 0");
-        return 0;
+        return std::nullopt;
     }
 
     NvapiD3d12Device::NvapiD3d12Device(ID3D12DeviceExt* vkd3dDevice)
-        : m_vkd3dDevice(static_cast<ID3D12DeviceExt4*>(vkd3dDevice)) {
+        : m_id(m_lastId.fetch_add(1, std::memory_order_relaxed) + 1),
+          m_vkd3dDevice(static_cast<ID3D12DeviceExt4*>(vkd3dDevice)) {
         m_supportsNvxBinaryImport = vkd3dDevice->GetExtensionSupport(D3D12_VK_NVX_BINARY_IMPORT);
         m_supportsNvxImageViewHandle = vkd3dDevice->GetExtensionSupport(D3D12_VK_NVX_IMAGE_VIEW_HANDLE);
 
@@ -87,6 +82,9 @@ namespace dxvk {
             }
         }
 
+        if (m_supportsCubin64bit)
+            m_cubin64bitSupport.store(Cubin64bitSupport::Available, std::memory_order_release);
+
         if (Com<ID3D12DeviceExt4> deviceExt4; SUCCEEDED(m_vkd3dDevice->QueryInterface(IID_PPV_ARGS(&deviceExt4)))) {
             m_supportsNvShaderExtn = true;
         }
@@ -100,13 +98,22 @@ namespace dxvk {
         if (!m_vkd3dDevice || !m_supportsNvxBinaryImport)
             return E_NOTIMPL;
 
+        auto key = NvapiCubinCache::Key{cubinData, cubinSize, blockX, blockY, blockZ, smemSize, 0 /* flags */, shaderName};
+        if (auto shader = m_cubinCache.Acquire(key)) {
+            *pShader = shader;
+            return S_OK;
+        }
+
         auto result = m_vkd3dDevice->CreateCubinComputeShaderWithName(cubinData, cubinSize, blockX, blockY, blockZ, shaderName, reinterpret_cast<D3D12_CUBIN_DATA_HANDLE**>(pShader));
         if (FAILED(result))
             return result;
 
-        std::scoped_lock lock(m_cubinSmemMutex);
-        m_cubinSmemMap.emplace(*pShader, smemSize);
+        {
+            std::scoped_lock lock(m_cubinSmemMutex);
+            m_cubinSmemMap.emplace(*pShader, smemSize);
+        }
 
+        m_cubinCache.Insert(key, *pShader);
         return result;
     }
 
@@ -114,12 +121,17 @@ namespace dxvk {
         if (!m_vkd3dDevice || !m_supportsNvxBinaryImport)
             return E_NOTIMPL;
 
+        // Identical shaders are handed out multiple times, only the last release destroys it
+        if (!m_cubinCache.Release(shader))
+            return S_OK;
+
         auto result = m_vkd3dDevice->DestroyCubinComputeShader(reinterpret_cast<D3D12_CUBIN_DATA_HANDLE*>(shader));
         if (FAILED(result))
             return result;
 
         std::scoped_lock lock(m_cubinSmemMutex);
         m_cubinSmemMap.erase(shader);
+        m_cubinSmemGeneration.fetch_add(1, std::memory_order_release);
 
         return result;
     }
@@ -153,13 +165,24 @@ namespace dxvk {
         if (!m_supportsCubin64bit)
             return E_NOTIMPL;
 
+        // Chained structures are not part of the cache key, so those shaders are always created
+        auto key = NvapiCubinCache::Key{params->pNext ? nullptr : params->pCubin, params->size, params->blockX, params->blockY, params->blockZ, params->dynSharedMemBytes, params->flags, params->pShaderName};
+        if (auto shader = m_cubinCache.Acquire(key)) {
+            params->hShader = reinterpret_cast<D3D12_CUBIN_DATA_HANDLE*>(shader);
+            return S_OK;
+        }
+
         auto result = m_vkd3dDevice->CreateCubinComputeShaderExV2(params);
         if (FAILED(result))
             return result;
 
-        std::scoped_lock lock(m_cubinSmemMutex);
-        m_cubinSmemMap.emplace(reinterpret_cast<NVDX_ObjectHandle>(params->hShader), params->dynSharedMemBytes);
+        auto shader = reinterpret_cast<NVDX_ObjectHandle>(params->hShader);
+        {
+            std::scoped_lock lock(m_cubinSmemMutex);
+            m_cubinSmemMap.emplace(shader, params->dynSharedMemBytes);
+        }
 
+        m_cubinCache.Insert(key, shader);
         return result;
     }
 
@@ -185,6 +208,30 @@ namespace dxvk {
         if (!m_supportsNvShaderExtn)
             return E_NOTIMPL;
 
-        return m_vkd3dDevice->SetNvShaderExtnSlotSpace(uavSlot, uavSpace, localThread);
+        auto result = m_vkd3dDevice->SetNvShaderExtnSlotSpace(uavSlot, uavSpace, localThread);
+        if (SUCCEEDED(result) && localThread)
+            m_localThreadNvShaderExtnSlotSpaces[m_id] = {uavSlot, uavSpace};
+
+        return result;
+    }
+
+    HRESULT NvapiD3d12Device::PushNvShaderExtnSlotSpace(UINT32 uavSlot, UINT32 uavSpace) const {
+        if (!m_supportsNvShaderExtn)
+            return E_NOTIMPL;
+
+        return m_vkd3dDevice->SetNvShaderExtnSlotSpace(uavSlot, uavSpace, true);
+    }
+
+    void NvapiD3d12Device::PopNvShaderExtnSlotSpace() const {
+        if (!m_supportsNvShaderExtn)
+            return;
+
+        // Threads without a slot of their own go back to following the slot of the device
+        auto slotSpace = NvShaderExtnSlotSpace{NoThreadLocalNvShaderExtnSlot, NoThreadLocalNvShaderExtnSlot};
+        if (auto it = m_localThreadNvShaderExtnSlotSpaces.find(m_id); it != m_localThreadNvShaderExtnSlotSpaces.end())
+            slotSpace = it->second;
+
+        if (FAILED(m_vkd3dDevice->SetNvShaderExtnSlotSpace(slotSpace.uavSlot, slotSpace.uavSpace, true)))
+            log::info("Failed to restore the NVIDIA shader extension slot of the calling thread");
     }
 }
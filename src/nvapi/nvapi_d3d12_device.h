@@ -1,17 +1,24 @@
 #pragma once
 
 #include "nvapi_adapter_registry.h"
+#include "nvapi_cubin_cache.h"
+#include "nvapi_wrapper_registry.h"
 #include "../nvapi_private.h"
 #include "../interfaces/vkd3d-proton_interfaces.h"
 
+#include <atomic>
+#include <shared_mutex>
+
 namespace dxvk {
     class NvapiD3d12Device {
 
       public:
         static void Reset();
-        [[nodiscard]] static bool Cubin64bitSupportAvailable(NvapiResourceFactory* factory, NvapiAdapterRegistry* registry);
+        [[nodiscard]] static bool Cubin64bitSupportAvailable(NvapiAdapterRegistry* registry);
         [[nodiscard]] static NvapiD3d12Device* GetOrCreate(ID3D12Device* device);
-        [[nodiscard]] static uint32_t FindCubinSmem(NVDX_ObjectHandle);
+        [[nodiscard]] static std::optional<uint32_t> FindCubinSmem(NVDX_ObjectHandle);
+        // Changes whenever a CuBIN shader is destroyed, lookups cached before that must not be used anymore
+        [[nodiscard]] static uint64_t GetCubinSmemGeneration() { return m_cubinSmemGeneration.load(std::memory_order_acquire); }
 
         explicit NvapiD3d12Device(ID3D12DeviceExt* vkd3dDevice);
 
@@ -30,20 +37,47 @@ namespace dxvk {
 
         [[nodiscard]] bool IsNvShaderExtnOpCodeSupported(UINT32 opCode) const;
         [[nodiscard]] HRESULT SetNvShaderExtnSlotSpace(UINT32 uavSlot, UINT32 uavSpace, bool localThread) const;
+        // Overrides the slot of the calling thread for a single pipeline without touching the slot set by the application
+        [[nodiscard]] HRESULT PushNvShaderExtnSlotSpace(UINT32 uavSlot, UINT32 uavSpace) const;
+        void PopNvShaderExtnSlotSpace() const;
 
       private:
-        static std::unordered_map<ID3D12Device*, NvapiD3d12Device> m_nvapiDeviceMap;
-        static std::mutex m_mutex;
+        static NvapiWrapperRegistry<ID3D12Device, NvapiD3d12Device> m_nvapiDeviceMap;
 
         static std::unordered_map<NVDX_ObjectHandle, NvU32> m_cubinSmemMap;
-        static std::mutex m_cubinSmemMutex;
+        static std::shared_mutex m_cubinSmemMutex;
+        static std::atomic<uint64_t> m_cubinSmemGeneration;
+
+        enum class Cubin64bitSupport : uint8_t {
+            Unknown,
+            Unavailable,
+            Available,
+        };
+
+        static std::atomic<Cubin64bitSupport> m_cubin64bitSupport;
+        static std::atomic<uint64_t> m_lastId;
+
+        // First revision of VK_NVX_image_view_handle with vkGetImageViewHandle64NVX
+        constexpr static uint32_t ImageViewHandle64SpecVersion = 3;
 
-        static std::optional<bool> m_cubin64bitSupportAvailable;
+        // vkd3d-proton treats this as no thread-local slot, the thread then uses the slot of the device again
+        constexpr static UINT32 NoThreadLocalNvShaderExtnSlot = ~0U;
 
+        struct NvShaderExtnSlotSpace {
+            UINT32 uavSlot;
+            UINT32 uavSpace;
+        };
+
+        // Slots the application set for the calling thread, keyed by device ID since device addresses get reused
+        static thread_local std::unordered_map<uint64_t, NvShaderExtnSlotSpace> m_localThreadNvShaderExtnSlotSpaces;
+
+        uint64_t m_id;
         ID3D12DeviceExt4* m_vkd3dDevice{};
         bool m_supportsCubin64bit = false;
         bool m_supportsNvShaderExtn = false;
         bool m_supportsNvxBinaryImport = false;
         bool m_supportsNvxImageViewHandle = false;
+
+        NvapiCubinCache m_cubinCache;
     };
 }
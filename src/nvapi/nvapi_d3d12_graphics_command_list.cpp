@@ -4,34 +4,23 @@
 #include "../util/util_log.h"
 
 namespace dxvk {
-    std::unordered_map<ID3D12GraphicsCommandList*, NvapiD3d12GraphicsCommandList> NvapiD3d12GraphicsCommandList::m_nvapiDeviceMap;
-    std::mutex NvapiD3d12GraphicsCommandList::m_mutex;
+    // {19e9b8f3-c73e-4eb1-93a1-9923c8f79b20}
+    static constexpr GUID nvapiD3d12GraphicsCommandListPrivateDataGuid = {0x19e9b8f3, 0xc73e, 0x4eb1, {0x93, 0xa1, 0x99, 0x23, 0xc8, 0xf7, 0x9b, 0x20}};
+
+    NvapiWrapperRegistry<ID3D12GraphicsCommandList, NvapiD3d12GraphicsCommandList> NvapiD3d12GraphicsCommandList::m_nvapiDeviceMap{nvapiD3d12GraphicsCommandListPrivateDataGuid};
 
     void NvapiD3d12GraphicsCommandList::Reset() {
-        std::scoped_lock lock{m_mutex};
-        m_nvapiDeviceMap.clear();
+        m_nvapiDeviceMap.Clear();
     }
 
     NvapiD3d12GraphicsCommandList* NvapiD3d12GraphicsCommandList::GetOrCreate(ID3D12GraphicsCommandList* commandList) {
-        std::scoped_lock lock{m_mutex};
-
-        auto itF = m_nvapiDeviceMap.find(commandList);
-        if (itF != m_nvapiDeviceMap.end())
-            return &itF->second;
-
-        Com<ID3D12GraphicsCommandListExt> commandListExt;
-        if (FAILED(commandList->QueryInterface(IID_PPV_ARGS(&commandListExt))))
-            return nullptr;
+        return m_nvapiDeviceMap.GetOrCreate(commandList, [commandList]() -> std::unique_ptr<NvapiD3d12GraphicsCommandList> {
+            Com<ID3D12GraphicsCommandListExt> commandListExt;
+            if (FAILED(commandList->QueryInterface(IID_PPV_ARGS(&commandListExt))))
+                return nullptr;
 
-        auto [itI, inserted] = m_nvapiDeviceMap.emplace(
-            std::piecewise_construct,
-            std::forward_as_tuple(commandList),
-            std::forward_as_tuple(commandListExt.ptr()));
-
-        if (!inserted)
-            return nullptr;
-
-        return &itI->second;
+            return std::make_unique<NvapiD3d12GraphicsCommandList>(commandListExt.ptr());
+        });
     }
 
     NvapiD3d12GraphicsCommandList::NvapiD3d12GraphicsCommandList(ID3D12GraphicsCommandListExt* vkd3dCommandList)
@@ -44,7 +33,7 @@ namespace dxvk {
         if (!m_vkd3dGraphicsCommandList)
             return E_NOTIMPL;
 
-        auto smem = NvapiD3d12Device::FindCubinSmem(pShader);
+        auto smem = FindCubinSmem(pShader);
 
         if (m_supportsExtGraphicsCommandList1)
             return m_vkd3dGraphicsCommandList->LaunchCubinShaderEx(reinterpret_cast<D3D12_CUBIN_DATA_HANDLE*>(pShader), blockX, blockY, blockZ, smem, params, paramSize, nullptr, 0);
@@ -54,4 +43,30 @@ namespace dxvk {
 
         return m_vkd3dGraphicsCommandList->LaunchCubinShader(reinterpret_cast<D3D12_CUBIN_DATA_HANDLE*>(pShader), blockX, blockY, blockZ, params, paramSize);
     }
+
+    uint32_t NvapiD3d12GraphicsCommandList::FindCubinSmem(NVDX_ObjectHandle shader) const {
+        // A destroyed shader handle may get reused for a different shader, drop everything when that happened
+        auto generation = NvapiD3d12Device::GetCubinSmemGeneration();
+        if (generation != m_cubinSmemGeneration) {
+            m_cubinSmemCache.fill({});
+            m_cubinSmemGeneration = generation;
+        }
+
+        for (const auto& entry : m_cubinSmemCache) {
+            if (entry.shader == shader && shader)
+                return entry.smem;
+        }
+
+        auto smem = NvapiD3d12Device::FindCubinSmem(shader);
+        if (!smem) {
+            // Unknown shaders are not cached, creating them later does not invalidate the cache
+            log::info("Failed to find CuBIN in m_cubinSmemMap, defaulting to 0");
+            return 0;
+        }
+
+        m_cubinSmemCache[m_cubinSmemCacheNext] = {shader, *smem};
+        m_cubinSmemCacheNext = (m_cubinSmemCacheNext + 1) % m_cubinSmemCache.size();
+
+        return *smem;
+    }
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "nvapi_wrapper_registry.h"
 #include "../nvapi_private.h"
 #include "../interfaces/vkd3d-proton_interfaces.h"
 
@@ -14,11 +15,22 @@ namespace dxvk {
 
         [[nodiscard]] HRESULT LaunchCubinShader(NVDX_ObjectHandle shader, NvU32 blockX, NvU32 blockY, NvU32 blockZ, const void* params, NvU32 paramSize) const;
 
+        // Command lists are recorded by one thread at a time, so recently launched shaders are cached without locking
+        [[nodiscard]] uint32_t FindCubinSmem(NVDX_ObjectHandle shader) const;
+
       private:
-        static std::unordered_map<ID3D12GraphicsCommandList*, NvapiD3d12GraphicsCommandList> m_nvapiDeviceMap;
-        static std::mutex m_mutex;
+        static NvapiWrapperRegistry<ID3D12GraphicsCommandList, NvapiD3d12GraphicsCommandList> m_nvapiDeviceMap;
 
         ID3D12GraphicsCommandListExt1* m_vkd3dGraphicsCommandList{};
         bool m_supportsExtGraphicsCommandList1 = false;
+
+        struct CubinSmemCacheEntry {
+            NVDX_ObjectHandle shader;
+            uint32_t smem;
+        };
+
+        mutable std::array<CubinSmemCacheEntry, 4> m_cubinSmemCache{};
+        mutable uint32_t m_cubinSmemCacheNext = 0;
+        mutable uint64_t m_cubinSmemGeneration = 0;
     };
 }
@@ -1,15 +1,48 @@
 #include "nvapi_d3d_low_latency_device.h"
+#include "nvapi_destruction_notifier.h"
 #include "../util/com_pointer.h"
 #include "../util/util_string.h"
 #include "../util/util_log.h"
 
 namespace dxvk {
+    // {5db4d43e-c69c-4963-a576-04ce16eb3dc6}
+    static constexpr GUID nvapiD3dLowLatencyDevicePrivateDataGuid = {0x5db4d43e, 0xc69c, 0x4963, {0xa5, 0x76, 0x04, 0xce, 0x16, 0xeb, 0x3d, 0xc6}};
+
     std::unordered_map<IUnknown*, std::shared_ptr<NvapiD3dLowLatencyDevice>> NvapiD3dLowLatencyDevice::m_nvapiDeviceMap = {};
     std::mutex NvapiD3dLowLatencyDevice::m_mutex = {};
 
+    // The private data lives on the D3D12 object, D3D11 device or D3D11 device child behind the given interface
+    struct LowLatencyDevicePrivateData {
+        IUnknown* device;
+
+        HRESULT SetPrivateDataInterface(REFGUID guid, const IUnknown* data) const {
+            if (Com<ID3D12Object> d3d12Object; SUCCEEDED(device->QueryInterface(IID_PPV_ARGS(&d3d12Object))))
+                return d3d12Object->SetPrivateDataInterface(guid, data);
+
+            if (Com<ID3D11Device> d3d11Device; SUCCEEDED(device->QueryInterface(IID_PPV_ARGS(&d3d11Device))))
+                return d3d11Device->SetPrivateDataInterface(guid, data);
+
+            if (Com<ID3D11DeviceChild> d3d11DeviceChild; SUCCEEDED(device->QueryInterface(IID_PPV_ARGS(&d3d11DeviceChild))))
+                return d3d11DeviceChild->SetPrivateDataInterface(guid, data);
+
+            return E_NOINTERFACE;
+        }
+    };
+
     void NvapiD3dLowLatencyDevice::Reset() {
-        std::scoped_lock lock{m_mutex};
-        m_nvapiDeviceMap.clear();
+        std::vector<IUnknown*> devices;
+        {
+            std::scoped_lock lock{m_mutex};
+            for (const auto& [device, lowLatencyDevice] : m_nvapiDeviceMap)
+                devices.push_back(device);
+
+            m_nvapiDeviceMap.clear();
+        }
+
+        // Objects that are still alive keep their notifier otherwise, which must not outlive this module.
+        // Outside the lock, detaching releases the notifiers which erase on their own.
+        for (auto device : devices)
+            LowLatencyDevicePrivateData{device}.SetPrivateDataInterface(nvapiD3dLowLatencyDevicePrivateDataGuid, nullptr);
     }
 
     static Com<ID3DLowLatencyDevice> GetD3DLowLatencyDevice(IUnknown* device) {
@@ -34,27 +67,48 @@ namespace dxvk {
     }
 
     NvapiD3dLowLatencyDevice* NvapiD3dLowLatencyDevice::GetOrCreate(IUnknown* device) {
-        std::scoped_lock lock{m_mutex};
+        std::shared_ptr<NvapiD3dLowLatencyDevice> lowLatencyDevice;
+        {
+            std::scoped_lock lock{m_mutex};
+
+            if (auto existing = Get(device))
+                return existing;
 
-        if (auto lowLatencyDevice = Get(device))
-            return lowLatencyDevice;
+            auto d3dLowLatencyDevice = GetD3DLowLatencyDevice(device);
+            if (d3dLowLatencyDevice == nullptr)
+                return nullptr;
 
-        auto d3dLowLatencyDevice = GetD3DLowLatencyDevice(device);
-        if (d3dLowLatencyDevice == nullptr)
-            return nullptr;
+            // Look for a cache entry where NvapiD3dLowLatencyDevice's m_d3dLowLatencyDevice matches the one we found
+            auto itF = std::find_if(m_nvapiDeviceMap.begin(), m_nvapiDeviceMap.end(),
+                [&d3dLowLatencyDevice](auto& item) { return item.second->m_d3dLowLatencyDevice == d3dLowLatencyDevice.ptr(); });
 
-        // Look for a cache entry where NvapiD3dLowLatencyDevice's m_d3dLowLatencyDevice matches the one we found
-        auto itF = std::find_if(m_nvapiDeviceMap.begin(), m_nvapiDeviceMap.end(),
-            [&d3dLowLatencyDevice](auto& item) { return item.second->m_d3dLowLatencyDevice == d3dLowLatencyDevice.ptr(); });
+            auto [itI, inserted] = itF == m_nvapiDeviceMap.end()
+                ? m_nvapiDeviceMap.emplace(device, std::make_shared<NvapiD3dLowLatencyDevice>(d3dLowLatencyDevice.ptr()))
+                : m_nvapiDeviceMap.emplace(device, itF->second);
 
-        auto [itI, inserted] = itF == m_nvapiDeviceMap.end()
-            ? m_nvapiDeviceMap.emplace(device, std::make_shared<NvapiD3dLowLatencyDevice>(d3dLowLatencyDevice.ptr()))
-            : m_nvapiDeviceMap.emplace(device, itF->second);
+            if (!inserted)
+                return nullptr;
 
-        if (!inserted)
-            return nullptr;
+            lowLatencyDevice = itI->second;
+        }
 
-        return itI->second.get();
+        // Outside the lock, attaching may release an outdated notifier which erases on its own
+        auto privateData = LowLatencyDevicePrivateData{device};
+        NvapiDestructionNotifier::Attach(&privateData, nvapiD3dLowLatencyDevicePrivateDataGuid, [device, weakLowLatencyDevice = std::weak_ptr(lowLatencyDevice)] {
+            if (auto lowLatencyDevice = weakLowLatencyDevice.lock())
+                Erase(device, lowLatencyDevice.get());
+        });
+
+        return lowLatencyDevice.get();
+    }
+
+    void NvapiD3dLowLatencyDevice::Erase(IUnknown* device, const NvapiD3dLowLatencyDevice* lowLatencyDevice) {
+        std::scoped_lock lock{m_mutex};
+
+        // The same address may have been wrapped again in the meantime
+        auto it = m_nvapiDeviceMap.find(device);
+        if (it != m_nvapiDeviceMap.end() && it->second.get() == lowLatencyDevice)
+            m_nvapiDeviceMap.erase(it);
     }
 
     NvapiD3dLowLatencyDevice* NvapiD3dLowLatencyDevice::Get(IUnknown* device) {
@@ -102,21 +156,32 @@ namespace dxvk {
     }
 
     NvapiD3dLowLatencyDevice::NvapiD3dLowLatencyDevice(ID3DLowLatencyDevice* d3dLowLatencyDevice)
-        : m_d3dLowLatencyDevice(d3dLowLatencyDevice) {}
+        : m_d3dLowLatencyDevice(d3dLowLatencyDevice) {
+        if (LowLatencyFramePacer<>::IsEnabled())
+            m_framePacer = std::make_unique<LowLatencyFramePacer<>>();
+    }
 
     bool NvapiD3dLowLatencyDevice::SupportsLowLatency() const {
         return m_d3dLowLatencyDevice->SupportsLowLatency();
     }
 
     HRESULT NvapiD3dLowLatencyDevice::LatencySleep() const {
+        if (m_framePacer)
+            m_framePacer->Sleep();
+
         return m_d3dLowLatencyDevice->LatencySleep();
     }
 
     HRESULT NvapiD3dLowLatencyDevice::SetLatencySleepMode(bool lowLatencyMode, bool lowLatencyBoost, uint32_t minimumIntervalUs) {
-        auto result = m_d3dLowLatencyDevice->SetLatencySleepMode(lowLatencyMode, lowLatencyBoost, minimumIntervalUs);
-        if (SUCCEEDED(result))
+        // The frame pacer takes over the frame rate limit, don't let the driver apply it a second time
+        auto result = m_d3dLowLatencyDevice->SetLatencySleepMode(lowLatencyMode, lowLatencyBoost, m_framePacer ? 0 : minimumIntervalUs);
+        if (SUCCEEDED(result)) {
             m_lowLatencyMode = lowLatencyMode;
 
+            if (m_framePacer)
+                m_framePacer->SetMinimumInterval(minimumIntervalUs);
+        }
+
         return result;
     }
 
@@ -136,9 +201,26 @@ namespace dxvk {
         return result;
     }
 
-    HRESULT NvapiD3dLowLatencyDevice::SetLatencyMarker(uint64_t frameID, uint32_t markerType) {
+    HRESULT NvapiD3dLowLatencyDevice::SetLatencyMarker(uint64_t frameID, NV_LATENCY_MARKER_TYPE markerType) {
+        auto lowLatencyDeviceMarkerType = ToMarkerType(markerType);
+        if (!lowLatencyDeviceMarkerType.has_value())
+            return E_INVALIDARG;
+
+        if (m_framePacer) {
+            switch (markerType) {
+                case SIMULATION_START:
+                    m_framePacer->SetMarker(VK_LATENCY_MARKER_SIMULATION_START_NV);
+                    break;
+                case PRESENT_START:
+                    m_framePacer->SetMarker(VK_LATENCY_MARKER_PRESENT_START_NV);
+                    break;
+                default:
+                    break;
+            }
+        }
+
         return m_d3dLowLatencyDevice->SetLatencyMarker(
-            m_frameIdGenerator.GetLowLatencyDeviceFrameId(frameID), markerType);
+            m_frameIdGenerator.GetLowLatencyDeviceFrameId(frameID), lowLatencyDeviceMarkerType.value());
     }
 
     bool NvapiD3dLowLatencyDevice::GetLowLatencyMode() const {
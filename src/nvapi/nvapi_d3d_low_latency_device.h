@@ -3,6 +3,7 @@
 #include "../nvapi_private.h"
 #include "../interfaces/shared_interfaces.h"
 #include "low_latency_frame_id_generator.h"
+#include "low_latency_frame_pacer.h"
 
 namespace dxvk {
     class NvapiD3dLowLatencyDevice {
@@ -18,17 +19,19 @@ namespace dxvk {
         [[nodiscard]] HRESULT LatencySleep() const;
         [[nodiscard]] HRESULT SetLatencySleepMode(bool lowLatencyMode, bool lowLatencyBoost, uint32_t minimumIntervalUs);
         [[nodiscard]] HRESULT GetLatencyInfo(D3D_LATENCY_RESULTS* latencyResults);
-        [[nodiscard]] HRESULT SetLatencyMarker(uint64_t frameID, uint32_t markerType);
+        [[nodiscard]] HRESULT SetLatencyMarker(uint64_t frameID, NV_LATENCY_MARKER_TYPE markerType);
         [[nodiscard]] bool GetLowLatencyMode() const;
 
       private:
         [[nodiscard]] static NvapiD3dLowLatencyDevice* Get(IUnknown*);
+        static void Erase(IUnknown* device, const NvapiD3dLowLatencyDevice* lowLatencyDevice);
 
         static std::unordered_map<IUnknown*, std::shared_ptr<NvapiD3dLowLatencyDevice>> m_nvapiDeviceMap;
         static std::mutex m_mutex;
 
         ID3DLowLatencyDevice* m_d3dLowLatencyDevice{};
         LowLatencyFrameIdGenerator m_frameIdGenerator;
+        std::unique_ptr<LowLatencyFramePacer<>> m_framePacer;
         bool m_lowLatencyMode{};
     };
 }
\ No newline at end of file
@@ -0,0 +1,36 @@
+#include "nvapi_destruction_notifier.h"
+
+namespace dxvk {
+    NvapiDestructionNotifier::NvapiDestructionNotifier(std::function<void()> callback)
+        : m_callback(std::move(callback)) {}
+
+    NvapiDestructionNotifier::~NvapiDestructionNotifier() {
+        if (m_callback)
+            m_callback();
+    }
+
+    HRESULT STDMETHODCALLTYPE NvapiDestructionNotifier::QueryInterface(REFIID riid, void** ppvObject) {
+        if (!ppvObject)
+            return E_POINTER;
+
+        *ppvObject = nullptr;
+        if (riid != __uuidof(IUnknown))
+            return E_NOINTERFACE;
+
+        AddRef();
+        *ppvObject = static_cast<IUnknown*>(this);
+        return S_OK;
+    }
+
+    ULONG STDMETHODCALLTYPE NvapiDestructionNotifier::AddRef() {
+        return ++m_refCount;
+    }
+
+    ULONG STDMETHODCALLTYPE NvapiDestructionNotifier::Release() {
+        auto refCount = --m_refCount;
+        if (refCount == 0)
+            delete this;
+
+        return refCount;
+    }
+}
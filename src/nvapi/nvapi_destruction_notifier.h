@@ -0,0 +1,38 @@
+#pragma once
+
+#include "../nvapi_private.h"
+
+#include <atomic>
+#include <functional>
+
+namespace dxvk {
+    // Stored as private data interface on a D3D object. The object releases its private data
+    // when it gets destroyed, which is when the callback runs.
+    class NvapiDestructionNotifier final : public IUnknown {
+
+      public:
+        template <typename T>
+        static bool Attach(T* object, REFGUID guid, std::function<void()> callback) {
+            auto notifier = new NvapiDestructionNotifier(std::move(callback));
+            notifier->AddRef();
+
+            auto attached = SUCCEEDED(object->SetPrivateDataInterface(guid, notifier));
+            if (!attached)
+                notifier->m_callback = nullptr;
+
+            notifier->Release();
+            return attached;
+        }
+
+        explicit NvapiDestructionNotifier(std::function<void()> callback);
+        ~NvapiDestructionNotifier();
+
+        HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** ppvObject) override;
+        ULONG STDMETHODCALLTYPE AddRef() override;
+        ULONG STDMETHODCALLTYPE Release() override;
+
+      private:
+        std::atomic<ULONG> m_refCount = 0;
+        std::function<void()> m_callback;
+    };
+}
@@ -0,0 +1,372 @@
+#include "nvapi_drs_database.h"
+#include "../util/util_string.h"
+
+namespace dxvk {
+    static std::wstring FromUnicodeString(const NvU16* str) {
+        auto wstr = reinterpret_cast<const wchar_t*>(str);
+        return {wstr, std::find(wstr, wstr + NVAPI_UNICODE_STRING_MAX, L'\0')};
+    }
+
+    static void ToUnicodeString(NvAPI_UnicodeString dst, const std::wstring& src) {
+        std::memset(dst, 0, sizeof(NvAPI_UnicodeString));
+        src.copy(reinterpret_cast<wchar_t*>(dst), std::min(src.size(), static_cast<size_t>(NVAPI_UNICODE_STRING_MAX - 1)));
+    }
+
+    static std::wstring ToLower(std::wstring str) {
+        std::transform(str.begin(), str.end(), str.begin(), [](const auto& c) { return std::tolower(c, std::locale::classic()); });
+        return str;
+    }
+
+    // Copies everything up to the given version, members of newer versions are left untouched
+    static void CopyApplication(NVDRS_APPLICATION* dst, const NVDRS_APPLICATION* src, NvU32 version) {
+        switch (version) {
+            case NVDRS_APPLICATION_VER_V4:
+                std::memcpy(dst->commandLine, src->commandLine, sizeof(dst->commandLine));
+                [[fallthrough]];
+            case NVDRS_APPLICATION_VER_V3:
+                dst->isCommandLine = src->isCommandLine;
+                dst->isMetro = src->isMetro;
+                [[fallthrough]];
+            case NVDRS_APPLICATION_VER_V2:
+                std::memcpy(dst->fileInFolder, src->fileInFolder, sizeof(dst->fileInFolder));
+                [[fallthrough]];
+            case NVDRS_APPLICATION_VER_V1:
+                std::memcpy(dst->launcher, src->launcher, sizeof(dst->launcher));
+                std::memcpy(dst->userFriendlyName, src->userFriendlyName, sizeof(dst->userFriendlyName));
+                std::memcpy(dst->appName, src->appName, sizeof(dst->appName));
+                dst->isPredefined = src->isPredefined;
+                break;
+            default:
+                break;
+        }
+    }
+
+    std::wstring NvapiDrsDatabase::NormalizeApplicationName(const NvU16* appName) {
+        auto name = FromUnicodeString(appName);
+        if (auto separator = name.find_last_of(L"\\/"); separator != std::wstring::npos)
+            name.erase(0, separator + 1);
+
+        return ToLower(std::move(name));
+    }
+
+    std::wstring NvapiDrsDatabase::NormalizeProfileName(const NvU16* profileName) {
+        return ToLower(FromUnicodeString(profileName));
+    }
+
+    NvapiDrsDatabase::NvapiDrsDatabase(const std::vector<NVDRS_SETTING>& environmentSettings, const std::string& executableName) {
+        m_baseProfile = AddProfile(L"Base Profile", true);
+        for (const auto& setting : environmentSettings) {
+            m_baseProfile->settings.insert_or_assign(setting.settingId, setting);
+            m_environmentSettings.insert_or_assign(setting.settingId, setting);
+        }
+
+        if (!executableName.empty())
+            AddApplicationProfile(str::tows(executableName.c_str()));
+    }
+
+    NvDRSSessionHandle NvapiDrsDatabase::CreateSession() {
+        std::scoped_lock lock{m_mutex};
+
+        auto handle = NextHandle<NvDRSSessionHandle>();
+        m_sessions.insert(handle);
+        return handle;
+    }
+
+    bool NvapiDrsDatabase::DestroySession(NvDRSSessionHandle session) {
+        std::scoped_lock lock{m_mutex};
+        return m_sessions.erase(session) != 0;
+    }
+
+    bool NvapiDrsDatabase::IsValidSession(NvDRSSessionHandle session) {
+        std::scoped_lock lock{m_mutex};
+        return m_sessions.contains(session);
+    }
+
+    NvAPI_Status NvapiDrsDatabase::GetBaseProfile(NvDRSSessionHandle session, NvDRSProfileHandle* profile) {
+        std::scoped_lock lock{m_mutex};
+        if (!m_sessions.contains(session))
+            return NVAPI_INVALID_HANDLE;
+
+        *profile = m_baseProfile->handle;
+        return NVAPI_OK;
+    }
+
+    NvAPI_Status NvapiDrsDatabase::GetNumProfiles(NvDRSSessionHandle session, NvU32* count) {
+        std::scoped_lock lock{m_mutex};
+        if (!m_sessions.contains(session))
+            return NVAPI_INVALID_HANDLE;
+
+        *count = static_cast<NvU32>(m_profileOrder.size());
+        return NVAPI_OK;
+    }
+
+    NvAPI_Status NvapiDrsDatabase::EnumProfiles(NvDRSSessionHandle session, NvU32 index, NvDRSProfileHandle* profile) {
+        std::scoped_lock lock{m_mutex};
+        if (!m_sessions.contains(session))
+            return NVAPI_INVALID_HANDLE;
+
+        if (index >= m_profileOrder.size())
+            return NVAPI_END_ENUMERATION;
+
+        *profile = m_profileOrder[index]->handle;
+        return NVAPI_OK;
+    }
+
+    NvAPI_Status NvapiDrsDatabase::CreateProfile(NvDRSSessionHandle session, const NVDRS_PROFILE* profileInfo, NvDRSProfileHandle* profile) {
+        std::scoped_lock lock{m_mutex};
+        if (!m_sessions.contains(session))
+            return NVAPI_INVALID_HANDLE;
+
+        auto name = FromUnicodeString(profileInfo->profileName);
+        if (name.empty())
+            return NVAPI_INVALID_ARGUMENT;
+
+        if (m_profilesByName.contains(ToLower(name)))
+            return NVAPI_PROFILE_NAME_IN_USE;
+
+        auto created = AddProfile(name, false);
+        created->gpuSupport = profileInfo->gpuSupport;
+
+        *profile = created->handle;
+        return NVAPI_OK;
+    }
+
+    NvAPI_Status NvapiDrsDatabase::DeleteProfile(NvDRSSessionHandle session, NvDRSProfileHandle profile) {
+        std::scoped_lock lock{m_mutex};
+        if (!m_sessions.contains(session))
+            return NVAPI_INVALID_HANDLE;
+
+        auto existing = FindProfile(profile);
+        if (!existing)
+            return NVAPI_PROFILE_NOT_FOUND;
+
+        if (existing == m_baseProfile)
+            return NVAPI_INVALID_ARGUMENT;
+
+        for (const auto& application : existing->applications)
+            m_profilesByApplication.erase(NormalizeApplicationName(application->appName));
+
+        m_profilesByName.erase(ToLower(existing->name));
+        m_profileOrder.erase(std::find(m_profileOrder.begin(), m_profileOrder.end(), existing));
+        m_profiles.erase(profile);
+        return NVAPI_OK;
+    }
+
+    NvAPI_Status NvapiDrsDatabase::FindProfileByName(NvDRSSessionHandle session, const NvU16* profileName, NvDRSProfileHandle* profile) {
+        std::scoped_lock lock{m_mutex};
+        if (!m_sessions.contains(session))
+            return NVAPI_INVALID_HANDLE;
+
+        auto name = FromUnicodeString(profileName);
+        if (name.empty())
+            return NVAPI_PROFILE_NOT_FOUND;
+
+        // Unknown profiles are created empty, so the base profile and environment settings reach whoever looks them up
+        auto it = m_profilesByName.find(NormalizeProfileName(profileName));
+        *profile = it != m_profilesByName.end() ? it->second->handle : AddProfile(name, false)->handle;
+        return NVAPI_OK;
+    }
+
+    NvAPI_Status NvapiDrsDatabase::GetProfileInfo(NvDRSSessionHandle session, NvDRSProfileHandle profile, NVDRS_PROFILE* profileInfo) {
+        std::scoped_lock lock{m_mutex};
+        if (!m_sessions.contains(session))
+            return NVAPI_INVALID_HANDLE;
+
+        auto existing = FindProfile(profile);
+        if (!existing)
+            return NVAPI_PROFILE_NOT_FOUND;
+
+        ToUnicodeString(profileInfo->profileName, existing->name);
+        profileInfo->gpuSupport = existing->gpuSupport;
+        profileInfo->isPredefined = existing->isPredefined;
+        profileInfo->numOfApps = static_cast<NvU32>(existing->applications.size());
+        profileInfo->numOfSettings = static_cast<NvU32>(existing->settings.size());
+        return NVAPI_OK;
+    }
+
+    NvAPI_Status NvapiDrsDatabase::CreateApplication(NvDRSSessionHandle session, NvDRSProfileHandle profile, const NVDRS_APPLICATION* application) {
+        std::scoped_lock lock{m_mutex};
+        if (!m_sessions.contains(session))
+            return NVAPI_INVALID_HANDLE;
+
+        auto existing = FindProfile(profile);
+        if (!existing)
+            return NVAPI_PROFILE_NOT_FOUND;
+
+        auto appName = NormalizeApplicationName(application->appName);
+        if (appName.empty())
+            return NVAPI_INVALID_ARGUMENT;
+
+        if (m_profilesByApplication.contains(appName))
+            return NVAPI_EXECUTABLE_ALREADY_IN_USE;
+
+        AddApplication(existing, appName, application);
+        return NVAPI_OK;
+    }
+
+    NvAPI_Status NvapiDrsDatabase::DeleteApplication(NvDRSSessionHandle session, NvDRSProfileHandle profile, const NvU16* appName) {
+        std::scoped_lock lock{m_mutex};
+        if (!m_sessions.contains(session))
+            return NVAPI_INVALID_HANDLE;
+
+        auto existing = FindProfile(profile);
+        if (!existing)
+            return NVAPI_PROFILE_NOT_FOUND;
+
+        auto name = NormalizeApplicationName(appName);
+        auto it = m_profilesByApplication.find(name);
+        if (it == m_profilesByApplication.end() || it->second != existing)
+            return NVAPI_EXECUTABLE_NOT_FOUND;
+
+        m_profilesByApplication.erase(it);
+        std::erase_if(existing->applications, [&name](const auto& application) { return NormalizeApplicationName(application->appName) == name; });
+        return NVAPI_OK;
+    }
+
+    NvAPI_Status NvapiDrsDatabase::FindApplicationByName(NvDRSSessionHandle session, const NvU16* appName, NvDRSProfileHandle* profile, NVDRS_APPLICATION* application) {
+        std::scoped_lock lock{m_mutex};
+        if (!m_sessions.contains(session))
+            return NVAPI_INVALID_HANDLE;
+
+        auto name = NormalizeApplicationName(appName);
+        if (name.empty())
+            return NVAPI_EXECUTABLE_NOT_FOUND;
+
+        // Same for unknown applications, NGX for example looks up other executables than the running one
+        auto it = m_profilesByApplication.find(name);
+        auto existing = it != m_profilesByApplication.end() ? it->second : AddApplicationProfile(FromUnicodeString(appName));
+
+        auto found = std::find_if(existing->applications.begin(), existing->applications.end(),
+            [&name](const auto& item) { return NormalizeApplicationName(item->appName) == name; });
+
+        CopyApplication(application, found->get(), application->version);
+        *profile = existing->handle;
+        return NVAPI_OK;
+    }
+
+    NvAPI_Status NvapiDrsDatabase::EnumApplications(NvDRSSessionHandle session, NvDRSProfileHandle profile, NvU32 startIndex, NvU32* count, NVDRS_APPLICATION* applications) {
+        std::scoped_lock lock{m_mutex};
+        if (!m_sessions.contains(session))
+            return NVAPI_INVALID_HANDLE;
+
+        auto existing = FindProfile(profile);
+        if (!existing)
+            return NVAPI_PROFILE_NOT_FOUND;
+
+        if (startIndex >= existing->applications.size()) {
+            *count = 0;
+            return NVAPI_END_ENUMERATION;
+        }
+
+        // Every entry in the output array carries the struct version it was allocated with
+        *count = std::min(*count, static_cast<NvU32>(existing->applications.size() - startIndex));
+        for (auto i = 0U; i < *count; i++)
+            CopyApplication(&applications[i], existing->applications[startIndex + i].get(), applications[i].version);
+
+        return NVAPI_OK;
+    }
+
+    NvAPI_Status NvapiDrsDatabase::SetSetting(NvDRSSessionHandle session, NvDRSProfileHandle profile, const NVDRS_SETTING* setting) {
+        std::scoped_lock lock{m_mutex};
+        if (!m_sessions.contains(session))
+            return NVAPI_INVALID_HANDLE;
+
+        auto existing = FindProfile(profile);
+        if (!existing)
+            return NVAPI_PROFILE_NOT_FOUND;
+
+        auto& stored = existing->settings.insert_or_assign(setting->settingId, *setting).first->second;
+        stored.settingLocation = NVDRS_CURRENT_PROFILE_LOCATION;
+        stored.isCurrentPredefined = 0;
+        return NVAPI_OK;
+    }
+
+    NvAPI_Status NvapiDrsDatabase::GetSetting(NvDRSSessionHandle, NvDRSProfileHandle profile, NvU32 settingId, NVDRS_SETTING* setting) {
+        std::scoped_lock lock{m_mutex};
+
+        // Reading settings never required valid handles, unknown ones still get the base profile and environment settings
+        auto existing = FindProfile(profile);
+        if (!existing)
+            existing = m_baseProfile;
+
+        // The user asked for these settings explicitly, the application must not be able to override them
+        if (auto it = m_environmentSettings.find(settingId); it != m_environmentSettings.end()) {
+            *setting = it->second;
+            if (existing != m_baseProfile)
+                setting->settingLocation = NVDRS_BASE_PROFILE_LOCATION;
+
+            return NVAPI_OK;
+        }
+
+        if (auto it = existing->settings.find(settingId); it != existing->settings.end()) {
+            *setting = it->second;
+            return NVAPI_OK;
+        }
+
+        if (auto it = m_baseProfile->settings.find(settingId); it != m_baseProfile->settings.end()) {
+            *setting = it->second;
+            if (existing != m_baseProfile)
+                setting->settingLocation = NVDRS_BASE_PROFILE_LOCATION;
+
+            return NVAPI_OK;
+        }
+
+        return NVAPI_SETTING_NOT_FOUND;
+    }
+
+    NvAPI_Status NvapiDrsDatabase::DeleteProfileSetting(NvDRSSessionHandle session, NvDRSProfileHandle profile, NvU32 settingId) {
+        std::scoped_lock lock{m_mutex};
+        if (!m_sessions.contains(session))
+            return NVAPI_INVALID_HANDLE;
+
+        auto existing = FindProfile(profile);
+        if (!existing)
+            return NVAPI_PROFILE_NOT_FOUND;
+
+        if (existing->settings.erase(settingId) == 0)
+            return NVAPI_SETTING_NOT_FOUND;
+
+        return NVAPI_OK;
+    }
+
+    NvapiDrsDatabase::Profile* NvapiDrsDatabase::FindProfile(NvDRSProfileHandle profile) const {
+        auto it = m_profiles.find(profile);
+        return it != m_profiles.end() ? it->second.get() : nullptr;
+    }
+
+    NvapiDrsDatabase::Profile* NvapiDrsDatabase::AddProfile(const std::wstring& name, bool isPredefined) {
+        auto profile = std::make_unique<Profile>();
+        profile->handle = NextHandle<NvDRSProfileHandle>();
+        profile->name = name;
+        profile->gpuSupport = {};
+        profile->isPredefined = isPredefined;
+
+        auto added = profile.get();
+        m_profiles.emplace(added->handle, std::move(profile));
+        m_profileOrder.push_back(added);
+        m_profilesByName.emplace(ToLower(name), added);
+        return added;
+    }
+
+    NvapiDrsDatabase::Profile* NvapiDrsDatabase::AddApplicationProfile(const std::wstring& appName) {
+        auto application = std::make_unique<NVDRS_APPLICATION>();
+        application->version = NVDRS_APPLICATION_VER;
+        ToUnicodeString(application->appName, appName);
+        ToUnicodeString(application->userFriendlyName, appName);
+
+        auto it = m_profilesByName.find(ToLower(appName));
+        auto profile = it != m_profilesByName.end() ? it->second : AddProfile(appName, false);
+        AddApplication(profile, NormalizeApplicationName(application->appName), application.get());
+        return profile;
+    }
+
+    void NvapiDrsDatabase::AddApplication(Profile* profile, const std::wstring& appName, const NVDRS_APPLICATION* application) {
+        auto added = std::make_unique<NVDRS_APPLICATION>();
+        added->version = NVDRS_APPLICATION_VER;
+        CopyApplication(added.get(), application, application->version);
+        added->isPredefined = 0;
+
+        profile->applications.push_back(std::move(added));
+        m_profilesByApplication.emplace(appName, profile);
+    }
+}
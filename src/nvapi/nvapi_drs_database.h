@@ -0,0 +1,72 @@
+#pragma once
+
+#include "../nvapi_private.h"
+
+namespace dxvk {
+    // In-memory driver settings database, profiles, applications and settings live as long as the process does.
+    // Profiles are found by name and by normalised application name, settings by ID, all without walking any list.
+    // All sessions share the same data, so saving and loading settings has nothing to do.
+    class NvapiDrsDatabase {
+
+      public:
+        // Environment settings are seeded into the base profile and take precedence over whatever any profile sets later on,
+        // settings of the base profile apply to every profile that does not set them itself
+        explicit NvapiDrsDatabase(const std::vector<NVDRS_SETTING>& environmentSettings, const std::string& executableName);
+
+        [[nodiscard]] NvDRSSessionHandle CreateSession();
+        [[nodiscard]] bool DestroySession(NvDRSSessionHandle session);
+        [[nodiscard]] bool IsValidSession(NvDRSSessionHandle session);
+
+        [[nodiscard]] NvAPI_Status GetBaseProfile(NvDRSSessionHandle session, NvDRSProfileHandle* profile);
+        [[nodiscard]] NvAPI_Status GetNumProfiles(NvDRSSessionHandle session, NvU32* count);
+        [[nodiscard]] NvAPI_Status EnumProfiles(NvDRSSessionHandle session, NvU32 index, NvDRSProfileHandle* profile);
+        [[nodiscard]] NvAPI_Status CreateProfile(NvDRSSessionHandle session, const NVDRS_PROFILE* profileInfo, NvDRSProfileHandle* profile);
+        [[nodiscard]] NvAPI_Status DeleteProfile(NvDRSSessionHandle session, NvDRSProfileHandle profile);
+        [[nodiscard]] NvAPI_Status FindProfileByName(NvDRSSessionHandle session, const NvU16* profileName, NvDRSProfileHandle* profile);
+        [[nodiscard]] NvAPI_Status GetProfileInfo(NvDRSSessionHandle session, NvDRSProfileHandle profile, NVDRS_PROFILE* profileInfo);
+
+        // Applications are copied in and out as far as their struct version allows
+        [[nodiscard]] NvAPI_Status CreateApplication(NvDRSSessionHandle session, NvDRSProfileHandle profile, const NVDRS_APPLICATION* application);
+        [[nodiscard]] NvAPI_Status DeleteApplication(NvDRSSessionHandle session, NvDRSProfileHandle profile, const NvU16* appName);
+        [[nodiscard]] NvAPI_Status FindApplicationByName(NvDRSSessionHandle session, const NvU16* appName, NvDRSProfileHandle* profile, NVDRS_APPLICATION* application);
+        [[nodiscard]] NvAPI_Status EnumApplications(NvDRSSessionHandle session, NvDRSProfileHandle profile, NvU32 startIndex, NvU32* count, NVDRS_APPLICATION* applications);
+
+        [[nodiscard]] NvAPI_Status SetSetting(NvDRSSessionHandle session, NvDRSProfileHandle profile, const NVDRS_SETTING* setting);
+        [[nodiscard]] NvAPI_Status GetSetting(NvDRSSessionHandle session, NvDRSProfileHandle profile, NvU32 settingId, NVDRS_SETTING* setting);
+        [[nodiscard]] NvAPI_Status DeleteProfileSetting(NvDRSSessionHandle session, NvDRSProfileHandle profile, NvU32 settingId);
+
+        // Lower case file name without directories, the same application may be passed with or without its path
+        [[nodiscard]] static std::wstring NormalizeApplicationName(const NvU16* appName);
+        [[nodiscard]] static std::wstring NormalizeProfileName(const NvU16* profileName);
+
+      private:
+        struct Profile {
+            NvDRSProfileHandle handle;
+            std::wstring name;
+            decltype(NVDRS_PROFILE::gpuSupport) gpuSupport;
+            bool isPredefined;
+            std::vector<std::unique_ptr<NVDRS_APPLICATION>> applications;
+            std::unordered_map<NvU32, NVDRS_SETTING> settings;
+        };
+
+        [[nodiscard]] Profile* FindProfile(NvDRSProfileHandle profile) const;
+        Profile* AddProfile(const std::wstring& name, bool isPredefined);
+        // Profile named after the application, holding only that application, so the base profile settings apply to it
+        Profile* AddApplicationProfile(const std::wstring& appName);
+        void AddApplication(Profile* profile, const std::wstring& appName, const NVDRS_APPLICATION* application);
+
+        // Handles are counted up and never reused, so a stale handle cannot refer to a newer session or profile
+        template <typename T>
+        [[nodiscard]] T NextHandle() { return reinterpret_cast<T>(++m_lastHandle); }
+
+        std::mutex m_mutex;
+        uintptr_t m_lastHandle{};
+        std::unordered_set<NvDRSSessionHandle> m_sessions;
+        std::unordered_map<NvDRSProfileHandle, std::unique_ptr<Profile>> m_profiles;
+        std::unordered_map<NvU32, NVDRS_SETTING> m_environmentSettings;
+        std::vector<Profile*> m_profileOrder;
+        std::unordered_map<std::wstring, Profile*> m_profilesByName;
+        std::unordered_map<std::wstring, Profile*> m_profilesByApplication;
+        Profile* m_baseProfile{};
+    };
+}
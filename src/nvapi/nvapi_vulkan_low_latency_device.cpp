@@ -188,7 +188,10 @@ namespace dxvk {
           PFN_INIT(vkGetLatencyTimingsNV),
           PFN_INIT(vkSetLatencyMarkerNV),
           PFN_INIT(vkQueueNotifyOutOfBandNV),
-          PFN_INIT(vkSignalSemaphore) {}
+          PFN_INIT(vkSignalSemaphore) {
+        if (LowLatencyFramePacer<>::IsEnabled())
+            m_framePacer = std::make_unique<LowLatencyFramePacer<>>();
+    }
 
     bool NvapiVulkanLowLatencyDevice::IsLayerPresent() const {
         return m_layerPresent;
@@ -210,6 +213,9 @@ namespace dxvk {
     }
 
     VkResult NvapiVulkanLowLatencyDevice::SetLatencySleepMode(std::nullptr_t) {
+        if (m_framePacer)
+            m_framePacer->SetMinimumInterval(0);
+
         if (!m_layerPresent)
             return VK_SUCCESS;
 
@@ -222,6 +228,12 @@ namespace dxvk {
     }
 
     VkResult NvapiVulkanLowLatencyDevice::SetLatencySleepMode(bool lowLatencyMode, bool lowLatencyBoost, uint32_t minimumIntervalUs) {
+        if (m_framePacer) {
+            // The frame pacer takes over the frame rate limit, don't let the driver apply it a second time
+            m_framePacer->SetMinimumInterval(minimumIntervalUs);
+            minimumIntervalUs = 0;
+        }
+
         if (!m_layerPresent)
             return VK_SUCCESS;
 
@@ -242,6 +254,9 @@ namespace dxvk {
     }
 
     VkResult NvapiVulkanLowLatencyDevice::LatencySleep(uint64_t value) {
+        if (m_framePacer)
+            m_framePacer->Sleep();
+
         if (m_layerPresent) {
             auto info = VkLatencySleepInfoNV{
                 .sType = VK_STRUCTURE_TYPE_LATENCY_SLEEP_INFO_NV,
@@ -284,6 +299,9 @@ namespace dxvk {
     }
 
     void NvapiVulkanLowLatencyDevice::SetLatencyMarker(uint64_t presentID, VkLatencyMarkerNV marker) {
+        if (m_framePacer)
+            m_framePacer->SetMarker(marker);
+
         if (!m_layerPresent)
             return;
 
@@ -2,6 +2,7 @@
 
 #include "../nvapi_private.h"
 #include "./nvapi_resource_factory.h"
+#include "./low_latency_frame_pacer.h"
 
 namespace dxvk {
     class NvapiVulkanLowLatencyDevice {
@@ -49,6 +50,7 @@ namespace dxvk {
         VkSemaphore m_semaphore{};
         bool m_lowLatencyMode{};
         bool m_layerPresent{};
+        std::unique_ptr<LowLatencyFramePacer<>> m_framePacer;
 #define PFN_MEMBER(proc) \
     PFN_##proc m_##proc {}
         PFN_MEMBER(vkDestroySemaphore);
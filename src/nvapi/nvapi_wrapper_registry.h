@@ -0,0 +1,182 @@
+#pragma once
+
+#include "nvapi_destruction_notifier.h"
+#include "../nvapi_private.h"
+
+#include <atomic>
+#include <shared_mutex>
+
+namespace dxvk {
+    // Maps D3D objects to their NVAPI wrappers. Every thread remembers its last hit, so repeated
+    // lookups of the same object (e.g. a command list during recording) do not touch any lock.
+    // Everything else goes through a striped table, so threads working on different objects
+    // rarely wait on each other. Wrappers keep their address until they are erased or cleared,
+    // which also happens when the wrapped object gets destroyed.
+    template <typename TKey, typename TValue, size_t StripeCount = 16>
+    class NvapiWrapperRegistry {
+        static_assert(StripeCount > 0 && (StripeCount & (StripeCount - 1)) == 0);
+
+      public:
+        // Stores private data on the object behind a key, for keys that do not carry private data themselves
+        using PrivateDataSetter = HRESULT (*)(TKey* key, REFGUID guid, const IUnknown* data);
+
+        // The GUID identifies the private data that erases a wrapper when its object gets destroyed
+        explicit NvapiWrapperRegistry(const GUID& privateDataGuid, PrivateDataSetter setPrivateData = &SetKeyPrivateData)
+            : m_privateDataGuid(privateDataGuid), m_setPrivateData(setPrivateData) {}
+
+        NvapiWrapperRegistry(const NvapiWrapperRegistry&) = delete;
+        NvapiWrapperRegistry& operator=(const NvapiWrapperRegistry&) = delete;
+
+        ~NvapiWrapperRegistry() {
+            Invalidate();
+        }
+
+        // Returns the wrapper for the given object, calls create for a new one when there is none yet,
+        // create returns a std::unique_ptr<TValue> or nullptr when the object cannot be wrapped
+        template <typename F>
+        [[nodiscard]] TValue* GetOrCreate(TKey* key, F&& create) {
+            auto generation = s_generation.load(std::memory_order_acquire);
+            if (t_lastHit.registry == this && t_lastHit.key == key && t_lastHit.generation == generation)
+                return t_lastHit.value;
+
+            auto& stripe = GetStripe(key);
+            auto value = Find(stripe, key);
+            if (!value) {
+                std::shared_ptr<TValue> created;
+                {
+                    std::unique_lock lock(stripe.mutex);
+                    auto& entry = stripe.map[key];
+                    if (!entry)
+                        created = entry = create();
+
+                    value = entry.get();
+                    if (!value)
+                        stripe.map.erase(key);
+                }
+
+                // Outside the lock, attaching may release an outdated notifier which erases on its own
+                if (created)
+                    Track(key, created);
+            }
+
+            if (value)
+                t_lastHit = LastHit{this, generation, key, value};
+
+            return value;
+        }
+
+        [[nodiscard]] TValue* Find(TKey* key) {
+            return Find(GetStripe(key), key);
+        }
+
+        bool Erase(TKey* key) {
+            auto& stripe = GetStripe(key);
+            std::unique_lock lock(stripe.mutex);
+            if (stripe.map.erase(key) == 0)
+                return false;
+
+            Invalidate();
+            return true;
+        }
+
+        // Only erases the entry when it still holds the given wrapper, the same address may have been wrapped again in the meantime
+        bool Erase(TKey* key, const TValue* value) {
+            auto& stripe = GetStripe(key);
+            std::unique_lock lock(stripe.mutex);
+            auto it = stripe.map.find(key);
+            if (it == stripe.map.end() || it->second.get() != value)
+                return false;
+
+            stripe.map.erase(it);
+            Invalidate();
+            return true;
+        }
+
+        // Objects that are still alive keep their notifier otherwise, which must not outlive this module
+        void Clear() {
+            std::vector<TKey*> keys;
+            for (auto& stripe : m_stripes) {
+                std::unique_lock lock(stripe.mutex);
+                for (const auto& [key, value] : stripe.map)
+                    keys.push_back(key);
+
+                stripe.map.clear();
+            }
+
+            Invalidate();
+
+            // Outside the lock, detaching releases the notifiers which erase on their own
+            for (auto key : keys)
+                m_setPrivateData(key, m_privateDataGuid, nullptr);
+        }
+
+        [[nodiscard]] size_t Size() {
+            size_t size = 0;
+            for (auto& stripe : m_stripes) {
+                std::shared_lock lock(stripe.mutex);
+                size += stripe.map.size();
+            }
+
+            return size;
+        }
+
+      private:
+        struct alignas(64) Stripe {
+            std::shared_mutex mutex;
+            std::unordered_map<TKey*, std::shared_ptr<TValue>> map;
+        };
+
+        struct PrivateDataOwner {
+            TKey* key;
+            PrivateDataSetter setPrivateData;
+
+            HRESULT SetPrivateDataInterface(REFGUID guid, const IUnknown* data) const {
+                return setPrivateData(key, guid, data);
+            }
+        };
+
+        struct LastHit {
+            const NvapiWrapperRegistry* registry;
+            uint64_t generation;
+            TKey* key;
+            TValue* value;
+        };
+
+        // Bumped whenever a wrapper goes away, so no thread keeps handing out its last hit
+        static inline std::atomic<uint64_t> s_generation = 1;
+        static inline thread_local LastHit t_lastHit{};
+
+        static HRESULT SetKeyPrivateData(TKey* key, REFGUID guid, const IUnknown* data) {
+            return key->SetPrivateDataInterface(guid, data);
+        }
+
+        static void Invalidate() {
+            s_generation.fetch_add(1, std::memory_order_acq_rel);
+        }
+
+        [[nodiscard]] Stripe& GetStripe(TKey* key) {
+            // Objects are at least pointer aligned, so skip the low bits before spreading them over the stripes
+            auto address = reinterpret_cast<uintptr_t>(key) >> 4;
+            return m_stripes[(address ^ (address >> 7)) & (StripeCount - 1)];
+        }
+
+        void Track(TKey* key, const std::shared_ptr<TValue>& value) {
+            // The wrapper owns the registry entry, once it is gone this registry may be gone as well
+            auto owner = PrivateDataOwner{key, m_setPrivateData};
+            NvapiDestructionNotifier::Attach(&owner, m_privateDataGuid, [this, key, weakValue = std::weak_ptr<TValue>(value)] {
+                if (auto wrapper = weakValue.lock())
+                    Erase(key, wrapper.get());
+            });
+        }
+
+        [[nodiscard]] static TValue* Find(Stripe& stripe, TKey* key) {
+            std::shared_lock lock(stripe.mutex);
+            auto it = stripe.map.find(key);
+            return it != stripe.map.end() ? it->second.get() : nullptr;
+        }
+
+        GUID m_privateDataGuid;
+        PrivateDataSetter m_setPrivateData;
+        std::array<Stripe, StripeCount> m_stripes;
+    };
+}
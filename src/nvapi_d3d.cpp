@@ -360,8 +360,7 @@ NVAPI_FUNCTION NvAPI_D3D_SetLatencyMarker(IUnknown* pDev, NV_LATENCY_MARKER_PARA
     if (!lowLatencyDevice || !lowLatencyDevice->SupportsLowLatency())
         return NoImplementation(n, alreadyLoggedNoImplementation);
 
-    auto markerType = NvapiD3dLowLatencyDevice::ToMarkerType(pSetLatencyMarkerParams->markerType);
-    if (!markerType.has_value()) {
+    if (!NvapiD3dLowLatencyDevice::ToMarkerType(pSetLatencyMarkerParams->markerType).has_value()) {
         // Silently drop unsupported marker types
         if (!std::exchange(alreadyLoggedMarkerTypeNotSupported, true))
             log::info(str::format("Not supported NV_LATENCY_MARKER_TYPE: ", pSetLatencyMarkerParams->markerType));
@@ -369,7 +368,7 @@ NVAPI_FUNCTION NvAPI_D3D_SetLatencyMarker(IUnknown* pDev, NV_LATENCY_MARKER_PARA
         return Ok(n, alreadyLoggedOk);
     }
 
-    switch (lowLatencyDevice->SetLatencyMarker(pSetLatencyMarkerParams->frameID, markerType.value())) {
+    switch (lowLatencyDevice->SetLatencyMarker(pSetLatencyMarkerParams->frameID, pSetLatencyMarkerParams->markerType)) {
         case S_OK:
             return Ok(n, alreadyLoggedOk);
         case E_NOTIMPL:
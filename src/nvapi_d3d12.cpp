@@ -9,6 +9,7 @@
 #include "util/util_op_code.h"
 #include "util/util_pso_extension.h"
 #include "util/util_raytracing_caps.h"
+#include "util/util_scratch.h"
 #include "util/util_string.h"
 #include "util/util_env.h"
 
@@ -214,7 +215,7 @@ NVAPI_FUNCTION NvAPI_D3D12_CreateCubinComputeShaderExV2(NVAPI_D3D12_CREATE_CUBIN
     if (log::tracing())
         log::trace(n, log::fmt::nvapi_d3d12_create_cubin_shader_params(pParams));
 
-    if (!NvapiD3d12Device::Cubin64bitSupportAvailable(resourceFactory.get(), nvapiAdapterRegistry.get()))
+    if (!NvapiD3d12Device::Cubin64bitSupportAvailable(nvapiAdapterRegistry.get()))
         return NoImplementation(n, alreadyLoggedNoImplementation);
 
     if (!pParams)
@@ -267,7 +268,7 @@ NVAPI_FUNCTION NvAPI_D3D12_GetCudaMergedTextureSamplerObject(NVAPI_D3D12_GET_CUD
     if (log::tracing())
         log::trace(n, log::fmt::nvapi_d3d12_get_cuda_merged_texture_sampler_object_params(pParams));
 
-    if (!NvapiD3d12Device::Cubin64bitSupportAvailable(resourceFactory.get(), nvapiAdapterRegistry.get()))
+    if (!NvapiD3d12Device::Cubin64bitSupportAvailable(nvapiAdapterRegistry.get()))
         return NoImplementation(n, alreadyLoggedNoImplementation);
 
     if (!pParams)
@@ -314,7 +315,7 @@ NVAPI_FUNCTION NvAPI_D3D12_GetCudaIndependentDescriptorObject(NVAPI_D3D12_GET_CU
     if (log::tracing())
         log::trace(n, log::fmt::nvapi_d3d12_get_cuda_independent_descriptor_object_params(pParams));
 
-    if (!NvapiD3d12Device::Cubin64bitSupportAvailable(resourceFactory.get(), nvapiAdapterRegistry.get()))
+    if (!NvapiD3d12Device::Cubin64bitSupportAvailable(nvapiAdapterRegistry.get()))
         return NoImplementation(n, alreadyLoggedNoImplementation);
 
     if (!pParams)
@@ -507,11 +508,56 @@ NVAPI_FUNCTION NvAPI_D3D12_IsFatbinPTXSupported(ID3D12Device* pDevice, bool* isS
     return Ok(str::format(n, "(", *isSupported ? "Supported" : "Unsupported", ")"), alreadyLoggedOk);
 }
 
-inline static bool CreateGraphicsPipelineState(ID3D12Device* device, const D3D12_GRAPHICS_PIPELINE_STATE_DESC* pipelineStateDescription, NvU32 numberOfExtensions, const NVAPI_D3D12_PSO_EXTENSION_DESC** extensions, ID3D12PipelineState** pipelineState) {
-    if (numberOfExtensions != 1 || extensions[0]->psoExtension != NV_PSO_ENABLE_DEPTH_BOUND_TEST_EXTENSION)
-        return false;
+struct PsoExtensionSet {
+    bool supported;
+    std::string logMessage;
+};
+
+// Every known extension code gets its own bit, unknown codes share the highest one
+inline static uint64_t ToPsoExtensionBit(const uint32_t code) {
+    return 1ULL << std::min(code, 63U);
+}
+
+// Applications create lots of pipelines with the same few extensions, so every combination is classified and named only once per thread
+inline static const PsoExtensionSet& GetPsoExtensionSet(const char* functionName, const uint64_t extensionBits) {
+    thread_local std::unordered_map<uint64_t, PsoExtensionSet> extensionSets;
+
+    auto [it, inserted] = extensionSets.try_emplace(extensionBits);
+    if (!inserted)
+        return it->second;
+
+    std::string extensionNames;
+    auto& extensionSet = it->second;
+    extensionSet.supported = true;
+    for (auto code = 0U; code < 64U; code++) {
+        if (!(extensionBits & ToPsoExtensionBit(code)))
+            continue;
+
+        if (getPsoExtensionSupport(code) == PsoExtensionSupport::Unsupported)
+            extensionSet.supported = false;
+
+        extensionNames += str::format(fromPsoExtension(code), ",");
+    }
+
+    extensionNames.pop_back();
+    extensionSet.logMessage = str::format(functionName, " (", extensionNames, ")");
 
-    return SUCCEEDED(device->CreateGraphicsPipelineState(pipelineStateDescription, __uuidof(ID3D12PipelineState), reinterpret_cast<void**>(pipelineState)));
+    return extensionSet;
+}
+
+inline static NvapiD3d12Device* SetPsoShaderExtensionSlot(ID3D12Device* pDevice, const NVAPI_D3D12_PSO_SET_SHADER_EXTENSION_SLOT_DESC* slotDesc) {
+    if (!env::isD3d12NvShaderExtnEnabled())
+        return nullptr;
+
+    auto device = NvapiD3d12Device::GetOrCreate(pDevice);
+    if (!device)
+        return nullptr;
+
+    // The slot only needs to be known while compiling the shaders of this pipeline, which happens on the calling thread
+    if (FAILED(device->PushNvShaderExtnSlotSpace(slotDesc->uavSlot, slotDesc->registerSpace)))
+        return nullptr;
+
+    return device;
 }
 
 NVAPI_FUNCTION NvAPI_D3D12_CreateGraphicsPipelineState(ID3D12Device* pDevice, const D3D12_GRAPHICS_PIPELINE_STATE_DESC* pPSODesc, NvU32 numExtensions, const NVAPI_D3D12_PSO_EXTENSION_DESC** ppExtensions, ID3D12PipelineState** ppPSO) {
@@ -527,19 +573,45 @@ NVAPI_FUNCTION NvAPI_D3D12_CreateGraphicsPipelineState(ID3D12Device* pDevice, co
     if (numExtensions == 0)
         return InvalidArgument(n);
 
-    if (ppExtensions[0]->baseVersion != NV_PSO_EXTENSION_DESC_VER_1)
-        return IncompatibleStructVersion(n, ppExtensions[0]->baseVersion);
+    uint64_t extensionBits = 0;
+    const NVAPI_D3D12_PSO_SET_SHADER_EXTENSION_SLOT_DESC* slotDesc = nullptr;
+    for (auto i = 0U; i < numExtensions; i++) {
+        auto extension = ppExtensions[i];
+        if (!extension)
+            return InvalidArgument(n);
 
-    std::string extensionNames;
-    for (auto i = 0U; i < numExtensions; i++)
-        extensionNames += str::format(fromPsoExtension(ppExtensions[i]->psoExtension), ",");
+        if (extension->baseVersion != NV_PSO_EXTENSION_DESC_VER_1)
+            return IncompatibleStructVersion(n, extension->baseVersion);
 
-    extensionNames.pop_back();
+        extensionBits |= ToPsoExtensionBit(extension->psoExtension);
+        if (extension->psoExtension == NV_PSO_SET_SHADER_EXTNENSION_SLOT_AND_SPACE)
+            slotDesc = static_cast<const NVAPI_D3D12_PSO_SET_SHADER_EXTENSION_SLOT_DESC*>(extension);
+    }
 
-    if (!CreateGraphicsPipelineState(pDevice, pPSODesc, numExtensions, ppExtensions, ppPSO))
-        return NotSupported(str::format(n, " (", numExtensions, "/", extensionNames, ")"));
+    auto& extensionSet = GetPsoExtensionSet(n, extensionBits);
+    if (!extensionSet.supported)
+        return NotSupported(extensionSet.logMessage);
 
-    return Ok(str::format(n, " (", numExtensions, "/", extensionNames, ")"), alreadyLoggedOk);
+    NvapiD3d12Device* slotDevice = nullptr;
+    if (slotDesc) {
+        if (slotDesc->version != NV_SET_SHADER_EXTENSION_SLOT_DESC_VER)
+            return IncompatibleStructVersion(n, slotDesc->version);
+
+        slotDevice = SetPsoShaderExtensionSlot(pDevice, slotDesc);
+        if (!slotDevice)
+            return NotSupported(extensionSet.logMessage);
+    }
+
+    auto result = pDevice->CreateGraphicsPipelineState(pPSODesc, __uuidof(ID3D12PipelineState), reinterpret_cast<void**>(ppPSO));
+
+    // Pipelines created afterwards on this thread must get the slot the application set, not the one of this pipeline
+    if (slotDevice)
+        slotDevice->PopNvShaderExtnSlotSpace();
+
+    if (FAILED(result))
+        return NotSupported(extensionSet.logMessage);
+
+    return Ok(extensionSet.logMessage, alreadyLoggedOk);
 }
 
 NVAPI_FUNCTION NvAPI_D3D12_SetNvShaderExtnSlotSpace(IUnknown* pDev, NvU32 uavSlot, NvU32 uavSpace) {
@@ -734,7 +806,15 @@ NVAPI_FUNCTION NvAPI_D3D12_GetRaytracingCaps(ID3D12Device* pDevice, NVAPI_D3D12_
     return Ok(str::format(n, " (", type, "/", fromRaytracingCaps(type), ")"));
 }
 
-inline static bool ConvertBuildRaytracingAccelerationStructureInputs(const NVAPI_D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS_EX* nvDesc, std::vector<D3D12_RAYTRACING_GEOMETRY_DESC>& geometryDescs, D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS* d3dDesc) {
+// Geometry descs without OMM or DMM attachment share their layout with D3D12_RAYTRACING_GEOMETRY_DESC
+static_assert(offsetof(NVAPI_D3D12_RAYTRACING_GEOMETRY_DESC_EX, type) == offsetof(D3D12_RAYTRACING_GEOMETRY_DESC, Type));
+static_assert(offsetof(NVAPI_D3D12_RAYTRACING_GEOMETRY_DESC_EX, flags) == offsetof(D3D12_RAYTRACING_GEOMETRY_DESC, Flags));
+static_assert(offsetof(NVAPI_D3D12_RAYTRACING_GEOMETRY_DESC_EX, triangles) == offsetof(D3D12_RAYTRACING_GEOMETRY_DESC, Triangles));
+static_assert(offsetof(NVAPI_D3D12_RAYTRACING_GEOMETRY_DESC_EX, aabbs) == offsetof(D3D12_RAYTRACING_GEOMETRY_DESC, AABBs));
+static_assert(static_cast<int>(NVAPI_D3D12_RAYTRACING_GEOMETRY_TYPE_TRIANGLES_EX) == static_cast<int>(D3D12_RAYTRACING_GEOMETRY_TYPE_TRIANGLES));
+static_assert(static_cast<int>(NVAPI_D3D12_RAYTRACING_GEOMETRY_TYPE_PROCEDURAL_PRIMITIVE_AABBS_EX) == static_cast<int>(D3D12_RAYTRACING_GEOMETRY_TYPE_PROCEDURAL_PRIMITIVE_AABBS));
+
+inline static bool ConvertBuildRaytracingAccelerationStructureInputs(const NVAPI_D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS_EX* nvDesc, D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS* d3dDesc) {
     d3dDesc->Type = nvDesc->type;
     // assume that OMM via VK_EXT_opacity_micromap and DMM via VK_NV_displacement_micromap are not supported, allow only standard flags to be passed
     d3dDesc->Flags = static_cast<D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAGS>(nvDesc->flags & 0x3f);
@@ -752,11 +832,27 @@ inline static bool ConvertBuildRaytracingAccelerationStructureInputs(const NVAPI
     }
 
     if (d3dDesc->Type == D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL && d3dDesc->DescsLayout == D3D12_ELEMENTS_LAYOUT_ARRAY) {
-        geometryDescs.resize(d3dDesc->NumDescs);
+        auto nvGeoDescs = reinterpret_cast<const std::byte*>(nvDesc->pGeometryDescs);
+
+        // Arrays with D3D12 stride can only hold triangles and AABBs, those can be passed through as they are
+        if (nvDesc->geometryDescStrideInBytes == sizeof(D3D12_RAYTRACING_GEOMETRY_DESC)) {
+            auto passThrough = true;
+            for (unsigned i = 0; i < d3dDesc->NumDescs && passThrough; ++i) {
+                auto& nvGeoDesc = *reinterpret_cast<const NVAPI_D3D12_RAYTRACING_GEOMETRY_DESC_EX*>(nvGeoDescs + (i * sizeof(D3D12_RAYTRACING_GEOMETRY_DESC)));
+                passThrough = nvGeoDesc.type == NVAPI_D3D12_RAYTRACING_GEOMETRY_TYPE_TRIANGLES_EX || nvGeoDesc.type == NVAPI_D3D12_RAYTRACING_GEOMETRY_TYPE_PROCEDURAL_PRIMITIVE_AABBS_EX;
+            }
+
+            if (passThrough) {
+                d3dDesc->pGeometryDescs = reinterpret_cast<const D3D12_RAYTRACING_GEOMETRY_DESC*>(nvDesc->pGeometryDescs);
+                return true;
+            }
+        }
+
+        auto geometryDescs = getThreadScratch<D3D12_RAYTRACING_GEOMETRY_DESC>(d3dDesc->NumDescs);
 
         for (unsigned i = 0; i < d3dDesc->NumDescs; ++i) {
             auto& d3dGeoDesc = geometryDescs[i];
-            auto& nvGeoDesc = *reinterpret_cast<const NVAPI_D3D12_RAYTRACING_GEOMETRY_DESC_EX*>(reinterpret_cast<const std::byte*>(nvDesc->pGeometryDescs) + (i * nvDesc->geometryDescStrideInBytes));
+            auto& nvGeoDesc = *reinterpret_cast<const NVAPI_D3D12_RAYTRACING_GEOMETRY_DESC_EX*>(nvGeoDescs + (i * nvDesc->geometryDescStrideInBytes));
 
             d3dGeoDesc.Flags = nvGeoDesc.flags;
 
@@ -781,7 +877,7 @@ inline static bool ConvertBuildRaytracingAccelerationStructureInputs(const NVAPI
             }
         }
 
-        d3dDesc->pGeometryDescs = geometryDescs.data();
+        d3dDesc->pGeometryDescs = geometryDescs;
         return true;
     }
 
@@ -804,10 +900,9 @@ NVAPI_FUNCTION NvAPI_D3D12_GetRaytracingAccelerationStructurePrebuildInfoEx(ID3D
     if (!pParams->pDesc || !pParams->pInfo)
         return InvalidArgument(n);
 
-    std::vector<D3D12_RAYTRACING_GEOMETRY_DESC> geometryDescs{};
     D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS desc{};
 
-    if (!ConvertBuildRaytracingAccelerationStructureInputs(pParams->pDesc, geometryDescs, &desc))
+    if (!ConvertBuildRaytracingAccelerationStructureInputs(pParams->pDesc, &desc))
         return InvalidArgument(n);
 
     pDevice->GetRaytracingAccelerationStructurePrebuildInfo(&desc, pParams->pInfo);
@@ -831,7 +926,6 @@ NVAPI_FUNCTION NvAPI_D3D12_BuildRaytracingAccelerationStructureEx(ID3D12Graphics
     if (!pParams->pDesc || (pParams->numPostbuildInfoDescs != 0 && !pParams->pPostbuildInfoDescs))
         return InvalidArgument(n);
 
-    std::vector<D3D12_RAYTRACING_GEOMETRY_DESC> geometryDescs{};
     D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_DESC desc = {
         .DestAccelerationStructureData = pParams->pDesc->destAccelerationStructureData,
         .Inputs = {},
@@ -839,7 +933,7 @@ NVAPI_FUNCTION NvAPI_D3D12_BuildRaytracingAccelerationStructureEx(ID3D12Graphics
         .ScratchAccelerationStructureData = pParams->pDesc->scratchAccelerationStructureData,
     };
 
-    if (!ConvertBuildRaytracingAccelerationStructureInputs(&pParams->pDesc->inputs, geometryDescs, &desc.Inputs))
+    if (!ConvertBuildRaytracingAccelerationStructureInputs(&pParams->pDesc->inputs, &desc.Inputs))
         return InvalidArgument(n);
 
     pCommandList->BuildRaytracingAccelerationStructure(&desc, pParams->numPostbuildInfoDescs, pParams->pPostbuildInfoDescs);
@@ -847,6 +941,26 @@ NVAPI_FUNCTION NvAPI_D3D12_BuildRaytracingAccelerationStructureEx(ID3D12Graphics
     return Ok(n, alreadyLoggedOk);
 }
 
+NVAPI_FUNCTION NvAPI_D3D12_SetCreatePipelineStateOptions(ID3D12Device5* pDevice, const NVAPI_D3D12_SET_CREATE_PIPELINE_STATE_OPTIONS_PARAMS* pState) {
+    constexpr auto n = __func__;
+    thread_local bool alreadyLoggedOk = false;
+
+    if (log::tracing())
+        log::trace(n, log::fmt::ptr(pDevice), log::fmt::ptr(pState));
+
+    if (!pDevice || !pState)
+        return InvalidArgument(n);
+
+    if (pState->version != NVAPI_D3D12_SET_CREATE_PIPELINE_STATE_OPTIONS_PARAMS_VER1)
+        return IncompatibleStructVersion(n, pState->version);
+
+    // GetRaytracingCaps reports no OMM, DMM or LSS caps, so only the default options are valid
+    if (pState->flags != 0)
+        return NotSupported(str::format(n, " (flags: ", pState->flags, ")"));
+
+    return Ok(n, alreadyLoggedOk);
+}
+
 NVAPI_FUNCTION NvAPI_D3D12_NotifyOutOfBandCommandQueue(ID3D12CommandQueue* pCommandQueue, NV_OUT_OF_BAND_CQ_TYPE cqType) {
     constexpr auto n = __func__;
     thread_local bool alreadyLoggedOk = false;
@@ -917,8 +1031,7 @@ NVAPI_FUNCTION NvAPI_D3D12_SetAsyncFrameMarker(ID3D12CommandQueue* pCommandQueue
     if (!lowLatencyDevice || !lowLatencyDevice->SupportsLowLatency())
         return NoImplementation(n, alreadyLoggedNoImplementation);
 
-    auto markerType = NvapiD3dLowLatencyDevice::ToMarkerType(pSetAsyncFrameMarkerParams->markerType);
-    if (!markerType.has_value()) {
+    if (!NvapiD3dLowLatencyDevice::ToMarkerType(pSetAsyncFrameMarkerParams->markerType).has_value()) {
         // Silently drop unsupported marker types
         if (!std::exchange(alreadyLoggedMarkerTypeNotSupported, true))
             log::info(str::format("Not supported NV_LATENCY_MARKER_TYPE: ", pSetAsyncFrameMarkerParams->markerType));
@@ -926,7 +1039,7 @@ NVAPI_FUNCTION NvAPI_D3D12_SetAsyncFrameMarker(ID3D12CommandQueue* pCommandQueue
         return Ok(n, alreadyLoggedOk);
     }
 
-    switch (lowLatencyDevice->SetLatencyMarker(pSetAsyncFrameMarkerParams->frameID, markerType.value())) {
+    switch (lowLatencyDevice->SetLatencyMarker(pSetAsyncFrameMarkerParams->frameID, pSetAsyncFrameMarkerParams->markerType)) {
         case S_OK:
             return Ok(n, alreadyLoggedOk);
         case E_NOTIMPL:
@@ -1,16 +1,129 @@
 #include "nvapi_private.h"
+#include "nvapi_globals.h"
 #include "NvApiDriverSettings.c"
 #include "util/util_drs.h"
 #include "util/util_env.h"
 #include "util/util_statuscode.h"
 #include "util/util_string.h"
 
-static auto drs = 1U;
-static auto nvapiDrsSession = reinterpret_cast<NvDRSSessionHandle>(&drs);
-static auto nvapiDrsProfile = reinterpret_cast<NvDRSProfileHandle>(&drs);
-
 using namespace dxvk;
 
+inline static const _SettingDWORDNameString* GetDwordSetting(NvU32 settingId) {
+    static const auto dwordSettings = [] {
+        std::unordered_map<NvU32, const _SettingDWORDNameString*> settings;
+        for (const auto& setting : mapSettingDWORD)
+            settings.emplace(setting.settingId, &setting);
+
+        return settings;
+    }();
+
+    auto it = dwordSettings.find(settingId);
+    return it != dwordSettings.end() ? it->second : nullptr;
+}
+
+inline static std::string GetSettingName(NvU32 settingId) {
+    auto itD = GetDwordSetting(settingId);
+    if (itD)
+        return str::fromws(itD->settingNameString);
+
+    auto itW = std::find_if(
+        std::begin(mapSettingWSTRING),
+        std::end(mapSettingWSTRING),
+        [&settingId](const auto& item) { return item.settingId == settingId; });
+    if (itW != std::end(mapSettingWSTRING))
+        return str::fromws(itW->settingNameString);
+
+    return {"Unknown"};
+}
+
+// Known DWORD settings carry their name and driver default, just like settings read from the driver
+inline static void FillDwordSetting(NVDRS_SETTING* setting, NvU32 value) {
+    setting->settingType = NVDRS_DWORD_TYPE;
+    setting->isCurrentPredefined = 0;
+    setting->isPredefinedValid = 1;
+    setting->u32CurrentValue = value;
+
+    auto itD = GetDwordSetting(setting->settingId);
+    if (itD) {
+        std::memcpy(setting->settingName, itD->settingNameString, sizeof(setting->settingName));
+        setting->u32PredefinedValue = itD->defaultValue;
+    } else {
+        std::memset(setting->settingName, 0, sizeof(setting->settingName));
+        setting->u32PredefinedValue = 0;
+    }
+}
+
+inline static std::vector<NVDRS_SETTING> GetEnvironmentSettings() {
+    static const auto nvapiDrsSettingsEnvName = "DXVK_NVAPI_DRS_SETTINGS";
+    static const auto nvapiDrsSettingsEnvPrefix = "DXVK_NVAPI_DRS_";
+
+    auto nvapiDrsDwords = drs::enrichwithenv(drs::parsedrsdwordsettings(env::getEnvVariable(nvapiDrsSettingsEnvName)), nvapiDrsSettingsEnvPrefix);
+    if (nvapiDrsDwords.empty())
+        return {};
+
+    log::info(str::format("Applying the following DRS settings when requested by the application (", nvapiDrsDwords.size(), " total):"));
+
+    std::vector<NVDRS_SETTING> settings(nvapiDrsDwords.size());
+    auto setting = settings.begin();
+    for (auto& [key, value] : nvapiDrsDwords) {
+        log::info(str::format("    0x", std::hex, key, "/", GetSettingName(key), " = 0x", std::hex, value));
+
+        setting->version = NVDRS_SETTING_VER1;
+        setting->settingId = key;
+        setting->settingLocation = NVDRS_CURRENT_PROFILE_LOCATION;
+        FillDwordSetting(&*setting++, value);
+    }
+
+    return settings;
+}
+
+static std::mutex nvapiDrsDatabaseMutex;
+
+inline static NvapiDrsDatabase& GetDrsDatabase() {
+    std::scoped_lock lock{nvapiDrsDatabaseMutex};
+    if (!nvapiDrsDatabase)
+        nvapiDrsDatabase = std::make_unique<NvapiDrsDatabase>(GetEnvironmentSettings(), env::getExecutableName());
+
+    return *nvapiDrsDatabase;
+}
+
+inline static NvAPI_Status DrsStatus(const std::string& logMessage, NvAPI_Status status) {
+    switch (status) {
+        case NVAPI_OK:
+            return Ok(logMessage);
+        case NVAPI_INVALID_ARGUMENT:
+            return InvalidArgument(logMessage);
+        case NVAPI_INVALID_HANDLE:
+            return InvalidHandle(logMessage);
+        case NVAPI_END_ENUMERATION:
+            return EndEnumeration(logMessage);
+        case NVAPI_PROFILE_NOT_FOUND:
+            return ProfileNotFound(logMessage);
+        case NVAPI_PROFILE_NAME_IN_USE:
+            return ProfileNameInUse(logMessage);
+        case NVAPI_EXECUTABLE_NOT_FOUND:
+            return ExecutableNotFound(logMessage);
+        case NVAPI_EXECUTABLE_ALREADY_IN_USE:
+            return ExecutableAlreadyInUse(logMessage);
+        case NVAPI_SETTING_NOT_FOUND:
+            return SettingNotFound(logMessage);
+        default:
+            return Error(logMessage);
+    }
+}
+
+inline static bool IsKnownApplicationVersion(NvU32 version) {
+    switch (version) {
+        case NVDRS_APPLICATION_VER_V1:
+        case NVDRS_APPLICATION_VER_V2:
+        case NVDRS_APPLICATION_VER_V3:
+        case NVDRS_APPLICATION_VER_V4:
+            return true;
+        default:
+            return false;
+    }
+}
+
 NVAPI_FUNCTION NvAPI_DRS_CreateSession(NvDRSSessionHandle* phSession) {
     constexpr auto n = __func__;
 
@@ -20,7 +133,7 @@ NVAPI_FUNCTION NvAPI_DRS_CreateSession(NvDRSSessionHandle* phSession) {
     if (!phSession)
         return InvalidArgument(n);
 
-    *phSession = nvapiDrsSession;
+    *phSession = GetDrsDatabase().CreateSession();
 
     return Ok(n);
 }
@@ -31,6 +144,9 @@ NVAPI_FUNCTION NvAPI_DRS_LoadSettings(NvDRSSessionHandle hSession) {
     if (log::tracing())
         log::trace(n, log::fmt::hnd(hSession));
 
+    if (!GetDrsDatabase().IsValidSession(hSession))
+        return InvalidHandle(n);
+
     return Ok(n);
 }
 
@@ -40,7 +156,11 @@ NVAPI_FUNCTION NvAPI_DRS_SaveSettings(NvDRSSessionHandle hSession) {
     if (log::tracing())
         log::trace(n, log::fmt::hnd(hSession));
 
-    return NotSupported(n);
+    // All sessions share the same in-memory settings, changes are visible as soon as they are made
+    if (!GetDrsDatabase().IsValidSession(hSession))
+        return InvalidHandle(n);
+
+    return Ok(n);
 }
 
 NVAPI_FUNCTION NvAPI_DRS_SetSetting(NvDRSSessionHandle hSession, NvDRSProfileHandle hProfile, NVDRS_SETTING* pSetting) {
@@ -49,7 +169,30 @@ NVAPI_FUNCTION NvAPI_DRS_SetSetting(NvDRSSessionHandle hSession, NvDRSProfileHan
     if (log::tracing())
         log::trace(n, log::fmt::hnd(hSession), log::fmt::hnd(hProfile), log::fmt::ptr(pSetting));
 
-    return NotSupported(n);
+    if (!pSetting)
+        return InvalidArgument(n);
+
+    if (pSetting->version != NVDRS_SETTING_VER1)
+        return IncompatibleStructVersion(n, pSetting->version);
+
+    auto id = str::format("0x", std::hex, pSetting->settingId);
+    if (pSetting->settingType != NVDRS_DWORD_TYPE)
+        return DrsStatus(str::format(n, " (", id, "/", GetSettingName(pSetting->settingId), ")"), GetDrsDatabase().SetSetting(hSession, hProfile, pSetting));
+
+    auto setting = *pSetting;
+    FillDwordSetting(&setting, pSetting->u32CurrentValue);
+
+    return DrsStatus(str::format(n, " (", id, "/", GetSettingName(pSetting->settingId), " = 0x", std::hex, pSetting->u32CurrentValue, ")"), GetDrsDatabase().SetSetting(hSession, hProfile, &setting));
+}
+
+NVAPI_FUNCTION NvAPI_DRS_DeleteProfileSetting(NvDRSSessionHandle hSession, NvDRSProfileHandle hProfile, NvU32 settingId) {
+    constexpr auto n = __func__;
+
+    if (log::tracing())
+        log::trace(n, log::fmt::hnd(hSession), log::fmt::hnd(hProfile), settingId);
+
+    auto id = str::format("0x", std::hex, settingId);
+    return DrsStatus(str::format(n, " (", id, "/", GetSettingName(settingId), ")"), GetDrsDatabase().DeleteProfileSetting(hSession, hProfile, settingId));
 }
 
 NVAPI_FUNCTION NvAPI_DRS_FindProfileByName(NvDRSSessionHandle hSession, NvAPI_UnicodeString profileName, NvDRSProfileHandle* phProfile) {
@@ -58,12 +201,10 @@ NVAPI_FUNCTION NvAPI_DRS_FindProfileByName(NvDRSSessionHandle hSession, NvAPI_Un
     if (log::tracing())
         log::trace(n, log::fmt::hnd(hSession), log::fmt::ptr(profileName), log::fmt::ptr(phProfile));
 
-    if (!phProfile)
+    if (!profileName || !phProfile)
         return InvalidArgument(n);
 
-    *phProfile = nvapiDrsProfile;
-
-    return Ok(n);
+    return DrsStatus(n, GetDrsDatabase().FindProfileByName(hSession, profileName, phProfile));
 }
 
 NVAPI_FUNCTION NvAPI_DRS_FindApplicationByName(NvDRSSessionHandle hSession, NvAPI_UnicodeString appName, NvDRSProfileHandle* phProfile, NVDRS_APPLICATION* pApplication) {
@@ -72,35 +213,13 @@ NVAPI_FUNCTION NvAPI_DRS_FindApplicationByName(NvDRSSessionHandle hSession, NvAP
     if (log::tracing())
         log::trace(n, log::fmt::hnd(hSession), log::fmt::ptr(appName), log::fmt::ptr(phProfile), log::fmt::ptr(pApplication));
 
-    if (!phProfile || !pApplication)
+    if (!appName || !phProfile || !pApplication)
         return InvalidArgument(n);
 
-    switch (pApplication->version) {
-        case NVDRS_APPLICATION_VER_V4:
-            std::memset(pApplication->commandLine, 0, sizeof(pApplication->commandLine));
-            [[fallthrough]];
-        case NVDRS_APPLICATION_VER_V3:
-            pApplication->isCommandLine = 0;
-            pApplication->isMetro = 0;
-            [[fallthrough]];
-        case NVDRS_APPLICATION_VER_V2:
-            std::memset(pApplication->fileInFolder, 0, sizeof(pApplication->fileInFolder));
-            [[fallthrough]];
-        case NVDRS_APPLICATION_VER_V1:
-            std::memset(pApplication->launcher, 0, sizeof(pApplication->launcher));
-            std::memset(pApplication->userFriendlyName, 0, sizeof(pApplication->userFriendlyName));
-            std::memset(pApplication->appName, 0, sizeof(pApplication->appName));
-            str::copynvus(pApplication->userFriendlyName, appName);
-            str::copynvus(pApplication->appName, appName);
-            pApplication->isPredefined = 0;
-            break;
-        default:
-            return IncompatibleStructVersion(n, pApplication->version);
-    }
-
-    *phProfile = nvapiDrsProfile;
+    if (!IsKnownApplicationVersion(pApplication->version))
+        return IncompatibleStructVersion(n, pApplication->version);
 
-    return Ok(n);
+    return DrsStatus(n, GetDrsDatabase().FindApplicationByName(hSession, appName, phProfile, pApplication));
 }
 
 NVAPI_FUNCTION NvAPI_DRS_GetBaseProfile(NvDRSSessionHandle hSession, NvDRSProfileHandle* phProfile) {
@@ -112,9 +231,7 @@ NVAPI_FUNCTION NvAPI_DRS_GetBaseProfile(NvDRSSessionHandle hSession, NvDRSProfil
     if (!phProfile)
         return InvalidArgument(n);
 
-    *phProfile = nvapiDrsProfile;
-
-    return Ok(n);
+    return DrsStatus(n, GetDrsDatabase().GetBaseProfile(hSession, phProfile));
 }
 
 NVAPI_FUNCTION NvAPI_DRS_GetCurrentGlobalProfile(NvDRSSessionHandle hSession, NvDRSProfileHandle* phProfile) {
@@ -126,73 +243,64 @@ NVAPI_FUNCTION NvAPI_DRS_GetCurrentGlobalProfile(NvDRSSessionHandle hSession, Nv
     if (!phProfile)
         return InvalidArgument(n);
 
-    *phProfile = nvapiDrsProfile;
-
-    return Ok(n);
+    // There is no way to select another global profile, so it is always the base profile
+    return DrsStatus(n, GetDrsDatabase().GetBaseProfile(hSession, phProfile));
 }
 
-NVAPI_FUNCTION NvAPI_DRS_CreateProfile(NvDRSSessionHandle hSession, NVDRS_PROFILE* pProfileInfo, NvDRSProfileHandle* phProfile) {
+NVAPI_FUNCTION NvAPI_DRS_GetNumProfiles(NvDRSSessionHandle hSession, NvU32* numProfiles) {
     constexpr auto n = __func__;
 
     if (log::tracing())
-        log::trace(n, log::fmt::hnd(hSession), log::fmt::ptr(pProfileInfo), log::fmt::ptr(phProfile));
+        log::trace(n, log::fmt::hnd(hSession), log::fmt::ptr(numProfiles));
+
+    if (!numProfiles)
+        return InvalidArgument(n);
 
-    return NotSupported(n);
+    return DrsStatus(n, GetDrsDatabase().GetNumProfiles(hSession, numProfiles));
 }
 
-NVAPI_FUNCTION NvAPI_DRS_DeleteProfile(NvDRSSessionHandle hSession, NvDRSProfileHandle hProfile) {
+NVAPI_FUNCTION NvAPI_DRS_EnumProfiles(NvDRSSessionHandle hSession, NvU32 index, NvDRSProfileHandle* phProfile) {
     constexpr auto n = __func__;
 
     if (log::tracing())
-        log::trace(n, log::fmt::hnd(hSession));
+        log::trace(n, log::fmt::hnd(hSession), index, log::fmt::ptr(phProfile));
 
-    return NotSupported(n);
+    if (!phProfile)
+        return InvalidArgument(n);
+
+    return DrsStatus(n, GetDrsDatabase().EnumProfiles(hSession, index, phProfile));
 }
 
-inline static _SettingDWORDNameString* GetDwordSetting(NvU32 settingId) {
-    auto it = std::find_if(
-        std::begin(mapSettingDWORD),
-        std::end(mapSettingDWORD),
-        [&settingId](const auto& item) { return item.settingId == settingId; });
+NVAPI_FUNCTION NvAPI_DRS_CreateProfile(NvDRSSessionHandle hSession, NVDRS_PROFILE* pProfileInfo, NvDRSProfileHandle* phProfile) {
+    constexpr auto n = __func__;
+
+    if (log::tracing())
+        log::trace(n, log::fmt::hnd(hSession), log::fmt::ptr(pProfileInfo), log::fmt::ptr(phProfile));
+
+    if (!pProfileInfo || !phProfile)
+        return InvalidArgument(n);
+
+    if (pProfileInfo->version != NVDRS_PROFILE_VER1)
+        return IncompatibleStructVersion(n, pProfileInfo->version);
 
-    return it != std::end(mapSettingDWORD) ? it : nullptr;
+    return DrsStatus(str::format(n, " (", str::fromws(reinterpret_cast<const WCHAR*>(pProfileInfo->profileName)), ")"), GetDrsDatabase().CreateProfile(hSession, pProfileInfo, phProfile));
 }
 
-inline static std::string GetSettingName(NvU32 settingId) {
-    auto itD = GetDwordSetting(settingId);
-    if (itD)
-        return str::fromws(itD->settingNameString);
+NVAPI_FUNCTION NvAPI_DRS_DeleteProfile(NvDRSSessionHandle hSession, NvDRSProfileHandle hProfile) {
+    constexpr auto n = __func__;
 
-    auto itW = std::find_if(
-        std::begin(mapSettingWSTRING),
-        std::end(mapSettingWSTRING),
-        [&settingId](const auto& item) { return item.settingId == settingId; });
-    if (itW != std::end(mapSettingWSTRING))
-        return str::fromws(itW->settingNameString);
+    if (log::tracing())
+        log::trace(n, log::fmt::hnd(hSession), log::fmt::hnd(hProfile));
 
-    return {"Unknown"};
+    return DrsStatus(n, GetDrsDatabase().DeleteProfile(hSession, hProfile));
 }
 
 NVAPI_FUNCTION NvAPI_DRS_GetSetting(NvDRSSessionHandle hSession, NvDRSProfileHandle hProfile, NvU32 settingId, NVDRS_SETTING* pSetting) {
     constexpr auto n = __func__;
-    static const auto nvapiDrsSettingsEnvName = "DXVK_NVAPI_DRS_SETTINGS";
-    static const auto nvapiDrsSettingsEnvPrefix = "DXVK_NVAPI_DRS_";
-    static const auto nvapiDrsSettingsString = dxvk::env::getEnvVariable(nvapiDrsSettingsEnvName);
-    static const auto nvapiDrsDwords = dxvk::drs::enrichwithenv(dxvk::drs::parsedrsdwordsettings(nvapiDrsSettingsString), nvapiDrsSettingsEnvPrefix);
 
     if (log::tracing())
         log::trace(n, log::fmt::hnd(hSession), log::fmt::hnd(hProfile), settingId, log::fmt::ptr(pSetting));
 
-    static std::once_flag once;
-    std::call_once(once, []() {
-        if (nvapiDrsDwords.empty())
-            return;
-
-        log::info(str::format("Applying the following DRS settings when requested by the application (", nvapiDrsDwords.size(), " total):"));
-        for (auto& [key, value] : nvapiDrsDwords)
-            log::info(str::format("    0x", std::hex, key, "/", GetSettingName(key), " = 0x", std::hex, value));
-    });
-
     if (!pSetting)
         return InvalidArgument(n);
 
@@ -200,30 +308,11 @@ NVAPI_FUNCTION NvAPI_DRS_GetSetting(NvDRSSessionHandle hSession, NvDRSProfileHan
         return IncompatibleStructVersion(n, pSetting->version);
 
     auto id = str::format("0x", std::hex, settingId);
+    auto status = GetDrsDatabase().GetSetting(hSession, hProfile, settingId, pSetting);
+    if (status == NVAPI_OK && pSetting->settingType == NVDRS_DWORD_TYPE)
+        return Ok(str::format(n, " (", id, "/", GetSettingName(settingId), " = 0x", std::hex, pSetting->u32CurrentValue, ")"));
 
-    if (auto it = nvapiDrsDwords.find(settingId); it != nvapiDrsDwords.end()) {
-        auto value = it->second;
-        pSetting->settingId = settingId;
-        pSetting->settingType = NVDRS_DWORD_TYPE;
-        pSetting->settingLocation = NVDRS_CURRENT_PROFILE_LOCATION;
-        pSetting->isCurrentPredefined = 0;
-        pSetting->isPredefinedValid = 1;
-        pSetting->u32CurrentValue = value;
-
-        auto itD = GetDwordSetting(settingId);
-        if (itD) {
-            std::memcpy(pSetting->settingName, itD->settingNameString, sizeof(pSetting->settingName));
-            pSetting->u32PredefinedValue = itD->defaultValue;
-        } else {
-            std::memset(pSetting->settingName, 0, sizeof(pSetting->settingName));
-            pSetting->u32PredefinedValue = 0;
-        }
-
-        auto name = itD ? str::fromws(itD->settingNameString) : "Unknown";
-        return Ok(str::format(n, " (", id, "/", name, " = 0x", std::hex, value, ")"));
-    }
-
-    return SettingNotFound(str::format(n, " (", id, "/", GetSettingName(settingId), ")"));
+    return DrsStatus(str::format(n, " (", id, "/", GetSettingName(settingId), ")"), status);
 }
 
 NVAPI_FUNCTION NvAPI_DRS_GetProfileInfo(NvDRSSessionHandle hSession, NvDRSProfileHandle hProfile, NVDRS_PROFILE* pProfileInfo) {
@@ -238,13 +327,7 @@ NVAPI_FUNCTION NvAPI_DRS_GetProfileInfo(NvDRSSessionHandle hSession, NvDRSProfil
     if (pProfileInfo->version != NVDRS_PROFILE_VER1)
         return IncompatibleStructVersion(n, pProfileInfo->version);
 
-    std::memset(pProfileInfo->profileName, 0, sizeof(pProfileInfo->profileName));
-    pProfileInfo->gpuSupport = {};
-    pProfileInfo->isPredefined = 0;
-    pProfileInfo->numOfApps = 0;
-    pProfileInfo->numOfSettings = 0;
-
-    return Ok(n);
+    return DrsStatus(n, GetDrsDatabase().GetProfileInfo(hSession, hProfile, pProfileInfo));
 }
 
 NVAPI_FUNCTION NvAPI_DRS_CreateApplication(NvDRSSessionHandle hSession, NvDRSProfileHandle hProfile, NVDRS_APPLICATION* pApplication) {
@@ -253,7 +336,42 @@ NVAPI_FUNCTION NvAPI_DRS_CreateApplication(NvDRSSessionHandle hSession, NvDRSPro
     if (log::tracing())
         log::trace(n, log::fmt::hnd(hSession), log::fmt::hnd(hProfile), log::fmt::ptr(pApplication));
 
-    return NotSupported(n);
+    if (!pApplication)
+        return InvalidArgument(n);
+
+    if (!IsKnownApplicationVersion(pApplication->version))
+        return IncompatibleStructVersion(n, pApplication->version);
+
+    return DrsStatus(str::format(n, " (", str::fromws(reinterpret_cast<const WCHAR*>(pApplication->appName)), ")"), GetDrsDatabase().CreateApplication(hSession, hProfile, pApplication));
+}
+
+NVAPI_FUNCTION NvAPI_DRS_DeleteApplication(NvDRSSessionHandle hSession, NvDRSProfileHandle hProfile, NvAPI_UnicodeString appName) {
+    constexpr auto n = __func__;
+
+    if (log::tracing())
+        log::trace(n, log::fmt::hnd(hSession), log::fmt::hnd(hProfile), log::fmt::ptr(appName));
+
+    if (!appName)
+        return InvalidArgument(n);
+
+    return DrsStatus(n, GetDrsDatabase().DeleteApplication(hSession, hProfile, appName));
+}
+
+NVAPI_FUNCTION NvAPI_DRS_EnumApplications(NvDRSSessionHandle hSession, NvDRSProfileHandle hProfile, NvU32 startIndex, NvU32* appCount, NVDRS_APPLICATION* pApplication) {
+    constexpr auto n = __func__;
+
+    if (log::tracing())
+        log::trace(n, log::fmt::hnd(hSession), log::fmt::hnd(hProfile), startIndex, log::fmt::ptr(appCount), log::fmt::ptr(pApplication));
+
+    if (!appCount || (*appCount != 0 && !pApplication))
+        return InvalidArgument(n);
+
+    for (auto i = 0U; i < *appCount; i++) {
+        if (!IsKnownApplicationVersion(pApplication[i].version))
+            return IncompatibleStructVersion(n, pApplication[i].version);
+    }
+
+    return DrsStatus(n, GetDrsDatabase().EnumApplications(hSession, hProfile, startIndex, appCount, pApplication));
 }
 
 NVAPI_FUNCTION NvAPI_DRS_DestroySession(NvDRSSessionHandle hSession) {
@@ -262,5 +380,8 @@ NVAPI_FUNCTION NvAPI_DRS_DestroySession(NvDRSSessionHandle hSession) {
     if (log::tracing())
         log::trace(n, log::fmt::hnd(hSession));
 
+    if (!GetDrsDatabase().DestroySession(hSession))
+        return InvalidHandle(n);
+
     return Ok(n);
 }
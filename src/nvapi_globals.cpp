@@ -3,3 +3,4 @@
 uint64_t initializationCount = 0ULL;
 std::unique_ptr<dxvk::NvapiResourceFactory> resourceFactory;
 std::unique_ptr<dxvk::NvapiAdapterRegistry> nvapiAdapterRegistry;
+std::unique_ptr<dxvk::NvapiDrsDatabase> nvapiDrsDatabase;
@@ -3,7 +3,9 @@
 #include "nvapi_private.h"
 #include "nvapi/nvapi_resource_factory.h"
 #include "nvapi/nvapi_adapter_registry.h"
+#include "nvapi/nvapi_drs_database.h"
 
 extern uint64_t initializationCount;
 extern std::unique_ptr<dxvk::NvapiResourceFactory> resourceFactory;
 extern std::unique_ptr<dxvk::NvapiAdapterRegistry> nvapiAdapterRegistry;
+extern std::unique_ptr<dxvk::NvapiDrsDatabase> nvapiDrsDatabase;
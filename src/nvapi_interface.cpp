@@ -124,6 +124,7 @@ NVAPI_QUERY_INTERFACE nvapi_QueryInterface(NvU32 id) {
     INSERT_AND_RETURN_WHEN_EQUALS(NvAPI_D3D12_GetRaytracingCaps)
     INSERT_AND_RETURN_WHEN_EQUALS(NvAPI_D3D12_GetRaytracingAccelerationStructurePrebuildInfoEx)
     INSERT_AND_RETURN_WHEN_EQUALS(NvAPI_D3D12_BuildRaytracingAccelerationStructureEx)
+    INSERT_AND_RETURN_WHEN_EQUALS(NvAPI_D3D12_SetCreatePipelineStateOptions)
     INSERT_AND_RETURN_WHEN_EQUALS(NvAPI_D3D12_NotifyOutOfBandCommandQueue)
     INSERT_AND_RETURN_WHEN_EQUALS(NvAPI_D3D12_SetAsyncFrameMarker)
     INSERT_AND_RETURN_WHEN_EQUALS(NvAPI_D3D_RegisterDevice)
@@ -186,6 +187,11 @@ NVAPI_QUERY_INTERFACE nvapi_QueryInterface(NvU32 id) {
     INSERT_AND_RETURN_WHEN_EQUALS(NvAPI_DRS_SetSetting)
     INSERT_AND_RETURN_WHEN_EQUALS(NvAPI_DRS_GetProfileInfo)
     INSERT_AND_RETURN_WHEN_EQUALS(NvAPI_DRS_CreateApplication)
+    INSERT_AND_RETURN_WHEN_EQUALS(NvAPI_DRS_DeleteApplication)
+    INSERT_AND_RETURN_WHEN_EQUALS(NvAPI_DRS_EnumApplications)
+    INSERT_AND_RETURN_WHEN_EQUALS(NvAPI_DRS_GetNumProfiles)
+    INSERT_AND_RETURN_WHEN_EQUALS(NvAPI_DRS_EnumProfiles)
+    INSERT_AND_RETURN_WHEN_EQUALS(NvAPI_DRS_DeleteProfileSetting)
     INSERT_AND_RETURN_WHEN_EQUALS(NvAPI_DRS_DestroySession)
     INSERT_AND_RETURN_WHEN_EQUALS(NvAPI_DRS_CreateSession)
     INSERT_AND_RETURN_WHEN_EQUALS(NvAPI_Disp_GetHdrCapabilities)
@@ -5,6 +5,7 @@
 #include <cassert>
 #include <cctype>
 #include <charconv>
+#include <chrono>
 #if __cpp_concepts >= 201907L
 #include <concepts>
 #endif
@@ -24,6 +25,7 @@
 #include <optional>
 #include <regex>
 #include <set>
+#include <span>
 #include <sstream>
 #include <string_view>
 #include <string>
@@ -0,0 +1,207 @@
+#include "nvofapi_d3d11_instance.h"
+#include "../util/util_log.h"
+#include "../util/util_string.h"
+
+namespace dxvk {
+
+    NvOFInstanceD3D11::NvOFInstanceD3D11(ResourceFactory& resourceFactory, ID3D11Device* pD3D11Device)
+        : NvOFInstanceVk(resourceFactory, VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE) {
+        // Grab the vk triad from DXVK
+        if (FAILED(pD3D11Device->QueryInterface(IID_PPV_ARGS(&m_device))))
+            throw std::invalid_argument("Failed to query interface for m_device");
+
+        m_device->GetVulkanHandles(&m_vkInstance,
+            &m_vkPhysicalDevice,
+            &m_vkDevice);
+    }
+
+    NvOFInstanceD3D11::~NvOFInstanceD3D11() {
+        if (!m_syncTimeline || !m_vkDestroySemaphore)
+            return;
+
+        // DXVK's queue may still wait for the semaphore, signal it behind those waits and wait for that before destroying it
+        if (m_syncValue) {
+            m_device->LockSubmissionQueue();
+            auto submitted = SubmitToD3D11Queue(false, ++m_syncValue);
+            m_device->ReleaseSubmissionQueue();
+
+            if (submitted) {
+                VkSemaphoreWaitInfo waitInfo{};
+                waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+                waitInfo.semaphoreCount = 1;
+                waitInfo.pSemaphores = &m_syncTimeline;
+                waitInfo.pValues = &m_syncValue;
+
+                m_vkWaitSemaphores(m_vkDevice, &waitInfo, UINT64_MAX);
+            }
+        }
+
+        m_vkDestroySemaphore(m_vkDevice, m_syncTimeline, nullptr);
+    }
+
+    bool NvOFInstanceD3D11::Initialize() {
+        if (!NvOFInstanceVk::Initialize())
+            return false;
+
+        if (NvOFDiagnostics::IsEnabled())
+            m_diagnostics = std::make_unique<NvOFDiagnostics>("D3D11");
+
+        m_device->GetSubmissionQueue(&m_d3d11Queue, &m_d3d11QueueFamilyIndex);
+
+        VkSemaphoreTypeCreateInfo semaphoreTypeInfo{};
+        semaphoreTypeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+        semaphoreTypeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+        semaphoreTypeInfo.initialValue = m_syncValue;
+
+        VkSemaphoreCreateInfo semaphoreInfo{};
+        semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        semaphoreInfo.pNext = &semaphoreTypeInfo;
+
+        if (m_vkCreateSemaphore(m_vkDevice, &semaphoreInfo, nullptr, &m_syncTimeline) != VK_SUCCESS) {
+            log::info("Failed to create timeline semaphore for D3D11 optical flow synchronization");
+            return false;
+        }
+
+        return true;
+    }
+
+    bool NvOFInstanceD3D11::RegisterBuffer(ID3D11Resource* pResource, NvOFGPUBufferHandle* hOFGpuBuffer) {
+        if (m_diagnostics)
+            log::info(str::format("RegisterBuffer D3D11: resource: ", pResource));
+
+        // Resources that are already registered reuse their image, the VkFormat is implied by the resource
+        auto handle = reinterpret_cast<uint64_t>(pResource);
+        auto nvOFImage = m_imageCache->Acquire(handle, VK_FORMAT_UNDEFINED);
+
+        if (!nvOFImage) {
+            Com<IDXGIVkInteropSurface> surface;
+            if (FAILED(pResource->QueryInterface(IID_PPV_ARGS(&surface))))
+                return false;
+
+            // ID3D11Resource -> VK Image / VkFormat pair, the layout is transitioned around each execution
+            VkImage image{};
+            VkImageLayout layout{};
+            VkImageCreateInfo createInfo{};
+            createInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            if (FAILED(surface->GetVulkanImageInfo(&image, &layout, &createInfo)))
+                return false;
+
+            nvOFImage = CreateImage(handle, VK_FORMAT_UNDEFINED, image, createInfo.format);
+            if (!nvOFImage)
+                return false;
+        }
+
+        *hOFGpuBuffer = reinterpret_cast<NvOFGPUBufferHandle>(nvOFImage);
+        return true;
+    }
+
+    bool NvOFInstanceD3D11::SubmitToD3D11Queue(bool wait, uint64_t value) const {
+        VkSemaphoreSubmitInfo semaphoreInfo{};
+        semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+        semaphoreInfo.semaphore = m_syncTimeline;
+        semaphoreInfo.value = value;
+        semaphoreInfo.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+
+        VkSubmitInfo2 submit{};
+        submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+        if (wait) {
+            submit.waitSemaphoreInfoCount = 1;
+            submit.pWaitSemaphoreInfos = &semaphoreInfo;
+        } else {
+            submit.signalSemaphoreInfoCount = 1;
+            submit.pSignalSemaphoreInfos = &semaphoreInfo;
+        }
+
+        return m_vkQueueSubmit2(m_d3d11Queue, 1, &submit, VK_NULL_HANDLE) == VK_SUCCESS;
+    }
+
+    void NvOFInstanceD3D11::TransitionSurfaces(std::span<NvOFImage* const> images, bool toGeneral) const {
+        VkImageSubresourceRange subresources{VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS};
+
+        for (auto nvOFImage : images) {
+            auto resource = reinterpret_cast<ID3D11Resource*>(nvOFImage->Handle());
+
+            Com<IDXGIVkInteropSurface> surface;
+            if (FAILED(resource->QueryInterface(IID_PPV_ARGS(&surface))))
+                continue;
+
+            VkImage image{};
+            VkImageLayout layout{};
+            VkImageCreateInfo createInfo{};
+            createInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            if (FAILED(surface->GetVulkanImageInfo(&image, &layout, &createInfo)) || layout == VK_IMAGE_LAYOUT_GENERAL)
+                continue;
+
+            if (toGeneral)
+                m_device->TransitionSurfaceLayout(surface.ptr(), &subresources, layout, VK_IMAGE_LAYOUT_GENERAL);
+            else
+                m_device->TransitionSurfaceLayout(surface.ptr(), &subresources, VK_IMAGE_LAYOUT_GENERAL, layout);
+        }
+    }
+
+    bool NvOFInstanceD3D11::Execute(const NV_OF_EXECUTE_INPUT_PARAMS* inParams, NV_OF_EXECUTE_OUTPUT_PARAMS* outParams) {
+        // Convert the D3D11 parameters to VK parameters
+        NV_OF_EXECUTE_INPUT_PARAMS_VK vkInputParams{};
+        NV_OF_EXECUTE_OUTPUT_PARAMS_VK vkOutputParams{};
+
+        vkInputParams.inputFrame = inParams->inputFrame;
+        vkInputParams.referenceFrame = inParams->referenceFrame;
+        vkInputParams.externalHints = inParams->externalHints;
+        vkInputParams.disableTemporalHints = inParams->disableTemporalHints;
+        vkInputParams.hPrivData = inParams->hPrivData;
+        vkInputParams.numRois = inParams->numRois;
+        vkInputParams.roiData = inParams->roiData;
+
+        vkOutputParams.outputBuffer = outParams->outputBuffer;
+        vkOutputParams.outputCostBuffer = outParams->outputCostBuffer;
+        vkOutputParams.hPrivData = outParams->hPrivData;
+        vkOutputParams.bwdOutputBuffer = outParams->bwdOutputBuffer;
+        vkOutputParams.bwdOutputCostBuffer = outParams->bwdOutputCostBuffer;
+        vkOutputParams.globalFlowBuffer = outParams->globalFlowBuffer;
+
+        // D3D11 has no explicit synchronization for optical flow, the execution is ordered like any other
+        // command on the immediate context. DXVK's queue signals once all previous D3D11 work is done,
+        // the OFA queue waits for that and signals back, which DXVK's queue waits for before continuing.
+        NV_OF_SYNC_VK waitSync{m_syncTimeline, m_syncValue + 1};
+        NV_OF_SYNC_VK signalSync{m_syncTimeline, m_syncValue + 2};
+
+        vkInputParams.numWaitSyncs = 1;
+        vkInputParams.pWaitSyncs = &waitSync;
+        vkOutputParams.pSignalSync = &signalSync;
+
+        // The transitions are recorded on the immediate context, so they execute before the signal and after the wait
+        const std::array buffers{inParams->inputFrame, inParams->referenceFrame, inParams->externalHints, outParams->outputBuffer,
+            outParams->outputCostBuffer, outParams->bwdOutputBuffer, outParams->bwdOutputCostBuffer, outParams->globalFlowBuffer};
+        std::array<NvOFImage*, std::tuple_size_v<decltype(buffers)>> imageStorage{};
+        size_t imageCount = 0;
+        for (auto buffer : buffers) {
+            auto nvOFImage = reinterpret_cast<NvOFImage*>(buffer);
+            auto used = std::span(imageStorage.data(), imageCount);
+            if (nvOFImage && std::ranges::find(used, nvOFImage) == used.end())
+                imageStorage[imageCount++] = nvOFImage;
+        }
+
+        auto images = std::span<NvOFImage* const>(imageStorage.data(), imageCount);
+        TransitionSurfaces(images, true);
+
+        m_device->FlushRenderingCommands();
+        m_device->LockSubmissionQueue();
+
+        auto success = SubmitToD3D11Queue(false, waitSync.value);
+        if (success) {
+            m_syncValue = waitSync.value;
+            success = NvOFInstanceVk::Execute(&vkInputParams, &vkOutputParams);
+        }
+
+        if (success) {
+            m_syncValue = signalSync.value;
+            success = SubmitToD3D11Queue(true, signalSync.value);
+        }
+
+        m_device->ReleaseSubmissionQueue();
+
+        TransitionSurfaces(images, false);
+
+        return success;
+    }
+}
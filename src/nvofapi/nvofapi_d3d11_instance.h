@@ -0,0 +1,36 @@
+#pragma once
+
+#include "../nvofapi_private.h"
+#include "../shared/resource_factory.h"
+#include "nvofapi_vk_instance.h"
+#include "../interfaces/dxvk_interfaces.h"
+#include "../util/com_pointer.h"
+
+namespace dxvk {
+    // Runs optical flow on the Vulkan device of DXVK. Work is submitted to the OFA queue
+    // and ordered against the D3D11 context using a timeline semaphore on DXVK's queue.
+    class NvOFInstanceD3D11 final : public NvOFInstanceVk {
+
+      public:
+        NvOFInstanceD3D11(ResourceFactory& resourceFactory, ID3D11Device* pD3D11Device);
+        ~NvOFInstanceD3D11() override;
+
+        bool Initialize();
+        bool Execute(const NV_OF_EXECUTE_INPUT_PARAMS* inParams, NV_OF_EXECUTE_OUTPUT_PARAMS* outParams);
+        bool RegisterBuffer(ID3D11Resource* pResource, NvOFGPUBufferHandle* hOFGpuBuffer);
+
+      private:
+        Com<IDXGIVkInteropDevice> m_device{};
+
+        VkQueue m_d3d11Queue{};
+        uint32_t m_d3d11QueueFamilyIndex{0};
+
+        VkSemaphore m_syncTimeline{};
+        uint64_t m_syncValue{0};
+
+        bool SubmitToD3D11Queue(bool wait, uint64_t value) const;
+
+        // Session bindings use the general layout, DXVK expects its images in their default layout outside of Execute
+        void TransitionSurfaces(std::span<NvOFImage* const> images, bool toGeneral) const;
+    };
+}
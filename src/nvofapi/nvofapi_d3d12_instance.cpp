@@ -22,9 +22,14 @@
  */
 
 #include "nvofapi_d3d12_instance.h"
+#include "nvofapi_image.h"
+#include "../nvapi/nvapi_destruction_notifier.h"
+#include "../util/util_env.h"
 #include "../util/util_log.h"
 
 namespace dxvk {
+    // {296b2197-b3e9-4209-abd6-69aa0df26e79}
+    static constexpr GUID nvofSessionPoolPrivateDataGuid = {0x296b2197, 0xb3e9, 0x4209, {0xab, 0xd6, 0x69, 0xaa, 0x0d, 0xf2, 0x6e, 0x79}};
 
     NvOFInstanceD3D12::NvOFInstanceD3D12(ResourceFactory& resourceFactory, ID3D12Device* pD3D12Device)
         : NvOFInstance(resourceFactory) {
@@ -44,6 +49,42 @@ namespace dxvk {
             throw std::invalid_argument("Failed to query interface for m_deviceExt");
     }
 
+    NvOFInstanceD3D12::~NvOFInstanceD3D12() {
+        if (m_worker.joinable()) {
+            // Everything queued before is still submitted, the caller's fences need to get signaled
+            std::scoped_lock lock{m_producerMutex};
+            m_jobs->Back().type = QueueJob::Type::Stop;
+            m_jobs->Push();
+            m_worker.join();
+        }
+
+        if (m_vkOfaSession)
+            ReleaseSession(WaitIdle());
+    }
+
+    bool NvOFInstanceD3D12::IsAsyncExecuteEnabled() {
+        return env::getEnvVariable("DXVK_NVAPI_OFA_ASYNC_EXECUTE") == "1";
+    }
+
+    bool NvOFInstanceD3D12::WaitIdle() const {
+        if (m_worker.joinable())
+            m_jobs->WaitEmpty();
+
+        if (!m_commandQueue)
+            return true;
+
+        // The queue is owned by this instance, a fresh fence behind everything submitted so far tells when it drained
+        Com<ID3D12Fence> fence;
+        if (FAILED(m_d3ddevice->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence))))
+            return false;
+
+        if (FAILED(m_commandQueue->Signal(fence.ptr(), 1)))
+            return false;
+
+        // Without an event handle this blocks until the fence reached the value
+        return SUCCEEDED(fence->SetEventOnCompletion(1, nullptr));
+    }
+
     bool NvOFInstanceD3D12::Initialize() {
         m_vk = m_resourceFactory.CreateVulkan("winevulkan.dll");
         if (!m_vk || !m_vk->IsAvailable()) {
@@ -60,6 +101,7 @@ namespace dxvk {
 #define VK_GET_INSTANCE_PROC_ADDR(proc) m_##proc = reinterpret_cast<PFN_##proc>(m_vk->GetInstanceProcAddr(m_vkInstance, #proc))
 
         VK_GET_INSTANCE_PROC_ADDR(vkGetPhysicalDeviceQueueFamilyProperties);
+        VK_GET_INSTANCE_PROC_ADDR(vkGetPhysicalDeviceOpticalFlowImageFormatsNV);
 
 #define VK_GET_DEVICE_PROC_ADDR(proc) m_##proc = reinterpret_cast<PFN_##proc>(m_vk->GetDeviceProcAddr(m_vkDevice, #proc))
 
@@ -73,8 +115,24 @@ namespace dxvk {
         VK_GET_DEVICE_PROC_ADDR(vkBindOpticalFlowSessionImageNV);
         VK_GET_DEVICE_PROC_ADDR(vkCmdOpticalFlowExecuteNV);
 
+        if (NvOFDiagnostics::IsEnabled())
+            m_diagnostics = std::make_unique<NvOFDiagnostics>("D3D12");
+
+        m_vkOpticalFlowProperties = GetVkOpticalFlowProperties();
+        m_sessionPool = NvOFSessionPool::Get(m_vkDevice, m_vkDestroyOpticalFlowSessionNV, nullptr);
+
+        // The D3D12 device owns the VkDevice, its private data keeps the pool alive until the device gets destroyed.
+        // vkd3d-proton releases private data before it destroys the VkDevice, so the sessions can still be destroyed then.
+        NvapiDestructionNotifier::Attach(m_d3ddevice.ptr(), nvofSessionPoolPrivateDataGuid, [sessionPool = m_sessionPool] {});
+
         // Get the OFA queue
-        m_vkQueueFamilyIndex = GetVkOFAQueue();
+        auto queueFamilyIndex = GetVkOFAQueue();
+        if (!queueFamilyIndex) {
+            log::info("Initializing NVOFAPI failed: no queue family supports optical flow");
+            return false;
+        }
+
+        m_vkQueueFamilyIndex = *queueFamilyIndex;
 
         D3D12_COMMAND_QUEUE_DESC desc{};
         if (FAILED(m_device->CreateInteropCommandQueue(&desc, m_vkQueueFamilyIndex, &m_commandQueue)))
@@ -87,36 +145,62 @@ namespace dxvk {
             if (FAILED(m_d3ddevice->CreateCommandList1(0, D3D12_COMMAND_LIST_TYPE_DIRECT, static_cast<D3D12_COMMAND_LIST_FLAGS>(0), IID_PPV_ARGS(&m_cmdLists[i]))))
                 return false;
         }
+
+        if (IsAsyncExecuteEnabled()) {
+            m_jobs = std::make_unique<NvOFSpscQueue<QueueJob, maxQueuedJobs>>();
+            m_worker = std::thread([this] { RunWorker(); });
+        }
+
         return true;
     }
 
-    void NvOFInstanceD3D12::RegisterBuffer(const NV_OF_REGISTER_RESOURCE_PARAMS_D3D12* registerParams) {
-        NV_OF_REGISTER_RESOURCE_PARAMS_VK vkParams{};
-        log::info(
-            str::format("RegisterBuffer DX: resource: ",
-                registerParams->resource, " inputFencePoint: ",
-                registerParams->inputFencePoint.fence, " outputFencePoint: ",
-                registerParams->outputFencePoint.fence));
-        // Convert D3D12 params to VK params
-        //
-        // ID3D12Resource -> VK Image / VkFormat pair
-        vkParams.hOFGpuBuffer = registerParams->hOFGpuBuffer;
-        uint64_t offset;
-        m_device->GetVulkanResourceInfo1(registerParams->resource, reinterpret_cast<UINT64*>(&vkParams.image), &offset, &vkParams.format);
+    bool NvOFInstanceD3D12::RegisterBuffer(const NV_OF_REGISTER_RESOURCE_PARAMS_D3D12* registerParams) {
+        if (m_diagnostics)
+            log::info(
+                str::format("RegisterBuffer DX: resource: ",
+                    registerParams->resource, " inputFencePoint: ",
+                    registerParams->inputFencePoint.fence, " outputFencePoint: ",
+                    registerParams->outputFencePoint.fence));
+
+        // Resources that are already registered reuse their image, the VkFormat is implied by the resource
+        auto handle = reinterpret_cast<uint64_t>(registerParams->resource);
+        auto nvOFImage = m_imageCache->Acquire(handle, VK_FORMAT_UNDEFINED);
+
+        if (!nvOFImage) {
+            // ID3D12Resource -> VK Image / VkFormat pair
+            VkImage image{};
+            VkFormat format{};
+            uint64_t offset;
+            m_device->GetVulkanResourceInfo1(registerParams->resource, reinterpret_cast<UINT64*>(&image), &offset, &format);
+
+            nvOFImage = CreateImage(handle, VK_FORMAT_UNDEFINED, image, format);
+            if (!nvOFImage)
+                return false;
+        }
 
         // no inputFencePoint/outputFencePoint equivalents for VK buffer
         // registration, but forward progress is necessary, so wait+signal to
         // keep momentum.
-        if (registerParams->inputFencePoint.fence)
-            m_commandQueue->Wait(registerParams->inputFencePoint.fence, registerParams->inputFencePoint.value);
-
-        if (registerParams->outputFencePoint.fence)
-            m_commandQueue->Signal(registerParams->outputFencePoint.fence, registerParams->outputFencePoint.value);
+        if (m_jobs) {
+            std::scoped_lock lock{m_producerMutex};
+            QueueFences(registerParams->inputFencePoint.fence ? &registerParams->inputFencePoint : nullptr,
+                registerParams->outputFencePoint.fence ? &registerParams->outputFencePoint : nullptr);
+        } else {
+            if (registerParams->inputFencePoint.fence)
+                m_commandQueue->Wait(registerParams->inputFencePoint.fence, registerParams->inputFencePoint.value);
+
+            if (registerParams->outputFencePoint.fence)
+                m_commandQueue->Signal(registerParams->outputFencePoint.fence, registerParams->outputFencePoint.value);
+        }
 
-        NvOFInstance::RegisterBuffer(&vkParams);
+        *registerParams->hOFGpuBuffer = reinterpret_cast<NvOFGPUBufferHandle>(nvOFImage);
+        return true;
     }
 
-    void NvOFInstanceD3D12::Execute(const NV_OF_EXECUTE_INPUT_PARAMS_D3D12* inParams, NV_OF_EXECUTE_OUTPUT_PARAMS_D3D12* outParams) {
+    bool NvOFInstanceD3D12::Execute(const NV_OF_EXECUTE_INPUT_PARAMS_D3D12* inParams, NV_OF_EXECUTE_OUTPUT_PARAMS_D3D12* outParams) {
+        if (inParams->numRois > MAX_ROIS)
+            return false;
+
         // Convert the D3D12 parameters to VK parameters
         NV_OF_EXECUTE_INPUT_PARAMS_VK vkInputParams{};
         NV_OF_EXECUTE_OUTPUT_PARAMS_VK vkOutputParams{};
@@ -136,30 +220,178 @@ namespace dxvk {
         vkOutputParams.bwdOutputCostBuffer = outParams->bwdOutputCostBuffer;
         vkOutputParams.globalFlowBuffer = outParams->globalFlowBuffer;
 
+        if (m_diagnostics)
+            m_diagnostics->Execute(NvOFDiagnostics::GetExecuteParams(&vkInputParams, &vkOutputParams, inParams->numFencePoints, outParams->fencePoint != nullptr));
+
+        // Held until the end of the execution, the fallback below must not overlap with jobs of other threads either
+        std::unique_lock producerLock{m_producerMutex, std::defer_lock};
+
+        if (m_jobs) {
+            producerLock.lock();
+
+            // Private data points to memory of the caller, replay those rare executions on this thread instead
+            if (!inParams->hPrivData) {
+                // The caller only learns about failures that are detected before the job is queued
+                if (ValidateImagesForSession(&vkInputParams, &vkOutputParams) != NV_OF_SUCCESS)
+                    return false;
+
+                return QueueExecute(inParams, outParams, &vkInputParams, &vkOutputParams);
+            }
+
+            m_jobs->WaitEmpty();
+        }
+
+        if (BindImagesToSession(&vkInputParams, &vkOutputParams) != NV_OF_SUCCESS)
+            return false;
+
+        // vkd3d-proton gathers consecutive waits into the next submission, so reduce
+        // the waits to the highest value per fence instead of waiting on each point
+        std::array<NV_OF_FENCE_POINT, MAX_INLINE_WAIT_SYNCS> fenceWaits{};
+        uint32_t fenceWaitCount = 0;
+
+        for (uint32_t i = 0; i < inParams->numFencePoints; i++) {
+            const auto& fencePoint = inParams->fencePoint[i];
+            auto fenceWaitsEnd = fenceWaits.begin() + fenceWaitCount;
+            auto it = std::find_if(fenceWaits.begin(), fenceWaitsEnd, [&fencePoint](const auto& fenceWait) { return fenceWait.fence == fencePoint.fence; });
+
+            if (it != fenceWaitsEnd)
+                it->value = std::max(it->value, fencePoint.value);
+            else if (fenceWaitCount < fenceWaits.size())
+                fenceWaits[fenceWaitCount++] = fencePoint;
+            else
+                m_commandQueue->Wait(fencePoint.fence, fencePoint.value);
+        }
+
+        for (uint32_t i = 0; i < fenceWaitCount; i++)
+            m_commandQueue->Wait(fenceWaits[i].fence, fenceWaits[i].value);
+
+        Submit(&vkInputParams);
+
+        m_commandQueue->Signal(outParams->fencePoint->fence, outParams->fencePoint->value);
+
+        return true;
+    }
+
+    void NvOFInstanceD3D12::Submit(const NV_OF_EXECUTE_INPUT_PARAMS_VK* inParams) {
         // Use vkd3d-proton's interop functionality to grab a VkCommandBuffer
         // that we record our commands into. Work submission and synchronization
         // happens using D3D12.
         m_cmdLists[m_cmdListIndex]->Reset(m_cmdAllocator.ptr(), nullptr);
 
-        for (uint32_t i = 0; i < inParams->numFencePoints; i++) {
-            m_commandQueue->Wait(inParams->fencePoint[i].fence, inParams->fencePoint[i].value);
-        }
-
         VkCommandBuffer vkCmdBuf;
         m_device->BeginVkCommandBufferInterop(m_cmdLists[m_cmdListIndex].ptr(), &vkCmdBuf);
 
-        this->RecordCmdBuf(&vkInputParams, &vkOutputParams, vkCmdBuf);
+        this->RecordCmdBuf(inParams, vkCmdBuf);
 
         m_device->EndVkCommandBufferInterop(m_cmdLists[m_cmdListIndex].ptr());
         m_cmdLists[m_cmdListIndex]->Close();
 
         m_commandQueue->ExecuteCommandLists(1, reinterpret_cast<ID3D12CommandList**>(&m_cmdLists[m_cmdListIndex]));
 
-        m_commandQueue->Signal(outParams->fencePoint->fence, outParams->fencePoint->value);
-
         m_cmdListIndex++;
         if (m_cmdListIndex >= CMDS_IN_FLIGHT)
             m_cmdListIndex = 0;
     }
 
+    // The images that the session binds for an execution
+    static auto ExecuteImages(const NV_OF_EXECUTE_INPUT_PARAMS_VK& inParams, const NV_OF_EXECUTE_OUTPUT_PARAMS_VK& outParams) {
+        return std::array{
+            inParams.inputFrame,
+            inParams.referenceFrame,
+            outParams.outputBuffer,
+            outParams.outputCostBuffer,
+            outParams.bwdOutputBuffer,
+            outParams.bwdOutputCostBuffer,
+            outParams.globalFlowBuffer,
+        };
+    }
+
+    void NvOFInstanceD3D12::QueueFences(const NV_OF_FENCE_POINT* wait, const NV_OF_FENCE_POINT* signal) {
+        if (!wait && !signal)
+            return;
+
+        auto& job = m_jobs->Back();
+        job.type = QueueJob::Type::Fences;
+        job.waits.clear();
+
+        if (wait)
+            job.waits.push_back(FencePoint{wait->fence, wait->value});
+
+        job.signal = signal ? FencePoint{signal->fence, signal->value} : FencePoint{};
+
+        m_jobs->Push();
+    }
+
+    bool NvOFInstanceD3D12::QueueExecute(const NV_OF_EXECUTE_INPUT_PARAMS_D3D12* inParams, NV_OF_EXECUTE_OUTPUT_PARAMS_D3D12* outParams, const NV_OF_EXECUTE_INPUT_PARAMS_VK* vkInputParams, const NV_OF_EXECUTE_OUTPUT_PARAMS_VK* vkOutputParams) {
+        auto& job = m_jobs->Back();
+        job.type = QueueJob::Type::Execute;
+        job.waits.clear();
+
+        // Same reduction as for immediate execution, fences are referenced until the worker waited for them
+        for (uint32_t i = 0; i < inParams->numFencePoints; i++) {
+            const auto& fencePoint = inParams->fencePoint[i];
+            auto it = std::ranges::find_if(job.waits, [&fencePoint](const auto& fenceWait) { return fenceWait.fence == fencePoint.fence; });
+
+            if (it != job.waits.end())
+                it->value = std::max(it->value, fencePoint.value);
+            else
+                job.waits.push_back(FencePoint{fencePoint.fence, fencePoint.value});
+        }
+
+        job.signal = FencePoint{outParams->fencePoint->fence, outParams->fencePoint->value};
+
+        job.inParams = *vkInputParams;
+        job.outParams = *vkOutputParams;
+
+        std::copy_n(vkInputParams->roiData, vkInputParams->numRois, job.rois.begin());
+        job.inParams.roiData = job.rois.data();
+
+        // Registrations may get dropped before the worker binds the images
+        for (auto hBuffer : ExecuteImages(job.inParams, job.outParams)) {
+            if (hBuffer)
+                reinterpret_cast<NvOFImage*>(hBuffer)->AddRef();
+        }
+
+        m_jobs->Push();
+        return true;
+    }
+
+    void NvOFInstanceD3D12::RunWorker() {
+        while (true) {
+            auto& job = m_jobs->Front();
+            if (job.type == QueueJob::Type::Stop) {
+                m_jobs->Pop();
+                return;
+            }
+
+            ProcessJob(job);
+            m_jobs->Pop();
+        }
+    }
+
+    void NvOFInstanceD3D12::ProcessJob(QueueJob& job) {
+        for (const auto& [fence, value] : job.waits)
+            m_commandQueue->Wait(fence.ptr(), value);
+
+        if (job.type == QueueJob::Type::Execute) {
+            // The binds were validated before the job was queued, so only the driver can fail them here. The caller
+            // already got success, so a failed bind is logged and the fence still signaled to not stall the caller.
+            if (BindImagesToSession(&job.inParams, &job.outParams) == NV_OF_SUCCESS)
+                Submit(&job.inParams);
+            else
+                log::info("Asynchronous optical flow execution failed to bind images to the session");
+
+            for (auto hBuffer : ExecuteImages(job.inParams, job.outParams)) {
+                if (hBuffer)
+                    reinterpret_cast<NvOFImage*>(hBuffer)->Release();
+            }
+        }
+
+        if (job.signal.fence != nullptr)
+            m_commandQueue->Signal(job.signal.fence.ptr(), job.signal.value);
+
+        // Drop the fence references now instead of when the slot gets reused
+        job.waits.clear();
+        job.signal = FencePoint{};
+    }
 }
@@ -26,19 +26,24 @@
 #include "../nvofapi_private.h"
 #include "../shared/resource_factory.h"
 #include "nvofapi_instance.h"
+#include "nvofapi_spsc_queue.h"
 #include "../interfaces/vkd3d-proton_interfaces.h"
 #include "../util/com_pointer.h"
 
+#include <thread>
+
 namespace dxvk {
     class NvOFInstanceD3D12 final : public NvOFInstance {
 
       public:
         NvOFInstanceD3D12(ResourceFactory& resourceFactory, ID3D12Device* pD3D12Device);
-        ~NvOFInstanceD3D12() override = default;
+        ~NvOFInstanceD3D12() override;
+
+        [[nodiscard]] static bool IsAsyncExecuteEnabled();
 
         bool Initialize();
-        void Execute(const NV_OF_EXECUTE_INPUT_PARAMS_D3D12* inParams, NV_OF_EXECUTE_OUTPUT_PARAMS_D3D12* outParams);
-        void RegisterBuffer(const NV_OF_REGISTER_RESOURCE_PARAMS_D3D12* registerParams);
+        bool Execute(const NV_OF_EXECUTE_INPUT_PARAMS_D3D12* inParams, NV_OF_EXECUTE_OUTPUT_PARAMS_D3D12* outParams);
+        bool RegisterBuffer(const NV_OF_REGISTER_RESOURCE_PARAMS_D3D12* registerParams);
 
       private:
         Com<ID3D12DXVKInteropDevice1> m_device{};
@@ -50,5 +55,44 @@ namespace dxvk {
         uint32_t m_cmdListIndex{0};
 
         uint32_t m_vkQueueFamilyIndex{0};
+
+        struct FencePoint {
+            Com<ID3D12Fence> fence;
+            uint64_t value;
+        };
+
+        // Work captured on the calling thread and replayed on the worker thread. Slots are reused,
+        // so the vector keeps its capacity and steady state execution does not allocate.
+        struct QueueJob {
+            enum class Type {
+                Fences,
+                Execute,
+                Stop,
+            };
+
+            Type type{};
+            std::vector<FencePoint> waits{};
+            FencePoint signal{};
+
+            NV_OF_EXECUTE_INPUT_PARAMS_VK inParams{};
+            NV_OF_EXECUTE_OUTPUT_PARAMS_VK outParams{};
+            std::array<NV_OF_ROI_RECT, MAX_ROIS> rois{};
+        };
+
+        static constexpr size_t maxQueuedJobs = 16;
+
+        // Only created with DXVK_NVAPI_OFA_ASYNC_EXECUTE=1, the worker owns the command queue and lists then.
+        // The queue supports a single producer, so callers on different threads are serialized by m_producerMutex.
+        std::unique_ptr<NvOFSpscQueue<QueueJob, maxQueuedJobs>> m_jobs{};
+        std::thread m_worker{};
+        std::mutex m_producerMutex;
+
+        [[nodiscard]] bool WaitIdle() const override;
+
+        void Submit(const NV_OF_EXECUTE_INPUT_PARAMS_VK* inParams);
+        void QueueFences(const NV_OF_FENCE_POINT* wait, const NV_OF_FENCE_POINT* signal);
+        bool QueueExecute(const NV_OF_EXECUTE_INPUT_PARAMS_D3D12* inParams, NV_OF_EXECUTE_OUTPUT_PARAMS_D3D12* outParams, const NV_OF_EXECUTE_INPUT_PARAMS_VK* vkInputParams, const NV_OF_EXECUTE_OUTPUT_PARAMS_VK* vkOutputParams);
+        void RunWorker();
+        void ProcessJob(QueueJob& job);
     };
 }
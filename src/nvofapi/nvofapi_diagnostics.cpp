@@ -0,0 +1,71 @@
+#include "nvofapi_diagnostics.h"
+#include "../util/util_env.h"
+#include "../util/util_log.h"
+#include "../util/util_string.h"
+
+namespace dxvk {
+    bool NvOFDiagnostics::IsEnabled() {
+        static bool enabled = env::getEnvVariable("DXVK_NVAPI_OFA_DIAGNOSTICS") == "1";
+        return enabled;
+    }
+
+    NvOFDiagnostics::ExecuteParams NvOFDiagnostics::GetExecuteParams(const NV_OF_EXECUTE_INPUT_PARAMS_VK* inParams, const NV_OF_EXECUTE_OUTPUT_PARAMS_VK* outParams, uint32_t numWaitSyncs, bool signalSync) {
+        return ExecuteParams{
+            .numRois = inParams->numRois,
+            .numWaitSyncs = numWaitSyncs,
+            .disableTemporalHints = inParams->disableTemporalHints != 0,
+            .externalHints = inParams->externalHints != nullptr,
+            .privData = inParams->hPrivData != nullptr,
+            .signalSync = signalSync,
+            .outputCostBuffer = outParams->outputCostBuffer != nullptr,
+            .bwdOutputBuffer = outParams->bwdOutputBuffer != nullptr,
+            .bwdOutputCostBuffer = outParams->bwdOutputCostBuffer != nullptr,
+            .globalFlowBuffer = outParams->globalFlowBuffer != nullptr,
+        };
+    }
+
+    NvOFDiagnostics::NvOFDiagnostics(const char* api, Logger logger)
+        : m_api(api), m_logger(logger ? std::move(logger) : Logger(log::info)) {
+        m_logger(str::format("Optical flow diagnostics enabled for ", m_api, " session"));
+    }
+
+    void NvOFDiagnostics::Execute(const ExecuteParams& params, std::chrono::steady_clock::time_point now) {
+        if (m_lastParams != params) {
+            m_logger(str::format("OFExecute", m_api, " ", m_lastParams ? "parameters changed" : "first execution", ":",
+                " numRois: ", params.numRois,
+                " numWaitSyncs: ", params.numWaitSyncs,
+                " disableTemporalHints: ", params.disableTemporalHints,
+                " externalHints: ", params.externalHints,
+                " hPrivData: ", params.privData,
+                " signalSync: ", params.signalSync,
+                " outputCostBuffer: ", params.outputCostBuffer,
+                " bwdOutputBuffer: ", params.bwdOutputBuffer,
+                " bwdOutputCostBuffer: ", params.bwdOutputCostBuffer,
+                " globalFlowBuffer: ", params.globalFlowBuffer));
+
+            m_lastParams = params;
+        }
+
+        if (m_summaryStart == std::chrono::steady_clock::time_point{})
+            m_summaryStart = now;
+
+        m_executions++;
+        m_rois += params.numRois;
+        m_waitSyncs += params.numWaitSyncs;
+
+        auto elapsed = now - m_summaryStart;
+        if (elapsed < summaryInterval)
+            return;
+
+        auto seconds = std::chrono::duration<double>(elapsed).count();
+        m_logger(str::format("OFExecute", m_api, " summary:",
+            " executions/s: ", static_cast<double>(m_executions) / seconds,
+            " average numRois: ", static_cast<double>(m_rois) / static_cast<double>(m_executions),
+            " average numWaitSyncs: ", static_cast<double>(m_waitSyncs) / static_cast<double>(m_executions)));
+
+        m_summaryStart = now;
+        m_executions = 0;
+        m_rois = 0;
+        m_waitSyncs = 0;
+    }
+}
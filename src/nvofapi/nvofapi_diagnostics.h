@@ -0,0 +1,51 @@
+#pragma once
+
+#include "../nvofapi_private.h"
+
+#include <functional>
+
+namespace dxvk {
+    // Optional per session logging of optical flow executions: the first execution, changes of the execute
+    // parameters and a periodic summary. Sessions without diagnostics don't create an instance of this class.
+    class NvOFDiagnostics {
+
+      public:
+        static constexpr auto summaryInterval = std::chrono::seconds(5);
+
+        using Logger = std::function<void(const std::string&)>;
+
+        struct ExecuteParams {
+            uint32_t numRois;
+            uint32_t numWaitSyncs;
+            bool disableTemporalHints;
+            bool externalHints;
+            bool privData;
+            bool signalSync;
+            bool outputCostBuffer;
+            bool bwdOutputBuffer;
+            bool bwdOutputCostBuffer;
+            bool globalFlowBuffer;
+
+            bool operator==(const ExecuteParams&) const = default;
+        };
+
+        [[nodiscard]] static bool IsEnabled();
+        [[nodiscard]] static ExecuteParams GetExecuteParams(const NV_OF_EXECUTE_INPUT_PARAMS_VK* inParams, const NV_OF_EXECUTE_OUTPUT_PARAMS_VK* outParams, uint32_t numWaitSyncs, bool signalSync);
+
+        // Messages go to the regular log unless a logger is given
+        explicit NvOFDiagnostics(const char* api, Logger logger = {});
+
+        void Execute(const ExecuteParams& params, std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+
+      private:
+        const char* m_api;
+        Logger m_logger;
+
+        std::optional<ExecuteParams> m_lastParams;
+
+        std::chrono::steady_clock::time_point m_summaryStart{};
+        uint64_t m_executions{};
+        uint64_t m_rois{};
+        uint64_t m_waitSyncs{};
+    };
+}
@@ -24,6 +24,11 @@
 #include "nvofapi_image.h"
 
 namespace dxvk {
+    uint64_t NvOFImage::NextId() {
+        static std::atomic<uint64_t> nextId{1};
+        return nextId.fetch_add(1, std::memory_order_relaxed);
+    }
+
     bool NvOFImage::Initialize(PFN_vkCreateImageView fpCreateImageView,
         PFN_vkDestroyImageView fpDestroyImageView) {
         m_vkDestroyImageView = fpDestroyImageView;
@@ -43,4 +48,49 @@ namespace dxvk {
         }
         return true;
     }
+
+    void NvOFImage::Release() {
+        if (m_cache)
+            m_cache->Release(this);
+        else
+            delete this;
+    }
+
+    NvOFImage* NvOFImageCache::Acquire(uint64_t handle, VkFormat format) {
+        std::scoped_lock lock(m_mutex);
+
+        auto it = m_images.find(Key{handle, format});
+        if (it == m_images.end())
+            return nullptr;
+
+        it->second->m_refCount++;
+        return it->second;
+    }
+
+    NvOFImage* NvOFImageCache::Insert(uint64_t handle, VkFormat format, std::unique_ptr<NvOFImage> image) {
+        std::scoped_lock lock(m_mutex);
+
+        auto [it, inserted] = m_images.emplace(Key{handle, format}, image.get());
+        if (!inserted) {
+            it->second->m_refCount++;
+            return it->second;
+        }
+
+        image->m_cache = shared_from_this();
+        image->m_cacheHandle = handle;
+        image->m_cacheFormat = format;
+        return image.release();
+    }
+
+    void NvOFImageCache::Release(NvOFImage* image) {
+        // Keep the cache alive while the last image detaches from it
+        auto self = shared_from_this();
+        std::scoped_lock lock(m_mutex);
+
+        if (--image->m_refCount)
+            return;
+
+        m_images.erase(Key{image->m_cacheHandle, image->m_cacheFormat});
+        delete image;
+    }
 }
@@ -25,26 +25,83 @@
 
 #include "../nvofapi_private.h"
 
+#include <atomic>
+
 namespace dxvk {
+    class NvOFImageCache;
+
     class NvOFImage {
       public:
-        NvOFImage(VkDevice device, VkImage image, VkFormat format) : m_vkDevice(device), m_image(image), m_format(format) {
+        NvOFImage(VkDevice device, VkImage image, VkFormat format) : m_vkDevice(device), m_image(image), m_format(format), m_id(NextId()) {
         }
 
         ~NvOFImage() {
-            m_vkDestroyImageView(m_vkDevice, m_imageView, nullptr);
+            if (m_vkDestroyImageView)
+                m_vkDestroyImageView(m_vkDevice, m_imageView, nullptr);
         }
 
         [[nodiscard]] VkImageView ImageView() const { return m_imageView; }
+        [[nodiscard]] uint64_t Id() const { return m_id; }
+
+        // Handle that the image was registered with, e.g. the D3D11 resource
+        [[nodiscard]] uint64_t Handle() const { return m_cacheHandle; }
 
         bool Initialize(PFN_vkCreateImageView CreateImageView,
             PFN_vkDestroyImageView DestroyImageView);
 
+        // Keeps a registered image alive while work that references it is still queued
+        void AddRef() { m_refCount.fetch_add(1, std::memory_order_relaxed); }
+
+        // Drops one registration, the image is destroyed together with the last one
+        void Release();
+
       private:
+        friend class NvOFImageCache;
+
         VkDevice m_vkDevice{};
         VkImage m_image{};
         VkImageView m_imageView{};
         VkFormat m_format{};
+        uint64_t m_id{};
         PFN_vkDestroyImageView m_vkDestroyImageView{};
+
+        // Guarded by the cache's mutex, the cache outlives the instance as long as images are registered.
+        // The reference count is only raised without the mutex by holders of an existing reference.
+        std::shared_ptr<NvOFImageCache> m_cache;
+        uint64_t m_cacheHandle{};
+        VkFormat m_cacheFormat{};
+        std::atomic<uint32_t> m_refCount{1};
+
+        // Unique for the lifetime of the process, unlike image view handles or addresses which may get reused
+        static uint64_t NextId();
+    };
+
+    // Hands out the same NvOFImage when the same underlying image is registered multiple times
+    class NvOFImageCache : public std::enable_shared_from_this<NvOFImageCache> {
+      public:
+        // Returns an existing image with an additional reference, or nullptr when the handle is not registered
+        NvOFImage* Acquire(uint64_t handle, VkFormat format);
+
+        // Takes ownership of a freshly created image, returns an existing image instead when another thread won the race
+        NvOFImage* Insert(uint64_t handle, VkFormat format, std::unique_ptr<NvOFImage> image);
+
+        void Release(NvOFImage* image);
+
+      private:
+        struct Key {
+            uint64_t handle;
+            VkFormat format;
+
+            bool operator==(const Key&) const = default;
+        };
+
+        struct KeyHash {
+            size_t operator()(const Key& key) const {
+                return std::hash<uint64_t>{}(key.handle) ^ (static_cast<size_t>(key.format) << 1);
+            }
+        };
+
+        std::mutex m_mutex;
+        std::unordered_map<Key, NvOFImage*, KeyHash> m_images;
     };
 }
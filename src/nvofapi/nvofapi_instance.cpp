@@ -24,6 +24,7 @@
 #include "nvofapi_image.h"
 #include "nvofapi_instance.h"
 #include "../util/util_log.h"
+#include "../util/util_string.h"
 #include "../util/util_statuscode.h"
 
 namespace dxvk {
@@ -42,7 +43,36 @@ namespace dxvk {
 
     constexpr uint32_t NV_OF_EXECUTE_PRIV_DATA_ID_INPUT_MIPS = 6;
 
-    uint32_t NvOFInstance::GetVkOFAQueue() const {
+    // NVOFAPI grid sizes are the edge length of a grid cell, Vulkan uses one bit per grid size
+    static constexpr std::array<std::pair<uint32_t, VkOpticalFlowGridSizeFlagBitsNV>, 4> gridSizes{{
+        {1, VK_OPTICAL_FLOW_GRID_SIZE_1X1_BIT_NV},
+        {2, VK_OPTICAL_FLOW_GRID_SIZE_2X2_BIT_NV},
+        {4, VK_OPTICAL_FLOW_GRID_SIZE_4X4_BIT_NV},
+        {8, VK_OPTICAL_FLOW_GRID_SIZE_8X8_BIT_NV},
+    }};
+
+    static VkOpticalFlowGridSizeFlagsNV ToVkGridSize(uint32_t gridSize) {
+        auto it = std::ranges::find(gridSizes, gridSize, &std::pair<uint32_t, VkOpticalFlowGridSizeFlagBitsNV>::first);
+        return it != gridSizes.end() ? it->second : VK_OPTICAL_FLOW_GRID_SIZE_UNKNOWN_NV;
+    }
+
+    static NV_OF_STATUS GetGridSizeCaps(VkOpticalFlowGridSizeFlagsNV supportedGridSizes, uint32_t maxGridSize, uint32_t* capsVal, uint32_t* size) {
+        uint32_t count = 0;
+        for (const auto& [gridSize, vkGridSize] : gridSizes) {
+            if (gridSize > maxGridSize || !(supportedGridSizes & vkGridSize))
+                continue;
+
+            if (capsVal && count < *size)
+                capsVal[count] = gridSize;
+
+            count++;
+        }
+
+        *size = count;
+        return Success();
+    }
+
+    std::optional<uint32_t> NvOFInstance::GetVkOFAQueue() const {
         uint32_t count = 0;
         m_vkGetPhysicalDeviceQueueFamilyProperties(m_vkPhysicalDevice, &count, nullptr);
         auto queueFamProps = std::vector<VkQueueFamilyProperties>(count);
@@ -53,7 +83,127 @@ namespace dxvk {
                 return i;
             }
         }
-        return -1;
+        return std::nullopt;
+    }
+
+    VkPhysicalDeviceOpticalFlowPropertiesNV NvOFInstance::GetVkOpticalFlowProperties() const {
+        VkPhysicalDeviceOpticalFlowPropertiesNV opticalFlowProperties{};
+        opticalFlowProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_OPTICAL_FLOW_PROPERTIES_NV;
+
+        VkPhysicalDeviceProperties2 deviceProperties2{};
+        deviceProperties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        deviceProperties2.pNext = &opticalFlowProperties;
+
+        m_vk->GetPhysicalDeviceProperties2(m_vkInstance, m_vkPhysicalDevice, &deviceProperties2);
+        opticalFlowProperties.pNext = nullptr;
+
+        log::info(str::format("Optical flow properties: output grid sizes: 0x", std::hex, opticalFlowProperties.supportedOutputGridSizes,
+            ", hint grid sizes: 0x", opticalFlowProperties.supportedHintGridSizes, std::dec,
+            ", dimensions: ", opticalFlowProperties.minWidth, "x", opticalFlowProperties.minHeight,
+            " - ", opticalFlowProperties.maxWidth, "x", opticalFlowProperties.maxHeight,
+            ", max ROIs: ", opticalFlowProperties.maxNumRegionsOfInterest));
+
+        return opticalFlowProperties;
+    }
+
+    const std::vector<VkFormat>& NvOFInstance::GetSurfaceFormats(NV_OF_BUFFER_USAGE bufferUsage, NV_OF_MODE ofMode) {
+        static const std::vector<VkFormat> noFormats;
+
+        // VK_NV_optical_flow has no stereo disparity mode
+        if (ofMode != NV_OF_MODE_OPTICALFLOW)
+            return noFormats;
+
+        VkOpticalFlowImageFormatInfoNV formatInfo{};
+        formatInfo.sType = VK_STRUCTURE_TYPE_OPTICAL_FLOW_IMAGE_FORMAT_INFO_NV;
+
+        switch (bufferUsage) {
+            case NV_OF_BUFFER_USAGE_INPUT:
+                formatInfo.usage = VK_OPTICAL_FLOW_USAGE_INPUT_BIT_NV;
+                break;
+            case NV_OF_BUFFER_USAGE_OUTPUT:
+                formatInfo.usage = VK_OPTICAL_FLOW_USAGE_OUTPUT_BIT_NV;
+                break;
+            case NV_OF_BUFFER_USAGE_HINT:
+                formatInfo.usage = VK_OPTICAL_FLOW_USAGE_HINT_BIT_NV;
+                break;
+            case NV_OF_BUFFER_USAGE_COST:
+                formatInfo.usage = VK_OPTICAL_FLOW_USAGE_COST_BIT_NV;
+                break;
+            case NV_OF_BUFFER_USAGE_GLOBAL_FLOW:
+                formatInfo.usage = VK_OPTICAL_FLOW_USAGE_GLOBAL_FLOW_BIT_NV;
+                break;
+            default:
+                return noFormats;
+        }
+
+        std::scoped_lock lock(m_surfaceFormatsMutex);
+        if (auto it = m_surfaceFormats.find(bufferUsage); it != m_surfaceFormats.end())
+            return it->second;
+
+        auto& formats = m_surfaceFormats[bufferUsage];
+        if (!m_vkGetPhysicalDeviceOpticalFlowImageFormatsNV)
+            return formats;
+
+        uint32_t count = 0;
+        if (m_vkGetPhysicalDeviceOpticalFlowImageFormatsNV(m_vkPhysicalDevice, &formatInfo, &count, nullptr) != VK_SUCCESS)
+            return formats;
+
+        auto properties = std::vector<VkOpticalFlowImageFormatPropertiesNV>(count, {VK_STRUCTURE_TYPE_OPTICAL_FLOW_IMAGE_FORMAT_PROPERTIES_NV});
+        if (m_vkGetPhysicalDeviceOpticalFlowImageFormatsNV(m_vkPhysicalDevice, &formatInfo, &count, properties.data()) < VK_SUCCESS)
+            return formats;
+
+        for (uint32_t i = 0; i < count; i++)
+            formats.push_back(properties[i].format);
+
+        return formats;
+    }
+
+    static DXGI_FORMAT ToDxgiFormat(VkFormat format) {
+        switch (format) {
+            case VK_FORMAT_R8_UNORM:
+                return DXGI_FORMAT_R8_UNORM;
+            case VK_FORMAT_G8_B8R8_2PLANE_420_UNORM:
+                return DXGI_FORMAT_NV12;
+            case VK_FORMAT_B8G8R8A8_UNORM:
+                return DXGI_FORMAT_B8G8R8A8_UNORM;
+            case VK_FORMAT_R8G8B8A8_UNORM:
+                return DXGI_FORMAT_R8G8B8A8_UNORM;
+            // There is no DXGI equivalent of the fixed point flow vector format, vkd3d-proton maps R16G16_SINT resources for it
+            case VK_FORMAT_R16G16_S10_5_NV:
+            case VK_FORMAT_R16G16_SINT:
+                return DXGI_FORMAT_R16G16_SINT;
+            case VK_FORMAT_R8_UINT:
+                return DXGI_FORMAT_R8_UINT;
+            case VK_FORMAT_R32_UINT:
+                return DXGI_FORMAT_R32_UINT;
+            default:
+                return DXGI_FORMAT_UNKNOWN;
+        }
+    }
+
+    const std::vector<DXGI_FORMAT>& NvOFInstance::GetDxgiSurfaceFormats(NV_OF_BUFFER_USAGE bufferUsage, NV_OF_MODE ofMode) {
+        const auto& vkFormats = GetSurfaceFormats(bufferUsage, ofMode);
+
+        std::scoped_lock lock(m_dxgiSurfaceFormatsMutex);
+        auto [it, inserted] = m_dxgiSurfaceFormats.try_emplace({bufferUsage, ofMode});
+        if (!inserted)
+            return it->second;
+
+        auto& formats = it->second;
+
+        // Without the Vulkan format query keep reporting the one format per usage that was always reported
+        if (!m_vkGetPhysicalDeviceOpticalFlowImageFormatsNV) {
+            formats.push_back(bufferUsage == NV_OF_BUFFER_USAGE_INPUT ? DXGI_FORMAT_R8_UNORM : DXGI_FORMAT_R16G16_SINT);
+            return formats;
+        }
+
+        for (auto vkFormat : vkFormats) {
+            auto format = ToDxgiFormat(vkFormat);
+            if (format != DXGI_FORMAT_UNKNOWN && std::ranges::find(formats, format) == formats.end())
+                formats.push_back(format);
+        }
+
+        return formats;
     }
 
     NV_OF_STATUS NvOFInstance::InitSession(const NV_OF_INIT_PARAMS* initParams) {
@@ -79,7 +229,27 @@ namespace dxvk {
         createInfo.sType = VK_STRUCTURE_TYPE_OPTICAL_FLOW_SESSION_CREATE_INFO_NV;
         createInfo.width = initParams->width;
         createInfo.height = initParams->height;
-        createInfo.outputGridSize = VK_OPTICAL_FLOW_GRID_SIZE_4X4_BIT_NV;
+        // Keep the previous default of a 4x4 output grid when the application did not ask for a specific size
+        createInfo.outputGridSize = ToVkGridSize(initParams->outGridSize != NV_OF_OUTPUT_VECTOR_GRID_SIZE_UNDEFINED ? initParams->outGridSize : NV_OF_OUTPUT_VECTOR_GRID_SIZE_4);
+        if (!(createInfo.outputGridSize & m_vkOpticalFlowProperties.supportedOutputGridSizes)) {
+            log::info(str::format("Unsupported optical flow output grid size: ", initParams->outGridSize));
+            return ErrorGeneric();
+        }
+
+        if (initParams->enableExternalHints) {
+            createInfo.hintGridSize = ToVkGridSize(initParams->hintGridSize);
+            if (!m_vkOpticalFlowProperties.hintSupported || !(createInfo.hintGridSize & m_vkOpticalFlowProperties.supportedHintGridSizes)) {
+                log::info(str::format("Unsupported optical flow hint grid size: ", initParams->hintGridSize));
+                return ErrorGeneric();
+            }
+        }
+
+        if ((initParams->enableOutputCost && !m_vkOpticalFlowProperties.costSupported)
+            || (initParams->enableGlobalFlow && !m_vkOpticalFlowProperties.globalFlowSupported)
+            || (initParams->predDirection == NV_OF_PRED_DIRECTION_BOTH && !m_vkOpticalFlowProperties.bidirectionalFlowSupported)) {
+            log::info("Unsupported optical flow output cost, global flow or bidirectional flow requested");
+            return ErrorGeneric();
+        }
 
         switch (initParams->perfLevel) {
             case NV_OF_PERF_LEVEL_SLOW:
@@ -123,20 +293,56 @@ namespace dxvk {
             createInfo.pNext = &privData;
         }
 
+        // Reinitialization replaces the session, the previous one stays available for later reuse
+        if (m_vkOfaSession)
+            ReleaseSession(WaitIdle());
+
+        m_boundImages.fill(0);
+
+        if (!createInfo.pNext)
+            m_sessionKey = NvOFSessionPool::GetSessionKey(createInfo);
+        else
+            m_sessionKey.reset();
+
+        if (m_sessionKey && m_sessionPool) {
+            m_vkOfaSession = m_sessionPool->AcquireSession(*m_sessionKey);
+            if (m_vkOfaSession)
+                return Success();
+        }
+
         auto ret = m_vkCreateOpticalFlowSessionNV(m_vkDevice, &createInfo, nullptr, &m_vkOfaSession);
 
         if (ret == VK_SUCCESS) {
             return Success();
         }
 
+        m_vkOfaSession = VK_NULL_HANDLE;
         return ErrorGeneric();
     }
 
-    NV_OF_STATUS NvOFInstance::BindImageToSession(NvOFGPUBufferHandle hBuffer, VkOpticalFlowSessionBindingPointNV bindingPoint) const {
+    void NvOFInstance::ReleaseSession(bool idle) {
+        if (!m_vkOfaSession)
+            return;
+
+        if (idle && m_sessionKey && m_sessionPool)
+            m_sessionPool->ReleaseSession(*m_sessionKey, m_vkOfaSession);
+        else if (m_vkDestroyOpticalFlowSessionNV)
+            m_vkDestroyOpticalFlowSessionNV(m_vkDevice, m_vkOfaSession, nullptr);
+
+        m_vkOfaSession = VK_NULL_HANDLE;
+    }
+
+    NV_OF_STATUS NvOFInstance::BindImageToSession(NvOFGPUBufferHandle hBuffer, VkOpticalFlowSessionBindingPointNV bindingPoint, bool forceBind) {
         auto nvOFImage = reinterpret_cast<NvOFImage*>(hBuffer);
 
+        // Optional buffers that were not provided are left untouched
         if (!nvOFImage)
-            return ErrorGeneric();
+            return Success();
+
+        // Session bindings persist across executions, so only rebind when the image changed
+        auto& boundImage = m_boundImages[bindingPoint];
+        if (!forceBind && boundImage == nvOFImage->Id())
+            return Success();
 
         auto ret = m_vkBindOpticalFlowSessionImageNV(m_vkDevice,
             m_vkOfaSession,
@@ -144,49 +350,149 @@ namespace dxvk {
             nvOFImage->ImageView(),
             VK_IMAGE_LAYOUT_GENERAL);
         if (ret != VK_SUCCESS) {
+            boundImage = 0;
             return ErrorGeneric();
         }
+
+        boundImage = nvOFImage->Id();
         return Success();
     }
 
-    NV_OF_STATUS NvOFInstance::GetCaps(NV_OF_CAPS param, uint32_t* capsVal, uint32_t* size) const {
-        if (param == NV_OF_CAPS_SUPPORTED_OUTPUT_GRID_SIZES) {
-            *size = 1;
-            if (capsVal) {
-                *capsVal = NV_OF_OUTPUT_VECTOR_GRID_SIZE_4;
-            }
+    NV_OF_STATUS NvOFInstance::ValidateImagesForSession(const NV_OF_EXECUTE_INPUT_PARAMS_VK* inParams, const NV_OF_EXECUTE_OUTPUT_PARAMS_VK* outParams) const {
+        if (!m_vkOfaSession)
+            return InvalidCall();
 
-            // XXX[ljm] query VkPhysicalDevice for actual support
-            return Success();
-        }
-        return ErrorGeneric();
-    }
+        // Both frames and the flow vectors are always bound, everything else is optional
+        if (!inParams->inputFrame || !inParams->referenceFrame || !outParams->outputBuffer)
+            return InvalidParam();
 
-    void NvOFInstance::RegisterBuffer(const NV_OF_REGISTER_RESOURCE_PARAMS_VK* registerParams) const {
-        auto nvOFImage = new NvOFImage(m_vkDevice, registerParams->image, registerParams->format);
-        nvOFImage->Initialize(m_vkCreateImageView, m_vkDestroyImageView);
-        *registerParams->hOFGpuBuffer = reinterpret_cast<NvOFGPUBufferHandle>(nvOFImage);
+        return Success();
     }
 
-    void NvOFInstance::RecordCmdBuf(const NV_OF_EXECUTE_INPUT_PARAMS_VK* inParams, NV_OF_EXECUTE_OUTPUT_PARAMS_VK* outParams, VkCommandBuffer cmdBuf) const {
-        BindImageToSession(inParams->inputFrame, VK_OPTICAL_FLOW_SESSION_BINDING_POINT_INPUT_NV);
-        BindImageToSession(inParams->referenceFrame, VK_OPTICAL_FLOW_SESSION_BINDING_POINT_REFERENCE_NV);
-        BindImageToSession(outParams->outputBuffer, VK_OPTICAL_FLOW_SESSION_BINDING_POINT_FLOW_VECTOR_NV);
-        BindImageToSession(outParams->outputCostBuffer, VK_OPTICAL_FLOW_SESSION_BINDING_POINT_COST_NV);
-        BindImageToSession(outParams->bwdOutputBuffer, VK_OPTICAL_FLOW_SESSION_BINDING_POINT_BACKWARD_FLOW_VECTOR_NV);
-        BindImageToSession(outParams->bwdOutputCostBuffer, VK_OPTICAL_FLOW_SESSION_BINDING_POINT_BACKWARD_COST_NV);
-        BindImageToSession(outParams->globalFlowBuffer, VK_OPTICAL_FLOW_SESSION_BINDING_POINT_GLOBAL_FLOW_NV);
+    NV_OF_STATUS NvOFInstance::BindImagesToSession(const NV_OF_EXECUTE_INPUT_PARAMS_VK* inParams, const NV_OF_EXECUTE_OUTPUT_PARAMS_VK* outParams) {
+        if (auto status = ValidateImagesForSession(inParams, outParams); status != NV_OF_SUCCESS)
+            return status;
+
+        const std::array<std::pair<NvOFGPUBufferHandle, VkOpticalFlowSessionBindingPointNV>, 5> outputs{{
+            {outParams->outputBuffer, VK_OPTICAL_FLOW_SESSION_BINDING_POINT_FLOW_VECTOR_NV},
+            {outParams->outputCostBuffer, VK_OPTICAL_FLOW_SESSION_BINDING_POINT_COST_NV},
+            {outParams->bwdOutputBuffer, VK_OPTICAL_FLOW_SESSION_BINDING_POINT_BACKWARD_FLOW_VECTOR_NV},
+            {outParams->bwdOutputCostBuffer, VK_OPTICAL_FLOW_SESSION_BINDING_POINT_BACKWARD_COST_NV},
+            {outParams->globalFlowBuffer, VK_OPTICAL_FLOW_SESSION_BINDING_POINT_GLOBAL_FLOW_NV},
+        }};
+
         // Support INPUT_MIPS execute priv data
-        if (inParams->hPrivData && reinterpret_cast<NV_OF_PRIV_DATA*>(inParams->hPrivData)->id == NV_OF_EXECUTE_PRIV_DATA_ID_INPUT_MIPS) {
-            auto mipData = static_cast<NV_OF_EXECUTE_PRIV_DATA_INPUT_MIPS*>(reinterpret_cast<NV_OF_PRIV_DATA*>(inParams->hPrivData)->data);
+        NV_OF_EXECUTE_PRIV_DATA_INPUT_MIPS* mipData = nullptr;
+        if (inParams->hPrivData && reinterpret_cast<NV_OF_PRIV_DATA*>(inParams->hPrivData)->id == NV_OF_EXECUTE_PRIV_DATA_ID_INPUT_MIPS)
+            mipData = static_cast<NV_OF_EXECUTE_PRIV_DATA_INPUT_MIPS*>(reinterpret_cast<NV_OF_PRIV_DATA*>(inParams->hPrivData)->data);
+
+        // Mip levels are bound to the same binding points as the frames themselves,
+        // so replay the whole sequence instead of skipping binds that look unchanged
+        auto forceInputBinds = mipData != nullptr;
+
+        if (auto status = BindImageToSession(inParams->inputFrame, VK_OPTICAL_FLOW_SESSION_BINDING_POINT_INPUT_NV, forceInputBinds); status != NV_OF_SUCCESS)
+            return status;
+
+        if (auto status = BindImageToSession(inParams->referenceFrame, VK_OPTICAL_FLOW_SESSION_BINDING_POINT_REFERENCE_NV, forceInputBinds); status != NV_OF_SUCCESS)
+            return status;
+
+        for (const auto& [hBuffer, bindingPoint] : outputs) {
+            if (auto status = BindImageToSession(hBuffer, bindingPoint); status != NV_OF_SUCCESS)
+                return status;
+        }
+
+        if (mipData) {
             for (uint32_t i = 0; i < 6; i++) {
-                if (mipData->input[i] && mipData->reference[i]) {
-                    BindImageToSession(mipData->input[i], VK_OPTICAL_FLOW_SESSION_BINDING_POINT_INPUT_NV);
-                    BindImageToSession(mipData->reference[i], VK_OPTICAL_FLOW_SESSION_BINDING_POINT_REFERENCE_NV);
-                }
+                if (!mipData->input[i] || !mipData->reference[i])
+                    continue;
+
+                if (auto status = BindImageToSession(mipData->input[i], VK_OPTICAL_FLOW_SESSION_BINDING_POINT_INPUT_NV, true); status != NV_OF_SUCCESS)
+                    return status;
+
+                if (auto status = BindImageToSession(mipData->reference[i], VK_OPTICAL_FLOW_SESSION_BINDING_POINT_REFERENCE_NV, true); status != NV_OF_SUCCESS)
+                    return status;
             }
         }
-        auto regions = std::vector<VkRect2D>(inParams->numRois);
+
+        return Success();
+    }
+
+    NV_OF_STATUS NvOFInstance::GetCaps(NV_OF_CAPS param, uint32_t* capsVal, uint32_t* size) const {
+        if (!size)
+            return InvalidPtr();
+
+        const auto& properties = m_vkOpticalFlowProperties;
+        switch (param) {
+            case NV_OF_CAPS_SUPPORTED_OUTPUT_GRID_SIZES:
+                return GetGridSizeCaps(properties.supportedOutputGridSizes, NV_OF_OUTPUT_VECTOR_GRID_SIZE_MAX - 1, capsVal, size);
+            case NV_OF_CAPS_SUPPORTED_HINT_GRID_SIZES:
+                return GetGridSizeCaps(properties.supportedHintGridSizes, NV_OF_HINT_VECTOR_GRID_SIZE_MAX - 1, capsVal, size);
+            default:
+                break;
+        }
+
+        uint32_t value;
+        switch (param) {
+            case NV_OF_CAPS_SUPPORT_HINT_WITH_OF_MODE:
+                value = properties.hintSupported;
+                break;
+            case NV_OF_CAPS_SUPPORT_HINT_WITH_ST_MODE:
+                // VK_NV_optical_flow has no stereo disparity mode
+                value = 0;
+                break;
+            case NV_OF_CAPS_WIDTH_MIN:
+                value = properties.minWidth;
+                break;
+            case NV_OF_CAPS_HEIGHT_MIN:
+                value = properties.minHeight;
+                break;
+            case NV_OF_CAPS_WIDTH_MAX:
+                value = properties.maxWidth;
+                break;
+            case NV_OF_CAPS_HEIGHT_MAX:
+                value = properties.maxHeight;
+                break;
+            case NV_OF_CAPS_SUPPORT_ROI:
+                value = properties.maxNumRegionsOfInterest > 0;
+                break;
+            case NV_OF_CAPS_SUPPORT_ROI_MAX_NUM:
+                value = std::min(properties.maxNumRegionsOfInterest, MAX_ROIS);
+                break;
+            default:
+                return ErrorGeneric();
+        }
+
+        *size = 1;
+        if (capsVal)
+            *capsVal = value;
+
+        return Success();
+    }
+
+    bool NvOFInstance::RegisterBuffer(const NV_OF_REGISTER_RESOURCE_PARAMS_VK* registerParams) {
+        auto handle = reinterpret_cast<uint64_t>(registerParams->image);
+
+        auto nvOFImage = m_imageCache->Acquire(handle, registerParams->format);
+        if (!nvOFImage)
+            nvOFImage = CreateImage(handle, registerParams->format, registerParams->image, registerParams->format);
+
+        if (!nvOFImage)
+            return false;
+
+        *registerParams->hOFGpuBuffer = reinterpret_cast<NvOFGPUBufferHandle>(nvOFImage);
+        return true;
+    }
+
+    NvOFImage* NvOFInstance::CreateImage(uint64_t cacheHandle, VkFormat cacheFormat, VkImage image, VkFormat format) {
+        auto nvOFImage = std::make_unique<NvOFImage>(m_vkDevice, image, format);
+        if (!nvOFImage->Initialize(m_vkCreateImageView, m_vkDestroyImageView))
+            return nullptr;
+
+        return m_imageCache->Insert(cacheHandle, cacheFormat, std::move(nvOFImage));
+    }
+
+    void NvOFInstance::RecordCmdBuf(const NV_OF_EXECUTE_INPUT_PARAMS_VK* inParams, VkCommandBuffer cmdBuf) const {
+        std::array<VkRect2D, MAX_ROIS> regions{};
         for (uint32_t i = 0; i < inParams->numRois; i++) {
             regions[i].offset.x = inParams->roiData[i].start_x;
             regions[i].offset.y = inParams->roiData[i].start_y;
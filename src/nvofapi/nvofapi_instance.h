@@ -26,9 +26,16 @@
 #include "../nvofapi_private.h"
 #include "../shared/resource_factory.h"
 #include "../shared/vk.h"
+#include "nvofapi_diagnostics.h"
+#include "nvofapi_image.h"
+#include "nvofapi_session_pool.h"
 
 namespace dxvk {
     constexpr uint32_t CMDS_IN_FLIGHT = 8;
+    // Maximum reported for NV_OF_CAPS_SUPPORT_ROI_MAX_NUM
+    constexpr uint32_t MAX_ROIS = 8;
+    // The API has no limit for wait syncs, larger counts fall back to heap storage
+    constexpr uint32_t MAX_INLINE_WAIT_SYNCS = 16;
 
     class NvOFInstance {
       public:
@@ -37,8 +44,8 @@ namespace dxvk {
             : m_resourceFactory(resourceFactory), m_vkInstance(vkInstance), m_vkPhysicalDevice(vkPhysicalDevice), m_vkDevice(vkDevice) {}
 
         virtual ~NvOFInstance() {
-            if (m_vkDestroyOpticalFlowSessionNV)
-                m_vkDestroyOpticalFlowSessionNV(m_vkDevice, m_vkOfaSession, nullptr);
+            // Derived instances return the session to the pool once their work is done, anything left is destroyed
+            ReleaseSession(false);
         }
 
         [[nodiscard]] VkDevice GetVkDevice() const { return m_vkDevice; }
@@ -46,23 +53,43 @@ namespace dxvk {
 
         NV_OF_STATUS GetCaps(NV_OF_CAPS param, uint32_t* capsVal, uint32_t* size) const;
 
+        // Natively supported formats, empty when the usage or mode is not supported
+        const std::vector<VkFormat>& GetSurfaceFormats(NV_OF_BUFFER_USAGE bufferUsage, NV_OF_MODE ofMode);
+
+        // Same as GetSurfaceFormats for the D3D backends, formats without DXGI equivalent are left out.
+        // Falls back to a single format per usage when the driver cannot be asked for its formats.
+        const std::vector<DXGI_FORMAT>& GetDxgiSurfaceFormats(NV_OF_BUFFER_USAGE bufferUsage, NV_OF_MODE ofMode);
+
         NV_OF_STATUS InitSession(const NV_OF_INIT_PARAMS* initParams);
 
-        void RegisterBuffer(const NV_OF_REGISTER_RESOURCE_PARAMS_VK* registerParams) const;
+        bool RegisterBuffer(const NV_OF_REGISTER_RESOURCE_PARAMS_VK* registerParams);
+
+        NV_OF_STATUS BindImageToSession(NvOFGPUBufferHandle hBuffer, VkOpticalFlowSessionBindingPointNV bindingPoint, bool forceBind = false);
 
-        NV_OF_STATUS BindImageToSession(NvOFGPUBufferHandle hBuffer, VkOpticalFlowSessionBindingPointNV bindingPoint) const;
+        NV_OF_STATUS BindImagesToSession(const NV_OF_EXECUTE_INPUT_PARAMS_VK* inParams, const NV_OF_EXECUTE_OUTPUT_PARAMS_VK* outParams);
 
-        void RecordCmdBuf(const NV_OF_EXECUTE_INPUT_PARAMS_VK* inParams, NV_OF_EXECUTE_OUTPUT_PARAMS_VK* outParams, VkCommandBuffer cmdBuf) const;
+        // Checks everything about the binds that does not need Vulkan, so that deferred binds only fail in the driver
+        [[nodiscard]] NV_OF_STATUS ValidateImagesForSession(const NV_OF_EXECUTE_INPUT_PARAMS_VK* inParams, const NV_OF_EXECUTE_OUTPUT_PARAMS_VK* outParams) const;
+
+        void RecordCmdBuf(const NV_OF_EXECUTE_INPUT_PARAMS_VK* inParams, VkCommandBuffer cmdBuf) const;
 
       protected:
         ResourceFactory& m_resourceFactory;
         std::unique_ptr<Vk> m_vk;
+        std::unique_ptr<NvOFDiagnostics> m_diagnostics;
+        std::shared_ptr<NvOFImageCache> m_imageCache = std::make_shared<NvOFImageCache>();
 
         VkInstance m_vkInstance{};
         VkPhysicalDevice m_vkPhysicalDevice{};
         VkDevice m_vkDevice{};
 
+        VkPhysicalDeviceOpticalFlowPropertiesNV m_vkOpticalFlowProperties{};
+
         VkOpticalFlowSessionNV m_vkOfaSession{};
+        std::shared_ptr<NvOFSessionPool> m_sessionPool;
+        std::optional<NvOFSessionPool::SessionKey> m_sessionKey; // empty when the session cannot be pooled
+        // Id of the NvOFImage that is currently bound to the session, indexed by binding point, zero when unbound
+        std::array<uint64_t, VK_OPTICAL_FLOW_SESSION_BINDING_POINT_GLOBAL_FLOW_NV + 1> m_boundImages{};
         PFN_vkCreateOpticalFlowSessionNV m_vkCreateOpticalFlowSessionNV{};
         PFN_vkDestroyOpticalFlowSessionNV m_vkDestroyOpticalFlowSessionNV{};
         PFN_vkCreateImageView m_vkCreateImageView{};
@@ -71,7 +98,27 @@ namespace dxvk {
         PFN_vkCmdOpticalFlowExecuteNV m_vkCmdOpticalFlowExecuteNV{};
 
         PFN_vkGetPhysicalDeviceQueueFamilyProperties m_vkGetPhysicalDeviceQueueFamilyProperties{};
+        PFN_vkGetPhysicalDeviceOpticalFlowImageFormatsNV m_vkGetPhysicalDeviceOpticalFlowImageFormatsNV{};
+
+        std::mutex m_surfaceFormatsMutex;
+        std::map<NV_OF_BUFFER_USAGE, std::vector<VkFormat>> m_surfaceFormats;
+
+        std::mutex m_dxgiSurfaceFormatsMutex;
+        std::map<std::pair<NV_OF_BUFFER_USAGE, NV_OF_MODE>, std::vector<DXGI_FORMAT>> m_dxgiSurfaceFormats;
+
+        // Index of the first queue family with optical flow support, empty when there is none
+        [[nodiscard]] std::optional<uint32_t> GetVkOFAQueue() const;
+
+        // Waits for all submitted work, false when that is not possible and the session must not be reused
+        [[nodiscard]] virtual bool WaitIdle() const { return false; }
+
+        // Hands the session to the pool when the GPU is done with it, destroys it otherwise
+        void ReleaseSession(bool idle);
+
+        // Queried once during initialization and kept in m_vkOpticalFlowProperties for the lifetime of the instance
+        [[nodiscard]] VkPhysicalDeviceOpticalFlowPropertiesNV GetVkOpticalFlowProperties() const;
 
-        [[nodiscard]] uint32_t GetVkOFAQueue() const;
+        // Creates the image view for an image that is not registered yet, the cache key may differ from the image itself
+        NvOFImage* CreateImage(uint64_t cacheHandle, VkFormat cacheFormat, VkImage image, VkFormat format);
     };
 }
@@ -0,0 +1,107 @@
+#include "nvofapi_session_pool.h"
+
+namespace dxvk {
+    std::mutex NvOFSessionPool::s_poolsMutex;
+    std::unordered_map<VkDevice, std::weak_ptr<NvOFSessionPool>> NvOFSessionPool::s_pools;
+
+    NvOFSessionPool::SessionKey NvOFSessionPool::GetSessionKey(const VkOpticalFlowSessionCreateInfoNV& createInfo) {
+        return SessionKey{
+            .width = createInfo.width,
+            .height = createInfo.height,
+            .imageFormat = createInfo.imageFormat,
+            .flowVectorFormat = createInfo.flowVectorFormat,
+            .costFormat = createInfo.costFormat,
+            .outputGridSize = createInfo.outputGridSize,
+            .hintGridSize = createInfo.hintGridSize,
+            .performanceLevel = createInfo.performanceLevel,
+            .flags = createInfo.flags,
+        };
+    }
+
+    std::shared_ptr<NvOFSessionPool> NvOFSessionPool::Get(VkDevice device, PFN_vkDestroyOpticalFlowSessionNV destroySession, PFN_vkDestroyCommandPool destroyCommandPool) {
+        std::scoped_lock lock(s_poolsMutex);
+
+        auto& entry = s_pools[device];
+        auto pool = entry.lock();
+        if (!pool) {
+            pool = std::make_shared<NvOFSessionPool>(device);
+            entry = pool;
+        }
+
+        std::scoped_lock poolLock(pool->m_mutex);
+        if (!pool->m_vkDestroyOpticalFlowSessionNV)
+            pool->m_vkDestroyOpticalFlowSessionNV = destroySession;
+
+        if (!pool->m_vkDestroyCommandPool)
+            pool->m_vkDestroyCommandPool = destroyCommandPool;
+
+        return pool;
+    }
+
+    NvOFSessionPool::~NvOFSessionPool() {
+        if (m_vkDestroyOpticalFlowSessionNV) {
+            for (const auto& [key, session] : m_sessions)
+                m_vkDestroyOpticalFlowSessionNV(m_vkDevice, session, nullptr);
+        }
+
+        if (m_vkDestroyCommandPool) {
+            for (const auto& [queueFamilyIndex, commandBuffer] : m_commandBuffers)
+                m_vkDestroyCommandPool(m_vkDevice, commandBuffer.commandPool, nullptr);
+        }
+
+        // A new pool for the same device may have been registered in the meantime
+        std::scoped_lock lock(s_poolsMutex);
+        auto it = s_pools.find(m_vkDevice);
+        if (it != s_pools.end() && it->second.expired())
+            s_pools.erase(it);
+    }
+
+    VkOpticalFlowSessionNV NvOFSessionPool::AcquireSession(const SessionKey& key) {
+        std::scoped_lock lock(m_mutex);
+
+        auto it = std::find_if(m_sessions.rbegin(), m_sessions.rend(), [&key](const auto& entry) { return entry.first == key; });
+        if (it == m_sessions.rend())
+            return VK_NULL_HANDLE;
+
+        auto session = it->second;
+        m_sessions.erase(std::next(it).base());
+        return session;
+    }
+
+    void NvOFSessionPool::ReleaseSession(const SessionKey& key, VkOpticalFlowSessionNV session) {
+        std::scoped_lock lock(m_mutex);
+
+        m_sessions.emplace_back(key, session);
+        if (m_sessions.size() <= maxSessions)
+            return;
+
+        if (m_vkDestroyOpticalFlowSessionNV)
+            m_vkDestroyOpticalFlowSessionNV(m_vkDevice, m_sessions.front().second, nullptr);
+
+        m_sessions.erase(m_sessions.begin());
+    }
+
+    std::optional<NvOFSessionPool::CommandBuffer> NvOFSessionPool::AcquireCommandBuffer(uint32_t queueFamilyIndex) {
+        std::scoped_lock lock(m_mutex);
+
+        auto it = std::ranges::find(m_commandBuffers, queueFamilyIndex, &std::pair<uint32_t, CommandBuffer>::first);
+        if (it == m_commandBuffers.end())
+            return std::nullopt;
+
+        auto commandBuffer = it->second;
+        m_commandBuffers.erase(it);
+        return commandBuffer;
+    }
+
+    void NvOFSessionPool::ReleaseCommandBuffer(uint32_t queueFamilyIndex, CommandBuffer commandBuffer) {
+        std::scoped_lock lock(m_mutex);
+
+        if (m_commandBuffers.size() < maxCommandBuffers) {
+            m_commandBuffers.emplace_back(queueFamilyIndex, commandBuffer);
+            return;
+        }
+
+        if (m_vkDestroyCommandPool)
+            m_vkDestroyCommandPool(m_vkDevice, commandBuffer.commandPool, nullptr);
+    }
+}
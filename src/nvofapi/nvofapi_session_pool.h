@@ -0,0 +1,74 @@
+#pragma once
+
+#include "../nvofapi_private.h"
+
+namespace dxvk {
+    // Optical flow sessions and command buffers that outlive the instance or session that created them.
+    // Shared by all instances on the same VkDevice. D3D12 instances keep it alive until the D3D12 device
+    // and with it the VkDevice gets destroyed. For Vulkan instances nothing tells us when the application
+    // destroys its device and the handle value may get reused afterwards, so the last of them destroys it.
+    class NvOFSessionPool {
+
+      public:
+        // Idle sessions kept per device, the least recently released one is destroyed first
+        static constexpr size_t maxSessions = 4;
+        // Idle command buffers kept per device, matches the growth limit of a single Vulkan instance
+        static constexpr size_t maxCommandBuffers = 64;
+
+        // Everything that was passed to vkCreateOpticalFlowSessionNV, sessions with private data are never pooled
+        struct SessionKey {
+            uint32_t width;
+            uint32_t height;
+            VkFormat imageFormat;
+            VkFormat flowVectorFormat;
+            VkFormat costFormat;
+            VkOpticalFlowGridSizeFlagsNV outputGridSize;
+            VkOpticalFlowGridSizeFlagsNV hintGridSize;
+            VkOpticalFlowPerformanceLevelNV performanceLevel;
+            VkOpticalFlowSessionCreateFlagsNV flags;
+
+            bool operator==(const SessionKey&) const = default;
+        };
+
+        struct CommandBuffer {
+            VkCommandPool commandPool;
+            VkCommandBuffer commandBuffer;
+        };
+
+        [[nodiscard]] static SessionKey GetSessionKey(const VkOpticalFlowSessionCreateInfoNV& createInfo);
+
+        // Returns the pool of the device, missing destroy functions are taken over from the caller
+        static std::shared_ptr<NvOFSessionPool> Get(VkDevice device, PFN_vkDestroyOpticalFlowSessionNV destroySession, PFN_vkDestroyCommandPool destroyCommandPool);
+
+        explicit NvOFSessionPool(VkDevice device) : m_vkDevice(device) {}
+        ~NvOFSessionPool();
+
+        NvOFSessionPool(const NvOFSessionPool&) = delete;
+        NvOFSessionPool& operator=(const NvOFSessionPool&) = delete;
+
+        // Returns an idle session created with the same parameters, or VK_NULL_HANDLE
+        VkOpticalFlowSessionNV AcquireSession(const SessionKey& key);
+
+        // Takes ownership of a session that the GPU no longer uses
+        void ReleaseSession(const SessionKey& key, VkOpticalFlowSessionNV session);
+
+        // Returns an idle command buffer of the queue family, its pool still needs to be reset before recording
+        std::optional<CommandBuffer> AcquireCommandBuffer(uint32_t queueFamilyIndex);
+
+        // Takes ownership of a command buffer that the GPU no longer uses
+        void ReleaseCommandBuffer(uint32_t queueFamilyIndex, CommandBuffer commandBuffer);
+
+      private:
+        VkDevice m_vkDevice{};
+        PFN_vkDestroyOpticalFlowSessionNV m_vkDestroyOpticalFlowSessionNV{};
+        PFN_vkDestroyCommandPool m_vkDestroyCommandPool{};
+
+        std::mutex m_mutex;
+        // Ordered from least to most recently released
+        std::vector<std::pair<SessionKey, VkOpticalFlowSessionNV>> m_sessions;
+        std::vector<std::pair<uint32_t, CommandBuffer>> m_commandBuffers;
+
+        static std::mutex s_poolsMutex;
+        static std::unordered_map<VkDevice, std::weak_ptr<NvOFSessionPool>> s_pools;
+    };
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "../nvofapi_private.h"
+
+#include <atomic>
+
+namespace dxvk {
+    // Bounded single producer, single consumer ring. Items are written and read in place, so members
+    // like vectors keep their capacity when a slot is reused. Full and empty states block on the indices.
+    template <typename T, size_t Capacity>
+    class NvOFSpscQueue {
+        static_assert(Capacity && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+      public:
+        // Producer: returns the next free slot, waits for the consumer while the ring is full
+        T& Back() {
+            auto tail = m_tail.load(std::memory_order_relaxed);
+            for (auto head = m_head.load(std::memory_order_acquire); tail - head == Capacity; head = m_head.load(std::memory_order_acquire))
+                m_head.wait(head, std::memory_order_acquire);
+
+            return m_items[tail & (Capacity - 1)];
+        }
+
+        // Producer: publishes the slot returned by Back()
+        void Push() {
+            m_tail.fetch_add(1, std::memory_order_release);
+            m_tail.notify_one();
+        }
+
+        // Producer: waits until the consumer has popped every published slot
+        void WaitEmpty() {
+            auto tail = m_tail.load(std::memory_order_relaxed);
+            for (auto head = m_head.load(std::memory_order_acquire); head != tail; head = m_head.load(std::memory_order_acquire))
+                m_head.wait(head, std::memory_order_acquire);
+        }
+
+        // Consumer: returns the oldest published slot, waits for the producer while the ring is empty
+        T& Front() {
+            auto head = m_head.load(std::memory_order_relaxed);
+            for (auto tail = m_tail.load(std::memory_order_acquire); tail == head; tail = m_tail.load(std::memory_order_acquire))
+                m_tail.wait(tail, std::memory_order_acquire);
+
+            return m_items[head & (Capacity - 1)];
+        }
+
+        // Consumer: hands the slot returned by Front() back to the producer
+        void Pop() {
+            m_head.fetch_add(1, std::memory_order_release);
+            m_head.notify_one();
+        }
+
+      private:
+        std::array<T, Capacity> m_items{};
+
+        // Both indices only ever grow, their difference is the number of published slots
+        alignas(64) std::atomic<size_t> m_head{0};
+        alignas(64) std::atomic<size_t> m_tail{0};
+    };
+}
@@ -26,6 +26,23 @@
 
 namespace dxvk {
 
+    NvOFInstanceVk::~NvOFInstanceVk() {
+        // Command pools and the session must not be destroyed or reused while the GPU still uses them
+        auto idle = WaitIdle();
+        ReleaseSession(idle);
+
+        // Idle command buffers are kept for the next instance on this device, destroying a pool frees its command buffers
+        for (auto& slot : m_commandSlots) {
+            if (idle && m_sessionPool && slot.commandBuffer)
+                m_sessionPool->ReleaseCommandBuffer(m_queueFamilyIndex, {slot.commandPool, slot.commandBuffer});
+            else if (m_vkDestroyCommandPool)
+                m_vkDestroyCommandPool(m_vkDevice, slot.commandPool, nullptr);
+        }
+
+        if (m_vkDestroySemaphore)
+            m_vkDestroySemaphore(m_vkDevice, m_timeline, nullptr);
+    }
+
     bool NvOFInstanceVk::Initialize() {
         // For Vulkan we cannot load `winevulkan.dll` directly, or we may break handle opacity
         m_vk = m_resourceFactory.CreateVulkan("vulkan-1.dll");
@@ -41,6 +58,7 @@ namespace dxvk {
 #define VK_GET_INSTANCE_PROC_ADDR(proc) m_##proc = reinterpret_cast<PFN_##proc>(m_vk->GetInstanceProcAddr(m_vkInstance, #proc))
 
         VK_GET_INSTANCE_PROC_ADDR(vkGetPhysicalDeviceQueueFamilyProperties);
+        VK_GET_INSTANCE_PROC_ADDR(vkGetPhysicalDeviceOpticalFlowImageFormatsNV);
 
 #define VK_GET_DEVICE_PROC_ADDR(proc) m_##proc = reinterpret_cast<PFN_##proc>(m_vk->GetDeviceProcAddr(m_vkDevice, #proc))
 
@@ -50,13 +68,18 @@ namespace dxvk {
         VK_GET_DEVICE_PROC_ADDR(vkGetDeviceQueue);
         VK_GET_DEVICE_PROC_ADDR(vkCreateCommandPool);
         VK_GET_DEVICE_PROC_ADDR(vkDestroyCommandPool);
+        VK_GET_DEVICE_PROC_ADDR(vkResetCommandPool);
         VK_GET_DEVICE_PROC_ADDR(vkAllocateCommandBuffers);
         VK_GET_DEVICE_PROC_ADDR(vkQueueSubmit2);
 
-        VK_GET_DEVICE_PROC_ADDR(vkResetCommandBuffer);
         VK_GET_DEVICE_PROC_ADDR(vkBeginCommandBuffer);
         VK_GET_DEVICE_PROC_ADDR(vkEndCommandBuffer);
 
+        VK_GET_DEVICE_PROC_ADDR(vkCreateSemaphore);
+        VK_GET_DEVICE_PROC_ADDR(vkDestroySemaphore);
+        VK_GET_DEVICE_PROC_ADDR(vkGetSemaphoreCounterValue);
+        VK_GET_DEVICE_PROC_ADDR(vkWaitSemaphores);
+
         // Get NvapiAdapter from the vkPhysicalDevice
         // Populate the optical flow related info here
         // fail to create if optical flow extension is unsupported
@@ -71,48 +94,141 @@ namespace dxvk {
             return false;
         }
 
+        if (!m_vkGetPhysicalDeviceQueueFamilyProperties || !m_vk->GetDeviceExtensions(m_vkInstance, m_vkPhysicalDevice).contains(VK_NV_OPTICAL_FLOW_EXTENSION_NAME)) {
+            log::info("Initializing NVOFAPI failed: VK_NV_optical_flow is not supported by the physical device");
+            return false;
+        }
+
+        if (NvOFDiagnostics::IsEnabled())
+            m_diagnostics = std::make_unique<NvOFDiagnostics>("VK");
+
+        m_vkOpticalFlowProperties = GetVkOpticalFlowProperties();
+        m_sessionPool = NvOFSessionPool::Get(m_vkDevice, m_vkDestroyOpticalFlowSessionNV, m_vkDestroyCommandPool);
+
         // Get the OFA queue
+        auto queueFamilyIndex = GetVkOFAQueue();
+        if (!queueFamilyIndex) {
+            log::info("Initializing NVOFAPI failed: no queue family supports optical flow");
+            return false;
+        }
+
+        m_queueFamilyIndex = *queueFamilyIndex;
+        m_vkGetDeviceQueue(m_vkDevice, m_queueFamilyIndex, 0, &m_queue);
+
+        // Submissions signal this timeline semaphore, so that command buffers are only reused once the GPU is done with them
+        VkSemaphoreTypeCreateInfo semaphoreTypeInfo{};
+        semaphoreTypeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+        semaphoreTypeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+        semaphoreTypeInfo.initialValue = m_timelineValue;
+
+        VkSemaphoreCreateInfo semaphoreInfo{};
+        semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        semaphoreInfo.pNext = &semaphoreTypeInfo;
+
+        if (m_vkCreateSemaphore(m_vkDevice, &semaphoreInfo, nullptr, &m_timeline) != VK_SUCCESS) {
+            log::info("Failed to create timeline semaphore for optical flow command buffer tracking");
+            return false;
+        }
+
+        m_commandSlots.reserve(maxCommandSlots);
+        for (uint32_t i = 0; i < CMDS_IN_FLIGHT; i++) {
+            if (!CreateCommandSlot(m_commandSlots.emplace_back()))
+                return false;
+        }
+
+        return true;
+    }
+
+    bool NvOFInstanceVk::CreateCommandSlot(CommandSlot& slot) const {
+        if (auto commandBuffer = m_sessionPool->AcquireCommandBuffer(m_queueFamilyIndex)) {
+            slot.commandPool = commandBuffer->commandPool;
+            slot.commandBuffer = commandBuffer->commandBuffer;
+            return true;
+        }
+
         VkCommandPoolCreateInfo createInfo{};
         createInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-        createInfo.queueFamilyIndex = GetVkOFAQueue();
-        createInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-        m_vkGetDeviceQueue(m_vkDevice, createInfo.queueFamilyIndex, 0, &m_queue);
+        createInfo.queueFamilyIndex = m_queueFamilyIndex;
+        createInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
 
-        if (m_vkCreateCommandPool(m_vkDevice, &createInfo, nullptr, &m_commandPool)
-            != VK_SUCCESS) {
+        if (m_vkCreateCommandPool(m_vkDevice, &createInfo, nullptr, &slot.commandPool) != VK_SUCCESS)
             return false;
-        }
 
-        // ALlocate command buffers
         VkCommandBufferAllocateInfo allocInfo{};
         allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-        allocInfo.commandPool = m_commandPool;
+        allocInfo.commandPool = slot.commandPool;
         allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-        allocInfo.commandBufferCount = CMDS_IN_FLIGHT; // more than enough for anybody ;)
-        if (m_vkAllocateCommandBuffers(m_vkDevice, &allocInfo, m_commandBuffers.data())
-            != VK_SUCCESS) {
-            return false;
+        allocInfo.commandBufferCount = 1;
+
+        return m_vkAllocateCommandBuffers(m_vkDevice, &allocInfo, &slot.commandBuffer) == VK_SUCCESS;
+    }
+
+    NvOFInstanceVk::CommandSlot* NvOFInstanceVk::AcquireCommandSlot() {
+        // Slots are used in submission order, so the next slot is always the one that was submitted longest ago
+        auto slot = &m_commandSlots[m_commandSlotIndex];
+
+        uint64_t completed = 0;
+        if (m_vkGetSemaphoreCounterValue(m_vkDevice, m_timeline, &completed) != VK_SUCCESS)
+            return nullptr;
+
+        if (completed < slot->submitValue) {
+            if (m_commandSlots.size() < maxCommandSlots) {
+                // All slots are in flight, grow the ring in front of the oldest slot to keep the submission order intact
+                CommandSlot newSlot{};
+                if (!CreateCommandSlot(newSlot))
+                    return nullptr;
+
+                return &*m_commandSlots.insert(m_commandSlots.begin() + static_cast<ptrdiff_t>(m_commandSlotIndex), newSlot);
+            }
+
+            VkSemaphoreWaitInfo waitInfo{};
+            waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+            waitInfo.semaphoreCount = 1;
+            waitInfo.pSemaphores = &m_timeline;
+            waitInfo.pValues = &slot->submitValue;
+
+            if (m_vkWaitSemaphores(m_vkDevice, &waitInfo, UINT64_MAX) != VK_SUCCESS)
+                return nullptr;
         }
 
-        return true;
+        if (m_vkResetCommandPool(m_vkDevice, slot->commandPool, 0) != VK_SUCCESS)
+            return nullptr;
+
+        return slot;
+    }
+
+    bool NvOFInstanceVk::WaitIdle() const {
+        if (!m_timeline || !m_timelineValue)
+            return true;
+
+        if (!m_vkWaitSemaphores)
+            return false;
+
+        VkSemaphoreWaitInfo waitInfo{};
+        waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+        waitInfo.semaphoreCount = 1;
+        waitInfo.pSemaphores = &m_timeline;
+        waitInfo.pValues = &m_timelineValue;
+
+        return m_vkWaitSemaphores(m_vkDevice, &waitInfo, UINT64_MAX) == VK_SUCCESS;
     }
 
     bool NvOFInstanceVk::Execute(const NV_OF_EXECUTE_INPUT_PARAMS_VK* inParams, NV_OF_EXECUTE_OUTPUT_PARAMS_VK* outParams) {
         VkResult status = VK_SUCCESS;
 
-        log::info(
-            str::format("OFExecuteVK params:",
-                " inputFrame: ", inParams->inputFrame,
-                " referenceFrame: ", inParams->referenceFrame,
-                " externalHints: ", inParams->externalHints,
-                " disableTemporalHints: ", inParams->disableTemporalHints,
-                " hPrivData: ", inParams->hPrivData,
-                " numRois: ", inParams->numRois,
-                " roiData: ", inParams->roiData,
-                " numWaitSync: ", inParams->numWaitSyncs,
-                " pWaitSyncs: ", inParams->pWaitSyncs));
-
-        auto waitSyncs = std::vector<VkSemaphoreSubmitInfo>(inParams->numWaitSyncs);
+        if (m_diagnostics)
+            m_diagnostics->Execute(NvOFDiagnostics::GetExecuteParams(inParams, outParams, inParams->numWaitSyncs, outParams->pSignalSync != nullptr));
+
+        if (inParams->numRois > MAX_ROIS)
+            return false;
+
+        std::array<VkSemaphoreSubmitInfo, MAX_INLINE_WAIT_SYNCS> inlineWaitSyncs{};
+        auto waitSyncs = inlineWaitSyncs.data();
+        if (inParams->numWaitSyncs > inlineWaitSyncs.size()) {
+            m_waitSyncOverflow.resize(inParams->numWaitSyncs);
+            waitSyncs = m_waitSyncOverflow.data();
+        }
+
         for (uint32_t i = 0; i < inParams->numWaitSyncs; i++) {
             waitSyncs[i].sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
             waitSyncs[i].semaphore = inParams->pWaitSyncs[i].semaphore;
@@ -120,42 +236,59 @@ namespace dxvk {
             waitSyncs[i].stageMask = VK_PIPELINE_STAGE_2_OPTICAL_FLOW_BIT_NV;
         }
 
-        VkSemaphoreSubmitInfo signalSync{};
-        signalSync.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+        if (BindImagesToSession(inParams, outParams) != NV_OF_SUCCESS)
+            return false;
+
+        auto slot = AcquireCommandSlot();
+        if (!slot)
+            return false;
+
+        std::array<VkSemaphoreSubmitInfo, 2> signalSyncs{};
+        uint32_t signalSyncCount = 0;
+
         if (outParams->pSignalSync) {
+            auto& signalSync = signalSyncs[signalSyncCount++];
+            signalSync.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
             signalSync.semaphore = outParams->pSignalSync->semaphore;
             signalSync.value = outParams->pSignalSync->value;
             signalSync.stageMask = VK_PIPELINE_STAGE_2_OPTICAL_FLOW_BIT_NV;
         }
 
+        auto& timelineSync = signalSyncs[signalSyncCount++];
+        timelineSync.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+        timelineSync.semaphore = m_timeline;
+        timelineSync.value = m_timelineValue + 1;
+        timelineSync.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+
         VkCommandBufferSubmitInfo cmdbufInfo{};
         cmdbufInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
-        cmdbufInfo.commandBuffer = m_commandBuffers[m_cmdBufIndex];
+        cmdbufInfo.commandBuffer = slot->commandBuffer;
         cmdbufInfo.deviceMask = 1;
 
         VkCommandBufferBeginInfo begInfo{};
         begInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-        m_vkResetCommandBuffer(m_commandBuffers[m_cmdBufIndex], 0);
-        m_vkBeginCommandBuffer(m_commandBuffers[m_cmdBufIndex], &begInfo);
+        begInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        m_vkBeginCommandBuffer(slot->commandBuffer, &begInfo);
 
-        RecordCmdBuf(inParams, outParams, m_commandBuffers[m_cmdBufIndex]);
+        RecordCmdBuf(inParams, slot->commandBuffer);
 
-        m_vkEndCommandBuffer(m_commandBuffers[m_cmdBufIndex]);
+        m_vkEndCommandBuffer(slot->commandBuffer);
 
         VkSubmitInfo2 submit{};
         submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
-        submit.waitSemaphoreInfoCount = waitSyncs.size();
-        submit.pWaitSemaphoreInfos = waitSyncs.data();
+        submit.waitSemaphoreInfoCount = inParams->numWaitSyncs;
+        submit.pWaitSemaphoreInfos = waitSyncs;
         submit.commandBufferInfoCount = 1;
         submit.pCommandBufferInfos = &cmdbufInfo;
-        submit.signalSemaphoreInfoCount = outParams->pSignalSync ? 1 : 0;
-        submit.pSignalSemaphoreInfos = &signalSync;
+        submit.signalSemaphoreInfoCount = signalSyncCount;
+        submit.pSignalSemaphoreInfos = signalSyncs.data();
 
         status = m_vkQueueSubmit2(m_queue, 1, &submit, VK_NULL_HANDLE);
 
-        m_cmdBufIndex++;
-        if (m_cmdBufIndex >= CMDS_IN_FLIGHT)
-            m_cmdBufIndex = 0;
+        if (status == VK_SUCCESS) {
+            slot->submitValue = ++m_timelineValue;
+            m_commandSlotIndex = (m_commandSlotIndex + 1) % m_commandSlots.size();
+        }
 
         return status == VK_SUCCESS;
     }
@@ -28,40 +28,57 @@
 #include "nvofapi_instance.h"
 
 namespace dxvk {
-    class NvOFInstanceVk final : public NvOFInstance {
+    class NvOFInstanceVk : public NvOFInstance {
 
       public:
         NvOFInstanceVk(ResourceFactory& resourceFactory, VkInstance vkInstance, VkPhysicalDevice vkPhysicalDevice, VkDevice vkDevice)
             : NvOFInstance(resourceFactory, vkInstance, vkPhysicalDevice, vkDevice) {}
 
-        ~NvOFInstanceVk() override {
-            // free cmdbuffers
-            if (m_vkFreeCommandBuffers)
-                m_vkFreeCommandBuffers(m_vkDevice, m_commandPool, CMDS_IN_FLIGHT, m_commandBuffers.data());
-            if (m_vkDestroyCommandPool)
-                m_vkDestroyCommandPool(m_vkDevice, m_commandPool, nullptr);
-        }
+        ~NvOFInstanceVk() override;
 
         bool Initialize();
 
         bool Execute(const NV_OF_EXECUTE_INPUT_PARAMS_VK* inParams, NV_OF_EXECUTE_OUTPUT_PARAMS_VK* outParams);
 
-      private:
+      protected:
+        // Upper bound for the number of command buffers in flight, Execute waits for the oldest one when reached
+        static constexpr size_t maxCommandSlots = 64;
+
+        // Every slot has its own pool, resetting the pool is cheaper than resetting individual command buffers
+        struct CommandSlot {
+            VkCommandPool commandPool;
+            VkCommandBuffer commandBuffer;
+            uint64_t submitValue; // timeline value that signals completion of the last submission
+        };
+
         VkQueue m_queue{};
-        VkCommandPool m_commandPool{};
+        uint32_t m_queueFamilyIndex{};
+
+        std::vector<CommandSlot> m_commandSlots{};
+        size_t m_commandSlotIndex{0};
+
+        std::vector<VkSemaphoreSubmitInfo> m_waitSyncOverflow{};
+
+        VkSemaphore m_timeline{};
+        uint64_t m_timelineValue{0};
+
         PFN_vkCreateCommandPool m_vkCreateCommandPool{};
         PFN_vkDestroyCommandPool m_vkDestroyCommandPool{};
-        std::array<VkCommandBuffer, CMDS_IN_FLIGHT> m_commandBuffers{};
-
+        PFN_vkResetCommandPool m_vkResetCommandPool{};
         PFN_vkAllocateCommandBuffers m_vkAllocateCommandBuffers{};
-        PFN_vkFreeCommandBuffers m_vkFreeCommandBuffers{};
-
-        uint32_t m_cmdBufIndex{0};
-        PFN_vkResetCommandBuffer m_vkResetCommandBuffer{};
         PFN_vkBeginCommandBuffer m_vkBeginCommandBuffer{};
         PFN_vkEndCommandBuffer m_vkEndCommandBuffer{};
 
+        PFN_vkCreateSemaphore m_vkCreateSemaphore{};
+        PFN_vkDestroySemaphore m_vkDestroySemaphore{};
+        PFN_vkGetSemaphoreCounterValue m_vkGetSemaphoreCounterValue{};
+        PFN_vkWaitSemaphores m_vkWaitSemaphores{};
+
         PFN_vkGetDeviceQueue m_vkGetDeviceQueue{};
         PFN_vkQueueSubmit2 m_vkQueueSubmit2{};
+
+        bool CreateCommandSlot(CommandSlot& slot) const;
+        CommandSlot* AcquireCommandSlot();
+        [[nodiscard]] bool WaitIdle() const override;
     };
 }
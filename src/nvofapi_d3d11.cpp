@@ -1,14 +1,172 @@
 #include "nvofapi_private.h"
+#include "nvofapi_globals.h"
+#include "nvofapi/nvofapi_image.h"
+#include "nvofapi/nvofapi_d3d11_instance.h"
+#include "util/util_env.h"
 #include "util/util_log.h"
+#include "util/util_string.h"
 #include "util/util_statuscode.h"
+#include "../version.h"
+#include "../config.h"
+
+static auto initializationMutex = std::mutex{};
 
 using namespace dxvk;
 
+// D3D11 entrypoints
+NVOFAPI_FUNCTION CreateOpticalFlowD3D11(ID3D11Device* pD3D11Device, ID3D11DeviceContext* pD3D11DeviceContext, NvOFHandle* hOFInstance) {
+    constexpr auto n = __func__;
+
+    if (log::tracing())
+        log::trace(n, log::fmt::ptr(pD3D11Device), log::fmt::ptr(pD3D11DeviceContext), log::fmt::ptr(hOFInstance));
+
+    if (!pD3D11Device || !hOFInstance)
+        return InvalidPtr(n);
+
+    std::scoped_lock lock(initializationMutex);
+    if (resourceFactory == nullptr)
+        resourceFactory = std::make_unique<ResourceFactory>();
+
+    NvOFInstanceD3D11* nvOF = nullptr;
+    try {
+        nvOF = new NvOFInstanceD3D11(*resourceFactory, pD3D11Device);
+    } catch (std::exception const& e) {
+        log::info(str::format("CreateOpticalFlowD3D11 exception, ", e.what()));
+        return ErrorGeneric(n);
+    }
+
+    if (!nvOF->Initialize()) {
+        delete nvOF;
+        return ErrorGeneric(n);
+    }
+
+    *hOFInstance = reinterpret_cast<NvOFHandle>(nvOF);
+    return Success(n);
+}
+
+NVOFAPI_FUNCTION GetSurfaceFormatCountD3D11(NvOFHandle hOf, const NV_OF_BUFFER_USAGE bufferUsage, const NV_OF_MODE ofMode, uint32_t* const pCount) {
+    constexpr auto n = __func__;
+
+    if (log::tracing())
+        log::trace(n, log::fmt::hnd(hOf), bufferUsage, ofMode, log::fmt::ptr(pCount));
+
+    auto nvOF = reinterpret_cast<NvOFInstanceD3D11*>(hOf);
+
+    if (!nvOF)
+        return ErrorGeneric(n);
+
+    if (!pCount)
+        return InvalidPtr(n);
+
+    *pCount = nvOF->GetDxgiSurfaceFormats(bufferUsage, ofMode).size();
+    return Success(n);
+}
+
+NVOFAPI_FUNCTION GetSurfaceFormatD3D11(NvOFHandle hOf, const NV_OF_BUFFER_USAGE bufferUsage, const NV_OF_MODE ofMode, DXGI_FORMAT* const pFormat) {
+    constexpr auto n = __func__;
+
+    if (log::tracing())
+        log::trace(n, log::fmt::hnd(hOf), bufferUsage, ofMode, log::fmt::ptr(pFormat));
+
+    auto nvOF = reinterpret_cast<NvOFInstanceD3D11*>(hOf);
+
+    if (!nvOF)
+        return ErrorGeneric(n);
+
+    if (!pFormat)
+        return InvalidPtr(n);
+
+    const auto& formats = nvOF->GetDxgiSurfaceFormats(bufferUsage, ofMode);
+    if (formats.empty())
+        return ErrorGeneric(n);
+
+    std::ranges::copy(formats, pFormat);
+    return Success(n);
+}
+
+NVOFAPI_FUNCTION RegisterResourceD3D11(NvOFHandle hOf, ID3D11Resource* pResource, NvOFGPUBufferHandle* const hOFGpuBuffer) {
+    constexpr auto n = __func__;
+
+    if (log::tracing())
+        log::trace(n, log::fmt::hnd(hOf), log::fmt::ptr(pResource), log::fmt::ptr(hOFGpuBuffer));
+
+    auto nvOF = reinterpret_cast<NvOFInstanceD3D11*>(hOf);
+
+    if (!nvOF)
+        return ErrorGeneric(n);
+
+    if (!pResource || !hOFGpuBuffer)
+        return InvalidPtr(n);
+
+    if (!nvOF->RegisterBuffer(pResource, hOFGpuBuffer))
+        return ErrorGeneric(n);
+
+    return Success(n);
+}
+
+NVOFAPI_FUNCTION UnregisterResourceD3D11(NvOFGPUBufferHandle hOFGpuBuffer) {
+    constexpr auto n = __func__;
+
+    if (log::tracing())
+        log::trace(n, log::fmt::hnd(hOFGpuBuffer));
+
+    auto nvRes = reinterpret_cast<NvOFImage*>(hOFGpuBuffer);
+    if (nvRes)
+        nvRes->Release();
+
+    return Success(n);
+}
+
+NVOFAPI_FUNCTION ExecuteD3D11(NvOFHandle hOf, const NV_OF_EXECUTE_INPUT_PARAMS* executeInParams, NV_OF_EXECUTE_OUTPUT_PARAMS* executeOutParams) {
+    constexpr auto n = __func__;
+    thread_local bool alreadyLoggedOk = false;
+
+    if (log::tracing())
+        log::trace(n, log::fmt::hnd(hOf), log::fmt::ptr(executeInParams), log::fmt::ptr(executeOutParams));
+
+    auto nvOF = reinterpret_cast<NvOFInstanceD3D11*>(hOf);
+
+    if (!nvOF)
+        return ErrorGeneric(n);
+
+    if (nvOF->Execute(executeInParams, executeOutParams))
+        return Success(n, alreadyLoggedOk);
+
+    return ErrorGeneric(n);
+}
+
+// ETBLs
 NVOFAPI_FUNCTION NvOFAPICreateInstanceD3D11(uint32_t apiVer, NV_OF_D3D11_API_FUNCTION_LIST* functionList) {
+    uint32_t apiVerMajor = (apiVer & 0xfffffff0) >> 4;
+    uint32_t apiVerMinor = (apiVer & 0xf);
     constexpr auto n = __func__;
 
     if (log::tracing())
         log::trace(n, apiVer, log::fmt::ptr(functionList));
 
-    return OFNotAvailable(n);
+    log::info(str::format(
+        "DXVK-NVAPI ", DXVK_NVAPI_VERSION,
+        " NVOFAPI/D3D11",
+        " ", DXVK_NVAPI_BUILD_COMPILER,
+        " ", DXVK_NVAPI_BUILD_COMPILER_VERSION,
+        " ", DXVK_NVAPI_BUILD_TARGET,
+        " ", DXVK_NVAPI_BUILD_TYPE,
+        " (", env::getExecutableName(), ")"));
+    log::info(str::format("OFAPI Client Version: ", apiVerMajor, ".", apiVerMinor));
+
+    if (apiVerMajor != 5)
+        return InvalidVersion(n);
+
+    functionList->nvCreateOpticalFlowD3D11 = CreateOpticalFlowD3D11;
+    functionList->nvOFInit = OFSessionInit;
+    functionList->nvOFGetSurfaceFormatCountD3D11 = GetSurfaceFormatCountD3D11;
+    functionList->nvOFGetSurfaceFormatD3D11 = GetSurfaceFormatD3D11;
+    functionList->nvOFRegisterResourceD3D11 = RegisterResourceD3D11;
+    functionList->nvOFUnregisterResourceD3D11 = UnregisterResourceD3D11;
+    functionList->nvOFExecute = ExecuteD3D11;
+    functionList->nvOFDestroy = OFSessionDestroy;
+    functionList->nvOFGetLastError = OFSessionGetLastError;
+    functionList->nvOFGetCaps = OFSessionGetCaps;
+
+    return Success(n);
 }
@@ -70,7 +70,15 @@ NVOFAPI_FUNCTION GetSurfaceFormatCountD3D12(NvOFHandle hOf, const NV_OF_BUFFER_U
     if (log::tracing())
         log::trace(n, log::fmt::hnd(hOf), bufferUsage, ofMode, log::fmt::ptr(pCount));
 
-    *pCount = 1;
+    auto nvOF = reinterpret_cast<NvOFInstanceD3D12*>(hOf);
+
+    if (!nvOF)
+        return ErrorGeneric(n);
+
+    if (!pCount)
+        return InvalidPtr(n);
+
+    *pCount = nvOF->GetDxgiSurfaceFormats(bufferUsage, ofMode).size();
     return Success(n);
 }
 
@@ -80,10 +88,19 @@ NVOFAPI_FUNCTION GetSurfaceFormatD3D12(NvOFHandle hOf, const NV_OF_BUFFER_USAGE
     if (log::tracing())
         log::trace(n, log::fmt::hnd(hOf), bufferUsage, ofMode, log::fmt::ptr(pFormat));
 
-    if (bufferUsage == NV_OF_BUFFER_USAGE_INPUT)
-        *pFormat = DXGI_FORMAT_R8_UNORM;
-    else
-        *pFormat = DXGI_FORMAT_R16G16_SINT;
+    auto nvOF = reinterpret_cast<NvOFInstanceD3D12*>(hOf);
+
+    if (!nvOF)
+        return ErrorGeneric(n);
+
+    if (!pFormat)
+        return InvalidPtr(n);
+
+    const auto& formats = nvOF->GetDxgiSurfaceFormats(bufferUsage, ofMode);
+    if (formats.empty())
+        return ErrorGeneric(n);
+
+    std::ranges::copy(formats, pFormat);
     return Success(n);
 }
 
@@ -95,7 +112,9 @@ NVOFAPI_FUNCTION RegisterResourceD3D12(NvOFHandle hOf, NV_OF_REGISTER_RESOURCE_P
 
     auto nvOF = reinterpret_cast<NvOFInstanceD3D12*>(hOf);
 
-    nvOF->RegisterBuffer(registerParams);
+    if (!nvOF->RegisterBuffer(registerParams))
+        return ErrorGeneric(n);
+
     return Success(n);
 }
 
@@ -106,7 +125,9 @@ NVOFAPI_FUNCTION UnregisterResourceD3D12(NV_OF_UNREGISTER_RESOURCE_PARAMS_D3D12*
         log::trace(n, log::fmt::ptr(registerParams));
 
     auto nvRes = reinterpret_cast<NvOFImage*>(registerParams->hOFGpuBuffer);
-    delete nvRes;
+    if (nvRes)
+        nvRes->Release();
+
     return Success(n);
 }
 
@@ -119,8 +140,10 @@ NVOFAPI_FUNCTION ExecuteD3D12(NvOFHandle hOf, const NV_OF_EXECUTE_INPUT_PARAMS_D
 
     auto nvOF = reinterpret_cast<NvOFInstanceD3D12*>(hOf);
 
-    nvOF->Execute(executeInParams, executeOutParams);
-    return Success(n, alreadyLoggedOk);
+    if (nvOF->Execute(executeInParams, executeOutParams))
+        return Success(n, alreadyLoggedOk);
+
+    return ErrorGeneric(n);
 }
 
 // ETBLs
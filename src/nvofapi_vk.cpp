@@ -64,7 +64,16 @@ NVOFAPI_FUNCTION GetSurfaceFormatCountVk(NvOFHandle hOf, const NV_OF_BUFFER_USAG
     if (log::tracing())
         log::trace(n, log::fmt::hnd(hOf), bufferUsage, ofMode, log::fmt::ptr(pCount));
 
-    return ErrorGeneric(n);
+    auto nvOF = reinterpret_cast<NvOFInstanceVk*>(hOf);
+
+    if (!nvOF)
+        return ErrorGeneric(n);
+
+    if (!pCount)
+        return InvalidPtr(n);
+
+    *pCount = nvOF->GetSurfaceFormats(bufferUsage, ofMode).size();
+    return Success(n);
 }
 
 NVOFAPI_FUNCTION GetSurfaceFormatVk(NvOFHandle hOf, const NV_OF_BUFFER_USAGE bufferUsage, const NV_OF_MODE ofMode, VkFormat* const pFormat) {
@@ -73,7 +82,20 @@ NVOFAPI_FUNCTION GetSurfaceFormatVk(NvOFHandle hOf, const NV_OF_BUFFER_USAGE buf
     if (log::tracing())
         log::trace(n, log::fmt::hnd(hOf), bufferUsage, ofMode, log::fmt::ptr(pFormat));
 
-    return ErrorGeneric(n);
+    auto nvOF = reinterpret_cast<NvOFInstanceVk*>(hOf);
+
+    if (!nvOF)
+        return ErrorGeneric(n);
+
+    if (!pFormat)
+        return InvalidPtr(n);
+
+    const auto& formats = nvOF->GetSurfaceFormats(bufferUsage, ofMode);
+    if (formats.empty())
+        return ErrorGeneric(n);
+
+    std::ranges::copy(formats, pFormat);
+    return Success(n);
 }
 
 NVOFAPI_FUNCTION RegisterResourceVk(NvOFHandle hOf, NV_OF_REGISTER_RESOURCE_PARAMS_VK* registerParams) {
@@ -83,7 +105,9 @@ NVOFAPI_FUNCTION RegisterResourceVk(NvOFHandle hOf, NV_OF_REGISTER_RESOURCE_PARA
         log::trace(n, log::fmt::hnd(hOf), log::fmt::ptr(registerParams));
 
     auto nvOF = reinterpret_cast<NvOFInstanceVk*>(hOf);
-    nvOF->RegisterBuffer(registerParams);
+    if (!nvOF->RegisterBuffer(registerParams))
+        return ErrorGeneric(n);
+
     return Success(n);
 }
 
@@ -94,8 +118,10 @@ NVOFAPI_FUNCTION UnregisterResourceVk(NV_OF_UNREGISTER_RESOURCE_PARAMS_VK* regis
         log::trace(n, log::fmt::ptr(registerParams));
 
     auto nvRes = reinterpret_cast<NvOFImage*>(registerParams->hOFGpuBuffer);
-    delete nvRes;
-    return ErrorGeneric(n);
+    if (nvRes)
+        nvRes->Release();
+
+    return Success(n);
 }
 
 NVOFAPI_FUNCTION ExecuteVk(NvOFHandle hOf, const NV_OF_EXECUTE_INPUT_PARAMS_VK* executeInParams, NV_OF_EXECUTE_OUTPUT_PARAMS_VK* executeOutParams) {
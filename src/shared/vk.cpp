@@ -33,14 +33,14 @@ namespace dxvk {
         return m_vkGetDeviceProcAddr(vkDevice, name);
     }
 
-    std::set<std::string> Vk::GetDeviceExtensions(VkInstance vkInstance, VkPhysicalDevice vkDevice) const {
+    std::map<std::string, uint32_t> Vk::GetDeviceExtensions(VkInstance vkInstance, VkPhysicalDevice vkDevice) const {
         auto vkEnumerateDeviceExtensionProperties =
             GetInstanceProcAddress<PFN_vkEnumerateDeviceExtensionProperties>(
                 vkInstance, "vkEnumerateDeviceExtensionProperties");
 
-        std::set<std::string> deviceExtensions;
+        std::map<std::string, uint32_t> deviceExtensions;
 
-        // Grab last of valid extensions for this device
+        // Grab list of valid extensions for this device together with their spec versions
         auto count = 0U;
         if (vkEnumerateDeviceExtensionProperties(vkDevice, nullptr, &count, nullptr) != VK_SUCCESS)
             return deviceExtensions;
@@ -50,7 +50,7 @@ namespace dxvk {
             return deviceExtensions;
 
         for (const auto& extension : extensions)
-            deviceExtensions.insert(std::string(extension.extensionName));
+            deviceExtensions.emplace(extension.extensionName, extension.specVersion);
 
         return deviceExtensions;
     }
@@ -16,7 +16,7 @@ namespace dxvk {
         [[nodiscard]] virtual bool IsAvailable() const;
         [[nodiscard]] virtual PFN_vkVoidFunction GetInstanceProcAddr(VkInstance vkInstance, const char* name) const;
         [[nodiscard]] virtual PFN_vkVoidFunction GetDeviceProcAddr(VkDevice vkDevice, const char* name) const;
-        [[nodiscard]] virtual std::set<std::string> GetDeviceExtensions(VkInstance vkInstance, VkPhysicalDevice vkDevice) const;
+        [[nodiscard]] virtual std::map<std::string, uint32_t> GetDeviceExtensions(VkInstance vkInstance, VkPhysicalDevice vkDevice) const;
         virtual void GetPhysicalDeviceProperties2(VkInstance vkInstance, VkPhysicalDevice vkDevice, VkPhysicalDeviceProperties2* deviceProperties2) const;
 
         [[nodiscard]] static NV_GPU_TYPE ToNvGpuType(VkPhysicalDeviceType vkDeviceType);
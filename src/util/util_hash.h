@@ -0,0 +1,40 @@
+#pragma once
+
+#include "../nvapi_private.h"
+
+#include <bit>
+
+namespace dxvk::hash {
+    inline uint64_t mix(uint64_t value) {
+        value ^= value >> 33;
+        value *= 0xff51afd7ed558ccdULL;
+        value ^= value >> 33;
+        value *= 0xc4ceb9fe1a85ec53ULL;
+        value ^= value >> 33;
+        return value;
+    }
+
+    inline uint64_t combine(uint64_t seed, uint64_t value) {
+        return seed ^ (mix(value) + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+    }
+
+    // Not suitable for anything security related, only meant to quickly tell large blobs apart
+    inline uint64_t bytes(const void* data, size_t size, uint64_t seed = 0) {
+        auto it = static_cast<const uint8_t*>(data);
+        auto hash = seed ^ (size * 0x9e3779b97f4a7c15ULL);
+
+        for (; size >= sizeof(uint64_t); it += sizeof(uint64_t), size -= sizeof(uint64_t)) {
+            uint64_t chunk;
+            std::memcpy(&chunk, it, sizeof(chunk));
+            hash = std::rotl(hash ^ mix(chunk), 27) * 0x9e3779b97f4a7c15ULL;
+        }
+
+        if (size > 0) {
+            uint64_t chunk = 0;
+            std::memcpy(&chunk, it, size);
+            hash = std::rotl(hash ^ mix(chunk), 27) * 0x9e3779b97f4a7c15ULL;
+        }
+
+        return mix(hash);
+    }
+}
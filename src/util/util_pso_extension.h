@@ -19,4 +19,22 @@ namespace dxvk {
         auto it = codes.find(code);
         return it != codes.end() ? it->second : "UNKNOWN_SHADER_EXTENSION";
     }
+
+    enum class PsoExtensionSupport : uint8_t {
+        Unsupported,
+        Ignored,
+        Supported,
+    };
+
+    inline PsoExtensionSupport getPsoExtensionSupport(const uint32_t code) {
+        switch (code) {
+            case NV_PSO_ENABLE_DEPTH_BOUND_TEST_EXTENSION: // VKD3D-Proton always allows setting depth bounds
+            case NV_PSO_SET_SHADER_EXTNENSION_SLOT_AND_SPACE: // Forwarded as thread local NvShader extension slot
+                return PsoExtensionSupport::Supported;
+            case NV_PSO_REQUEST_FASTGS_EXTENSION: // Only a hint, the pipeline behaves the same without
+                return PsoExtensionSupport::Ignored;
+            default: // Raster, explicit fast GS and custom semantics extensions have no VKD3D-Proton equivalent
+                return PsoExtensionSupport::Unsupported;
+        }
+    }
 }
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "../nvapi_private.h"
+
+namespace dxvk {
+    // Per-thread scratch memory for data that only lives until the driver call it was converted for returns.
+    // The storage only ever grows, so steady state calls do not allocate at all. The returned pointer stays
+    // valid until the next request for the same type on the same thread.
+    template <typename T>
+    [[nodiscard]] T* getThreadScratch(size_t count) {
+        static_assert(std::is_trivially_copyable_v<T>);
+
+        thread_local std::vector<T> scratch;
+        if (scratch.size() < count)
+            scratch.resize(std::max(count, scratch.size() * 2));
+
+        return scratch.data();
+    }
+}
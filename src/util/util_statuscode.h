@@ -79,6 +79,11 @@ namespace dxvk {
         return NVAPI_INVALID_ARGUMENT;
     }
 
+    inline NvAPI_Status InvalidHandle(const std::string& logMessage) {
+        log::info(str::format("<-", logMessage, ": Invalid handle"));
+        return NVAPI_INVALID_HANDLE;
+    }
+
     inline NvAPI_Status ExpectedPhysicalGpuHandle(const std::string& logMessage) {
         log::info(str::format("<-", logMessage, ": Expected physical GPU handle"));
         return NVAPI_EXPECTED_PHYSICAL_GPU_HANDLE;
@@ -150,11 +155,21 @@ namespace dxvk {
         return NVAPI_PROFILE_NOT_FOUND;
     }
 
+    inline NvAPI_Status ProfileNameInUse(const std::string& logMessage) {
+        log::info(str::format("<-", logMessage, ": Profile name in use"));
+        return NVAPI_PROFILE_NAME_IN_USE;
+    }
+
     inline NvAPI_Status ExecutableNotFound(const std::string& logMessage) {
         log::info(str::format("<-", logMessage, ": Executable not found"));
         return NVAPI_EXECUTABLE_NOT_FOUND;
     }
 
+    inline NvAPI_Status ExecutableAlreadyInUse(const std::string& logMessage) {
+        log::info(str::format("<-", logMessage, ": Executable already in use"));
+        return NVAPI_EXECUTABLE_ALREADY_IN_USE;
+    }
+
     inline NvAPI_Status SettingNotFound(const std::string& logMessage) {
         log::info(str::format("<-", logMessage, ": Setting not found"));
         return NVAPI_SETTING_NOT_FOUND;
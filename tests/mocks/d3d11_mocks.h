@@ -3,7 +3,7 @@
 #include "../../src/nvapi_private.h"
 #include "../../src/interfaces/dxvk_interfaces.h"
 
-class ID3D11DxvkDevice : public ID3D11Device, public ID3D11VkExtDevice1 {};
+class ID3D11DxvkDevice : public ID3D11Device, public ID3D11VkExtDevice1, public IDXGIVkInteropDevice {};
 
 class D3D11DxvkDeviceMock final : public trompeloeil::mock_interface<ID3D11DxvkDevice> {
     MAKE_MOCK2(QueryInterface, HRESULT(REFIID, void**), override);
@@ -56,6 +56,12 @@ class D3D11DxvkDeviceMock final : public trompeloeil::mock_interface<ID3D11DxvkD
     IMPLEMENT_MOCK4(CreateShaderResourceViewAndGetDriverHandleNVX);
     IMPLEMENT_MOCK3(CreateSamplerStateAndGetDriverHandleNVX);
     IMPLEMENT_MOCK3(GetResourceHandleGPUVirtualAddressAndSizeNVX);
+    IMPLEMENT_MOCK3(GetVulkanHandles);
+    IMPLEMENT_MOCK2(GetSubmissionQueue);
+    IMPLEMENT_MOCK4(TransitionSurfaceLayout);
+    IMPLEMENT_MOCK0(FlushRenderingCommands);
+    IMPLEMENT_MOCK0(LockSubmissionQueue);
+    IMPLEMENT_MOCK0(ReleaseSubmissionQueue);
 };
 
 class ID3D11DxvkDeviceContext : public ID3D11DeviceContext, public ID3D11VkExtContext1 {};
@@ -198,3 +204,21 @@ class D3D11BufferMock final : public trompeloeil::mock_interface<ID3D11Buffer> {
     IMPLEMENT_MOCK0(GetEvictionPriority);
     IMPLEMENT_MOCK1(GetDesc);
 };
+
+class ID3D11DxvkTexture2D : public ID3D11Texture2D, public IDXGIVkInteropSurface {};
+
+class D3D11DxvkTexture2DMock final : public trompeloeil::mock_interface<ID3D11DxvkTexture2D> {
+    MAKE_MOCK2(QueryInterface, HRESULT(REFIID, void**), override);
+    MAKE_MOCK0(AddRef, ULONG(), override);
+    MAKE_MOCK0(Release, ULONG(), override);
+    MAKE_MOCK1(GetDevice, void(ID3D11Device**), override);
+    IMPLEMENT_MOCK3(GetPrivateData);
+    IMPLEMENT_MOCK3(SetPrivateData);
+    IMPLEMENT_MOCK2(SetPrivateDataInterface);
+    IMPLEMENT_MOCK1(GetType);
+    IMPLEMENT_MOCK1(SetEvictionPriority);
+    IMPLEMENT_MOCK0(GetEvictionPriority);
+    IMPLEMENT_MOCK1(GetDesc);
+    MAKE_MOCK1(GetDevice, HRESULT(IDXGIVkInteropDevice**), override);
+    IMPLEMENT_MOCK3(GetVulkanImageInfo);
+};
@@ -229,4 +229,17 @@ class D3D12Vkd3dCommandQueueMock final : public trompeloeil::mock_interface<ID3D
     MAKE_MOCK1(GetDesc, D3D12_COMMAND_QUEUE_DESC*(D3D12_COMMAND_QUEUE_DESC*), override);
 #endif
     IMPLEMENT_MOCK1(NotifyOutOfBandCommandQueue);
-};
\ No newline at end of file
+};
+class D3D12FenceMock final : public trompeloeil::mock_interface<ID3D12Fence> {
+    MAKE_MOCK2(QueryInterface, HRESULT(REFIID, void**), override);
+    MAKE_MOCK0(AddRef, ULONG(), override);
+    MAKE_MOCK0(Release, ULONG(), override);
+    IMPLEMENT_MOCK3(GetPrivateData);
+    IMPLEMENT_MOCK3(SetPrivateData);
+    IMPLEMENT_MOCK2(SetPrivateDataInterface);
+    IMPLEMENT_MOCK1(SetName);
+    IMPLEMENT_MOCK2(GetDevice);
+    IMPLEMENT_MOCK0(GetCompletedValue);
+    IMPLEMENT_MOCK2(SetEventOnCompletion);
+    IMPLEMENT_MOCK1(Signal);
+};
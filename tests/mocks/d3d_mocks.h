@@ -2,6 +2,55 @@
 
 #include "../../src/nvapi_private.h"
 
+// Keeps private data interfaces alive like a D3D object does, Destroy() releases them like the destruction of that object would
+class PrivateDataStore {
+  public:
+    ~PrivateDataStore() {
+        Destroy();
+    }
+
+    HRESULT SetPrivateDataInterface(REFGUID guid, const IUnknown* data) {
+        auto unknown = const_cast<IUnknown*>(data);
+        if (unknown)
+            unknown->AddRef();
+
+        auto it = std::find_if(m_data.begin(), m_data.end(), [&guid](const auto& entry) { return entry.first == guid; });
+        if (it == m_data.end()) {
+            if (unknown)
+                m_data.emplace_back(guid, unknown);
+
+            return S_OK;
+        }
+
+        // Setting NULL removes the entry like D3D does
+        auto previous = it->second;
+        if (unknown)
+            it->second = unknown;
+        else
+            m_data.erase(it);
+
+        if (previous)
+            previous->Release();
+
+        return S_OK;
+    }
+
+    void Destroy() {
+        auto data = std::exchange(m_data, {});
+        for (const auto& [guid, unknown] : data) {
+            if (unknown)
+                unknown->Release();
+        }
+    }
+
+    [[nodiscard]] size_t Size() const {
+        return m_data.size();
+    }
+
+  private:
+    std::vector<std::pair<GUID, IUnknown*>> m_data;
+};
+
 class UnknownMock : public trompeloeil::mock_interface<IUnknown> {
     MAKE_MOCK2(QueryInterface, HRESULT(REFIID, void**), override);
     MAKE_MOCK0(AddRef, ULONG(), override);
@@ -13,6 +13,7 @@ struct ConfigureProps {
     VkPhysicalDeviceFragmentShadingRatePropertiesKHR* fragmentShadingRateProps;
     VkPhysicalDeviceComputeShaderDerivativesPropertiesKHR* computeShaderDerivativesProps;
     VkPhysicalDeviceRayTracingInvocationReorderPropertiesNV* rayTracingInvocationReorderProps;
+    VkPhysicalDeviceOpticalFlowPropertiesNV* opticalFlowProps;
 };
 
 class VkDeviceMock {
@@ -23,6 +24,18 @@ class VkDeviceMock {
     MAKE_MOCK3(vkLatencySleepNV, VkResult(VkDevice, VkSwapchainKHR, const VkLatencySleepInfoNV*));
     MAKE_MOCK3(vkGetLatencyTimingsNV, void(VkDevice, VkSwapchainKHR, VkGetLatencyMarkerInfoNV*));
     MAKE_MOCK3(vkSetLatencyMarkerNV, void(VkDevice, VkSwapchainKHR, const VkSetLatencyMarkerInfoNV*));
+    MAKE_MOCK4(vkGetDeviceQueue, void(VkDevice, uint32_t, uint32_t, VkQueue*));
+    MAKE_MOCK4(vkCreateCommandPool, VkResult(VkDevice, const VkCommandPoolCreateInfo*, const VkAllocationCallbacks*, VkCommandPool*));
+    MAKE_MOCK3(vkDestroyCommandPool, void(VkDevice, VkCommandPool, const VkAllocationCallbacks*));
+    MAKE_MOCK3(vkResetCommandPool, VkResult(VkDevice, VkCommandPool, VkCommandPoolResetFlags));
+    MAKE_MOCK3(vkAllocateCommandBuffers, VkResult(VkDevice, const VkCommandBufferAllocateInfo*, VkCommandBuffer*));
+    MAKE_MOCK4(vkCreateImageView, VkResult(VkDevice, const VkImageViewCreateInfo*, const VkAllocationCallbacks*, VkImageView*));
+    MAKE_MOCK3(vkDestroyImageView, void(VkDevice, VkImageView, const VkAllocationCallbacks*));
+    MAKE_MOCK3(vkGetSemaphoreCounterValue, VkResult(VkDevice, VkSemaphore, uint64_t*));
+    MAKE_MOCK3(vkWaitSemaphores, VkResult(VkDevice, const VkSemaphoreWaitInfo*, uint64_t));
+    MAKE_MOCK4(vkCreateOpticalFlowSessionNV, VkResult(VkDevice, const VkOpticalFlowSessionCreateInfoNV*, const VkAllocationCallbacks*, VkOpticalFlowSessionNV*));
+    MAKE_MOCK3(vkDestroyOpticalFlowSessionNV, void(VkDevice, VkOpticalFlowSessionNV, const VkAllocationCallbacks*));
+    MAKE_MOCK5(vkBindOpticalFlowSessionImageNV, VkResult(VkDevice, VkOpticalFlowSessionNV, VkOpticalFlowSessionBindingPointNV, VkImageView, VkImageLayout));
 
     static VkResult CreateSemaphore(VkDevice device, const VkSemaphoreCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkSemaphore* pSemaphore) {
         return reinterpret_cast<VkDeviceMock*>(device)->vkCreateSemaphore(device, pCreateInfo, pAllocator, pSemaphore);
@@ -45,22 +58,83 @@ class VkDeviceMock {
     static void SetLatencyMarkerNV(VkDevice device, VkSwapchainKHR swapchain, const VkSetLatencyMarkerInfoNV* pLatencyMarkerInfo) {
         reinterpret_cast<VkDeviceMock*>(device)->vkSetLatencyMarkerNV(device, swapchain, pLatencyMarkerInfo);
     }
+    static void GetDeviceQueue(VkDevice device, uint32_t queueFamilyIndex, uint32_t queueIndex, VkQueue* pQueue) {
+        reinterpret_cast<VkDeviceMock*>(device)->vkGetDeviceQueue(device, queueFamilyIndex, queueIndex, pQueue);
+    }
+    static VkResult CreateCommandPool(VkDevice device, const VkCommandPoolCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkCommandPool* pCommandPool) {
+        return reinterpret_cast<VkDeviceMock*>(device)->vkCreateCommandPool(device, pCreateInfo, pAllocator, pCommandPool);
+    }
+    static void DestroyCommandPool(VkDevice device, VkCommandPool commandPool, const VkAllocationCallbacks* pAllocator) {
+        reinterpret_cast<VkDeviceMock*>(device)->vkDestroyCommandPool(device, commandPool, pAllocator);
+    }
+    static VkResult ResetCommandPool(VkDevice device, VkCommandPool commandPool, VkCommandPoolResetFlags flags) {
+        return reinterpret_cast<VkDeviceMock*>(device)->vkResetCommandPool(device, commandPool, flags);
+    }
+    static VkResult AllocateCommandBuffers(VkDevice device, const VkCommandBufferAllocateInfo* pAllocateInfo, VkCommandBuffer* pCommandBuffers) {
+        return reinterpret_cast<VkDeviceMock*>(device)->vkAllocateCommandBuffers(device, pAllocateInfo, pCommandBuffers);
+    }
+    static VkResult CreateImageView(VkDevice device, const VkImageViewCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkImageView* pView) {
+        return reinterpret_cast<VkDeviceMock*>(device)->vkCreateImageView(device, pCreateInfo, pAllocator, pView);
+    }
+    static void DestroyImageView(VkDevice device, VkImageView imageView, const VkAllocationCallbacks* pAllocator) {
+        reinterpret_cast<VkDeviceMock*>(device)->vkDestroyImageView(device, imageView, pAllocator);
+    }
+    static VkResult GetSemaphoreCounterValue(VkDevice device, VkSemaphore semaphore, uint64_t* pValue) {
+        return reinterpret_cast<VkDeviceMock*>(device)->vkGetSemaphoreCounterValue(device, semaphore, pValue);
+    }
+    static VkResult WaitSemaphores(VkDevice device, const VkSemaphoreWaitInfo* pWaitInfo, uint64_t timeout) {
+        return reinterpret_cast<VkDeviceMock*>(device)->vkWaitSemaphores(device, pWaitInfo, timeout);
+    }
+    static VkResult CreateOpticalFlowSessionNV(VkDevice device, const VkOpticalFlowSessionCreateInfoNV* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkOpticalFlowSessionNV* pSession) {
+        return reinterpret_cast<VkDeviceMock*>(device)->vkCreateOpticalFlowSessionNV(device, pCreateInfo, pAllocator, pSession);
+    }
+    static void DestroyOpticalFlowSessionNV(VkDevice device, VkOpticalFlowSessionNV session, const VkAllocationCallbacks* pAllocator) {
+        reinterpret_cast<VkDeviceMock*>(device)->vkDestroyOpticalFlowSessionNV(device, session, pAllocator);
+    }
+    static VkResult BindOpticalFlowSessionImageNV(VkDevice device, VkOpticalFlowSessionNV session, VkOpticalFlowSessionBindingPointNV bindingPoint, VkImageView view, VkImageLayout layout) {
+        return reinterpret_cast<VkDeviceMock*>(device)->vkBindOpticalFlowSessionImageNV(device, session, bindingPoint, view, layout);
+    }
 };
 
 class VkPhysicalDeviceMock {
     MAKE_MOCK3(vkGetPhysicalDeviceQueueFamilyProperties, void(VkPhysicalDevice, uint32_t*, VkQueueFamilyProperties*));
 
+    MAKE_MOCK4(vkGetPhysicalDeviceOpticalFlowImageFormatsNV, VkResult(VkPhysicalDevice, const VkOpticalFlowImageFormatInfoNV*, uint32_t*, VkOpticalFlowImageFormatPropertiesNV*));
+
     static void GetPhysicalDeviceQueueFamilyProperties(VkPhysicalDevice physicalDevice, uint32_t* pQueueFamilyPropertyCount, VkQueueFamilyProperties* pQueueFamilyProperties) {
         reinterpret_cast<VkPhysicalDeviceMock*>(physicalDevice)->vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, pQueueFamilyPropertyCount, pQueueFamilyProperties);
     }
+    static VkResult GetPhysicalDeviceOpticalFlowImageFormatsNV(VkPhysicalDevice physicalDevice, const VkOpticalFlowImageFormatInfoNV* pOpticalFlowImageFormatInfo, uint32_t* pFormatCount, VkOpticalFlowImageFormatPropertiesNV* pImageFormatProperties) {
+        return reinterpret_cast<VkPhysicalDeviceMock*>(physicalDevice)->vkGetPhysicalDeviceOpticalFlowImageFormatsNV(physicalDevice, pOpticalFlowImageFormatInfo, pFormatCount, pImageFormatProperties);
+    }
 };
 
 class VkQueueMock {
     MAKE_MOCK2(vkQueueNotifyOutOfBandNV, void(VkQueue, const VkOutOfBandQueueTypeInfoNV*));
+    MAKE_MOCK4(vkQueueSubmit2, VkResult(VkQueue, uint32_t, const VkSubmitInfo2*, VkFence));
 
     static void QueueNotifyOutOfBandNV(VkQueue queue, const VkOutOfBandQueueTypeInfoNV* pQueueTypeInfo) {
         reinterpret_cast<VkQueueMock*>(queue)->vkQueueNotifyOutOfBandNV(queue, pQueueTypeInfo);
     }
+    static VkResult QueueSubmit2(VkQueue queue, uint32_t submitCount, const VkSubmitInfo2* pSubmits, VkFence fence) {
+        return reinterpret_cast<VkQueueMock*>(queue)->vkQueueSubmit2(queue, submitCount, pSubmits, fence);
+    }
+};
+
+class VkCommandBufferMock {
+    MAKE_MOCK2(vkBeginCommandBuffer, VkResult(VkCommandBuffer, const VkCommandBufferBeginInfo*));
+    MAKE_MOCK1(vkEndCommandBuffer, VkResult(VkCommandBuffer));
+    MAKE_MOCK3(vkCmdOpticalFlowExecuteNV, void(VkCommandBuffer, VkOpticalFlowSessionNV, const VkOpticalFlowExecuteInfoNV*));
+
+    static VkResult BeginCommandBuffer(VkCommandBuffer commandBuffer, const VkCommandBufferBeginInfo* pBeginInfo) {
+        return reinterpret_cast<VkCommandBufferMock*>(commandBuffer)->vkBeginCommandBuffer(commandBuffer, pBeginInfo);
+    }
+    static VkResult EndCommandBuffer(VkCommandBuffer commandBuffer) {
+        return reinterpret_cast<VkCommandBufferMock*>(commandBuffer)->vkEndCommandBuffer(commandBuffer);
+    }
+    static void CmdOpticalFlowExecuteNV(VkCommandBuffer commandBuffer, VkOpticalFlowSessionNV session, const VkOpticalFlowExecuteInfoNV* pExecuteInfo) {
+        reinterpret_cast<VkCommandBufferMock*>(commandBuffer)->vkCmdOpticalFlowExecuteNV(commandBuffer, session, pExecuteInfo);
+    }
 };
 
 class VkMock final : public mock_interface<dxvk::Vk> {
@@ -102,6 +176,46 @@ class VkMock final : public mock_interface<dxvk::Vk> {
                 .RETURN(reinterpret_cast<PFN_vkVoidFunction>(VkQueueMock::QueueNotifyOutOfBandNV))};
     }
 
+    [[nodiscard]] static std::array<std::unique_ptr<expectation>, 18> ConfigureOpticalFlowPFN(VkMock& mock) {
+        return {
+            NAMED_ALLOW_CALL(mock, GetInstanceProcAddr(_, eq(std::string_view("vkGetPhysicalDeviceQueueFamilyProperties"))))
+                .RETURN(reinterpret_cast<PFN_vkVoidFunction>(VkPhysicalDeviceMock::GetPhysicalDeviceQueueFamilyProperties)),
+            NAMED_ALLOW_CALL(mock, GetInstanceProcAddr(_, eq(std::string_view("vkGetPhysicalDeviceOpticalFlowImageFormatsNV"))))
+                .RETURN(reinterpret_cast<PFN_vkVoidFunction>(VkPhysicalDeviceMock::GetPhysicalDeviceOpticalFlowImageFormatsNV)),
+            NAMED_ALLOW_CALL(mock, GetDeviceProcAddr(_, eq(std::string_view("vkGetDeviceQueue"))))
+                .RETURN(reinterpret_cast<PFN_vkVoidFunction>(VkDeviceMock::GetDeviceQueue)),
+            NAMED_ALLOW_CALL(mock, GetDeviceProcAddr(_, eq(std::string_view("vkCreateCommandPool"))))
+                .RETURN(reinterpret_cast<PFN_vkVoidFunction>(VkDeviceMock::CreateCommandPool)),
+            NAMED_ALLOW_CALL(mock, GetDeviceProcAddr(_, eq(std::string_view("vkDestroyCommandPool"))))
+                .RETURN(reinterpret_cast<PFN_vkVoidFunction>(VkDeviceMock::DestroyCommandPool)),
+            NAMED_ALLOW_CALL(mock, GetDeviceProcAddr(_, eq(std::string_view("vkResetCommandPool"))))
+                .RETURN(reinterpret_cast<PFN_vkVoidFunction>(VkDeviceMock::ResetCommandPool)),
+            NAMED_ALLOW_CALL(mock, GetDeviceProcAddr(_, eq(std::string_view("vkAllocateCommandBuffers"))))
+                .RETURN(reinterpret_cast<PFN_vkVoidFunction>(VkDeviceMock::AllocateCommandBuffers)),
+            NAMED_ALLOW_CALL(mock, GetDeviceProcAddr(_, eq(std::string_view("vkCreateImageView"))))
+                .RETURN(reinterpret_cast<PFN_vkVoidFunction>(VkDeviceMock::CreateImageView)),
+            NAMED_ALLOW_CALL(mock, GetDeviceProcAddr(_, eq(std::string_view("vkDestroyImageView"))))
+                .RETURN(reinterpret_cast<PFN_vkVoidFunction>(VkDeviceMock::DestroyImageView)),
+            NAMED_ALLOW_CALL(mock, GetDeviceProcAddr(_, eq(std::string_view("vkGetSemaphoreCounterValue"))))
+                .RETURN(reinterpret_cast<PFN_vkVoidFunction>(VkDeviceMock::GetSemaphoreCounterValue)),
+            NAMED_ALLOW_CALL(mock, GetDeviceProcAddr(_, eq(std::string_view("vkWaitSemaphores"))))
+                .RETURN(reinterpret_cast<PFN_vkVoidFunction>(VkDeviceMock::WaitSemaphores)),
+            NAMED_ALLOW_CALL(mock, GetDeviceProcAddr(_, eq(std::string_view("vkCreateOpticalFlowSessionNV"))))
+                .RETURN(reinterpret_cast<PFN_vkVoidFunction>(VkDeviceMock::CreateOpticalFlowSessionNV)),
+            NAMED_ALLOW_CALL(mock, GetDeviceProcAddr(_, eq(std::string_view("vkDestroyOpticalFlowSessionNV"))))
+                .RETURN(reinterpret_cast<PFN_vkVoidFunction>(VkDeviceMock::DestroyOpticalFlowSessionNV)),
+            NAMED_ALLOW_CALL(mock, GetDeviceProcAddr(_, eq(std::string_view("vkBindOpticalFlowSessionImageNV"))))
+                .RETURN(reinterpret_cast<PFN_vkVoidFunction>(VkDeviceMock::BindOpticalFlowSessionImageNV)),
+            NAMED_ALLOW_CALL(mock, GetDeviceProcAddr(_, eq(std::string_view("vkQueueSubmit2"))))
+                .RETURN(reinterpret_cast<PFN_vkVoidFunction>(VkQueueMock::QueueSubmit2)),
+            NAMED_ALLOW_CALL(mock, GetDeviceProcAddr(_, eq(std::string_view("vkBeginCommandBuffer"))))
+                .RETURN(reinterpret_cast<PFN_vkVoidFunction>(VkCommandBufferMock::BeginCommandBuffer)),
+            NAMED_ALLOW_CALL(mock, GetDeviceProcAddr(_, eq(std::string_view("vkEndCommandBuffer"))))
+                .RETURN(reinterpret_cast<PFN_vkVoidFunction>(VkCommandBufferMock::EndCommandBuffer)),
+            NAMED_ALLOW_CALL(mock, GetDeviceProcAddr(_, eq(std::string_view("vkCmdOpticalFlowExecuteNV"))))
+                .RETURN(reinterpret_cast<PFN_vkVoidFunction>(VkCommandBufferMock::CmdOpticalFlowExecuteNV))};
+    }
+
     static void ConfigureGetPhysicalDeviceProperties2(
         VkPhysicalDeviceProperties2* props,
         std::function<void(ConfigureProps)> configure) { // NOLINT(performance-unnecessary-value-param)
@@ -112,7 +226,8 @@ class VkMock final : public mock_interface<dxvk::Vk> {
             .driverProps = nullptr,
             .fragmentShadingRateProps = nullptr,
             .computeShaderDerivativesProps = nullptr,
-            .rayTracingInvocationReorderProps = nullptr};
+            .rayTracingInvocationReorderProps = nullptr,
+            .opticalFlowProps = nullptr};
 
         auto next = reinterpret_cast<VkBaseOutStructure*>(props);
         while (next != nullptr) {
@@ -141,6 +256,10 @@ class VkMock final : public mock_interface<dxvk::Vk> {
                     vkProps.rayTracingInvocationReorderProps = reinterpret_cast<VkPhysicalDeviceRayTracingInvocationReorderPropertiesNV*>(next);
                     break;
                 }
+                case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_OPTICAL_FLOW_PROPERTIES_NV: {
+                    vkProps.opticalFlowProps = reinterpret_cast<VkPhysicalDeviceOpticalFlowPropertiesNV*>(next);
+                    break;
+                }
                 default:
                     break;
             }
@@ -11,7 +11,7 @@ DefaultTestEnvironment::DefaultTestEnvironment() {
     output = mockFactory->CreateDXGIOutput6Mock();
 }
 
-[[nodiscard]] std::array<std::unique_ptr<expectation>, 22> DefaultTestEnvironment::ConfigureExpectations() {
+[[nodiscard]] std::array<std::unique_ptr<expectation>, 23> DefaultTestEnvironment::ConfigureExpectations() {
     auto dxgiFactory = mockFactory->GetDXGIFactoryMock();
     auto vk = mockFactory->GetVkMock();
     auto nvml = mockFactory->GetNvmlMock();
@@ -60,7 +60,7 @@ DefaultTestEnvironment::DefaultTestEnvironment() {
         NAMED_ALLOW_CALL(*vk, IsAvailable())
             .RETURN(true),
         NAMED_ALLOW_CALL(*vk, GetDeviceExtensions(_, _))
-            .RETURN(std::set<std::string>{VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME}),
+            .RETURN(std::map<std::string, uint32_t>{{VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME, 1}}),
         NAMED_ALLOW_CALL(*vk, GetPhysicalDeviceProperties2(_, _, _))
             .SIDE_EFFECT(
                 VkMock::ConfigureGetPhysicalDeviceProperties2(_3,
@@ -14,7 +14,7 @@ ExtendedTestEnvironment::ExtendedTestEnvironment() {
     output3 = mockFactory->CreateDXGIOutput6Mock();
 }
 
-[[nodiscard]] std::array<std::unique_ptr<expectation>, 39> ExtendedTestEnvironment::ConfigureExpectations() {
+[[nodiscard]] std::array<std::unique_ptr<expectation>, 40> ExtendedTestEnvironment::ConfigureExpectations() {
     auto dxgiFactory = mockFactory->GetDXGIFactoryMock();
     auto vk = mockFactory->GetVkMock();
     auto nvml = mockFactory->GetNvmlMock();
@@ -107,7 +107,7 @@ ExtendedTestEnvironment::ExtendedTestEnvironment() {
         NAMED_ALLOW_CALL(*vk, IsAvailable())
             .RETURN(true),
         NAMED_ALLOW_CALL(*vk, GetDeviceExtensions(_, _))
-            .RETURN(std::set<std::string>{VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME}),
+            .RETURN(std::map<std::string, uint32_t>{{VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME, 1}}),
         NAMED_ALLOW_CALL(*vk, GetPhysicalDeviceProperties2(_, reinterpret_cast<VkPhysicalDevice>(0x01), _))
             .SIDE_EFFECT(
                 VkMock::ConfigureGetPhysicalDeviceProperties2(_3,
@@ -27,6 +27,8 @@ class SectionListener : public Catch::EventListenerBase {
         NvapiD3dLowLatencyDevice::Reset();
         NvapiVulkanLowLatencyDevice::Reset();
 
+        nvapiDrsDatabase.reset();
+
         if (!resourceFactory)
             return;
 
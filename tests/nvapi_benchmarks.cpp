@@ -0,0 +1,221 @@
+#include "nvapi_tests_private.h"
+#include "mocks/d3d_mocks.h"
+#include "mocks/d3d12_mocks.h"
+
+#include <thread>
+
+using namespace trompeloeil;
+using namespace dxvk;
+
+// Runs the same work on the given number of threads at once and returns when all of them are done
+template <typename F>
+static void RunOnThreads(size_t threadCount, F&& work) {
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; i++)
+        threads.emplace_back([&work, i] { work(i); });
+
+    for (auto& thread : threads)
+        thread.join();
+}
+
+static constexpr std::array benchmarkThreadCounts{1U, 2U, 4U, 8U};
+
+TEST_CASE("CuBIN SMEM lookup scales with threads", "[.benchmark]") {
+    D3D12Vkd3dDeviceMock device;
+    D3D12Vkd3dGraphicsCommandListMock commandList;
+
+    ALLOW_CALL(device, QueryInterface(__uuidof(ID3D12DeviceExt2), _))
+        .LR_SIDE_EFFECT(*_2 = static_cast<ID3D12DeviceExt2*>(&device))
+        .RETURN(S_OK);
+    ALLOW_CALL(device, QueryInterface(__uuidof(ID3D12DeviceExt4), _))
+        .LR_SIDE_EFFECT(*_2 = static_cast<ID3D12DeviceExt4*>(&device))
+        .RETURN(S_OK);
+    ALLOW_CALL(device, AddRef())
+        .RETURN(1);
+    ALLOW_CALL(device, Release())
+        .RETURN(0);
+    ALLOW_CALL(device, GetExtensionSupport(_))
+        .RETURN(true);
+    ALLOW_CALL(device, SupportsCubin64bit())
+        .RETURN(true);
+
+    ALLOW_CALL(commandList, QueryInterface(__uuidof(ID3D12GraphicsCommandListExt1), _))
+        .LR_SIDE_EFFECT(*_2 = static_cast<ID3D12GraphicsCommandListExt*>(&commandList))
+        .RETURN(S_OK);
+    ALLOW_CALL(commandList, AddRef())
+        .RETURN(1);
+    ALLOW_CALL(commandList, Release())
+        .RETURN(0);
+
+    constexpr uintptr_t shaderCount = 64;
+    auto nextShader = uintptr_t{0x1000};
+    ALLOW_CALL(device, CreateCubinComputeShaderWithName(_, _, _, _, _, _, _))
+        .LR_SIDE_EFFECT(*_7 = reinterpret_cast<D3D12_CUBIN_DATA_HANDLE*>(nextShader++))
+        .RETURN(S_OK);
+
+    NvapiD3d12Device nvapiDevice(static_cast<ID3D12DeviceExt*>(&device));
+    std::vector<NVDX_ObjectHandle> shaders(shaderCount);
+    for (uintptr_t i = 0; i < shaderCount; i++)
+        REQUIRE(nvapiDevice.CreateCubinComputeShaderEx(nullptr, 0, 1, 1, 1, static_cast<NvU32>(i), "shader", &shaders[i]) == S_OK);
+
+    // Every thread records its own command list and launches the same few shaders over and over, like a frame would
+    constexpr size_t launchesPerThread = 100000;
+    for (auto threadCount : benchmarkThreadCounts) {
+        std::vector<NvapiD3d12GraphicsCommandList> nvapiCommandLists;
+        for (size_t i = 0; i < threadCount; i++)
+            nvapiCommandLists.emplace_back(static_cast<ID3D12GraphicsCommandListExt*>(&commandList));
+
+        BENCHMARK("Command list lookup with " + std::to_string(threadCount) + " threads") {
+            std::atomic<uint64_t> sum = 0;
+            RunOnThreads(threadCount, [&](size_t thread) {
+                uint64_t localSum = 0;
+                for (size_t i = 0; i < launchesPerThread; i++)
+                    localSum += nvapiCommandLists[thread].FindCubinSmem(shaders[(thread + i) % 3]);
+
+                sum += localSum;
+            });
+            return sum.load();
+        };
+
+        BENCHMARK("Device lookup with " + std::to_string(threadCount) + " threads") {
+            std::atomic<uint64_t> sum = 0;
+            RunOnThreads(threadCount, [&](size_t thread) {
+                uint64_t localSum = 0;
+                for (size_t i = 0; i < launchesPerThread; i++)
+                    localSum += NvapiD3d12Device::FindCubinSmem(shaders[(thread + i) % 3]).value_or(0);
+
+                sum += localSum;
+            });
+            return sum.load();
+        };
+    }
+}
+
+TEST_CASE("D3D12 wrapper lookup scales with threads", "[.benchmark]") {
+    D3D12Vkd3dDeviceMock device;
+    D3D12Vkd3dCommandQueueMock commandQueue;
+    constexpr size_t commandListCount = 2 * benchmarkThreadCounts.back();
+    std::array<D3D12Vkd3dGraphicsCommandListMock, commandListCount> commandLists;
+    PrivateDataStore devicePrivateData;
+    PrivateDataStore commandQueuePrivateData;
+    std::array<PrivateDataStore, commandListCount> commandListPrivateData;
+    std::vector<std::unique_ptr<expectation>> expectations;
+
+    ALLOW_CALL(device, QueryInterface(__uuidof(ID3D12DeviceExt), _))
+        .LR_SIDE_EFFECT(*_2 = static_cast<ID3D12DeviceExt*>(&device))
+        .RETURN(S_OK);
+    ALLOW_CALL(device, QueryInterface(__uuidof(ID3D12DeviceExt2), _))
+        .LR_SIDE_EFFECT(*_2 = static_cast<ID3D12DeviceExt2*>(&device))
+        .RETURN(S_OK);
+    ALLOW_CALL(device, QueryInterface(__uuidof(ID3D12DeviceExt4), _))
+        .LR_SIDE_EFFECT(*_2 = static_cast<ID3D12DeviceExt4*>(&device))
+        .RETURN(S_OK);
+    ALLOW_CALL(device, AddRef())
+        .RETURN(1);
+    ALLOW_CALL(device, Release())
+        .RETURN(0);
+    ALLOW_CALL(device, GetExtensionSupport(_))
+        .RETURN(true);
+    ALLOW_CALL(device, SupportsCubin64bit())
+        .RETURN(true);
+    ALLOW_CALL(device, SetPrivateDataInterface(_, _))
+        .LR_RETURN(devicePrivateData.SetPrivateDataInterface(_1, _2));
+
+    ALLOW_CALL(commandQueue, QueryInterface(__uuidof(ID3D12CommandQueueExt), _))
+        .LR_SIDE_EFFECT(*_2 = static_cast<ID3D12CommandQueueExt*>(&commandQueue))
+        .RETURN(S_OK);
+    ALLOW_CALL(commandQueue, AddRef())
+        .RETURN(1);
+    ALLOW_CALL(commandQueue, Release())
+        .RETURN(0);
+    ALLOW_CALL(commandQueue, SetPrivateDataInterface(_, _))
+        .LR_RETURN(commandQueuePrivateData.SetPrivateDataInterface(_1, _2));
+
+    for (size_t i = 0; i < commandListCount; i++) {
+        auto commandList = &commandLists[i];
+        auto privateData = &commandListPrivateData[i];
+        expectations.push_back(NAMED_ALLOW_CALL(*commandList, QueryInterface(__uuidof(ID3D12GraphicsCommandListExt), _))
+                .SIDE_EFFECT(*_2 = static_cast<ID3D12GraphicsCommandListExt*>(commandList))
+                .RETURN(S_OK));
+        expectations.push_back(NAMED_ALLOW_CALL(*commandList, QueryInterface(__uuidof(ID3D12GraphicsCommandListExt1), _))
+                .SIDE_EFFECT(*_2 = static_cast<ID3D12GraphicsCommandListExt*>(commandList))
+                .RETURN(S_OK));
+        expectations.push_back(NAMED_ALLOW_CALL(*commandList, AddRef())
+                .RETURN(1));
+        expectations.push_back(NAMED_ALLOW_CALL(*commandList, Release())
+                .RETURN(0));
+        expectations.push_back(NAMED_ALLOW_CALL(*commandList, SetPrivateDataInterface(_, _))
+                .RETURN(privateData->SetPrivateDataInterface(_1, _2)));
+    }
+
+    // Every dispatch looks up its command list, plus the device or command queue, which is shared by all threads
+    constexpr size_t lookupsPerThread = 100000;
+    for (auto threadCount : benchmarkThreadCounts) {
+        BENCHMARK("Same command list with " + std::to_string(threadCount) + " threads") {
+            std::atomic<uintptr_t> sum = 0;
+            RunOnThreads(threadCount, [&](size_t thread) {
+                uintptr_t localSum = 0;
+                for (size_t i = 0; i < lookupsPerThread; i++) {
+                    localSum += reinterpret_cast<uintptr_t>(NvapiD3d12GraphicsCommandList::GetOrCreate(&commandLists[thread]));
+                    localSum += reinterpret_cast<uintptr_t>(NvapiD3d12Device::GetOrCreate(&device));
+                }
+
+                sum += localSum;
+            });
+            return sum.load();
+        };
+
+        BENCHMARK("Alternating command lists with " + std::to_string(threadCount) + " threads") {
+            std::atomic<uintptr_t> sum = 0;
+            RunOnThreads(threadCount, [&](size_t thread) {
+                uintptr_t localSum = 0;
+                for (size_t i = 0; i < lookupsPerThread; i++) {
+                    localSum += reinterpret_cast<uintptr_t>(NvapiD3d12GraphicsCommandList::GetOrCreate(&commandLists[2 * thread + i % 2]));
+                    localSum += reinterpret_cast<uintptr_t>(NvapiD3d12CommandQueue::GetOrCreate(&commandQueue));
+                }
+
+                sum += localSum;
+            });
+            return sum.load();
+        };
+    }
+}
+
+TEST_CASE("Raytracing acceleration structure input conversion", "[.benchmark]") {
+    D3D12Vkd3dGraphicsCommandListMock commandList;
+
+    ALLOW_CALL(commandList, BuildRaytracingAccelerationStructure(_, _, _));
+
+    // Skinned meshes usually have a handful of geometries per BLAS, static scenery up to a few hundred
+    for (auto geometryCount : {1U, 4U, 32U, 256U}) {
+        std::vector<NVAPI_D3D12_RAYTRACING_GEOMETRY_DESC_EX> geometryDescsEx(geometryCount);
+        std::vector<D3D12_RAYTRACING_GEOMETRY_DESC> geometryDescs(geometryCount);
+        for (auto i = 0U; i < geometryCount; i++) {
+            geometryDescsEx[i].type = NVAPI_D3D12_RAYTRACING_GEOMETRY_TYPE_TRIANGLES_EX;
+            geometryDescsEx[i].triangles.VertexCount = 3 * (i + 1);
+            geometryDescs[i].Type = D3D12_RAYTRACING_GEOMETRY_TYPE_TRIANGLES;
+            geometryDescs[i].Triangles.VertexCount = 3 * (i + 1);
+        }
+
+        NVAPI_D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_DESC_EX desc{};
+        desc.inputs.type = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL;
+        desc.inputs.descsLayout = D3D12_ELEMENTS_LAYOUT_ARRAY;
+        desc.inputs.numDescs = geometryCount;
+        NVAPI_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_EX_PARAMS params{};
+        params.version = NVAPI_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_EX_PARAMS_VER1;
+        params.pDesc = &desc;
+
+        BENCHMARK("Refit with " + std::to_string(geometryCount) + " geometries in NVAPI layout") {
+            desc.inputs.pGeometryDescs = geometryDescsEx.data();
+            desc.inputs.geometryDescStrideInBytes = sizeof(NVAPI_D3D12_RAYTRACING_GEOMETRY_DESC_EX);
+            return NvAPI_D3D12_BuildRaytracingAccelerationStructureEx(static_cast<ID3D12GraphicsCommandList4*>(&commandList), &params);
+        };
+
+        BENCHMARK("Refit with " + std::to_string(geometryCount) + " geometries in D3D12 layout") {
+            desc.inputs.pGeometryDescs = reinterpret_cast<NVAPI_D3D12_RAYTRACING_GEOMETRY_DESC_EX*>(geometryDescs.data());
+            desc.inputs.geometryDescStrideInBytes = sizeof(D3D12_RAYTRACING_GEOMETRY_DESC);
+            return NvAPI_D3D12_BuildRaytracingAccelerationStructureEx(static_cast<ID3D12GraphicsCommandList4*>(&commandList), &params);
+        };
+    }
+}
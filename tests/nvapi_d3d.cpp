@@ -169,6 +169,8 @@ TEST_CASE("D3D Reflex depending methods succeed", "[.d3d]") {
     D3D11DxvkDeviceMock d3d11Device;
     D3D11DxvkDeviceContextMock d3d11DeviceContext;
     D3DLowLatencyDeviceMock lowLatencyDevice;
+    PrivateDataStore d3d11DevicePrivateData;
+    PrivateDataStore d3d11DeviceContextPrivateData;
     auto d3d11DeviceRefCount = 0;
     auto d3d11DeviceContextRefCount = 0;
     auto lowLatencyDeviceRefCount = 0;
@@ -219,6 +221,14 @@ TEST_CASE("D3D Reflex depending methods succeed", "[.d3d]") {
             .LR_SIDE_EFFECT(*_2 = static_cast<ID3DLowLatencyDevice*>(&lowLatencyDevice))
             .LR_SIDE_EFFECT(lowLatencyDeviceRefCount++)
             .RETURN(S_OK);
+        ALLOW_CALL(d3d11Device, QueryInterface(__uuidof(ID3D12Object), _))
+            .RETURN(E_NOINTERFACE);
+        ALLOW_CALL(d3d11Device, QueryInterface(__uuidof(ID3D11Device), _))
+            .LR_SIDE_EFFECT(*_2 = static_cast<ID3D11Device*>(&d3d11Device))
+            .LR_SIDE_EFFECT(d3d11DeviceRefCount++)
+            .RETURN(S_OK);
+        ALLOW_CALL(d3d11Device, SetPrivateDataInterface(_, _))
+            .LR_RETURN(d3d11DevicePrivateData.SetPrivateDataInterface(_1, _2));
 
         ALLOW_CALL(d3d11DeviceContext, AddRef())
             .LR_SIDE_EFFECT(d3d11DeviceContextRefCount++)
@@ -235,6 +245,12 @@ TEST_CASE("D3D Reflex depending methods succeed", "[.d3d]") {
             .LR_SIDE_EFFECT(d3d11DeviceRefCount++);
         ALLOW_CALL(d3d11DeviceContext, QueryInterface(__uuidof(ID3DLowLatencyDevice), _))
             .RETURN(E_NOINTERFACE);
+        ALLOW_CALL(d3d11DeviceContext, QueryInterface(__uuidof(ID3D12Object), _))
+            .RETURN(E_NOINTERFACE);
+        ALLOW_CALL(d3d11DeviceContext, QueryInterface(__uuidof(ID3D11Device), _))
+            .RETURN(E_NOINTERFACE);
+        ALLOW_CALL(d3d11DeviceContext, SetPrivateDataInterface(_, _))
+            .LR_RETURN(d3d11DeviceContextPrivateData.SetPrivateDataInterface(_1, _2));
 
         ALLOW_CALL(lowLatencyDevice, AddRef())
             .LR_SIDE_EFFECT(lowLatencyDeviceRefCount++)
@@ -382,6 +398,22 @@ TEST_CASE("D3D Reflex depending methods succeed", "[.d3d]") {
                 REQUIRE(NvAPI_D3D_Sleep(reinterpret_cast<IUnknown*>(&d3d11DeviceContext)) == NVAPI_OK);
             }
 
+            SECTION("Reset detaches the notifiers from devices and contexts that are still alive") {
+                REQUIRE(NvAPI_Initialize() == NVAPI_OK);
+
+                NV_GET_SLEEP_STATUS_PARAMS_V1 params{};
+                params.version = NV_GET_SLEEP_STATUS_PARAMS_VER1;
+                REQUIRE(NvAPI_D3D_GetSleepStatus(reinterpret_cast<IUnknown*>(&d3d11Device), &params) == NVAPI_OK);
+                REQUIRE(NvAPI_D3D_GetSleepStatus(reinterpret_cast<IUnknown*>(&d3d11DeviceContext), &params) == NVAPI_OK);
+                REQUIRE(d3d11DevicePrivateData.Size() == 1);
+                REQUIRE(d3d11DeviceContextPrivateData.Size() == 1);
+
+                NvapiD3dLowLatencyDevice::Reset();
+
+                REQUIRE(d3d11DevicePrivateData.Size() == 0);
+                REQUIRE(d3d11DeviceContextPrivateData.Size() == 0);
+            }
+
             SECTION("SetLatencyMarker successfully handles being passed ID3D11DeviceContext as IUnknown") {
                 REQUIRE_CALL(lowLatencyDevice, SetLatencyMarker(1ULL, VK_LATENCY_MARKER_OUT_OF_BAND_RENDERSUBMIT_START_NV))
                     .RETURN(S_OK);
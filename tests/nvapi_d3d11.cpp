@@ -8,6 +8,8 @@ using namespace trompeloeil;
 TEST_CASE("D3D11 methods succeed", "[.d3d11]") {
     D3D11DxvkDeviceMock device;
     D3D11DxvkDeviceContextMock context;
+    PrivateDataStore devicePrivateData;
+    PrivateDataStore contextPrivateData;
     auto deviceRefCount = 0;
     auto contextRefCount = 0;
 
@@ -31,6 +33,8 @@ TEST_CASE("D3D11 methods succeed", "[.d3d11]") {
         .RETURN(deviceRefCount);
     ALLOW_CALL(device, GetExtensionSupport(_))
         .RETURN(true);
+    ALLOW_CALL(device, SetPrivateDataInterface(_, _))
+        .LR_RETURN(devicePrivateData.SetPrivateDataInterface(_1, _2));
     ALLOW_CALL(device, GetImmediateContext(_))
         .LR_SIDE_EFFECT(*_1 = &context)
         .LR_SIDE_EFFECT(contextRefCount++);
@@ -55,6 +59,8 @@ TEST_CASE("D3D11 methods succeed", "[.d3d11]") {
     ALLOW_CALL(context, Release())
         .LR_SIDE_EFFECT(contextRefCount--)
         .RETURN(contextRefCount);
+    ALLOW_CALL(context, SetPrivateDataInterface(_, _))
+        .LR_RETURN(contextPrivateData.SetPrivateDataInterface(_1, _2));
     ALLOW_CALL(context, GetDevice(_))
         .LR_SIDE_EFFECT(*_1 = &device)
         .LR_SIDE_EFFECT(deviceRefCount++);
@@ -253,6 +259,48 @@ TEST_CASE("D3D11 methods succeed", "[.d3d11]") {
         REQUIRE(NvAPI_D3D11_MultiDrawIndexedInstancedIndirect(static_cast<ID3D11DeviceContext*>(&context), drawCount, &buffer, offsetForArgs, strideForArgs) == NVAPI_OK);
     }
 
+    SECTION("MultiDrawInstancedIndirect/MultiDrawIndexedInstancedIndirect forwards every call once while looking up the context only once") {
+        D3D11BufferMock buffer;
+        REQUIRE_CALL(context, QueryInterface(__uuidof(ID3D11VkExtContext), _))
+            .LR_SIDE_EFFECT(*_2 = static_cast<ID3D11VkExtContext*>(&context))
+            .LR_SIDE_EFFECT(contextRefCount++)
+            .TIMES(1)
+            .RETURN(S_OK);
+        REQUIRE_CALL(context, MultiDrawIndirect(4U, &buffer, _, 16U))
+            .TIMES(100);
+        REQUIRE_CALL(context, MultiDrawIndexedIndirect(6U, &buffer, _, 20U))
+            .TIMES(100);
+
+        for (auto i = 0U; i < 100U; i++) {
+            REQUIRE(NvAPI_D3D11_MultiDrawInstancedIndirect(static_cast<ID3D11DeviceContext*>(&context), 4U, &buffer, i * 4U * 16U, 16U) == NVAPI_OK);
+            REQUIRE(NvAPI_D3D11_MultiDrawIndexedInstancedIndirect(static_cast<ID3D11DeviceContext*>(&context), 6U, &buffer, i * 6U * 20U, 20U) == NVAPI_OK);
+        }
+    }
+
+    SECTION("MultiDrawInstancedIndirect/MultiDrawIndexedInstancedIndirect without draws returns OK") {
+        D3D11BufferMock buffer;
+        FORBID_CALL(context, MultiDrawIndirect(_, _, _, _));
+        FORBID_CALL(context, MultiDrawIndexedIndirect(_, _, _, _));
+
+        REQUIRE(NvAPI_D3D11_MultiDrawInstancedIndirect(static_cast<ID3D11DeviceContext*>(&context), 0U, &buffer, 8U, 16U) == NVAPI_OK);
+        REQUIRE(NvAPI_D3D11_MultiDrawIndexedInstancedIndirect(static_cast<ID3D11DeviceContext*>(&context), 0U, &buffer, 12U, 20U) == NVAPI_OK);
+    }
+
+    SECTION("MultiDrawInstancedIndirect after destroying the context looks up the context again") {
+        D3D11BufferMock buffer;
+        REQUIRE_CALL(context, QueryInterface(__uuidof(ID3D11VkExtContext), _))
+            .LR_SIDE_EFFECT(*_2 = static_cast<ID3D11VkExtContext*>(&context))
+            .LR_SIDE_EFFECT(contextRefCount++)
+            .TIMES(2)
+            .RETURN(S_OK);
+        REQUIRE_CALL(context, MultiDrawIndirect(4U, &buffer, 8U, 16U))
+            .TIMES(2);
+
+        REQUIRE(NvAPI_D3D11_MultiDrawInstancedIndirect(static_cast<ID3D11DeviceContext*>(&context), 4U, &buffer, 8U, 16U) == NVAPI_OK);
+        contextPrivateData.Destroy();
+        REQUIRE(NvAPI_D3D11_MultiDrawInstancedIndirect(static_cast<ID3D11DeviceContext*>(&context), 4U, &buffer, 8U, 16U) == NVAPI_OK);
+    }
+
     SECTION("LaunchCubinShader/CreateCubinComputeShader/CreateCubinComputeShaderWithName returns OK") {
         auto shader = "X";
         NVDX_ObjectHandle objhandle{};
@@ -293,7 +341,56 @@ TEST_CASE("D3D11 methods succeed", "[.d3d11]") {
         REQUIRE(NvAPI_D3D11_DestroyCubinComputeShader(static_cast<ID3D11Device*>(&device), handle) == NVAPI_OK);
     }
 
-    SECTION("DestroyCubinComputeShader returns error on a NULL or NVDX_OBJECT_NONE handle") {
+    SECTION("Identical CuBIN shaders are created once and released on the last destroy") {
+        UnknownMock unknown;
+        auto cubinData = std::string("cubin");
+        auto otherCubinData = cubinData;
+        NVDX_ObjectHandle handle1{};
+        NVDX_ObjectHandle handle2{};
+        REQUIRE_CALL(device, CreateCubinComputeShaderWithNameNVX(_, 5U, 2U, 3U, 4U, _, _))
+            .WITH(_6 == std::string("shader"))
+            .LR_SIDE_EFFECT(*_7 = &unknown)
+            .RETURN(true)
+            .TIMES(1);
+
+        REQUIRE(NvAPI_D3D11_CreateCubinComputeShaderWithName(static_cast<ID3D11Device*>(&device), cubinData.data(), 5U, 2U, 3U, 4U, "shader", &handle1) == NVAPI_OK);
+        REQUIRE(NvAPI_D3D11_CreateCubinComputeShaderWithName(static_cast<ID3D11Device*>(&device), otherCubinData.data(), 5U, 2U, 3U, 4U, "shader", &handle2) == NVAPI_OK);
+        REQUIRE(handle1 == reinterpret_cast<NVDX_ObjectHandle>(&unknown));
+        REQUIRE(handle2 == handle1);
+
+        {
+            FORBID_CALL(unknown, Release());
+            REQUIRE(NvAPI_D3D11_DestroyCubinComputeShader(static_cast<ID3D11Device*>(&device), handle1) == NVAPI_OK);
+        }
+
+        REQUIRE_CALL(unknown, Release())
+            .TIMES(1)
+            .RETURN(0);
+
+        REQUIRE(NvAPI_D3D11_DestroyCubinComputeShader(static_cast<ID3D11Device*>(&device), handle2) == NVAPI_OK);
+    }
+
+    SECTION("Device wrapper is dropped when the device gets destroyed") {
+        bool supported = false;
+        REQUIRE(NvAPI_D3D11_IsFatbinPTXSupported(static_cast<ID3D11Device*>(&device), &supported) == NVAPI_OK);
+        REQUIRE(devicePrivateData.Size() == 1);
+        REQUIRE(contextPrivateData.Size() == 0);
+
+        constexpr auto churnCount = 16U;
+        REQUIRE_CALL(device, QueryInterface(__uuidof(ID3D11VkExtDevice), _))
+            .LR_SIDE_EFFECT(*_2 = static_cast<ID3D11VkExtDevice*>(&device))
+            .LR_SIDE_EFFECT(deviceRefCount++)
+            .RETURN(S_OK)
+            .TIMES(churnCount);
+
+        for (auto i = 0U; i < churnCount; i++) {
+            devicePrivateData.Destroy();
+            REQUIRE(NvAPI_D3D11_IsFatbinPTXSupported(static_cast<ID3D11Device*>(&device), &supported) == NVAPI_OK);
+            REQUIRE(NvAPI_D3D11_IsFatbinPTXSupported(static_cast<ID3D11Device*>(&device), &supported) == NVAPI_OK);
+        }
+    }
+
+
         // this also checks the assumption that NVDX_OBJECT_NONE casts <-> NULL, which should forever be true but will break some stuff in subtle ways if not, so ¯\_(ツ)_/¯
         REQUIRE(NVDX_OBJECT_NONE == reinterpret_cast<NVDX_ObjectHandle>(NULL /* not nullptr which is cast-proofed */));
         REQUIRE(reinterpret_cast<void*>(NVDX_OBJECT_NONE) == nullptr);
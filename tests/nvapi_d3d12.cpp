@@ -4,6 +4,8 @@
 #include "mocks/d3d12_mocks.h"
 #include "nvapi/default_test_environment.h"
 
+#include <thread>
+
 using namespace trompeloeil;
 
 // previous version of this structure before the union gained a new dmmTriangles member in R535
@@ -25,6 +27,9 @@ TEST_CASE("D3D12 methods succeed", "[.d3d12]") {
     D3D12Vkd3dCommandQueueMock commandQueue;
     D3DLowLatencyDeviceMock lowLatencyDevice;
     D3D12Vkd3dGraphicsCommandListMock commandList;
+    PrivateDataStore devicePrivateData;
+    PrivateDataStore commandQueuePrivateData;
+    PrivateDataStore commandListPrivateData;
     auto deviceRefCount = 0;
     auto commandListRefCount = 0;
     auto commandQueueRefCount = 0;
@@ -55,6 +60,12 @@ TEST_CASE("D3D12 methods succeed", "[.d3d12]") {
 
     ALLOW_CALL(device, QueryInterface(__uuidof(ID3DLowLatencyDevice), _))
         .RETURN(E_NOINTERFACE);
+    ALLOW_CALL(device, QueryInterface(__uuidof(ID3D12Object), _))
+        .LR_SIDE_EFFECT(*_2 = static_cast<ID3D12Object*>(&device))
+        .LR_SIDE_EFFECT(deviceRefCount++)
+        .RETURN(S_OK);
+    ALLOW_CALL(device, SetPrivateDataInterface(_, _))
+        .LR_RETURN(devicePrivateData.SetPrivateDataInterface(_1, _2));
 
     ALLOW_CALL(device, GetExtensionSupport(_))
         .RETURN(true);
@@ -79,6 +90,8 @@ TEST_CASE("D3D12 methods succeed", "[.d3d12]") {
     ALLOW_CALL(commandList, Release())
         .LR_SIDE_EFFECT(commandListRefCount--)
         .RETURN(commandListRefCount);
+    ALLOW_CALL(commandList, SetPrivateDataInterface(_, _))
+        .LR_RETURN(commandListPrivateData.SetPrivateDataInterface(_1, _2));
 
     ALLOW_CALL(commandQueue, QueryInterface(__uuidof(ID3D12CommandQueue), _))
         .LR_SIDE_EFFECT(*_2 = static_cast<ID3D12CommandQueue*>(&commandQueue))
@@ -90,6 +103,12 @@ TEST_CASE("D3D12 methods succeed", "[.d3d12]") {
         .RETURN(S_OK);
     ALLOW_CALL(commandQueue, QueryInterface(__uuidof(ID3D11DeviceChild), _))
         .RETURN(E_NOINTERFACE);
+    ALLOW_CALL(commandQueue, QueryInterface(__uuidof(ID3D12Object), _))
+        .LR_SIDE_EFFECT(*_2 = static_cast<ID3D12Object*>(&commandQueue))
+        .LR_SIDE_EFFECT(commandQueueRefCount++)
+        .RETURN(S_OK);
+    ALLOW_CALL(commandQueue, SetPrivateDataInterface(_, _))
+        .LR_RETURN(commandQueuePrivateData.SetPrivateDataInterface(_1, _2));
     ALLOW_CALL(commandQueue, AddRef())
         .LR_SIDE_EFFECT(commandQueueRefCount++)
         .RETURN(commandQueueRefCount);
@@ -101,20 +120,45 @@ TEST_CASE("D3D12 methods succeed", "[.d3d12]") {
         .LR_SIDE_EFFECT(deviceRefCount++)
         .RETURN(S_OK);
 
-    SECTION("CreateGraphicsPipelineState for other than SetDepthBounds returns not-supported") {
+    SECTION("CreateGraphicsPipelineState for extensions without VKD3D-Proton equivalent returns not-supported") {
         FORBID_CALL(device, CreateGraphicsPipelineState(_, _, _));
 
+        auto psoExtension = GENERATE(
+            NV_PSO_RASTER_EXTENSION,
+            NV_PSO_GEOMETRY_SHADER_EXTENSION,
+            NV_PSO_EXPLICIT_FASTGS_EXTENSION,
+            NV_PSO_VERTEX_SHADER_EXTENSION,
+            NV_PSO_DOMAIN_SHADER_EXTENSION,
+            NV_PSO_HULL_SHADER_EXTENSION,
+            static_cast<NV_PSO_EXTENSION>(0x42));
+
         // See https://developer.nvidia.com/unlocking-gpu-intrinsics-hlsl how to use NvAPI_D3D12_CreateGraphicsPipelineState
         auto desc = D3D12_GRAPHICS_PIPELINE_STATE_DESC{};
-        NVAPI_D3D12_PSO_SET_SHADER_EXTENSION_SLOT_DESC extensionDesc;
+        NVAPI_D3D12_PSO_EXTENSION_DESC extensionDesc{};
         extensionDesc.baseVersion = NV_PSO_EXTENSION_DESC_VER;
-        extensionDesc.psoExtension = NV_PSO_SET_SHADER_EXTNENSION_SLOT_AND_SPACE;
-        extensionDesc.version = NV_SET_SHADER_EXTENSION_SLOT_DESC_VER;
+        extensionDesc.psoExtension = psoExtension;
         const NVAPI_D3D12_PSO_EXTENSION_DESC* extensions[] = {&extensionDesc};
         ID3D12PipelineState* pipelineState = nullptr;
         REQUIRE(NvAPI_D3D12_CreateGraphicsPipelineState(&device, &desc, 1, extensions, &pipelineState) == NVAPI_NOT_SUPPORTED);
     }
 
+    SECTION("CreateGraphicsPipelineState with supported and unsupported extensions returns not-supported") {
+        FORBID_CALL(device, CreateGraphicsPipelineState(_, _, _));
+        FORBID_CALL(device, SetNvShaderExtnSlotSpace(_, _, _));
+
+        auto desc = D3D12_GRAPHICS_PIPELINE_STATE_DESC{};
+        NVAPI_D3D12_PSO_SET_SHADER_EXTENSION_SLOT_DESC slotDesc{};
+        slotDesc.baseVersion = NV_PSO_EXTENSION_DESC_VER;
+        slotDesc.psoExtension = NV_PSO_SET_SHADER_EXTNENSION_SLOT_AND_SPACE;
+        slotDesc.version = NV_SET_SHADER_EXTENSION_SLOT_DESC_VER;
+        NVAPI_D3D12_PSO_EXTENSION_DESC rasterDesc{};
+        rasterDesc.baseVersion = NV_PSO_EXTENSION_DESC_VER;
+        rasterDesc.psoExtension = NV_PSO_RASTER_EXTENSION;
+        const NVAPI_D3D12_PSO_EXTENSION_DESC* extensions[] = {&slotDesc, &rasterDesc};
+        ID3D12PipelineState* pipelineState = nullptr;
+        REQUIRE(NvAPI_D3D12_CreateGraphicsPipelineState(&device, &desc, 2, extensions, &pipelineState) == NVAPI_NOT_SUPPORTED);
+    }
+
     SECTION("D3D12 methods without VKD3D-Proton return error") {
         ALLOW_CALL(device, QueryInterface(__uuidof(ID3D12DeviceExt), _))
             .RETURN(E_NOINTERFACE);
@@ -309,14 +353,15 @@ TEST_CASE("D3D12 methods succeed", "[.d3d12]") {
 
             ::SetEnvironmentVariableA("DXVK_NVAPI_ALLOW_OTHER_DRIVERS", "1");
 
-            auto extensionNames = std::set<std::string>{VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME};
-            extensionNames.insert(args.extensionNames.begin(), args.extensionNames.end());
+            auto extensions = std::map<std::string, uint32_t>{{VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME, 1}};
+            for (const auto& extensionName : args.extensionNames)
+                extensions.emplace(extensionName, 1);
 
             luid.HighPart = 0x00000002;
             luid.LowPart = 0x00000001;
 
             ALLOW_CALL(*t->Vk(), GetDeviceExtensions(_, _))
-                .RETURN(extensionNames);
+                .RETURN(extensions);
             ALLOW_CALL(*t->Vk(), GetPhysicalDeviceProperties2(_, _, _))
                 .SIDE_EFFECT(
                     VkMock::ConfigureGetPhysicalDeviceProperties2(_3,
@@ -373,6 +418,182 @@ TEST_CASE("D3D12 methods succeed", "[.d3d12]") {
             REQUIRE(NvAPI_D3D12_CreateGraphicsPipelineState(&device, &desc, 1, extensions, &pipelineState) == NVAPI_OK);
         }
 
+        SECTION("CreateGraphicsPipelineState for SetShaderExtensionSlot returns OK") {
+            // DXVK_NVAPI_D3D12_NV_SHADER_EXTN = 1 is set in section starting listener
+            auto desc = D3D12_GRAPHICS_PIPELINE_STATE_DESC{};
+            NVAPI_D3D12_PSO_SET_SHADER_EXTENSION_SLOT_DESC extensionDesc{};
+            extensionDesc.baseVersion = NV_PSO_EXTENSION_DESC_VER_1;
+            extensionDesc.psoExtension = NV_PSO_SET_SHADER_EXTNENSION_SLOT_AND_SPACE;
+            extensionDesc.version = NV_SET_SHADER_EXTENSION_SLOT_DESC_VER;
+            extensionDesc.uavSlot = 1U;
+            extensionDesc.registerSpace = 2U;
+            const NVAPI_D3D12_PSO_EXTENSION_DESC* extensions[] = {&extensionDesc};
+            ID3D12PipelineState* pipelineState = nullptr;
+
+            SECTION("CreateGraphicsPipelineState for SetShaderExtensionSlot resets the slot of the thread afterwards") {
+                sequence seq;
+                REQUIRE_CALL(device, SetNvShaderExtnSlotSpace(1U, 2U, true))
+                    .IN_SEQUENCE(seq)
+                    .RETURN(S_OK);
+                REQUIRE_CALL(device, CreateGraphicsPipelineState(&desc, __uuidof(ID3D12PipelineState), reinterpret_cast<void**>(&pipelineState)))
+                    .IN_SEQUENCE(seq)
+                    .RETURN(S_OK);
+                REQUIRE_CALL(device, SetNvShaderExtnSlotSpace(~0U, ~0U, true))
+                    .IN_SEQUENCE(seq)
+                    .RETURN(S_OK);
+
+                REQUIRE(NvAPI_D3D12_CreateGraphicsPipelineState(&device, &desc, 1, extensions, &pipelineState) == NVAPI_OK);
+            }
+
+            SECTION("CreateGraphicsPipelineState for SetShaderExtensionSlot restores the slot set by SetNvShaderExtnSlotSpaceLocalThread") {
+                sequence seq;
+                REQUIRE_CALL(device, SetNvShaderExtnSlotSpace(3U, 4U, true))
+                    .IN_SEQUENCE(seq)
+                    .RETURN(S_OK);
+                REQUIRE_CALL(device, SetNvShaderExtnSlotSpace(1U, 2U, true))
+                    .IN_SEQUENCE(seq)
+                    .RETURN(S_OK);
+                REQUIRE_CALL(device, CreateGraphicsPipelineState(&desc, __uuidof(ID3D12PipelineState), reinterpret_cast<void**>(&pipelineState)))
+                    .IN_SEQUENCE(seq)
+                    .RETURN(S_OK);
+                REQUIRE_CALL(device, SetNvShaderExtnSlotSpace(3U, 4U, true))
+                    .IN_SEQUENCE(seq)
+                    .RETURN(S_OK);
+
+                REQUIRE(NvAPI_D3D12_SetNvShaderExtnSlotSpaceLocalThread(static_cast<ID3D12Device*>(&device), 3U, 4U) == NVAPI_OK);
+                REQUIRE(NvAPI_D3D12_CreateGraphicsPipelineState(&device, &desc, 1, extensions, &pipelineState) == NVAPI_OK);
+            }
+
+            SECTION("CreateGraphicsPipelineState for SetShaderExtensionSlot leaves the slot set by SetNvShaderExtnSlotSpace to the device") {
+                sequence seq;
+                REQUIRE_CALL(device, SetNvShaderExtnSlotSpace(3U, 4U, false))
+                    .IN_SEQUENCE(seq)
+                    .RETURN(S_OK);
+                REQUIRE_CALL(device, SetNvShaderExtnSlotSpace(1U, 2U, true))
+                    .IN_SEQUENCE(seq)
+                    .RETURN(S_OK);
+                REQUIRE_CALL(device, CreateGraphicsPipelineState(&desc, __uuidof(ID3D12PipelineState), reinterpret_cast<void**>(&pipelineState)))
+                    .IN_SEQUENCE(seq)
+                    .RETURN(S_OK);
+                REQUIRE_CALL(device, SetNvShaderExtnSlotSpace(~0U, ~0U, true))
+                    .IN_SEQUENCE(seq)
+                    .RETURN(S_OK);
+                REQUIRE_CALL(device, SetNvShaderExtnSlotSpace(5U, 6U, false))
+                    .IN_SEQUENCE(seq)
+                    .RETURN(S_OK);
+                REQUIRE_CALL(device, SetNvShaderExtnSlotSpace(1U, 2U, true))
+                    .IN_SEQUENCE(seq)
+                    .RETURN(S_OK);
+                REQUIRE_CALL(device, CreateGraphicsPipelineState(&desc, __uuidof(ID3D12PipelineState), reinterpret_cast<void**>(&pipelineState)))
+                    .IN_SEQUENCE(seq)
+                    .RETURN(S_OK);
+                REQUIRE_CALL(device, SetNvShaderExtnSlotSpace(~0U, ~0U, true))
+                    .IN_SEQUENCE(seq)
+                    .RETURN(S_OK);
+
+                REQUIRE(NvAPI_D3D12_SetNvShaderExtnSlotSpace(static_cast<ID3D12Device*>(&device), 3U, 4U) == NVAPI_OK);
+                REQUIRE(NvAPI_D3D12_CreateGraphicsPipelineState(&device, &desc, 1, extensions, &pipelineState) == NVAPI_OK);
+                REQUIRE(NvAPI_D3D12_SetNvShaderExtnSlotSpace(static_cast<ID3D12Device*>(&device), 5U, 6U) == NVAPI_OK);
+                REQUIRE(NvAPI_D3D12_CreateGraphicsPipelineState(&device, &desc, 1, extensions, &pipelineState) == NVAPI_OK);
+            }
+
+            SECTION("CreateGraphicsPipelineState for SetShaderExtensionSlot restores the slot when pipeline creation fails") {
+                sequence seq;
+                REQUIRE_CALL(device, SetNvShaderExtnSlotSpace(3U, 4U, true))
+                    .IN_SEQUENCE(seq)
+                    .RETURN(S_OK);
+                REQUIRE_CALL(device, SetNvShaderExtnSlotSpace(1U, 2U, true))
+                    .IN_SEQUENCE(seq)
+                    .RETURN(S_OK);
+                REQUIRE_CALL(device, CreateGraphicsPipelineState(&desc, __uuidof(ID3D12PipelineState), reinterpret_cast<void**>(&pipelineState)))
+                    .IN_SEQUENCE(seq)
+                    .RETURN(E_INVALIDARG);
+                REQUIRE_CALL(device, SetNvShaderExtnSlotSpace(3U, 4U, true))
+                    .IN_SEQUENCE(seq)
+                    .RETURN(S_OK);
+
+                REQUIRE(NvAPI_D3D12_SetNvShaderExtnSlotSpaceLocalThread(static_cast<ID3D12Device*>(&device), 3U, 4U) == NVAPI_OK);
+                REQUIRE(NvAPI_D3D12_CreateGraphicsPipelineState(&device, &desc, 1, extensions, &pipelineState) == NVAPI_NOT_SUPPORTED);
+            }
+        }
+
+        SECTION("CreateGraphicsPipelineState for SetShaderExtensionSlot without VKD3D-Proton support returns not-supported") {
+            ALLOW_CALL(device, QueryInterface(__uuidof(ID3D12DeviceExt4), _))
+                .RETURN(E_NOTIMPL);
+            FORBID_CALL(device, CreateGraphicsPipelineState(_, _, _));
+
+            auto desc = D3D12_GRAPHICS_PIPELINE_STATE_DESC{};
+            NVAPI_D3D12_PSO_SET_SHADER_EXTENSION_SLOT_DESC extensionDesc{};
+            extensionDesc.baseVersion = NV_PSO_EXTENSION_DESC_VER_1;
+            extensionDesc.psoExtension = NV_PSO_SET_SHADER_EXTNENSION_SLOT_AND_SPACE;
+            extensionDesc.version = NV_SET_SHADER_EXTENSION_SLOT_DESC_VER;
+            const NVAPI_D3D12_PSO_EXTENSION_DESC* extensions[] = {&extensionDesc};
+            ID3D12PipelineState* pipelineState = nullptr;
+            REQUIRE(NvAPI_D3D12_CreateGraphicsPipelineState(&device, &desc, 1, extensions, &pipelineState) == NVAPI_NOT_SUPPORTED);
+        }
+
+        SECTION("CreateGraphicsPipelineState for RequestFastGS returns OK") {
+            auto desc = D3D12_GRAPHICS_PIPELINE_STATE_DESC{};
+            NVAPI_D3D12_PSO_EXTENSION_DESC extensionDesc{};
+            extensionDesc.baseVersion = NV_PSO_EXTENSION_DESC_VER_1;
+            extensionDesc.psoExtension = NV_PSO_REQUEST_FASTGS_EXTENSION;
+            const NVAPI_D3D12_PSO_EXTENSION_DESC* extensions[] = {&extensionDesc};
+            ID3D12PipelineState* pipelineState = nullptr;
+            REQUIRE_CALL(device, CreateGraphicsPipelineState(&desc, __uuidof(ID3D12PipelineState), reinterpret_cast<void**>(&pipelineState)))
+                .RETURN(S_OK);
+
+            REQUIRE(NvAPI_D3D12_CreateGraphicsPipelineState(&device, &desc, 1, extensions, &pipelineState) == NVAPI_OK);
+        }
+
+        SECTION("CreateGraphicsPipelineState repeatedly for SetDepthBounds and RequestFastGS returns OK") {
+            auto desc = D3D12_GRAPHICS_PIPELINE_STATE_DESC{};
+            NVAPI_D3D12_PSO_ENABLE_DEPTH_BOUND_TEST_DESC_V1 depthBoundDesc{};
+            depthBoundDesc.baseVersion = NV_PSO_EXTENSION_DESC_VER_1;
+            depthBoundDesc.psoExtension = NV_PSO_ENABLE_DEPTH_BOUND_TEST_EXTENSION;
+            depthBoundDesc.version = NV_ENABLE_DEPTH_BOUND_TEST_PSO_EXTENSION_DESC_VER;
+            depthBoundDesc.EnableDBT = true;
+            NVAPI_D3D12_PSO_EXTENSION_DESC fastGSDesc{};
+            fastGSDesc.baseVersion = NV_PSO_EXTENSION_DESC_VER_1;
+            fastGSDesc.psoExtension = NV_PSO_REQUEST_FASTGS_EXTENSION;
+            const NVAPI_D3D12_PSO_EXTENSION_DESC* extensions[] = {&depthBoundDesc, &fastGSDesc};
+            ID3D12PipelineState* pipelineState = nullptr;
+            REQUIRE_CALL(device, CreateGraphicsPipelineState(&desc, __uuidof(ID3D12PipelineState), reinterpret_cast<void**>(&pipelineState)))
+                .TIMES(3)
+                .RETURN(S_OK);
+
+            for (auto i = 0U; i < 3U; i++)
+                REQUIRE(NvAPI_D3D12_CreateGraphicsPipelineState(&device, &desc, 2, extensions, &pipelineState) == NVAPI_OK);
+        }
+
+        SECTION("CreateGraphicsPipelineState with failing pipeline creation returns not-supported") {
+            auto desc = D3D12_GRAPHICS_PIPELINE_STATE_DESC{};
+            NVAPI_D3D12_PSO_ENABLE_DEPTH_BOUND_TEST_DESC_V1 extensionDesc{};
+            extensionDesc.baseVersion = NV_PSO_EXTENSION_DESC_VER_1;
+            extensionDesc.psoExtension = NV_PSO_ENABLE_DEPTH_BOUND_TEST_EXTENSION;
+            extensionDesc.version = NV_ENABLE_DEPTH_BOUND_TEST_PSO_EXTENSION_DESC_VER;
+            const NVAPI_D3D12_PSO_EXTENSION_DESC* extensions[] = {&extensionDesc};
+            ID3D12PipelineState* pipelineState = nullptr;
+            REQUIRE_CALL(device, CreateGraphicsPipelineState(_, _, _))
+                .RETURN(E_INVALIDARG);
+
+            REQUIRE(NvAPI_D3D12_CreateGraphicsPipelineState(&device, &desc, 1, extensions, &pipelineState) == NVAPI_NOT_SUPPORTED);
+        }
+
+        SECTION("CreateGraphicsPipelineState with unknown struct version of a later extension returns incompatible-struct-version") {
+            FORBID_CALL(device, CreateGraphicsPipelineState(_, _, _));
+
+            auto desc = D3D12_GRAPHICS_PIPELINE_STATE_DESC{};
+            NVAPI_D3D12_PSO_EXTENSION_DESC depthBoundDesc{};
+            depthBoundDesc.baseVersion = NV_PSO_EXTENSION_DESC_VER_1;
+            depthBoundDesc.psoExtension = NV_PSO_ENABLE_DEPTH_BOUND_TEST_EXTENSION;
+            NVAPI_D3D12_PSO_EXTENSION_DESC fastGSDesc{};
+            fastGSDesc.baseVersion = NV_PSO_EXTENSION_DESC_VER_1 + 1;
+            fastGSDesc.psoExtension = NV_PSO_REQUEST_FASTGS_EXTENSION;
+            const NVAPI_D3D12_PSO_EXTENSION_DESC* extensions[] = {&depthBoundDesc, &fastGSDesc};
+            ID3D12PipelineState* pipelineState = nullptr;
+            REQUIRE(NvAPI_D3D12_CreateGraphicsPipelineState(&device, &desc, 2, extensions, &pipelineState) == NVAPI_INCOMPATIBLE_STRUCT_VERSION);
+        }
+
         SECTION("CreateGraphicsPipelineState with unknown struct version returns incompatible-struct-version") {
             auto desc = D3D12_GRAPHICS_PIPELINE_STATE_DESC{};
             NVAPI_D3D12_PSO_ENABLE_DEPTH_BOUND_TEST_DESC extensionDesc;
@@ -546,6 +767,167 @@ TEST_CASE("D3D12 methods succeed", "[.d3d12]") {
         REQUIRE(NvAPI_D3D12_LaunchCubinShader(static_cast<ID3D12GraphicsCommandList*>(&commandList), handle, blockX, blockY, blockZ, params, paramSize) == NVAPI_OK);
     }
 
+    SECTION("Launch CuBIN after destroying and recreating the same handle uses the new SMEM") {
+        auto blockX = 3U;
+        auto blockY = 4U;
+        auto blockZ = 5U;
+        auto shaderName = "shader";
+        NVDX_ObjectHandle handle{};
+        const void* params = nullptr;
+        auto paramSize = 7U;
+        const void* rawParam = nullptr;
+        auto rawParamCount = 0U;
+        ALLOW_CALL(device, CreateCubinComputeShaderWithName(_, _, blockX, blockY, blockZ, shaderName, _))
+            .SIDE_EFFECT(*_7 = reinterpret_cast<D3D12_CUBIN_DATA_HANDLE*>(0x912122))
+            .RETURN(S_OK);
+        REQUIRE_CALL(device, DestroyCubinComputeShader(reinterpret_cast<D3D12_CUBIN_DATA_HANDLE*>(0x912122)))
+            .RETURN(S_OK)
+            .TIMES(1);
+        REQUIRE_CALL(commandList, LaunchCubinShaderEx(_, blockX, blockY, blockZ, 6U, params, paramSize, rawParam, rawParamCount))
+            .RETURN(S_OK)
+            .TIMES(2);
+        REQUIRE_CALL(commandList, LaunchCubinShaderEx(_, blockX, blockY, blockZ, 8U, params, paramSize, rawParam, rawParamCount))
+            .RETURN(S_OK)
+            .TIMES(1);
+
+        REQUIRE(NvAPI_D3D12_CreateCubinComputeShaderEx(static_cast<ID3D12Device*>(&device), nullptr, 0, blockX, blockY, blockZ, 6U, shaderName, &handle) == NVAPI_OK);
+        REQUIRE(NvAPI_D3D12_LaunchCubinShader(static_cast<ID3D12GraphicsCommandList*>(&commandList), handle, blockX, blockY, blockZ, params, paramSize) == NVAPI_OK);
+        REQUIRE(NvAPI_D3D12_LaunchCubinShader(static_cast<ID3D12GraphicsCommandList*>(&commandList), handle, blockX, blockY, blockZ, params, paramSize) == NVAPI_OK);
+
+        REQUIRE(NvAPI_D3D12_DestroyCubinComputeShader(static_cast<ID3D12Device*>(&device), handle) == NVAPI_OK);
+        REQUIRE(NvAPI_D3D12_CreateCubinComputeShaderEx(static_cast<ID3D12Device*>(&device), nullptr, 0, blockX, blockY, blockZ, 8U, shaderName, &handle) == NVAPI_OK);
+        REQUIRE(NvAPI_D3D12_LaunchCubinShader(static_cast<ID3D12GraphicsCommandList*>(&commandList), handle, blockX, blockY, blockZ, params, paramSize) == NVAPI_OK);
+    }
+
+    SECTION("Wrappers are created once and shared between threads") {
+        std::array<NvapiD3d12GraphicsCommandList*, 4> commandLists{};
+        std::array<NvapiD3d12CommandQueue*, 4> commandQueues{};
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < commandLists.size(); i++)
+            threads.emplace_back([&, i] {
+                commandLists[i] = NvapiD3d12GraphicsCommandList::GetOrCreate(&commandList);
+                commandQueues[i] = NvapiD3d12CommandQueue::GetOrCreate(&commandQueue);
+            });
+
+        for (auto& thread : threads)
+            thread.join();
+
+        REQUIRE(commandLists[0] != nullptr);
+        REQUIRE(commandQueues[0] != nullptr);
+        REQUIRE(std::ranges::all_of(commandLists, [&](auto wrapper) { return wrapper == commandLists[0]; }));
+        REQUIRE(std::ranges::all_of(commandQueues, [&](auto wrapper) { return wrapper == commandQueues[0]; }));
+        REQUIRE(NvapiD3d12GraphicsCommandList::GetOrCreate(&commandList) == commandLists[0]);
+
+        // The last hit of this thread must not survive a reset
+        REQUIRE_CALL(commandList, QueryInterface(__uuidof(ID3D12GraphicsCommandListExt), _))
+            .LR_SIDE_EFFECT(*_2 = static_cast<ID3D12GraphicsCommandListExt*>(&commandList))
+            .LR_SIDE_EFFECT(commandListRefCount++)
+            .RETURN(S_OK)
+            .TIMES(1);
+
+        NvapiD3d12GraphicsCommandList::Reset();
+        REQUIRE(NvapiD3d12GraphicsCommandList::GetOrCreate(&commandList) != nullptr);
+    }
+
+    SECTION("Wrappers are dropped when their objects get destroyed") {
+        REQUIRE(NvapiD3d12GraphicsCommandList::GetOrCreate(&commandList) != nullptr);
+        REQUIRE(NvapiD3d12CommandQueue::GetOrCreate(&commandQueue) != nullptr);
+        REQUIRE(commandListPrivateData.Size() == 1);
+        REQUIRE(commandQueuePrivateData.Size() == 1);
+
+        // Every lookup after a destruction wraps the object again, the one right after that hits
+        constexpr auto churnCount = 16U;
+        REQUIRE_CALL(commandList, QueryInterface(__uuidof(ID3D12GraphicsCommandListExt), _))
+            .LR_SIDE_EFFECT(*_2 = static_cast<ID3D12GraphicsCommandListExt*>(&commandList))
+            .LR_SIDE_EFFECT(commandListRefCount++)
+            .RETURN(S_OK)
+            .TIMES(churnCount);
+
+        for (auto i = 0U; i < churnCount; i++) {
+            commandListPrivateData.Destroy();
+            REQUIRE(NvapiD3d12GraphicsCommandList::GetOrCreate(&commandList) != nullptr);
+            REQUIRE(NvapiD3d12GraphicsCommandList::GetOrCreate(&commandList) != nullptr);
+        }
+
+        FORBID_CALL(commandQueue, QueryInterface(__uuidof(ID3D12CommandQueueExt), _));
+        REQUIRE(NvapiD3d12CommandQueue::GetOrCreate(&commandQueue) != nullptr);
+    }
+
+    SECTION("Destroying an object wrapped before a reset keeps the current wrapper") {
+        REQUIRE(NvapiD3d12Device::GetOrCreate(&device) != nullptr);
+        NvapiD3d12Device::Reset();
+
+        // The reset released the notifier of the first wrapper, wrapping again attaches a new one
+        REQUIRE(devicePrivateData.Size() == 0);
+        REQUIRE(NvapiD3d12Device::GetOrCreate(&device) != nullptr);
+        REQUIRE(devicePrivateData.Size() == 1);
+
+        FORBID_CALL(device, QueryInterface(__uuidof(ID3D12DeviceExt), _));
+        REQUIRE(NvapiD3d12Device::GetOrCreate(&device) != nullptr);
+    }
+
+    SECTION("Reset detaches the notifiers from objects that are still alive") {
+        REQUIRE(NvapiD3d12Device::GetOrCreate(&device) != nullptr);
+        REQUIRE(NvapiD3d12GraphicsCommandList::GetOrCreate(&commandList) != nullptr);
+        REQUIRE(NvapiD3d12CommandQueue::GetOrCreate(&commandQueue) != nullptr);
+        REQUIRE(devicePrivateData.Size() == 1);
+        REQUIRE(commandListPrivateData.Size() == 1);
+        REQUIRE(commandQueuePrivateData.Size() == 1);
+
+        NvapiD3d12Device::Reset();
+        NvapiD3d12GraphicsCommandList::Reset();
+        NvapiD3d12CommandQueue::Reset();
+
+        REQUIRE(devicePrivateData.Size() == 0);
+        REQUIRE(commandListPrivateData.Size() == 0);
+        REQUIRE(commandQueuePrivateData.Size() == 0);
+    }
+
+
+        auto cubinData = std::array<uint8_t, 12>{0x7f, 'E', 'L', 'F', 1, 2, 3, 4, 5, 6, 7, 8};
+        auto otherCubinData = cubinData;
+        auto cubinSize = static_cast<NvU32>(cubinData.size());
+        auto blockX = 3U;
+        auto blockY = 4U;
+        auto blockZ = 5U;
+        auto shaderName = "shader";
+        NVDX_ObjectHandle handle1{};
+        NVDX_ObjectHandle handle2{};
+        NVDX_ObjectHandle handle3{};
+        REQUIRE_CALL(device, CreateCubinComputeShaderWithName(_, cubinSize, blockX, blockY, blockZ, _, _))
+            .LR_WITH(_1 == cubinData.data() && _6 == std::string("shader"))
+            .SIDE_EFFECT(*_7 = reinterpret_cast<D3D12_CUBIN_DATA_HANDLE*>(0x912122))
+            .RETURN(S_OK)
+            .TIMES(1);
+        REQUIRE_CALL(device, CreateCubinComputeShaderWithName(_, cubinSize, blockX, blockY, blockZ, _, _))
+            .LR_WITH(_1 == cubinData.data() && _6 == std::string("other"))
+            .SIDE_EFFECT(*_7 = reinterpret_cast<D3D12_CUBIN_DATA_HANDLE*>(0x912123))
+            .RETURN(S_OK)
+            .TIMES(1);
+
+        REQUIRE(NvAPI_D3D12_CreateCubinComputeShaderEx(static_cast<ID3D12Device*>(&device), cubinData.data(), cubinSize, blockX, blockY, blockZ, 6U, shaderName, &handle1) == NVAPI_OK);
+        REQUIRE(NvAPI_D3D12_CreateCubinComputeShaderEx(static_cast<ID3D12Device*>(&device), otherCubinData.data(), cubinSize, blockX, blockY, blockZ, 6U, shaderName, &handle2) == NVAPI_OK);
+        REQUIRE(NvAPI_D3D12_CreateCubinComputeShaderEx(static_cast<ID3D12Device*>(&device), cubinData.data(), cubinSize, blockX, blockY, blockZ, 6U, "other", &handle3) == NVAPI_OK);
+        REQUIRE(handle1 == reinterpret_cast<NVDX_ObjectHandle>(0x912122));
+        REQUIRE(handle2 == handle1);
+        REQUIRE(handle3 == reinterpret_cast<NVDX_ObjectHandle>(0x912123));
+
+        {
+            FORBID_CALL(device, DestroyCubinComputeShader(_));
+            REQUIRE(NvAPI_D3D12_DestroyCubinComputeShader(static_cast<ID3D12Device*>(&device), handle1) == NVAPI_OK);
+        }
+
+        REQUIRE_CALL(device, DestroyCubinComputeShader(reinterpret_cast<D3D12_CUBIN_DATA_HANDLE*>(0x912122)))
+            .RETURN(S_OK)
+            .TIMES(1);
+        REQUIRE_CALL(device, DestroyCubinComputeShader(reinterpret_cast<D3D12_CUBIN_DATA_HANDLE*>(0x912123)))
+            .RETURN(S_OK)
+            .TIMES(1);
+
+        REQUIRE(NvAPI_D3D12_DestroyCubinComputeShader(static_cast<ID3D12Device*>(&device), handle2) == NVAPI_OK);
+        REQUIRE(NvAPI_D3D12_DestroyCubinComputeShader(static_cast<ID3D12Device*>(&device), handle3) == NVAPI_OK);
+    }
+
     SECTION("Launch CuBIN without ID3D12GraphicsCommandListExt1 returns OK") {
         ALLOW_CALL(commandList, QueryInterface(__uuidof(ID3D12GraphicsCommandListExt1), _))
             .RETURN(E_NOINTERFACE);
@@ -567,39 +949,13 @@ TEST_CASE("D3D12 methods succeed", "[.d3d12]") {
 
     SECTION("CuBIN64 functions succeed") {
         auto t = std::make_unique<DefaultTestEnvironment>();
-        auto otherDevice = t->D3D12Device();
-        auto otherDeviceRefCount = 0;
         auto e = t->ConfigureExpectations();
 
-        ALLOW_CALL(*otherDevice, AddRef())
-            .LR_SIDE_EFFECT(otherDeviceRefCount++)
-            .RETURN(otherDeviceRefCount);
-        ALLOW_CALL(*otherDevice, Release())
-            .LR_SIDE_EFFECT(otherDeviceRefCount--)
-            .RETURN(otherDeviceRefCount);
-        ALLOW_CALL(*otherDevice, QueryInterface(__uuidof(ID3D12DeviceExt2), _))
-            .LR_SIDE_EFFECT(*_2 = static_cast<ID3D12DeviceExt2*>(otherDevice))
-            .LR_SIDE_EFFECT(otherDeviceRefCount++)
-            .RETURN(S_OK);
-        ALLOW_CALL(*otherDevice, SupportsCubin64bit())
-            .RETURN(true);
+        ALLOW_CALL(*t->Vk(), GetDeviceExtensions(_, _))
+            .RETURN(std::map<std::string, uint32_t>{{VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME, 1}, {VK_NVX_BINARY_IMPORT_EXTENSION_NAME, 1}, {VK_NVX_IMAGE_VIEW_HANDLE_EXTENSION_NAME, 3}});
 
         REQUIRE(NvAPI_Initialize() == NVAPI_OK);
 
-        SECTION("CreateCubinComputeShaderExV2 without any ID3D12DeviceExt2 support returns no-implementation") {
-            ALLOW_CALL(*otherDevice, QueryInterface(__uuidof(ID3D12DeviceExt2), _))
-                .RETURN(E_NOINTERFACE);
-
-            REQUIRE(NvAPI_D3D12_CreateCubinComputeShaderExV2(nullptr) == NVAPI_NO_IMPLEMENTATION);
-        }
-
-        SECTION("CreateCubinComputeShaderExV2 without any CuBIN64 support returns no-implementation") {
-            ALLOW_CALL(*otherDevice, SupportsCubin64bit())
-                .RETURN(false);
-
-            REQUIRE(NvAPI_D3D12_CreateCubinComputeShaderExV2(nullptr) == NVAPI_NO_IMPLEMENTATION);
-        }
-
         SECTION("CreateCubinComputeShaderExV2 with null argument returns invalid-pointer") {
             REQUIRE(NvAPI_D3D12_CreateCubinComputeShaderExV2(nullptr) == NVAPI_INVALID_POINTER);
         }
@@ -619,20 +975,6 @@ TEST_CASE("D3D12 methods succeed", "[.d3d12]") {
             REQUIRE(params.hShader == reinterpret_cast<NVDX_ObjectHandle>(0x912122));
         }
 
-        SECTION("GetCudaMergedTextureSamplerObject without any ID3D12DeviceExt2 support returns no-implementation") {
-            ALLOW_CALL(*otherDevice, QueryInterface(__uuidof(ID3D12DeviceExt2), _))
-                .RETURN(E_NOINTERFACE);
-
-            REQUIRE(NvAPI_D3D12_GetCudaMergedTextureSamplerObject(nullptr) == NVAPI_NO_IMPLEMENTATION);
-        }
-
-        SECTION("GetCudaMergedTextureSamplerObject without any CuBIN64 support returns no-implementation") {
-            ALLOW_CALL(*otherDevice, SupportsCubin64bit())
-                .RETURN(false);
-
-            REQUIRE(NvAPI_D3D12_GetCudaMergedTextureSamplerObject(nullptr) == NVAPI_NO_IMPLEMENTATION);
-        }
-
         SECTION("GetCudaMergedTextureSamplerObject with null argument returns invalid-pointer") {
             REQUIRE(NvAPI_D3D12_GetCudaMergedTextureSamplerObject(nullptr) == NVAPI_INVALID_POINTER);
         }
@@ -651,20 +993,6 @@ TEST_CASE("D3D12 methods succeed", "[.d3d12]") {
             REQUIRE(params.textureHandle == 0x1234);
         }
 
-        SECTION("GetCudaIndependentDescriptorObject without any ID3D12DeviceExt2 support returns no-implementation") {
-            ALLOW_CALL(*otherDevice, QueryInterface(__uuidof(ID3D12DeviceExt2), _))
-                .RETURN(E_NOINTERFACE);
-
-            REQUIRE(NvAPI_D3D12_GetCudaIndependentDescriptorObject(nullptr) == NVAPI_NO_IMPLEMENTATION);
-        }
-
-        SECTION("GetCudaIndependentDescriptorObject without any CuBIN64 support returns no-implementation") {
-            ALLOW_CALL(*otherDevice, SupportsCubin64bit())
-                .RETURN(false);
-
-            REQUIRE(NvAPI_D3D12_GetCudaIndependentDescriptorObject(nullptr) == NVAPI_NO_IMPLEMENTATION);
-        }
-
         SECTION("GetCudaIndependentDescriptorObject with null argument returns invalid-pointer") {
             REQUIRE(NvAPI_D3D12_GetCudaIndependentDescriptorObject(nullptr) == NVAPI_INVALID_POINTER);
         }
@@ -683,8 +1011,81 @@ TEST_CASE("D3D12 methods succeed", "[.d3d12]") {
             REQUIRE(NvAPI_D3D12_GetCudaIndependentDescriptorObject(&params) == NVAPI_OK);
             REQUIRE(params.handle == 0x1234);
         }
+    }
+
+    SECTION("CuBIN64 support probe does not create a device") {
+        auto t = std::make_unique<DefaultTestEnvironment>();
+        auto otherDevice = t->D3D12Device();
+        auto e = t->ConfigureExpectations();
+
+        FORBID_CALL(*otherDevice, AddRef());
+        FORBID_CALL(*otherDevice, QueryInterface(_, _));
+
+        SECTION("CuBIN64 functions without NVX extensions return no-implementation") {
+            REQUIRE(NvAPI_Initialize() == NVAPI_OK);
+
+            REQUIRE(NvAPI_D3D12_CreateCubinComputeShaderExV2(nullptr) == NVAPI_NO_IMPLEMENTATION);
+            REQUIRE(NvAPI_D3D12_GetCudaMergedTextureSamplerObject(nullptr) == NVAPI_NO_IMPLEMENTATION);
+            REQUIRE(NvAPI_D3D12_GetCudaIndependentDescriptorObject(nullptr) == NVAPI_NO_IMPLEMENTATION);
+        }
+
+        SECTION("CuBIN64 functions without VK_NVX_binary_import return no-implementation") {
+            ALLOW_CALL(*t->Vk(), GetDeviceExtensions(_, _))
+                .RETURN(std::map<std::string, uint32_t>{{VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME, 1}, {VK_NVX_IMAGE_VIEW_HANDLE_EXTENSION_NAME, 3}});
+
+            REQUIRE(NvAPI_Initialize() == NVAPI_OK);
+
+            REQUIRE(NvAPI_D3D12_CreateCubinComputeShaderExV2(nullptr) == NVAPI_NO_IMPLEMENTATION);
+            REQUIRE(NvAPI_D3D12_GetCudaMergedTextureSamplerObject(nullptr) == NVAPI_NO_IMPLEMENTATION);
+            REQUIRE(NvAPI_D3D12_GetCudaIndependentDescriptorObject(nullptr) == NVAPI_NO_IMPLEMENTATION);
+        }
+
+        SECTION("CuBIN64 functions without 64-bit image view handles return no-implementation") {
+            ALLOW_CALL(*t->Vk(), GetDeviceExtensions(_, _))
+                .RETURN(std::map<std::string, uint32_t>{{VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME, 1}, {VK_NVX_BINARY_IMPORT_EXTENSION_NAME, 1}, {VK_NVX_IMAGE_VIEW_HANDLE_EXTENSION_NAME, 2}});
+
+            REQUIRE(NvAPI_Initialize() == NVAPI_OK);
 
-        CHECK(otherDeviceRefCount == 0);
+            REQUIRE(NvAPI_D3D12_CreateCubinComputeShaderExV2(nullptr) == NVAPI_NO_IMPLEMENTATION);
+            REQUIRE(NvAPI_D3D12_GetCudaMergedTextureSamplerObject(nullptr) == NVAPI_NO_IMPLEMENTATION);
+            REQUIRE(NvAPI_D3D12_GetCudaIndependentDescriptorObject(nullptr) == NVAPI_NO_IMPLEMENTATION);
+        }
+
+        SECTION("CuBIN64 functions with 64-bit image view handles are available") {
+            ALLOW_CALL(*t->Vk(), GetDeviceExtensions(_, _))
+                .RETURN(std::map<std::string, uint32_t>{{VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME, 1}, {VK_NVX_BINARY_IMPORT_EXTENSION_NAME, 1}, {VK_NVX_IMAGE_VIEW_HANDLE_EXTENSION_NAME, 3}});
+
+            REQUIRE(NvAPI_Initialize() == NVAPI_OK);
+
+            REQUIRE(NvAPI_D3D12_CreateCubinComputeShaderExV2(nullptr) == NVAPI_INVALID_POINTER);
+            REQUIRE(NvAPI_D3D12_GetCudaMergedTextureSamplerObject(nullptr) == NVAPI_INVALID_POINTER);
+            REQUIRE(NvAPI_D3D12_GetCudaIndependentDescriptorObject(nullptr) == NVAPI_INVALID_POINTER);
+        }
+
+        SECTION("CreateCubinComputeShaderExV2 after wrapping a device with CuBIN64 support returns OK") {
+            ALLOW_CALL(*t->Vk(), GetDeviceExtensions(_, _))
+                .RETURN(std::map<std::string, uint32_t>{{VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME, 1}, {VK_NVX_BINARY_IMPORT_EXTENSION_NAME, 1}, {VK_NVX_IMAGE_VIEW_HANDLE_EXTENSION_NAME, 1}});
+
+            REQUIRE(NvAPI_Initialize() == NVAPI_OK);
+
+            ALLOW_CALL(device, IsNvShaderExtnOpCodeSupported(_))
+                .RETURN(false);
+
+            auto supported = true;
+            REQUIRE(NvAPI_D3D12_IsNvShaderExtnOpCodeSupported(&device, NV_EXTN_OP_HIT_OBJECT_REORDER_THREAD, &supported) == NVAPI_OK);
+
+            REQUIRE_CALL(device, CreateCubinComputeShaderExV2(_))
+                .SIDE_EFFECT(_1->hShader = reinterpret_cast<D3D12_CUBIN_DATA_HANDLE*>(0x912122))
+                .RETURN(S_OK)
+                .TIMES(1);
+
+            NVAPI_D3D12_CREATE_CUBIN_SHADER_PARAMS params{};
+            params.structSizeIn = sizeof(params);
+            params.pDevice = &device;
+            params.pShaderName = "shader";
+            REQUIRE(NvAPI_D3D12_CreateCubinComputeShaderExV2(&params) == NVAPI_OK);
+            REQUIRE(params.hShader == reinterpret_cast<NVDX_ObjectHandle>(0x912122));
+        }
     }
 
     SECTION("GetRaytracingCaps succeeds") {
@@ -705,7 +1106,7 @@ TEST_CASE("D3D12 methods succeed", "[.d3d12]") {
 
             SECTION("GetRaytracingCaps with reorder support returns OK") {
                 ALLOW_CALL(*t->Vk(), GetDeviceExtensions(_, _))
-                    .RETURN(std::set<std::string>{VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME, VK_NV_RAY_TRACING_INVOCATION_REORDER_EXTENSION_NAME});
+                    .RETURN(std::map<std::string, uint32_t>{{VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME, 1}, {VK_NV_RAY_TRACING_INVOCATION_REORDER_EXTENSION_NAME, 1}});
                 ALLOW_CALL(*t->Vk(), GetPhysicalDeviceProperties2(_, _, _))
                     .SIDE_EFFECT(
                         VkMock::ConfigureGetPhysicalDeviceProperties2(_3,
@@ -826,8 +1227,8 @@ TEST_CASE("D3D12 methods succeed", "[.d3d12]") {
                 .LR_SIDE_EFFECT({
                     d3d12Desc = *_1;
 
-                    // we know that our implementation passes pointer to data in stack-allocated vector in pGeometryDescs
-                    // so we need to copy it before the function returns and the vector is destroyed
+                    // we know that our implementation passes pointer to data in thread-local scratch memory in pGeometryDescs
+                    // so we need to copy it before the next call overwrites it
                     if (_1->Type == D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL && _1->DescsLayout == D3D12_ELEMENTS_LAYOUT_ARRAY)
                         geometryDescs.assign(_1->pGeometryDescs, _1->pGeometryDescs + _1->NumDescs);
                 });
@@ -889,6 +1290,40 @@ TEST_CASE("D3D12 methods succeed", "[.d3d12]") {
                 }
             }
 
+            SECTION("GetRaytracingAccelerationStructurePrebuildInfoEx with BLAS for array with D3D12 stride passes the array through") {
+                D3D12_RAYTRACING_GEOMETRY_DESC geometryDesc[2]{};
+                geometryDesc[0].Type = D3D12_RAYTRACING_GEOMETRY_TYPE_TRIANGLES;
+                geometryDesc[0].Triangles.IndexBuffer = 3;
+                geometryDesc[1].Type = D3D12_RAYTRACING_GEOMETRY_TYPE_PROCEDURAL_PRIMITIVE_AABBS;
+                geometryDesc[1].AABBs.AABBCount = 4;
+                desc.type = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL;
+                desc.descsLayout = D3D12_ELEMENTS_LAYOUT_ARRAY;
+                desc.numDescs = 2;
+                desc.pGeometryDescs = reinterpret_cast<NVAPI_D3D12_RAYTRACING_GEOMETRY_DESC_EX*>(geometryDesc);
+                desc.geometryDescStrideInBytes = sizeof(D3D12_RAYTRACING_GEOMETRY_DESC);
+
+                REQUIRE(NvAPI_D3D12_GetRaytracingAccelerationStructurePrebuildInfoEx(static_cast<ID3D12Device5*>(&device), &params) == NVAPI_OK);
+                REQUIRE(d3d12Desc.NumDescs == desc.numDescs);
+                REQUIRE(d3d12Desc.pGeometryDescs == geometryDesc);
+                REQUIRE(geometryDescs[0].Triangles.IndexBuffer == geometryDesc[0].Triangles.IndexBuffer);
+                REQUIRE(geometryDescs[1].AABBs.AABBCount == geometryDesc[1].AABBs.AABBCount);
+            }
+
+            SECTION("GetRaytracingAccelerationStructurePrebuildInfoEx with BLAS for array with D3D12 stride and OMM triangles returns invalid-argument") {
+                D3D12_RAYTRACING_GEOMETRY_DESC geometryDesc[2]{};
+                geometryDesc[0].Type = D3D12_RAYTRACING_GEOMETRY_TYPE_TRIANGLES;
+                geometryDesc[1].Type = static_cast<D3D12_RAYTRACING_GEOMETRY_TYPE>(NVAPI_D3D12_RAYTRACING_GEOMETRY_TYPE_OMM_TRIANGLES_EX);
+                desc.type = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL;
+                desc.descsLayout = D3D12_ELEMENTS_LAYOUT_ARRAY;
+                desc.numDescs = 2;
+                desc.pGeometryDescs = reinterpret_cast<NVAPI_D3D12_RAYTRACING_GEOMETRY_DESC_EX*>(geometryDesc);
+                desc.geometryDescStrideInBytes = sizeof(D3D12_RAYTRACING_GEOMETRY_DESC);
+
+                FORBID_CALL(device, GetRaytracingAccelerationStructurePrebuildInfo(_, _));
+
+                REQUIRE(NvAPI_D3D12_GetRaytracingAccelerationStructurePrebuildInfoEx(static_cast<ID3D12Device5*>(&device), &params) == NVAPI_INVALID_ARGUMENT);
+            }
+
             SECTION("GetRaytracingAccelerationStructurePrebuildInfoEx with BLAS for array of R520 structures") {
                 NVAPI_D3D12_RAYTRACING_GEOMETRY_DESC_EX_R520 geometryDescExR520[2];
                 desc.type = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL;
@@ -956,8 +1391,8 @@ TEST_CASE("D3D12 methods succeed", "[.d3d12]") {
                 .LR_SIDE_EFFECT({
                     d3d12Desc = *_1;
 
-                    // we know that our implementation passes pointer to data in stack-allocated vector in pGeometryDescs
-                    // so we need to copy it before the function returns and the vector is destroyed
+                    // we know that our implementation passes pointer to data in thread-local scratch memory in pGeometryDescs
+                    // so we need to copy it before the next call overwrites it
                     if (_1->Inputs.Type == D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL && _1->Inputs.DescsLayout == D3D12_ELEMENTS_LAYOUT_ARRAY)
                         geometryDescs.assign(_1->Inputs.pGeometryDescs, _1->Inputs.pGeometryDescs + _1->Inputs.NumDescs);
                 });
@@ -1031,6 +1466,25 @@ TEST_CASE("D3D12 methods succeed", "[.d3d12]") {
                 }
             }
 
+            SECTION("BuildRaytracingAccelerationStructureEx with BLAS for array with D3D12 stride passes the array through") {
+                D3D12_RAYTRACING_GEOMETRY_DESC geometryDesc[2]{};
+                geometryDesc[0].Type = D3D12_RAYTRACING_GEOMETRY_TYPE_TRIANGLES;
+                geometryDesc[0].Triangles.IndexBuffer = 3;
+                geometryDesc[1].Type = D3D12_RAYTRACING_GEOMETRY_TYPE_PROCEDURAL_PRIMITIVE_AABBS;
+                geometryDesc[1].AABBs.AABBCount = 4;
+                desc.inputs.type = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL;
+                desc.inputs.descsLayout = D3D12_ELEMENTS_LAYOUT_ARRAY;
+                desc.inputs.numDescs = 2;
+                desc.inputs.pGeometryDescs = reinterpret_cast<NVAPI_D3D12_RAYTRACING_GEOMETRY_DESC_EX*>(geometryDesc);
+                desc.inputs.geometryDescStrideInBytes = sizeof(D3D12_RAYTRACING_GEOMETRY_DESC);
+
+                REQUIRE(NvAPI_D3D12_BuildRaytracingAccelerationStructureEx(static_cast<ID3D12GraphicsCommandList4*>(&commandList), &params) == NVAPI_OK);
+                REQUIRE(d3d12Desc.Inputs.NumDescs == desc.inputs.numDescs);
+                REQUIRE(d3d12Desc.Inputs.pGeometryDescs == geometryDesc);
+                REQUIRE(geometryDescs[0].Triangles.IndexBuffer == geometryDesc[0].Triangles.IndexBuffer);
+                REQUIRE(geometryDescs[1].AABBs.AABBCount == geometryDesc[1].AABBs.AABBCount);
+            }
+
             SECTION("BuildRaytracingAccelerationStructureEx with BLAS for array of R520 structures") {
                 NVAPI_D3D12_RAYTRACING_GEOMETRY_DESC_EX_R520 geometryDescExR520[2];
                 desc.inputs.type = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL;
@@ -1091,6 +1545,46 @@ TEST_CASE("D3D12 methods succeed", "[.d3d12]") {
         }
     }
 
+    SECTION("Opacity micromap methods are not supported") {
+        NVAPI_D3D12_RAYTRACING_GEOMETRY_DESC_EX geometryDescEx{};
+        geometryDescEx.type = NVAPI_D3D12_RAYTRACING_GEOMETRY_TYPE_OMM_TRIANGLES_EX;
+
+        NVAPI_D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS_EX inputs{};
+        inputs.type = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL;
+        inputs.numDescs = 1;
+        inputs.descsLayout = D3D12_ELEMENTS_LAYOUT_ARRAY;
+        inputs.geometryDescStrideInBytes = sizeof(geometryDescEx);
+        inputs.pGeometryDescs = &geometryDescEx;
+
+        FORBID_CALL(device, GetRaytracingAccelerationStructurePrebuildInfo(_, _));
+
+        D3D12_RAYTRACING_ACCELERATION_STRUCTURE_PREBUILD_INFO info{};
+        NVAPI_GET_RAYTRACING_ACCELERATION_STRUCTURE_PREBUILD_INFO_EX_PARAMS params{};
+        params.version = NVAPI_GET_RAYTRACING_ACCELERATION_STRUCTURE_PREBUILD_INFO_EX_PARAMS_VER;
+        params.pDesc = &inputs;
+        params.pInfo = &info;
+        REQUIRE(NvAPI_D3D12_GetRaytracingAccelerationStructurePrebuildInfoEx(static_cast<ID3D12Device5*>(&device), &params) == NVAPI_INVALID_ARGUMENT);
+    }
+
+    SECTION("SetCreatePipelineStateOptions succeeds") {
+        NVAPI_D3D12_SET_CREATE_PIPELINE_STATE_OPTIONS_PARAMS params{};
+        params.version = NVAPI_D3D12_SET_CREATE_PIPELINE_STATE_OPTIONS_PARAMS_VER1;
+
+        SECTION("SetCreatePipelineStateOptions without flags returns OK") {
+            REQUIRE(NvAPI_D3D12_SetCreatePipelineStateOptions(static_cast<ID3D12Device5*>(&device), &params) == NVAPI_OK);
+        }
+
+        SECTION("SetCreatePipelineStateOptions with OMM support returns not-supported") {
+            params.flags = NVAPI_D3D12_PIPELINE_CREATION_STATE_FLAGS_ENABLE_OMM_SUPPORT;
+            REQUIRE(NvAPI_D3D12_SetCreatePipelineStateOptions(static_cast<ID3D12Device5*>(&device), &params) == NVAPI_NOT_SUPPORTED);
+        }
+
+        SECTION("SetCreatePipelineStateOptions with unknown struct version returns incompatible-struct-version") {
+            params.version = NVAPI_D3D12_SET_CREATE_PIPELINE_STATE_OPTIONS_PARAMS_VER1 + 1;
+            REQUIRE(NvAPI_D3D12_SetCreatePipelineStateOptions(static_cast<ID3D12Device5*>(&device), &params) == NVAPI_INCOMPATIBLE_STRUCT_VERSION);
+        }
+    }
+
     SECTION("D3DLowLatencyDevice methods succeed") {
         auto t = std::make_unique<DefaultTestEnvironment>();
         auto e = t->ConfigureExpectations();
@@ -1161,6 +1655,7 @@ TEST_CASE("D3D12 methods succeed", "[.d3d12]") {
 
             SECTION("SetAsyncFrameMarker with second command queue from the same device uses the same D3DLowLatencyDevice") {
                 D3D12Vkd3dCommandQueueMock otherCommandQueue;
+                PrivateDataStore otherCommandQueuePrivateData;
                 ALLOW_CALL(otherCommandQueue, QueryInterface(__uuidof(ID3D12CommandQueue), _))
                     .LR_SIDE_EFFECT(*_2 = static_cast<ID3D12CommandQueue*>(&otherCommandQueue))
                     .RETURN(S_OK);
@@ -1179,6 +1674,11 @@ TEST_CASE("D3D12 methods succeed", "[.d3d12]") {
                     .RETURN(S_OK);
                 ALLOW_CALL(otherCommandQueue, QueryInterface(__uuidof(ID3DLowLatencyDevice), _))
                     .RETURN(E_NOINTERFACE);
+                ALLOW_CALL(otherCommandQueue, QueryInterface(__uuidof(ID3D12Object), _))
+                    .LR_SIDE_EFFECT(*_2 = static_cast<ID3D12Object*>(&otherCommandQueue))
+                    .RETURN(S_OK);
+                ALLOW_CALL(otherCommandQueue, SetPrivateDataInterface(_, _))
+                    .LR_RETURN(otherCommandQueuePrivateData.SetPrivateDataInterface(_1, _2));
 
                 REQUIRE_CALL(lowLatencyDevice, SetLatencyMarker(_, VK_LATENCY_MARKER_OUT_OF_BAND_RENDERSUBMIT_START_NV))
                     .RETURN(S_OK)
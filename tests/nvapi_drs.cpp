@@ -9,40 +9,114 @@ TEST_CASE("DRS methods succeed", "[.drs]") {
         REQUIRE(NvAPI_DRS_CreateSession(&handle) == NVAPI_OK);
     }
 
+    SECTION("CreateSession with null handle returns invalid-argument") {
+        REQUIRE(NvAPI_DRS_CreateSession(nullptr) == NVAPI_INVALID_ARGUMENT);
+    }
+
     SECTION("LoadSettings returns OK") {
-        NvDRSSessionHandle handle{};
+        NvDRSSessionHandle handle;
+        REQUIRE(NvAPI_DRS_CreateSession(&handle) == NVAPI_OK);
         REQUIRE(NvAPI_DRS_LoadSettings(handle) == NVAPI_OK);
     }
 
-    SECTION("SaveSettings returns not-supported") {
-        NvDRSSessionHandle handle{};
-        REQUIRE(NvAPI_DRS_SaveSettings(handle) == NVAPI_NOT_SUPPORTED);
+    SECTION("SaveSettings returns OK") {
+        NvDRSSessionHandle handle;
+        REQUIRE(NvAPI_DRS_CreateSession(&handle) == NVAPI_OK);
+        REQUIRE(NvAPI_DRS_SaveSettings(handle) == NVAPI_OK);
     }
 
-    SECTION("SetSetting returns not-supported") {
+    SECTION("Methods with unknown session return invalid-handle") {
         NvDRSSessionHandle handle{};
-        NvDRSProfileHandle profile{};
+        NvDRSProfileHandle profile;
+        NvU32 count;
+        REQUIRE(NvAPI_DRS_LoadSettings(handle) == NVAPI_INVALID_HANDLE);
+        REQUIRE(NvAPI_DRS_SaveSettings(handle) == NVAPI_INVALID_HANDLE);
+        REQUIRE(NvAPI_DRS_GetBaseProfile(handle, &profile) == NVAPI_INVALID_HANDLE);
+        REQUIRE(NvAPI_DRS_GetNumProfiles(handle, &count) == NVAPI_INVALID_HANDLE);
+        REQUIRE(NvAPI_DRS_DestroySession(handle) == NVAPI_INVALID_HANDLE);
+    }
+
+    SECTION("DestroySession invalidates the session") {
+        NvDRSSessionHandle handle;
+        NvDRSProfileHandle profile;
+        REQUIRE(NvAPI_DRS_CreateSession(&handle) == NVAPI_OK);
+        REQUIRE(NvAPI_DRS_DestroySession(handle) == NVAPI_OK);
+        REQUIRE(NvAPI_DRS_GetBaseProfile(handle, &profile) == NVAPI_INVALID_HANDLE);
+    }
+
+    SECTION("SetSetting with null setting returns invalid-argument") {
+        NvDRSSessionHandle handle;
+        NvDRSProfileHandle profile;
+        REQUIRE(NvAPI_DRS_CreateSession(&handle) == NVAPI_OK);
+        REQUIRE(NvAPI_DRS_GetBaseProfile(handle, &profile) == NVAPI_OK);
+        REQUIRE(NvAPI_DRS_SetSetting(handle, profile, nullptr) == NVAPI_INVALID_ARGUMENT);
+    }
+
+    SECTION("SetSetting with unknown struct version returns incompatible-struct-version") {
+        NvDRSSessionHandle handle;
+        NvDRSProfileHandle profile;
+        REQUIRE(NvAPI_DRS_CreateSession(&handle) == NVAPI_OK);
+        REQUIRE(NvAPI_DRS_GetBaseProfile(handle, &profile) == NVAPI_OK);
         NVDRS_SETTING setting{};
-        REQUIRE(NvAPI_DRS_SetSetting(handle, profile, &setting) == NVAPI_NOT_SUPPORTED);
+        setting.version = NVDRS_SETTING_VER + 1;
+        REQUIRE(NvAPI_DRS_SetSetting(handle, profile, &setting) == NVAPI_INCOMPATIBLE_STRUCT_VERSION);
+    }
+
+    SECTION("SetSetting with unknown profile returns profile-not-found") {
+        NvDRSSessionHandle handle;
+        REQUIRE(NvAPI_DRS_CreateSession(&handle) == NVAPI_OK);
+        NVDRS_SETTING setting{};
+        setting.version = NVDRS_SETTING_VER1;
+        setting.settingId = FXAA_ALLOW_ID;
+        setting.settingType = NVDRS_DWORD_TYPE;
+        REQUIRE(NvAPI_DRS_SetSetting(handle, nullptr, &setting) == NVAPI_PROFILE_NOT_FOUND);
     }
 
     SECTION("FindProfileByName with null profile returns invalid-argument") {
-        NvDRSSessionHandle handle{};
+        NvDRSSessionHandle handle;
+        REQUIRE(NvAPI_DRS_CreateSession(&handle) == NVAPI_OK);
         NvAPI_UnicodeString name;
         memcpy(name, L"Profile", 16);
         REQUIRE(NvAPI_DRS_FindProfileByName(handle, name, nullptr) == NVAPI_INVALID_ARGUMENT);
     }
 
-    SECTION("FindProfileByName returns OK") {
-        NvDRSSessionHandle handle{};
+    SECTION("FindProfileByName for unknown profile returns new profile") {
+        NvDRSSessionHandle handle;
+        REQUIRE(NvAPI_DRS_CreateSession(&handle) == NVAPI_OK);
+        NvDRSProfileHandle baseProfile;
+        REQUIRE(NvAPI_DRS_GetBaseProfile(handle, &baseProfile) == NVAPI_OK);
         NvDRSProfileHandle profile;
-        NvAPI_UnicodeString name;
+        NvAPI_UnicodeString name{};
         memcpy(name, L"Profile", 16);
         REQUIRE(NvAPI_DRS_FindProfileByName(handle, name, &profile) == NVAPI_OK);
+        REQUIRE(profile != baseProfile);
+
+        NvDRSProfileHandle found;
+        REQUIRE(NvAPI_DRS_FindProfileByName(handle, name, &found) == NVAPI_OK);
+        REQUIRE(found == profile);
+
+        NVDRS_PROFILE info{};
+        info.version = NVDRS_PROFILE_VER1;
+        REQUIRE(NvAPI_DRS_GetProfileInfo(handle, profile, &info) == NVAPI_OK);
+        REQUIRE_FALSE(memcmp(info.profileName, name, sizeof(NvAPI_UnicodeString)));
+        REQUIRE(info.numOfSettings == 0);
+    }
+
+    SECTION("FindProfileByName for base profile returns OK") {
+        NvDRSSessionHandle handle;
+        REQUIRE(NvAPI_DRS_CreateSession(&handle) == NVAPI_OK);
+        NvDRSProfileHandle baseProfile;
+        REQUIRE(NvAPI_DRS_GetBaseProfile(handle, &baseProfile) == NVAPI_OK);
+        NvDRSProfileHandle profile;
+        NvAPI_UnicodeString name;
+        memcpy(name, L"base profile", 26);
+        REQUIRE(NvAPI_DRS_FindProfileByName(handle, name, &profile) == NVAPI_OK);
+        REQUIRE(profile == baseProfile);
     }
 
     SECTION("FindApplicationByName with null profile returns invalid-argument") {
-        NvDRSSessionHandle handle{};
+        NvDRSSessionHandle handle;
+        REQUIRE(NvAPI_DRS_CreateSession(&handle) == NVAPI_OK);
         NvAPI_UnicodeString name;
         memcpy(name, L"Application", 24);
         NVDRS_APPLICATION application{};
@@ -51,7 +125,8 @@ TEST_CASE("DRS methods succeed", "[.drs]") {
     }
 
     SECTION("FindApplicationByName with null application returns invalid-argument") {
-        NvDRSSessionHandle handle{};
+        NvDRSSessionHandle handle;
+        REQUIRE(NvAPI_DRS_CreateSession(&handle) == NVAPI_OK);
         NvDRSProfileHandle profile;
         NvAPI_UnicodeString name;
         memcpy(name, L"Application", 24);
@@ -59,7 +134,8 @@ TEST_CASE("DRS methods succeed", "[.drs]") {
     }
 
     SECTION("FindApplicationByName with unknown struct version returns incompatible-struct-version") {
-        NvDRSSessionHandle handle{};
+        NvDRSSessionHandle handle;
+        REQUIRE(NvAPI_DRS_CreateSession(&handle) == NVAPI_OK);
         NvDRSProfileHandle profile;
         NvAPI_UnicodeString name;
         memcpy(name, L"Application", 24);
@@ -69,7 +145,8 @@ TEST_CASE("DRS methods succeed", "[.drs]") {
     }
 
     SECTION("FindApplicationByName with current struct version returns not incompatible-struct-version") {
-        NvDRSSessionHandle handle{};
+        NvDRSSessionHandle handle;
+        REQUIRE(NvAPI_DRS_CreateSession(&handle) == NVAPI_OK);
         NvDRSProfileHandle profile;
         NvAPI_UnicodeString name;
         memcpy(name, L"Application", 24);
@@ -78,109 +155,370 @@ TEST_CASE("DRS methods succeed", "[.drs]") {
         REQUIRE(NvAPI_DRS_FindApplicationByName(handle, name, &profile, &application) != NVAPI_INCOMPATIBLE_STRUCT_VERSION);
     }
 
-    SECTION("FindApplicationByName returns OK and fills NVDRS_APPLICATION structure") {
-        NvDRSSessionHandle handle{};
+    SECTION("FindApplicationByName for unknown application returns new profile") {
+        NvDRSSessionHandle handle;
+        REQUIRE(NvAPI_DRS_CreateSession(&handle) == NVAPI_OK);
+        NvDRSProfileHandle baseProfile;
+        REQUIRE(NvAPI_DRS_GetBaseProfile(handle, &baseProfile) == NVAPI_OK);
         NvDRSProfileHandle profile;
-        NvAPI_UnicodeString name;
-        std::memcpy(name, L"Application", 24);
-        NvAPI_UnicodeString namePaddedEnd{};
-        memcpy(namePaddedEnd, name, 24);
-        NvAPI_UnicodeString empty{};
+        NvAPI_UnicodeString name{};
+        memcpy(name, L"Application", 24);
         NVDRS_APPLICATION application;
-        application.version = NVDRS_APPLICATION_VER_V4;
+        application.version = NVDRS_APPLICATION_VER;
         REQUIRE(NvAPI_DRS_FindApplicationByName(handle, name, &profile, &application) == NVAPI_OK);
-        CHECK_FALSE(application.isPredefined);
-        CHECK_FALSE(memcmp(application.appName, namePaddedEnd, sizeof(NvAPI_UnicodeString)));
-        CHECK_FALSE(memcmp(application.userFriendlyName, namePaddedEnd, sizeof(NvAPI_UnicodeString)));
-        CHECK_FALSE(memcmp(application.launcher, empty, sizeof(NvAPI_UnicodeString)));
-        CHECK_FALSE(memcmp(application.fileInFolder, empty, sizeof(NvAPI_UnicodeString)));
-        CHECK_FALSE(application.isMetro);
-        CHECK_FALSE(application.isCommandLine);
-        CHECK_FALSE(memcmp(application.commandLine, empty, sizeof(NvAPI_UnicodeString)));
+        REQUIRE(profile != baseProfile);
+        REQUIRE_FALSE(memcmp(application.appName, name, sizeof(NvAPI_UnicodeString)));
+
+        NvDRSProfileHandle found;
+        REQUIRE(NvAPI_DRS_FindApplicationByName(handle, name, &found, &application) == NVAPI_OK);
+        REQUIRE(found == profile);
     }
 
     SECTION("GetBaseProfile returns OK") {
-        NvDRSSessionHandle handle{};
+        NvDRSSessionHandle handle;
+        REQUIRE(NvAPI_DRS_CreateSession(&handle) == NVAPI_OK);
         NvDRSProfileHandle profile;
         REQUIRE(NvAPI_DRS_GetBaseProfile(handle, &profile) == NVAPI_OK);
     }
 
-    SECTION("GetCurrentGlobalProfile returns OK") {
-        NvDRSSessionHandle handle{};
+    SECTION("GetCurrentGlobalProfile returns base profile") {
+        NvDRSSessionHandle handle;
+        REQUIRE(NvAPI_DRS_CreateSession(&handle) == NVAPI_OK);
+        NvDRSProfileHandle baseProfile;
+        REQUIRE(NvAPI_DRS_GetBaseProfile(handle, &baseProfile) == NVAPI_OK);
         NvDRSProfileHandle profile;
         REQUIRE(NvAPI_DRS_GetCurrentGlobalProfile(handle, &profile) == NVAPI_OK);
+        REQUIRE(profile == baseProfile);
     }
 
-    SECTION("CreateProfile returns not-supported") {
-        NvDRSSessionHandle handle{};
+    SECTION("CreateProfile with unknown struct version returns incompatible-struct-version") {
+        NvDRSSessionHandle handle;
+        REQUIRE(NvAPI_DRS_CreateSession(&handle) == NVAPI_OK);
         NVDRS_PROFILE profileInfo{};
+        profileInfo.version = NVDRS_PROFILE_VER + 1;
         NvDRSProfileHandle profile;
-        REQUIRE(NvAPI_DRS_CreateProfile(handle, &profileInfo, &profile) == NVAPI_NOT_SUPPORTED);
+        REQUIRE(NvAPI_DRS_CreateProfile(handle, &profileInfo, &profile) == NVAPI_INCOMPATIBLE_STRUCT_VERSION);
     }
 
-    SECTION("DeleteProfile returns not-supported") {
-        NvDRSSessionHandle handle{};
-        NvDRSProfileHandle profile{};
-        REQUIRE(NvAPI_DRS_DeleteProfile(handle, profile) == NVAPI_NOT_SUPPORTED);
+    SECTION("CreateProfile with empty name returns invalid-argument") {
+        NvDRSSessionHandle handle;
+        REQUIRE(NvAPI_DRS_CreateSession(&handle) == NVAPI_OK);
+        NVDRS_PROFILE profileInfo{};
+        profileInfo.version = NVDRS_PROFILE_VER1;
+        NvDRSProfileHandle profile;
+        REQUIRE(NvAPI_DRS_CreateProfile(handle, &profileInfo, &profile) == NVAPI_INVALID_ARGUMENT);
+    }
+
+    SECTION("DeleteProfile for base profile returns invalid-argument") {
+        NvDRSSessionHandle handle;
+        REQUIRE(NvAPI_DRS_CreateSession(&handle) == NVAPI_OK);
+        NvDRSProfileHandle profile;
+        REQUIRE(NvAPI_DRS_GetBaseProfile(handle, &profile) == NVAPI_OK);
+        REQUIRE(NvAPI_DRS_DeleteProfile(handle, profile) == NVAPI_INVALID_ARGUMENT);
+    }
+
+    SECTION("DeleteProfile for unknown profile returns profile-not-found") {
+        NvDRSSessionHandle handle;
+        REQUIRE(NvAPI_DRS_CreateSession(&handle) == NVAPI_OK);
+        REQUIRE(NvAPI_DRS_DeleteProfile(handle, nullptr) == NVAPI_PROFILE_NOT_FOUND);
     }
 
     SECTION("GetProfileInfo with null profile-info returns invalid-argument") {
-        NvDRSSessionHandle handle{};
-        NvDRSProfileHandle profile{};
+        NvDRSSessionHandle handle;
+        REQUIRE(NvAPI_DRS_CreateSession(&handle) == NVAPI_OK);
+        NvDRSProfileHandle profile;
+        REQUIRE(NvAPI_DRS_GetBaseProfile(handle, &profile) == NVAPI_OK);
         REQUIRE(NvAPI_DRS_GetProfileInfo(handle, profile, nullptr) == NVAPI_INVALID_ARGUMENT);
     }
 
     SECTION("GetProfileInfo with unknown struct version returns incompatible-struct-version") {
-        NvDRSSessionHandle handle{};
-        NvDRSProfileHandle profile{};
+        NvDRSSessionHandle handle;
+        REQUIRE(NvAPI_DRS_CreateSession(&handle) == NVAPI_OK);
+        NvDRSProfileHandle profile;
+        REQUIRE(NvAPI_DRS_GetBaseProfile(handle, &profile) == NVAPI_OK);
         NVDRS_PROFILE profileInfo;
         profileInfo.version = NVDRS_PROFILE_VER + 1;
         REQUIRE(NvAPI_DRS_GetProfileInfo(handle, profile, &profileInfo) == NVAPI_INCOMPATIBLE_STRUCT_VERSION);
     }
 
     SECTION("GetProfileInfo with current struct version returns not incompatible-struct-version") {
-        NvDRSSessionHandle handle{};
-        NvDRSProfileHandle profile{};
+        NvDRSSessionHandle handle;
+        REQUIRE(NvAPI_DRS_CreateSession(&handle) == NVAPI_OK);
+        NvDRSProfileHandle profile;
+        REQUIRE(NvAPI_DRS_GetBaseProfile(handle, &profile) == NVAPI_OK);
         NVDRS_PROFILE profileInfo;
         profileInfo.version = NVDRS_PROFILE_VER;
         REQUIRE(NvAPI_DRS_GetProfileInfo(handle, profile, &profileInfo) != NVAPI_INCOMPATIBLE_STRUCT_VERSION);
     }
 
-    SECTION("GetProfileInfo returns OK with empty profile") {
-        NvDRSSessionHandle handle{};
-        NvDRSProfileHandle profile{};
+    SECTION("GetProfileInfo returns OK for base profile") {
+        NvDRSSessionHandle handle;
+        REQUIRE(NvAPI_DRS_CreateSession(&handle) == NVAPI_OK);
+        NvDRSProfileHandle profile;
+        REQUIRE(NvAPI_DRS_GetBaseProfile(handle, &profile) == NVAPI_OK);
         NVDRS_PROFILE profileInfo;
         profileInfo.version = NVDRS_PROFILE_VER1;
         REQUIRE(NvAPI_DRS_GetProfileInfo(handle, profile, &profileInfo) == NVAPI_OK);
+        NvAPI_UnicodeString name{};
+        memcpy(name, L"Base Profile", 24);
+        REQUIRE_FALSE(memcmp(profileInfo.profileName, name, sizeof(NvAPI_UnicodeString)));
         REQUIRE(profileInfo.numOfApps == 0);
-        REQUIRE(profileInfo.numOfSettings == 0);
-        REQUIRE(profileInfo.isPredefined == 0);
+        REQUIRE(profileInfo.isPredefined == 1);
     }
 
-    SECTION("CreateApplication returns not-supported") {
-        NvDRSSessionHandle handle{};
-        NvDRSProfileHandle profile{};
+    SECTION("CreateApplication with unknown struct version returns incompatible-struct-version") {
+        NvDRSSessionHandle handle;
+        REQUIRE(NvAPI_DRS_CreateSession(&handle) == NVAPI_OK);
+        NvDRSProfileHandle profile;
+        REQUIRE(NvAPI_DRS_GetBaseProfile(handle, &profile) == NVAPI_OK);
         NVDRS_APPLICATION application{};
-        REQUIRE(NvAPI_DRS_CreateApplication(handle, profile, &application) == NVAPI_NOT_SUPPORTED);
+        application.version = NVDRS_APPLICATION_VER + 1;
+        REQUIRE(NvAPI_DRS_CreateApplication(handle, profile, &application) == NVAPI_INCOMPATIBLE_STRUCT_VERSION);
+    }
+
+    SECTION("CreateApplication with unknown profile returns profile-not-found") {
+        NvDRSSessionHandle handle;
+        REQUIRE(NvAPI_DRS_CreateSession(&handle) == NVAPI_OK);
+        NVDRS_APPLICATION application{};
+        application.version = NVDRS_APPLICATION_VER;
+        memcpy(application.appName, L"Application", 24);
+        REQUIRE(NvAPI_DRS_CreateApplication(handle, nullptr, &application) == NVAPI_PROFILE_NOT_FOUND);
+    }
+
+    SECTION("Profiles and applications round-trip") {
+        NvDRSSessionHandle handle;
+        REQUIRE(NvAPI_DRS_CreateSession(&handle) == NVAPI_OK);
+
+        NVDRS_PROFILE profileInfo{};
+        profileInfo.version = NVDRS_PROFILE_VER1;
+        memcpy(profileInfo.profileName, L"Game", 10);
+        NvDRSProfileHandle profile;
+        REQUIRE(NvAPI_DRS_CreateProfile(handle, &profileInfo, &profile) == NVAPI_OK);
+
+        NVDRS_APPLICATION application{};
+        application.version = NVDRS_APPLICATION_VER_V4;
+        memcpy(application.appName, L"Game.exe", 18);
+        memcpy(application.userFriendlyName, L"Game", 10);
+        REQUIRE(NvAPI_DRS_CreateApplication(handle, profile, &application) == NVAPI_OK);
+
+        SECTION("FindProfileByName ignores case") {
+            NvDRSProfileHandle found;
+            NvAPI_UnicodeString name;
+            memcpy(name, L"GAME", 10);
+            REQUIRE(NvAPI_DRS_FindProfileByName(handle, name, &found) == NVAPI_OK);
+            REQUIRE(found == profile);
+        }
+
+        SECTION("FindApplicationByName ignores case and directories and fills NVDRS_APPLICATION structure") {
+            auto name = GENERATE(
+                std::wstring(L"Game.exe"),
+                std::wstring(L"game.EXE"),
+                std::wstring(L"C:\\Games\\Game.exe"),
+                std::wstring(L"/games/game.exe"));
+
+            NvAPI_UnicodeString appName{};
+            memcpy(appName, name.c_str(), name.size() * sizeof(wchar_t));
+            NvAPI_UnicodeString expectedName{};
+            memcpy(expectedName, L"Game.exe", 18);
+            NvAPI_UnicodeString expectedFriendlyName{};
+            memcpy(expectedFriendlyName, L"Game", 10);
+            NvAPI_UnicodeString empty{};
+
+            NvDRSProfileHandle found;
+            NVDRS_APPLICATION foundApplication;
+            foundApplication.version = NVDRS_APPLICATION_VER_V4;
+            REQUIRE(NvAPI_DRS_FindApplicationByName(handle, appName, &found, &foundApplication) == NVAPI_OK);
+            REQUIRE(found == profile);
+            CHECK_FALSE(foundApplication.isPredefined);
+            CHECK_FALSE(memcmp(foundApplication.appName, expectedName, sizeof(NvAPI_UnicodeString)));
+            CHECK_FALSE(memcmp(foundApplication.userFriendlyName, expectedFriendlyName, sizeof(NvAPI_UnicodeString)));
+            CHECK_FALSE(memcmp(foundApplication.launcher, empty, sizeof(NvAPI_UnicodeString)));
+            CHECK_FALSE(memcmp(foundApplication.fileInFolder, empty, sizeof(NvAPI_UnicodeString)));
+            CHECK_FALSE(foundApplication.isMetro);
+            CHECK_FALSE(foundApplication.isCommandLine);
+            CHECK_FALSE(memcmp(foundApplication.commandLine, empty, sizeof(NvAPI_UnicodeString)));
+        }
+
+        SECTION("GetProfileInfo returns profile details") {
+            NVDRS_PROFILE info;
+            info.version = NVDRS_PROFILE_VER1;
+            REQUIRE(NvAPI_DRS_GetProfileInfo(handle, profile, &info) == NVAPI_OK);
+            REQUIRE_FALSE(memcmp(info.profileName, profileInfo.profileName, sizeof(NvAPI_UnicodeString)));
+            REQUIRE(info.isPredefined == 0);
+            REQUIRE(info.numOfApps == 1);
+            REQUIRE(info.numOfSettings == 0);
+        }
+
+        SECTION("CreateProfile with existing name returns profile-name-in-use") {
+            NVDRS_PROFILE duplicateInfo{};
+            duplicateInfo.version = NVDRS_PROFILE_VER1;
+            memcpy(duplicateInfo.profileName, L"game", 10);
+            NvDRSProfileHandle duplicate;
+            REQUIRE(NvAPI_DRS_CreateProfile(handle, &duplicateInfo, &duplicate) == NVAPI_PROFILE_NAME_IN_USE);
+        }
+
+        SECTION("CreateApplication with existing name returns executable-already-in-use") {
+            NvDRSProfileHandle baseProfile;
+            REQUIRE(NvAPI_DRS_GetBaseProfile(handle, &baseProfile) == NVAPI_OK);
+            NVDRS_APPLICATION duplicate{};
+            duplicate.version = NVDRS_APPLICATION_VER_V1;
+            memcpy(duplicate.appName, L"GAME.exe", 18);
+            REQUIRE(NvAPI_DRS_CreateApplication(handle, baseProfile, &duplicate) == NVAPI_EXECUTABLE_ALREADY_IN_USE);
+        }
+
+        SECTION("EnumApplications returns applications") {
+            NVDRS_APPLICATION applications[2]{};
+            applications[0].version = NVDRS_APPLICATION_VER;
+            applications[1].version = NVDRS_APPLICATION_VER;
+            NvU32 count = 2;
+            REQUIRE(NvAPI_DRS_EnumApplications(handle, profile, 0, &count, applications) == NVAPI_OK);
+            REQUIRE(count == 1);
+            REQUIRE_FALSE(memcmp(applications[0].appName, application.appName, sizeof(NvAPI_UnicodeString)));
+
+            count = 2;
+            REQUIRE(NvAPI_DRS_EnumApplications(handle, profile, 1, &count, applications) == NVAPI_END_ENUMERATION);
+            REQUIRE(count == 0);
+        }
+
+        SECTION("DeleteApplication removes application") {
+            NvAPI_UnicodeString name{};
+            memcpy(name, L"game.exe", 18);
+            REQUIRE(NvAPI_DRS_DeleteApplication(handle, profile, name) == NVAPI_OK);
+            REQUIRE(NvAPI_DRS_DeleteApplication(handle, profile, name) == NVAPI_EXECUTABLE_NOT_FOUND);
+
+            NvDRSProfileHandle found;
+            NVDRS_APPLICATION foundApplication;
+            foundApplication.version = NVDRS_APPLICATION_VER;
+            REQUIRE(NvAPI_DRS_FindApplicationByName(handle, name, &found, &foundApplication) == NVAPI_OK);
+            REQUIRE(found != profile);
+        }
+
+        SECTION("EnumProfiles returns created profile") {
+            NvU32 count;
+            REQUIRE(NvAPI_DRS_GetNumProfiles(handle, &count) == NVAPI_OK);
+            REQUIRE(count >= 2);
+
+            auto found = false;
+            for (auto i = 0U; i < count; i++) {
+                NvDRSProfileHandle enumerated;
+                REQUIRE(NvAPI_DRS_EnumProfiles(handle, i, &enumerated) == NVAPI_OK);
+                found |= enumerated == profile;
+            }
+
+            REQUIRE(found);
+
+            NvDRSProfileHandle enumerated;
+            REQUIRE(NvAPI_DRS_EnumProfiles(handle, count, &enumerated) == NVAPI_END_ENUMERATION);
+        }
+
+        SECTION("DeleteProfile removes profile and its applications") {
+            NvU32 count;
+            REQUIRE(NvAPI_DRS_GetNumProfiles(handle, &count) == NVAPI_OK);
+            REQUIRE(NvAPI_DRS_DeleteProfile(handle, profile) == NVAPI_OK);
+
+            NvU32 remaining;
+            REQUIRE(NvAPI_DRS_GetNumProfiles(handle, &remaining) == NVAPI_OK);
+            REQUIRE(remaining == count - 1);
+
+            REQUIRE(NvAPI_DRS_DeleteProfile(handle, profile) == NVAPI_PROFILE_NOT_FOUND);
+
+            NvDRSProfileHandle found;
+            REQUIRE(NvAPI_DRS_FindProfileByName(handle, profileInfo.profileName, &found) == NVAPI_OK);
+            REQUIRE(found != profile);
+            NVDRS_APPLICATION foundApplication;
+            foundApplication.version = NVDRS_APPLICATION_VER;
+            REQUIRE(NvAPI_DRS_FindApplicationByName(handle, application.appName, &found, &foundApplication) == NVAPI_OK);
+            REQUIRE(found != profile);
+        }
+
+        SECTION("DeleteProfile does not hand out the deleted handle again") {
+            REQUIRE(NvAPI_DRS_DeleteProfile(handle, profile) == NVAPI_OK);
+
+            NvDRSProfileHandle recreated;
+            REQUIRE(NvAPI_DRS_CreateProfile(handle, &profileInfo, &recreated) == NVAPI_OK);
+            REQUIRE(recreated != profile);
+
+            NVDRS_PROFILE info{};
+            info.version = NVDRS_PROFILE_VER1;
+            REQUIRE(NvAPI_DRS_GetProfileInfo(handle, profile, &info) == NVAPI_PROFILE_NOT_FOUND);
+            REQUIRE(NvAPI_DRS_GetProfileInfo(handle, recreated, &info) == NVAPI_OK);
+        }
+
+        SECTION("Settings are visible across sessions") {
+            NVDRS_SETTING setting{};
+            setting.version = NVDRS_SETTING_VER1;
+            setting.settingId = FXAA_ALLOW_ID;
+            setting.settingType = NVDRS_DWORD_TYPE;
+            setting.u32CurrentValue = FXAA_ALLOW_DISALLOWED;
+            REQUIRE(NvAPI_DRS_SetSetting(handle, profile, &setting) == NVAPI_OK);
+            REQUIRE(NvAPI_DRS_SaveSettings(handle) == NVAPI_OK);
+
+            NvDRSSessionHandle otherHandle;
+            REQUIRE(NvAPI_DRS_CreateSession(&otherHandle) == NVAPI_OK);
+            NVDRS_SETTING read;
+            read.version = NVDRS_SETTING_VER1;
+            REQUIRE(NvAPI_DRS_GetSetting(otherHandle, profile, FXAA_ALLOW_ID, &read) == NVAPI_OK);
+            REQUIRE(read.settingType == NVDRS_DWORD_TYPE);
+            REQUIRE(read.settingLocation == NVDRS_CURRENT_PROFILE_LOCATION);
+            REQUIRE(read.u32CurrentValue == FXAA_ALLOW_DISALLOWED);
+            REQUIRE(read.u32PredefinedValue == FXAA_ALLOW_DEFAULT);
+            REQUIRE(read.isCurrentPredefined == 0);
+        }
+
+        SECTION("GetSetting falls back to base profile") {
+            NvDRSProfileHandle baseProfile;
+            REQUIRE(NvAPI_DRS_GetBaseProfile(handle, &baseProfile) == NVAPI_OK);
+            NVDRS_SETTING setting{};
+            setting.version = NVDRS_SETTING_VER1;
+            setting.settingId = FXAA_ALLOW_ID;
+            setting.settingType = NVDRS_DWORD_TYPE;
+            setting.u32CurrentValue = FXAA_ALLOW_DISALLOWED;
+            REQUIRE(NvAPI_DRS_SetSetting(handle, baseProfile, &setting) == NVAPI_OK);
+
+            NVDRS_SETTING read;
+            read.version = NVDRS_SETTING_VER1;
+            REQUIRE(NvAPI_DRS_GetSetting(handle, profile, FXAA_ALLOW_ID, &read) == NVAPI_OK);
+            REQUIRE(read.settingLocation == NVDRS_BASE_PROFILE_LOCATION);
+            REQUIRE(read.u32CurrentValue == FXAA_ALLOW_DISALLOWED);
+        }
+
+        SECTION("DeleteProfileSetting removes setting") {
+            NVDRS_SETTING setting{};
+            setting.version = NVDRS_SETTING_VER1;
+            setting.settingId = FXAA_ALLOW_ID;
+            setting.settingType = NVDRS_DWORD_TYPE;
+            setting.u32CurrentValue = FXAA_ALLOW_DISALLOWED;
+            REQUIRE(NvAPI_DRS_SetSetting(handle, profile, &setting) == NVAPI_OK);
+            REQUIRE(NvAPI_DRS_DeleteProfileSetting(handle, profile, FXAA_ALLOW_ID) == NVAPI_OK);
+            REQUIRE(NvAPI_DRS_DeleteProfileSetting(handle, profile, FXAA_ALLOW_ID) == NVAPI_SETTING_NOT_FOUND);
+
+            NVDRS_SETTING read;
+            read.version = NVDRS_SETTING_VER1;
+            REQUIRE(NvAPI_DRS_GetSetting(handle, profile, FXAA_ALLOW_ID, &read) == NVAPI_SETTING_NOT_FOUND);
+        }
     }
 
     SECTION("GetSetting") {
-        // these variables are read and cached the first time NvAPI_DRS_GetSetting is called
+        // these variables are read when the DRS database is created by the first DRS call of a section
         ::SetEnvironmentVariableA("DXVK_NVAPI_DRS_SETTINGS", "0x10E41E01=1,0x10E41DF3=0xffffff,NGX_DLAA_OVERRIDE=DLAA_ON");
         ::SetEnvironmentVariableA("DXVK_NVAPI_DRS_NGX_DLSS_SR_OVERRIDE_RENDER_PRESET_SELECTION", "render_preset_a");
         ::SetEnvironmentVariableA("DXVK_NVAPI_DRS_NGX_DLSS_SR_MODE", "performance");
 
         SECTION("GetSetting with unknown struct version returns incompatible-struct-version") {
-            NvDRSSessionHandle handle{};
-            NvDRSProfileHandle profile{};
+            NvDRSSessionHandle handle;
+            NvDRSProfileHandle profile;
+            REQUIRE(NvAPI_DRS_CreateSession(&handle) == NVAPI_OK);
+            REQUIRE(NvAPI_DRS_GetBaseProfile(handle, &profile) == NVAPI_OK);
             NVDRS_SETTING setting;
             setting.version = NVDRS_SETTING_VER + 1;
             REQUIRE(NvAPI_DRS_GetSetting(handle, profile, FXAA_ALLOW_ID, &setting) == NVAPI_INCOMPATIBLE_STRUCT_VERSION);
         }
 
         SECTION("GetSetting with current struct version returns not incompatible-struct-version") {
-            NvDRSSessionHandle handle{};
-            NvDRSProfileHandle profile{};
+            NvDRSSessionHandle handle;
+            NvDRSProfileHandle profile;
+            REQUIRE(NvAPI_DRS_CreateSession(&handle) == NVAPI_OK);
+            REQUIRE(NvAPI_DRS_GetBaseProfile(handle, &profile) == NVAPI_OK);
             NVDRS_SETTING setting;
             setting.version = NVDRS_SETTING_VER;
             REQUIRE(NvAPI_DRS_GetSetting(handle, profile, FXAA_ALLOW_ID, &setting) != NVAPI_INCOMPATIBLE_STRUCT_VERSION);
@@ -192,8 +530,10 @@ TEST_CASE("DRS methods succeed", "[.drs]") {
                 CUDA_EXCLUDED_GPUS_ID,
                 0x12345678u);
 
-            NvDRSSessionHandle handle{};
-            NvDRSProfileHandle profile{};
+            NvDRSSessionHandle handle;
+            NvDRSProfileHandle profile;
+            REQUIRE(NvAPI_DRS_CreateSession(&handle) == NVAPI_OK);
+            REQUIRE(NvAPI_DRS_GetBaseProfile(handle, &profile) == NVAPI_OK);
             NVDRS_SETTING setting;
             setting.version = NVDRS_SETTING_VER1;
             REQUIRE(NvAPI_DRS_GetSetting(handle, profile, settingId, &setting) == NVAPI_SETTING_NOT_FOUND);
@@ -206,18 +546,78 @@ TEST_CASE("DRS methods succeed", "[.drs]") {
                 std::make_pair(NGX_DLAA_OVERRIDE_ID, NGX_DLAA_OVERRIDE_DLAA_ON),
                 std::make_pair(NGX_DLSS_SR_MODE_ID, NGX_DLSS_SR_MODE_NGX_DLSS_SR_MODE_PERFORMANCE));
 
-            NvDRSSessionHandle handle{};
-            NvDRSProfileHandle profile{};
+            NvDRSSessionHandle handle;
+            NvDRSProfileHandle profile;
+            REQUIRE(NvAPI_DRS_CreateSession(&handle) == NVAPI_OK);
+            REQUIRE(NvAPI_DRS_GetBaseProfile(handle, &profile) == NVAPI_OK);
             NVDRS_SETTING setting;
             setting.version = NVDRS_SETTING_VER1;
             REQUIRE(NvAPI_DRS_GetSetting(handle, profile, settingId, &setting) == NVAPI_OK);
             REQUIRE(setting.settingType == NVDRS_DWORD_TYPE);
             REQUIRE(setting.u32CurrentValue == value);
         }
+
+        SECTION("GetSetting for applications found by name returns DWORD settings found in environment") {
+            NvDRSSessionHandle handle;
+            REQUIRE(NvAPI_DRS_CreateSession(&handle) == NVAPI_OK);
+            NvDRSProfileHandle profile;
+            NvAPI_UnicodeString name{};
+            memcpy(name, L"C:\\Games\\Other.exe", 38);
+            NVDRS_APPLICATION application;
+            application.version = NVDRS_APPLICATION_VER;
+            REQUIRE(NvAPI_DRS_FindApplicationByName(handle, name, &profile, &application) == NVAPI_OK);
+
+            NVDRS_SETTING setting;
+            setting.version = NVDRS_SETTING_VER1;
+            REQUIRE(NvAPI_DRS_GetSetting(handle, profile, NGX_DLAA_OVERRIDE_ID, &setting) == NVAPI_OK);
+            REQUIRE(setting.settingType == NVDRS_DWORD_TYPE);
+            REQUIRE(setting.settingLocation == NVDRS_BASE_PROFILE_LOCATION);
+            REQUIRE(setting.u32CurrentValue == NGX_DLAA_OVERRIDE_DLAA_ON);
+        }
+
+        SECTION("GetSetting with unknown handles returns DWORD settings found in environment") {
+            NVDRS_SETTING setting;
+            setting.version = NVDRS_SETTING_VER1;
+            REQUIRE(NvAPI_DRS_GetSetting(nullptr, nullptr, NGX_DLAA_OVERRIDE_ID, &setting) == NVAPI_OK);
+            REQUIRE(setting.settingType == NVDRS_DWORD_TYPE);
+            REQUIRE(setting.u32CurrentValue == NGX_DLAA_OVERRIDE_DLAA_ON);
+        }
+
+        SECTION("GetSetting prefers DWORD settings found in environment over profile settings") {
+            NvDRSSessionHandle handle;
+            REQUIRE(NvAPI_DRS_CreateSession(&handle) == NVAPI_OK);
+
+            NVDRS_PROFILE profileInfo{};
+            profileInfo.version = NVDRS_PROFILE_VER1;
+            memcpy(profileInfo.profileName, L"Game", 10);
+            NvDRSProfileHandle profile;
+            REQUIRE(NvAPI_DRS_CreateProfile(handle, &profileInfo, &profile) == NVAPI_OK);
+            NvDRSProfileHandle baseProfile;
+            REQUIRE(NvAPI_DRS_GetBaseProfile(handle, &baseProfile) == NVAPI_OK);
+
+            NVDRS_SETTING written{};
+            written.version = NVDRS_SETTING_VER1;
+            written.settingId = NGX_DLAA_OVERRIDE_ID;
+            written.settingType = NVDRS_DWORD_TYPE;
+            written.u32CurrentValue = NGX_DLAA_OVERRIDE_DLAA_DEFAULT;
+            REQUIRE(NvAPI_DRS_SetSetting(handle, profile, &written) == NVAPI_OK);
+            REQUIRE(NvAPI_DRS_SetSetting(handle, baseProfile, &written) == NVAPI_OK);
+
+            NVDRS_SETTING setting;
+            setting.version = NVDRS_SETTING_VER1;
+            REQUIRE(NvAPI_DRS_GetSetting(handle, profile, NGX_DLAA_OVERRIDE_ID, &setting) == NVAPI_OK);
+            REQUIRE(setting.settingLocation == NVDRS_BASE_PROFILE_LOCATION);
+            REQUIRE(setting.u32CurrentValue == NGX_DLAA_OVERRIDE_DLAA_ON);
+
+            REQUIRE(NvAPI_DRS_GetSetting(handle, baseProfile, NGX_DLAA_OVERRIDE_ID, &setting) == NVAPI_OK);
+            REQUIRE(setting.settingLocation == NVDRS_CURRENT_PROFILE_LOCATION);
+            REQUIRE(setting.u32CurrentValue == NGX_DLAA_OVERRIDE_DLAA_ON);
+        }
     }
 
     SECTION("DestroySession returns OK") {
-        NvDRSSessionHandle handle{};
+        NvDRSSessionHandle handle;
+        REQUIRE(NvAPI_DRS_CreateSession(&handle) == NVAPI_OK);
         REQUIRE(NvAPI_DRS_DestroySession(handle) == NVAPI_OK);
     }
 }
@@ -244,7 +244,7 @@ TEST_CASE("Sysinfo methods succeed", "[.sysinfo]") {
 
     SECTION("GetGPUIDFromPhysicalGPU / GetPhysicalGPUFromGPUID succeeds") {
         ALLOW_CALL(*t->Vk(), GetDeviceExtensions(_, _))
-            .RETURN(std::set<std::string>{VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME, VK_EXT_PCI_BUS_INFO_EXTENSION_NAME});
+            .RETURN(std::map<std::string, uint32_t>{{VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME, 1}, {VK_EXT_PCI_BUS_INFO_EXTENSION_NAME, 1}});
         ALLOW_CALL(*t->Vk(), GetPhysicalDeviceProperties2(_, _, _))
             .LR_SIDE_EFFECT(
                 VkMock::ConfigureGetPhysicalDeviceProperties2(_3,
@@ -287,9 +287,9 @@ TEST_CASE("Sysinfo methods succeed", "[.sysinfo]") {
         ::SetEnvironmentVariableA("DXVK_NVAPI_ALLOW_OTHER_DRIVERS", "1");
 
         ALLOW_CALL(*t->Vk(), GetDeviceExtensions(_, _))
-            .RETURN(std::set<std::string>{
-                VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME,
-                args.extensionName});
+            .RETURN(std::map<std::string, uint32_t>{
+                {VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME, 1},
+                {args.extensionName, 1}});
         ALLOW_CALL(*t->Vk(), GetPhysicalDeviceProperties2(_, _, _))
             .SIDE_EFFECT(
                 VkMock::ConfigureGetPhysicalDeviceProperties2(_3,
@@ -396,7 +396,7 @@ TEST_CASE("Sysinfo methods succeed", "[.sysinfo]") {
     SECTION("GetBusId returns OK") {
         auto id = 2U;
         ALLOW_CALL(*t->Vk(), GetDeviceExtensions(_, _))
-            .RETURN(std::set<std::string>{VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME, VK_EXT_PCI_BUS_INFO_EXTENSION_NAME});
+            .RETURN(std::map<std::string, uint32_t>{{VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME, 1}, {VK_EXT_PCI_BUS_INFO_EXTENSION_NAME, 1}});
         ALLOW_CALL(*t->Vk(), GetPhysicalDeviceProperties2(_, _, _))
             .LR_SIDE_EFFECT(
                 VkMock::ConfigureGetPhysicalDeviceProperties2(_3,
@@ -418,7 +418,7 @@ TEST_CASE("Sysinfo methods succeed", "[.sysinfo]") {
     SECTION("GetBusSlotId returns OK") {
         auto id = 3U;
         ALLOW_CALL(*t->Vk(), GetDeviceExtensions(_, _))
-            .RETURN(std::set<std::string>{VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME, VK_EXT_PCI_BUS_INFO_EXTENSION_NAME});
+            .RETURN(std::map<std::string, uint32_t>{{VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME, 1}, {VK_EXT_PCI_BUS_INFO_EXTENSION_NAME, 1}});
         ALLOW_CALL(*t->Vk(), GetPhysicalDeviceProperties2(_, _, _))
             .LR_SIDE_EFFECT(
                 VkMock::ConfigureGetPhysicalDeviceProperties2(_3,
@@ -447,9 +447,9 @@ TEST_CASE("Sysinfo methods succeed", "[.sysinfo]") {
             Data{"ext", NVAPI_GPU_BUS_TYPE_UNDEFINED});
 
         ALLOW_CALL(*t->Vk(), GetDeviceExtensions(_, _))
-            .RETURN(std::set<std::string>{
-                VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME,
-                args.extensionName});
+            .RETURN(std::map<std::string, uint32_t>{
+                {VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME, 1},
+                {args.extensionName, 1}});
         ALLOW_CALL(*t->Vk(), GetPhysicalDeviceProperties2(_, _, _))
             .SIDE_EFFECT(
                 VkMock::ConfigureGetPhysicalDeviceProperties2(_3,
@@ -793,9 +793,9 @@ TEST_CASE("Sysinfo methods succeed", "[.sysinfo]") {
             Data{VK_DRIVER_ID_MESA_NVK, 0x2000, "ext", 0x4000, NV_GPU_ARCHITECTURE_GK100, NV_GPU_ARCH_IMPLEMENTATION_GK104});
 
         ALLOW_CALL(*t->Vk(), GetDeviceExtensions(_, _))
-            .RETURN(std::set<std::string>{
-                VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME,
-                args.extensionName});
+            .RETURN(std::map<std::string, uint32_t>{
+                {VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME, 1},
+                {args.extensionName, 1}});
         ALLOW_CALL(*t->Vk(), GetPhysicalDeviceProperties2(_, _, _))
             .SIDE_EFFECT(
                 VkMock::ConfigureGetPhysicalDeviceProperties2(_3,
@@ -908,9 +908,9 @@ TEST_CASE("Sysinfo methods succeed", "[.sysinfo]") {
             Data{VK_DRIVER_ID_MESA_NVK, 0x2600, VK_KHR_FRAGMENT_SHADING_RATE_EXTENSION_NAME, 76, 304});
 
         ALLOW_CALL(*t->Vk(), GetDeviceExtensions(_, _))
-            .RETURN(std::set<std::string>{
-                VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME,
-                args.extensionName});
+            .RETURN(std::map<std::string, uint32_t>{
+                {VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME, 1},
+                {args.extensionName, 1}});
         ALLOW_CALL(*t->Vk(), GetPhysicalDeviceProperties2(_, _, _))
             .SIDE_EFFECT(
                 VkMock::ConfigureGetPhysicalDeviceProperties2(_3,
@@ -6,16 +6,54 @@
 
 using namespace trompeloeil;
 
+// Forwards to a mock that is owned by the test, so that several instances can share the same mock
+class VkMockForwarder final : public dxvk::Vk {
+
+  public:
+    explicit VkMockForwarder(VkMock& vkMock)
+        : m_vkMock(vkMock) {};
+
+    [[nodiscard]] bool IsAvailable() const override {
+        return m_vkMock.IsAvailable();
+    }
+
+    [[nodiscard]] PFN_vkVoidFunction GetInstanceProcAddr(VkInstance vkInstance, const char* name) const override {
+        return m_vkMock.GetInstanceProcAddr(vkInstance, name);
+    }
+
+    [[nodiscard]] PFN_vkVoidFunction GetDeviceProcAddr(VkDevice vkDevice, const char* name) const override {
+        return m_vkMock.GetDeviceProcAddr(vkDevice, name);
+    }
+
+    [[nodiscard]] std::map<std::string, uint32_t> GetDeviceExtensions(VkInstance vkInstance, VkPhysicalDevice vkDevice) const override {
+        return m_vkMock.GetDeviceExtensions(vkInstance, vkDevice);
+    }
+
+    void GetPhysicalDeviceProperties2(VkInstance vkInstance, VkPhysicalDevice vkDevice, VkPhysicalDeviceProperties2* deviceProperties2) const override {
+        m_vkMock.GetPhysicalDeviceProperties2(vkInstance, vkDevice, deviceProperties2);
+    }
+
+  private:
+    VkMock& m_vkMock;
+};
+
 class MockFactory final : public dxvk::ResourceFactory {
 
   public:
     MockFactory(std::unique_ptr<VkMock> vkMock)
         : m_vkMock(std::move(vkMock)) {};
 
+    explicit MockFactory(VkMock& sharedVkMock)
+        : m_sharedVkMock(&sharedVkMock) {};
+
     std::unique_ptr<dxvk::Vk> CreateVulkan(const char*) override {
+        if (m_sharedVkMock)
+            return std::make_unique<VkMockForwarder>(*m_sharedVkMock);
+
         return std::move(m_vkMock);
     }
 
   private:
     std::unique_ptr<VkMock> m_vkMock;
+    VkMock* m_sharedVkMock{};
 };
@@ -9,5 +9,7 @@ class SectionListener : public Catch::EventListenerBase {
 
     void sectionEnded(Catch::SectionStats const&) override {
         resourceFactory.reset();
+
+        ::SetEnvironmentVariableA("DXVK_NVAPI_OFA_ASYNC_EXECUTE", "");
     }
 };
@@ -0,0 +1,130 @@
+#include "vk_test_environment.h"
+
+using namespace trompeloeil;
+using namespace dxvk;
+
+VkTestEnvironment::VkTestEnvironment() {
+    resourceFactory = std::make_unique<MockFactory>(m_vk);
+
+    opticalFlowProperties.supportedOutputGridSizes = VK_OPTICAL_FLOW_GRID_SIZE_1X1_BIT_NV | VK_OPTICAL_FLOW_GRID_SIZE_4X4_BIT_NV | VK_OPTICAL_FLOW_GRID_SIZE_8X8_BIT_NV;
+    opticalFlowProperties.supportedHintGridSizes = VK_OPTICAL_FLOW_GRID_SIZE_4X4_BIT_NV | VK_OPTICAL_FLOW_GRID_SIZE_8X8_BIT_NV;
+    opticalFlowProperties.hintSupported = VK_TRUE;
+    opticalFlowProperties.costSupported = VK_FALSE;
+    opticalFlowProperties.bidirectionalFlowSupported = VK_FALSE;
+    opticalFlowProperties.globalFlowSupported = VK_FALSE;
+    opticalFlowProperties.minWidth = 64;
+    opticalFlowProperties.minHeight = 64;
+    opticalFlowProperties.maxWidth = 4096;
+    opticalFlowProperties.maxHeight = 4096;
+    opticalFlowProperties.maxNumRegionsOfInterest = 0;
+
+    queueFamilies = {
+        VkQueueFamilyProperties{.queueFlags = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT, .queueCount = 1},
+        VkQueueFamilyProperties{.queueFlags = VK_QUEUE_OPTICAL_FLOW_BIT_NV, .queueCount = 1},
+    };
+
+    opticalFlowImageFormats = {
+        {VK_OPTICAL_FLOW_USAGE_INPUT_BIT_NV, {VK_FORMAT_R8_UNORM, VK_FORMAT_B8G8R8A8_UNORM}},
+        {VK_OPTICAL_FLOW_USAGE_OUTPUT_BIT_NV, {VK_FORMAT_R16G16_S10_5_NV}},
+        {VK_OPTICAL_FLOW_USAGE_HINT_BIT_NV, {VK_FORMAT_R16G16_S10_5_NV}},
+    };
+}
+
+std::vector<std::unique_ptr<expectation>> VkTestEnvironment::ConfigureExpectations() {
+    std::vector<std::unique_ptr<expectation>> e;
+    std::ranges::move(VkMock::ConfigureDefaultPFN(m_vk), std::back_inserter(e));
+    std::ranges::move(VkMock::ConfigureOpticalFlowPFN(m_vk), std::back_inserter(e));
+
+    e.emplace_back(NAMED_ALLOW_CALL(m_vk, IsAvailable())
+            .RETURN(true));
+    e.emplace_back(NAMED_ALLOW_CALL(m_vk, GetDeviceExtensions(_, PhysicalDevice()))
+            .RETURN(std::map<std::string, uint32_t>{{VK_NV_OPTICAL_FLOW_EXTENSION_NAME, 1}}));
+    e.emplace_back(NAMED_ALLOW_CALL(m_vk, GetPhysicalDeviceProperties2(_, PhysicalDevice(), _))
+            .LR_SIDE_EFFECT(
+                VkMock::ConfigureGetPhysicalDeviceProperties2(_3,
+                    [this](auto vkProps) {
+                        if (vkProps.opticalFlowProps) {
+                            auto pNext = vkProps.opticalFlowProps->pNext;
+                            *vkProps.opticalFlowProps = opticalFlowProperties;
+                            vkProps.opticalFlowProps->sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_OPTICAL_FLOW_PROPERTIES_NV;
+                            vkProps.opticalFlowProps->pNext = pNext;
+                        }
+                    })));
+
+    e.emplace_back(NAMED_ALLOW_CALL(m_physicalDevice, vkGetPhysicalDeviceQueueFamilyProperties(_, _, _))
+            .LR_SIDE_EFFECT(GetQueueFamilyProperties(_2, _3)));
+    e.emplace_back(NAMED_ALLOW_CALL(m_physicalDevice, vkGetPhysicalDeviceOpticalFlowImageFormatsNV(_, _, _, _))
+            .LR_RETURN(GetOpticalFlowImageFormats(_2, _3, _4)));
+
+    e.emplace_back(NAMED_ALLOW_CALL(m_device, vkCreateSemaphore(_, _, _, _))
+            .SIDE_EFFECT(*_4 = reinterpret_cast<VkSemaphore>(uintptr_t{0x100}))
+            .RETURN(VK_SUCCESS));
+    e.emplace_back(NAMED_ALLOW_CALL(m_device, vkDestroySemaphore(_, _, _)));
+    e.emplace_back(NAMED_ALLOW_CALL(m_device, vkGetSemaphoreCounterValue(_, _, _))
+            .SIDE_EFFECT(*_3 = UINT64_MAX)
+            .RETURN(VK_SUCCESS));
+    e.emplace_back(NAMED_ALLOW_CALL(m_device, vkWaitSemaphores(_, _, _))
+            .RETURN(VK_SUCCESS));
+
+    e.emplace_back(NAMED_ALLOW_CALL(m_device, vkGetDeviceQueue(_, _, _, _))
+            .LR_SIDE_EFFECT(*_4 = reinterpret_cast<VkQueue>(&m_queue)));
+    e.emplace_back(NAMED_ALLOW_CALL(m_device, vkCreateCommandPool(_, _, _, _))
+            .SIDE_EFFECT(*_4 = reinterpret_cast<VkCommandPool>(uintptr_t{0x200}))
+            .RETURN(VK_SUCCESS));
+    e.emplace_back(NAMED_ALLOW_CALL(m_device, vkDestroyCommandPool(_, _, _)));
+    e.emplace_back(NAMED_ALLOW_CALL(m_device, vkResetCommandPool(_, _, _))
+            .RETURN(VK_SUCCESS));
+    e.emplace_back(NAMED_ALLOW_CALL(m_device, vkAllocateCommandBuffers(_, _, _))
+            .LR_SIDE_EFFECT(*_3 = reinterpret_cast<VkCommandBuffer>(&m_commandBuffer))
+            .RETURN(VK_SUCCESS));
+
+    e.emplace_back(NAMED_ALLOW_CALL(m_device, vkCreateImageView(_, _, _, _))
+            .SIDE_EFFECT(*_4 = reinterpret_cast<VkImageView>(uintptr_t{0x300}))
+            .RETURN(VK_SUCCESS));
+    e.emplace_back(NAMED_ALLOW_CALL(m_device, vkDestroyImageView(_, _, _)));
+
+    e.emplace_back(NAMED_ALLOW_CALL(m_device, vkCreateOpticalFlowSessionNV(_, _, _, _))
+            .LR_SIDE_EFFECT(*_4 = reinterpret_cast<VkOpticalFlowSessionNV>(++m_sessionCount))
+            .RETURN(VK_SUCCESS));
+    e.emplace_back(NAMED_ALLOW_CALL(m_device, vkDestroyOpticalFlowSessionNV(_, _, _)));
+    e.emplace_back(NAMED_ALLOW_CALL(m_device, vkBindOpticalFlowSessionImageNV(_, _, _, _, _))
+            .RETURN(VK_SUCCESS));
+
+    e.emplace_back(NAMED_ALLOW_CALL(m_queue, vkQueueSubmit2(_, _, _, _))
+            .RETURN(VK_SUCCESS));
+    e.emplace_back(NAMED_ALLOW_CALL(m_commandBuffer, vkBeginCommandBuffer(_, _))
+            .RETURN(VK_SUCCESS));
+    e.emplace_back(NAMED_ALLOW_CALL(m_commandBuffer, vkEndCommandBuffer(_))
+            .RETURN(VK_SUCCESS));
+    e.emplace_back(NAMED_ALLOW_CALL(m_commandBuffer, vkCmdOpticalFlowExecuteNV(_, _, _)));
+
+    return e;
+}
+
+void VkTestEnvironment::GetQueueFamilyProperties(uint32_t* count, VkQueueFamilyProperties* properties) const {
+    if (properties)
+        std::copy_n(queueFamilies.begin(), std::min<size_t>(*count, queueFamilies.size()), properties);
+
+    *count = properties ? std::min<uint32_t>(*count, queueFamilies.size()) : queueFamilies.size();
+}
+
+VkResult VkTestEnvironment::GetOpticalFlowImageFormats(const VkOpticalFlowImageFormatInfoNV* formatInfo, uint32_t* count, VkOpticalFlowImageFormatPropertiesNV* properties) const {
+    auto it = opticalFlowImageFormats.find(formatInfo->usage);
+    if (it == opticalFlowImageFormats.end()) {
+        *count = 0;
+        return VK_SUCCESS;
+    }
+
+    const auto& formats = it->second;
+    if (!properties) {
+        *count = formats.size();
+        return VK_SUCCESS;
+    }
+
+    auto written = std::min<uint32_t>(*count, formats.size());
+    for (uint32_t i = 0; i < written; i++)
+        properties[i].format = formats[i];
+
+    *count = written;
+    return written < formats.size() ? VK_INCOMPLETE : VK_SUCCESS;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "nvofapi_tests_private.h"
+#include "../mocks/vulkan_mocks.h"
+#include "mock_factory.h"
+
+using namespace trompeloeil;
+using namespace dxvk;
+
+// Vulkan device with VK_NV_optical_flow where submitted work completes immediately. All instances
+// created while the environment exists share its mocks.
+class VkTestEnvironment {
+  public:
+    static constexpr uint32_t opticalFlowQueueFamilyIndex = 1;
+
+    VkTestEnvironment();
+
+    [[nodiscard]] std::vector<std::unique_ptr<expectation>> ConfigureExpectations();
+    [[nodiscard]] VkMock* Vk() { return &m_vk; }
+    [[nodiscard]] VkPhysicalDeviceMock* PhysicalDeviceMock() { return &m_physicalDevice; }
+    [[nodiscard]] VkDeviceMock* DeviceMock() { return &m_device; }
+    [[nodiscard]] VkQueueMock* QueueMock() { return &m_queue; }
+    [[nodiscard]] VkCommandBufferMock* CommandBufferMock() { return &m_commandBuffer; }
+
+    [[nodiscard]] VkPhysicalDevice PhysicalDevice() { return reinterpret_cast<VkPhysicalDevice>(&m_physicalDevice); }
+    [[nodiscard]] VkDevice Device() { return reinterpret_cast<VkDevice>(&m_device); }
+
+    // Reported through vkGetPhysicalDeviceProperties2, vkGetPhysicalDeviceQueueFamilyProperties and vkGetPhysicalDeviceOpticalFlowImageFormatsNV
+    VkPhysicalDeviceOpticalFlowPropertiesNV opticalFlowProperties{};
+    std::vector<VkQueueFamilyProperties> queueFamilies{};
+    std::map<VkOpticalFlowUsageFlagsNV, std::vector<VkFormat>> opticalFlowImageFormats{};
+
+  private:
+    VkMock m_vk;
+    VkPhysicalDeviceMock m_physicalDevice;
+    VkDeviceMock m_device;
+    VkQueueMock m_queue;
+    VkCommandBufferMock m_commandBuffer;
+
+    uintptr_t m_sessionCount{0};
+
+    void GetQueueFamilyProperties(uint32_t* count, VkQueueFamilyProperties* properties) const;
+    VkResult GetOpticalFlowImageFormats(const VkOpticalFlowImageFormatInfoNV* formatInfo, uint32_t* count, VkOpticalFlowImageFormatPropertiesNV* properties) const;
+};
@@ -1,9 +1,221 @@
 #include "nvofapi_tests_private.h"
+#include "mocks/d3d11_mocks.h"
 #include "nvofapi/mock_factory.h"
+#include "nvofapi/vk_test_environment.h"
 
 using namespace trompeloeil;
 
-TEST_CASE("CreateInstanceD3D11 returns not-available", "[.d3d11]") {
+TEST_CASE("D3D11 methods succeed", "[.d3d11]") {
+    SECTION("CreateInstanceD3D11 fails to initialize with major version other than 5") {
+        NV_OF_D3D11_API_FUNCTION_LIST functionList{};
+        REQUIRE(NvOFAPICreateInstanceD3D11(0, &functionList) == NV_OF_ERR_INVALID_VERSION);
+    }
+
+    SECTION("CreateInstanceD3D11 initializes") {
+        auto vk = std::make_unique<VkMock>();
+        auto vkDevice = std::make_unique<VkDeviceMock>();
+
+        D3D11DxvkDeviceMock device;
+
+        ALLOW_CALL(device, AddRef())
+            .RETURN(1);
+        ALLOW_CALL(device, Release())
+            .RETURN(0);
+        ALLOW_CALL(device, GetVulkanHandles(_, _, _))
+            .LR_SIDE_EFFECT(*_3 = reinterpret_cast<VkDevice>(vkDevice.get()));
+
+        NV_OF_D3D11_API_FUNCTION_LIST functionList{};
+        REQUIRE(NvOFAPICreateInstanceD3D11(80, &functionList) == NV_OF_SUCCESS);
+        REQUIRE(functionList.nvCreateOpticalFlowD3D11 != nullptr);
+        REQUIRE(functionList.nvOFRegisterResourceD3D11 != nullptr);
+        REQUIRE(functionList.nvOFExecute != nullptr);
+
+        SECTION("CreateInstanceD3D11 fails to initialize without DXVK interop") {
+            ALLOW_CALL(device, QueryInterface(__uuidof(IDXGIVkInteropDevice), _))
+                .RETURN(E_NOINTERFACE);
+            FORBID_CALL(*vk, GetInstanceProcAddr(_, _));
+            FORBID_CALL(*vk, GetDeviceProcAddr(_, _));
+
+            resourceFactory = std::make_unique<MockFactory>(std::move(vk));
+
+            NvOFHandle hOFInstance;
+            REQUIRE(functionList.nvCreateOpticalFlowD3D11(static_cast<ID3D11Device*>(&device), nullptr, &hOFInstance) == NV_OF_ERR_GENERIC);
+        }
+
+        SECTION("CreateInstanceD3D11 fails to initialize when Vulkan is not available") {
+            ALLOW_CALL(device, QueryInterface(__uuidof(IDXGIVkInteropDevice), _))
+                .LR_SIDE_EFFECT(*_2 = static_cast<IDXGIVkInteropDevice*>(&device))
+                .RETURN(S_OK);
+            ALLOW_CALL(*vk, IsAvailable()).RETURN(false);
+            FORBID_CALL(*vk, GetInstanceProcAddr(_, _));
+            FORBID_CALL(*vk, GetDeviceProcAddr(_, _));
+
+            resourceFactory = std::make_unique<MockFactory>(std::move(vk));
+
+            NvOFHandle hOFInstance;
+            REQUIRE(functionList.nvCreateOpticalFlowD3D11(static_cast<ID3D11Device*>(&device), nullptr, &hOFInstance) == NV_OF_ERR_GENERIC);
+        }
+
+        SECTION("CreateInstanceD3D11 fails to initialize without VK_NV_optical_flow") {
+            ALLOW_CALL(device, QueryInterface(__uuidof(IDXGIVkInteropDevice), _))
+                .LR_SIDE_EFFECT(*_2 = static_cast<IDXGIVkInteropDevice*>(&device))
+                .RETURN(S_OK);
+            ALLOW_CALL(*vk, IsAvailable()).RETURN(true);
+            ALLOW_CALL(*vk, GetInstanceProcAddr(_, _))
+                .RETURN(nullptr);
+            ALLOW_CALL(*vk, GetDeviceProcAddr(_, _))
+                .RETURN(nullptr);
+            FORBID_CALL(device, GetSubmissionQueue(_, _));
+
+            resourceFactory = std::make_unique<MockFactory>(std::move(vk));
+
+            NvOFHandle hOFInstance;
+            REQUIRE(functionList.nvCreateOpticalFlowD3D11(static_cast<ID3D11Device*>(&device), nullptr, &hOFInstance) == NV_OF_ERR_GENERIC);
+        }
+    }
+}
+
+// DXVK device on top of the Vulkan test environment, DXVK's queue is the queue of the test environment
+[[nodiscard]] static std::vector<std::unique_ptr<expectation>> ConfigureD3D11Device(D3D11DxvkDeviceMock& device, VkTestEnvironment& env) {
+    std::vector<std::unique_ptr<expectation>> e;
+
+    e.emplace_back(NAMED_ALLOW_CALL(device, AddRef())
+            .RETURN(1));
+    e.emplace_back(NAMED_ALLOW_CALL(device, Release())
+            .RETURN(0));
+    e.emplace_back(NAMED_ALLOW_CALL(device, QueryInterface(__uuidof(IDXGIVkInteropDevice), _))
+            .LR_SIDE_EFFECT(*_2 = static_cast<IDXGIVkInteropDevice*>(&device))
+            .RETURN(S_OK));
+    e.emplace_back(NAMED_ALLOW_CALL(device, GetVulkanHandles(_, _, _))
+            .LR_SIDE_EFFECT(*_1 = VK_NULL_HANDLE)
+            .LR_SIDE_EFFECT(*_2 = env.PhysicalDevice())
+            .LR_SIDE_EFFECT(*_3 = env.Device()));
+    e.emplace_back(NAMED_ALLOW_CALL(device, GetSubmissionQueue(_, _))
+            .LR_SIDE_EFFECT(*_1 = reinterpret_cast<VkQueue>(env.QueueMock()))
+            .SIDE_EFFECT(*_2 = 0));
+    e.emplace_back(NAMED_ALLOW_CALL(device, FlushRenderingCommands()));
+    e.emplace_back(NAMED_ALLOW_CALL(device, LockSubmissionQueue()));
+    e.emplace_back(NAMED_ALLOW_CALL(device, ReleaseSubmissionQueue()));
+
+    return e;
+}
+
+[[nodiscard]] static std::vector<std::unique_ptr<expectation>> ConfigureTexture(D3D11DxvkTexture2DMock& texture, VkImage image) {
+    std::vector<std::unique_ptr<expectation>> e;
+
+    e.emplace_back(NAMED_ALLOW_CALL(texture, AddRef())
+            .RETURN(1));
+    e.emplace_back(NAMED_ALLOW_CALL(texture, Release())
+            .RETURN(0));
+    e.emplace_back(NAMED_ALLOW_CALL(texture, QueryInterface(__uuidof(IDXGIVkInteropSurface), _))
+            .LR_SIDE_EFFECT(*_2 = static_cast<IDXGIVkInteropSurface*>(&texture))
+            .RETURN(S_OK));
+    e.emplace_back(NAMED_ALLOW_CALL(texture, GetVulkanImageInfo(_, _, _))
+            .SIDE_EFFECT(*_1 = image)
+            .SIDE_EFFECT(*_2 = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+            .SIDE_EFFECT(_3->format = VK_FORMAT_B8G8R8A8_UNORM)
+            .RETURN(S_OK));
+
+    return e;
+}
+
+TEST_CASE("D3D11 register and execute", "[.d3d11]") {
+    VkTestEnvironment env;
+    D3D11DxvkDeviceMock device;
+    D3D11DxvkTexture2DMock input;
+    D3D11DxvkTexture2DMock reference;
+    D3D11DxvkTexture2DMock output;
+
+    auto e = env.ConfigureExpectations();
+    auto d3d11 = ConfigureD3D11Device(device, env);
+    auto inputExpectations = ConfigureTexture(input, reinterpret_cast<VkImage>(uintptr_t{0x1001}));
+    auto referenceExpectations = ConfigureTexture(reference, reinterpret_cast<VkImage>(uintptr_t{0x1002}));
+    auto outputExpectations = ConfigureTexture(output, reinterpret_cast<VkImage>(uintptr_t{0x1003}));
+
     NV_OF_D3D11_API_FUNCTION_LIST functionList{};
-    REQUIRE(NvOFAPICreateInstanceD3D11(0, &functionList) == NV_OF_ERR_OF_NOT_AVAILABLE);
+    REQUIRE(NvOFAPICreateInstanceD3D11(80, &functionList) == NV_OF_SUCCESS);
+
+    NvOFHandle hOFInstance{};
+    REQUIRE(functionList.nvCreateOpticalFlowD3D11(static_cast<ID3D11Device*>(&device), nullptr, &hOFInstance) == NV_OF_SUCCESS);
+
+    SECTION("RegisterResourceD3D11 keeps the layout of the surface") {
+        FORBID_CALL(device, TransitionSurfaceLayout(_, _, _, _));
+
+        NvOFGPUBufferHandle hInput{};
+        REQUIRE(functionList.nvOFRegisterResourceD3D11(hOFInstance, static_cast<ID3D11Texture2D*>(&input), &hInput) == NV_OF_SUCCESS);
+        REQUIRE(hInput != nullptr);
+
+        NvOFGPUBufferHandle hInputAgain{};
+        REQUIRE(functionList.nvOFRegisterResourceD3D11(hOFInstance, static_cast<ID3D11Texture2D*>(&input), &hInputAgain) == NV_OF_SUCCESS);
+        REQUIRE(hInputAgain == hInput);
+
+        REQUIRE(functionList.nvOFUnregisterResourceD3D11(hInputAgain) == NV_OF_SUCCESS);
+        REQUIRE(functionList.nvOFUnregisterResourceD3D11(hInput) == NV_OF_SUCCESS);
+    }
+
+    SECTION("RegisterResourceD3D11 fails for resources without Vulkan image") {
+        D3D11DxvkTexture2DMock texture;
+        ALLOW_CALL(texture, QueryInterface(__uuidof(IDXGIVkInteropSurface), _))
+            .RETURN(E_NOINTERFACE);
+
+        NvOFGPUBufferHandle hTexture{};
+        REQUIRE(functionList.nvOFRegisterResourceD3D11(hOFInstance, static_cast<ID3D11Texture2D*>(&texture), &hTexture) == NV_OF_ERR_GENERIC);
+    }
+
+    SECTION("Execute transitions the surfaces to the general layout and back around the optical flow work") {
+        NV_OF_INIT_PARAMS initParams{};
+        initParams.width = 1920;
+        initParams.height = 1080;
+        initParams.outGridSize = NV_OF_OUTPUT_VECTOR_GRID_SIZE_4;
+        initParams.mode = NV_OF_MODE_OPTICALFLOW;
+        initParams.perfLevel = NV_OF_PERF_LEVEL_SLOW;
+        initParams.predDirection = NV_OF_PRED_DIRECTION_FORWARD;
+        initParams.inputBufferFormat = NV_OF_BUFFER_FORMAT_ABGR8;
+        REQUIRE(functionList.nvOFInit(hOFInstance, &initParams) == NV_OF_SUCCESS);
+
+        NvOFGPUBufferHandle hInput{};
+        NvOFGPUBufferHandle hReference{};
+        NvOFGPUBufferHandle hOutput{};
+        REQUIRE(functionList.nvOFRegisterResourceD3D11(hOFInstance, static_cast<ID3D11Texture2D*>(&input), &hInput) == NV_OF_SUCCESS);
+        REQUIRE(functionList.nvOFRegisterResourceD3D11(hOFInstance, static_cast<ID3D11Texture2D*>(&reference), &hReference) == NV_OF_SUCCESS);
+        REQUIRE(functionList.nvOFRegisterResourceD3D11(hOFInstance, static_cast<ID3D11Texture2D*>(&output), &hOutput) == NV_OF_SUCCESS);
+
+        NV_OF_EXECUTE_INPUT_PARAMS inParams{};
+        inParams.inputFrame = hInput;
+        inParams.referenceFrame = hReference;
+        NV_OF_EXECUTE_OUTPUT_PARAMS outParams{};
+        outParams.outputBuffer = hOutput;
+
+        {
+            sequence seq;
+            REQUIRE_CALL(device, TransitionSurfaceLayout(static_cast<IDXGIVkInteropSurface*>(&input), _, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL))
+                .IN_SEQUENCE(seq);
+            REQUIRE_CALL(device, TransitionSurfaceLayout(static_cast<IDXGIVkInteropSurface*>(&reference), _, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL))
+                .IN_SEQUENCE(seq);
+            REQUIRE_CALL(device, TransitionSurfaceLayout(static_cast<IDXGIVkInteropSurface*>(&output), _, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL))
+                .IN_SEQUENCE(seq);
+            REQUIRE_CALL(device, FlushRenderingCommands())
+                .IN_SEQUENCE(seq);
+            REQUIRE_CALL(device, LockSubmissionQueue())
+                .IN_SEQUENCE(seq);
+            REQUIRE_CALL(*env.CommandBufferMock(), vkCmdOpticalFlowExecuteNV(_, _, _))
+                .IN_SEQUENCE(seq);
+            REQUIRE_CALL(device, ReleaseSubmissionQueue())
+                .IN_SEQUENCE(seq);
+            REQUIRE_CALL(device, TransitionSurfaceLayout(static_cast<IDXGIVkInteropSurface*>(&input), _, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL))
+                .IN_SEQUENCE(seq);
+            REQUIRE_CALL(device, TransitionSurfaceLayout(static_cast<IDXGIVkInteropSurface*>(&reference), _, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL))
+                .IN_SEQUENCE(seq);
+            REQUIRE_CALL(device, TransitionSurfaceLayout(static_cast<IDXGIVkInteropSurface*>(&output), _, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL))
+                .IN_SEQUENCE(seq);
+
+            REQUIRE(functionList.nvOFExecute(hOFInstance, &inParams, &outParams) == NV_OF_SUCCESS);
+        }
+
+        REQUIRE(functionList.nvOFUnregisterResourceD3D11(hInput) == NV_OF_SUCCESS);
+        REQUIRE(functionList.nvOFUnregisterResourceD3D11(hReference) == NV_OF_SUCCESS);
+        REQUIRE(functionList.nvOFUnregisterResourceD3D11(hOutput) == NV_OF_SUCCESS);
+    }
+
+    REQUIRE(functionList.nvOFDestroy(hOFInstance) == NV_OF_SUCCESS);
 }
@@ -1,6 +1,8 @@
 #include "nvofapi_tests_private.h"
+#include "mocks/d3d_mocks.h"
 #include "mocks/d3d12_mocks.h"
 #include "nvofapi/mock_factory.h"
+#include "nvofapi/vk_test_environment.h"
 
 using namespace trompeloeil;
 
@@ -63,3 +65,435 @@ TEST_CASE("D3D12 methods succeed", "[.d3d12]") {
         }
     }
 }
+
+// vkd3d-proton device on top of the Vulkan test environment, the OFA queue is created through vkd3d-proton's interop
+[[nodiscard]] static std::vector<std::unique_ptr<expectation>> ConfigureD3D12Device(D3D12Vkd3dDeviceMock& device, D3D12Vkd3dCommandQueueMock& commandQueue, D3D12Vkd3dGraphicsCommandListMock& commandList, VkTestEnvironment& env) {
+    std::vector<std::unique_ptr<expectation>> e;
+
+    e.emplace_back(NAMED_ALLOW_CALL(device, AddRef())
+            .RETURN(1));
+    e.emplace_back(NAMED_ALLOW_CALL(device, Release())
+            .RETURN(0));
+    e.emplace_back(NAMED_ALLOW_CALL(device, QueryInterface(__uuidof(ID3D12DXVKInteropDevice1), _))
+            .LR_SIDE_EFFECT(*_2 = static_cast<ID3D12DXVKInteropDevice1*>(&device))
+            .RETURN(S_OK));
+    e.emplace_back(NAMED_ALLOW_CALL(device, QueryInterface(__uuidof(ID3D12Device4), _))
+            .LR_SIDE_EFFECT(*_2 = static_cast<ID3D12Device4*>(&device))
+            .RETURN(S_OK));
+    e.emplace_back(NAMED_ALLOW_CALL(device, QueryInterface(__uuidof(ID3D12DeviceExt), _))
+            .LR_SIDE_EFFECT(*_2 = static_cast<ID3D12DeviceExt*>(&device))
+            .RETURN(S_OK));
+    e.emplace_back(NAMED_ALLOW_CALL(device, GetVulkanHandles(_, _, _))
+            .LR_SIDE_EFFECT(*_1 = VK_NULL_HANDLE)
+            .LR_SIDE_EFFECT(*_2 = env.PhysicalDevice())
+            .LR_SIDE_EFFECT(*_3 = env.Device())
+            .RETURN(S_OK));
+    e.emplace_back(NAMED_ALLOW_CALL(device, GetExtensionSupport(D3D12_VK_NV_OPTICAL_FLOW))
+            .RETURN(TRUE));
+    // Without private data the session pool goes away together with the last instance
+    e.emplace_back(NAMED_ALLOW_CALL(device, SetPrivateDataInterface(_, _))
+            .RETURN(E_NOTIMPL));
+
+    e.emplace_back(NAMED_ALLOW_CALL(device, CreateInteropCommandQueue(_, VkTestEnvironment::opticalFlowQueueFamilyIndex, _))
+            .LR_SIDE_EFFECT(*_3 = static_cast<ID3D12CommandQueue*>(&commandQueue))
+            .RETURN(S_OK));
+    e.emplace_back(NAMED_ALLOW_CALL(device, CreateInteropCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, VkTestEnvironment::opticalFlowQueueFamilyIndex, _))
+            .SIDE_EFFECT(*_3 = nullptr)
+            .RETURN(S_OK));
+    e.emplace_back(NAMED_ALLOW_CALL(device, CreateCommandList1(0U, D3D12_COMMAND_LIST_TYPE_DIRECT, _, _, _))
+            .LR_SIDE_EFFECT(*_5 = static_cast<ID3D12GraphicsCommandList*>(&commandList))
+            .RETURN(S_OK));
+    e.emplace_back(NAMED_ALLOW_CALL(device, CreateFence(_, _, _, _))
+            .RETURN(E_FAIL));
+    e.emplace_back(NAMED_ALLOW_CALL(device, BeginVkCommandBufferInterop(_, _))
+            .LR_SIDE_EFFECT(*_2 = reinterpret_cast<VkCommandBuffer>(env.CommandBufferMock()))
+            .RETURN(S_OK));
+    e.emplace_back(NAMED_ALLOW_CALL(device, EndVkCommandBufferInterop(_))
+            .RETURN(S_OK));
+
+    e.emplace_back(NAMED_ALLOW_CALL(commandQueue, AddRef())
+            .RETURN(1));
+    e.emplace_back(NAMED_ALLOW_CALL(commandQueue, Release())
+            .RETURN(0));
+    e.emplace_back(NAMED_ALLOW_CALL(commandQueue, Wait(_, _))
+            .RETURN(S_OK));
+    e.emplace_back(NAMED_ALLOW_CALL(commandQueue, Signal(_, _))
+            .RETURN(S_OK));
+    e.emplace_back(NAMED_ALLOW_CALL(commandQueue, ExecuteCommandLists(_, _)));
+    e.emplace_back(NAMED_ALLOW_CALL(commandList, AddRef())
+            .RETURN(1));
+    e.emplace_back(NAMED_ALLOW_CALL(commandList, Release())
+            .RETURN(0));
+    e.emplace_back(NAMED_ALLOW_CALL(commandList, Reset(_, _))
+            .RETURN(S_OK));
+    e.emplace_back(NAMED_ALLOW_CALL(commandList, Close())
+            .RETURN(S_OK));
+
+    return e;
+}
+
+TEST_CASE("D3D12 capabilities and session parameters", "[.d3d12]") {
+    VkTestEnvironment env;
+    D3D12Vkd3dDeviceMock device;
+    D3D12Vkd3dCommandQueueMock commandQueue;
+    D3D12Vkd3dGraphicsCommandListMock commandList;
+
+    auto e = env.ConfigureExpectations();
+    auto d3d12 = ConfigureD3D12Device(device, commandQueue, commandList, env);
+
+    NV_OF_D3D12_API_FUNCTION_LIST functionList{};
+    REQUIRE(NvOFAPICreateInstanceD3D12(80, &functionList) == NV_OF_SUCCESS);
+
+    NvOFHandle hOFInstance{};
+    REQUIRE(functionList.nvCreateOpticalFlowD3D12(static_cast<ID3D12Device*>(&device), &hOFInstance) == NV_OF_SUCCESS);
+
+    NV_OF_INIT_PARAMS initParams{};
+    initParams.width = 1920;
+    initParams.height = 1080;
+    initParams.outGridSize = NV_OF_OUTPUT_VECTOR_GRID_SIZE_4;
+    initParams.mode = NV_OF_MODE_OPTICALFLOW;
+    initParams.perfLevel = NV_OF_PERF_LEVEL_SLOW;
+    initParams.predDirection = NV_OF_PRED_DIRECTION_FORWARD;
+    initParams.inputBufferFormat = NV_OF_BUFFER_FORMAT_ABGR8;
+
+    SECTION("GetCaps reports the supported grid sizes") {
+        std::array<uint32_t, 4> gridSizes{};
+        uint32_t size = gridSizes.size();
+        REQUIRE(functionList.nvOFGetCaps(hOFInstance, NV_OF_CAPS_SUPPORTED_OUTPUT_GRID_SIZES, gridSizes.data(), &size) == NV_OF_SUCCESS);
+        REQUIRE(size == 2);
+        REQUIRE(gridSizes[0] == NV_OF_OUTPUT_VECTOR_GRID_SIZE_1);
+        REQUIRE(gridSizes[1] == NV_OF_OUTPUT_VECTOR_GRID_SIZE_4);
+
+        size = gridSizes.size();
+        REQUIRE(functionList.nvOFGetCaps(hOFInstance, NV_OF_CAPS_SUPPORTED_HINT_GRID_SIZES, gridSizes.data(), &size) == NV_OF_SUCCESS);
+        REQUIRE(size == 2);
+        REQUIRE(gridSizes[0] == NV_OF_HINT_VECTOR_GRID_SIZE_4);
+        REQUIRE(gridSizes[1] == NV_OF_HINT_VECTOR_GRID_SIZE_8);
+    }
+
+    SECTION("GetCaps only reports as many grid sizes as requested") {
+        std::array<uint32_t, 2> gridSizes{};
+        uint32_t size = 1;
+        REQUIRE(functionList.nvOFGetCaps(hOFInstance, NV_OF_CAPS_SUPPORTED_OUTPUT_GRID_SIZES, gridSizes.data(), &size) == NV_OF_SUCCESS);
+        REQUIRE(size == 2);
+        REQUIRE(gridSizes[0] == NV_OF_OUTPUT_VECTOR_GRID_SIZE_1);
+        REQUIRE(gridSizes[1] == 0);
+    }
+
+    SECTION("InitSession creates a session with supported grid sizes") {
+        initParams.enableExternalHints = NV_OF_TRUE;
+        initParams.hintGridSize = NV_OF_HINT_VECTOR_GRID_SIZE_4;
+
+        REQUIRE_CALL(*env.DeviceMock(), vkCreateOpticalFlowSessionNV(_, _, _, _))
+            .WITH(_2->outputGridSize == VK_OPTICAL_FLOW_GRID_SIZE_4X4_BIT_NV && _2->hintGridSize == VK_OPTICAL_FLOW_GRID_SIZE_4X4_BIT_NV)
+            .SIDE_EFFECT(*_4 = reinterpret_cast<VkOpticalFlowSessionNV>(uintptr_t{1}))
+            .RETURN(VK_SUCCESS);
+
+        REQUIRE(functionList.nvOFInit(hOFInstance, &initParams) == NV_OF_SUCCESS);
+    }
+
+    SECTION("InitSession fails with an unsupported output grid size") {
+        initParams.outGridSize = NV_OF_OUTPUT_VECTOR_GRID_SIZE_2;
+
+        FORBID_CALL(*env.DeviceMock(), vkCreateOpticalFlowSessionNV(_, _, _, _));
+
+        REQUIRE(functionList.nvOFInit(hOFInstance, &initParams) == NV_OF_ERR_GENERIC);
+    }
+
+    SECTION("InitSession fails with an unsupported hint grid size") {
+        initParams.enableExternalHints = NV_OF_TRUE;
+        initParams.hintGridSize = NV_OF_HINT_VECTOR_GRID_SIZE_2;
+
+        FORBID_CALL(*env.DeviceMock(), vkCreateOpticalFlowSessionNV(_, _, _, _));
+
+        REQUIRE(functionList.nvOFInit(hOFInstance, &initParams) == NV_OF_ERR_GENERIC);
+    }
+
+    SECTION("InitSession fails when output cost is not supported") {
+        initParams.enableOutputCost = NV_OF_TRUE;
+
+        FORBID_CALL(*env.DeviceMock(), vkCreateOpticalFlowSessionNV(_, _, _, _));
+
+        REQUIRE(functionList.nvOFInit(hOFInstance, &initParams) == NV_OF_ERR_GENERIC);
+    }
+
+    SECTION("InitSession fails when global flow is not supported") {
+        initParams.enableGlobalFlow = NV_OF_TRUE;
+
+        FORBID_CALL(*env.DeviceMock(), vkCreateOpticalFlowSessionNV(_, _, _, _));
+
+        REQUIRE(functionList.nvOFInit(hOFInstance, &initParams) == NV_OF_ERR_GENERIC);
+    }
+
+    REQUIRE(functionList.nvOFDestroy(hOFInstance) == NV_OF_SUCCESS);
+}
+
+TEST_CASE("D3D12 surface formats", "[.d3d12]") {
+    VkTestEnvironment env;
+    D3D12Vkd3dDeviceMock device;
+    D3D12Vkd3dCommandQueueMock commandQueue;
+    D3D12Vkd3dGraphicsCommandListMock commandList;
+
+    auto e = env.ConfigureExpectations();
+    auto d3d12 = ConfigureD3D12Device(device, commandQueue, commandList, env);
+
+    NV_OF_D3D12_API_FUNCTION_LIST functionList{};
+    REQUIRE(NvOFAPICreateInstanceD3D12(80, &functionList) == NV_OF_SUCCESS);
+
+    SECTION("GetSurfaceFormatCountD3D12 and GetSurfaceFormatD3D12 report the DXGI formats of the driver") {
+        env.opticalFlowImageFormats[VK_OPTICAL_FLOW_USAGE_OUTPUT_BIT_NV] = {VK_FORMAT_R16G16_S10_5_NV, VK_FORMAT_R16G16_SINT, VK_FORMAT_R16G16_SFLOAT};
+
+        NvOFHandle hOFInstance{};
+        REQUIRE(functionList.nvCreateOpticalFlowD3D12(static_cast<ID3D12Device*>(&device), &hOFInstance) == NV_OF_SUCCESS);
+
+        uint32_t count = 0;
+        REQUIRE(functionList.nvOFGetSurfaceFormatCountD3D12(hOFInstance, NV_OF_BUFFER_USAGE_INPUT, NV_OF_MODE_OPTICALFLOW, &count) == NV_OF_SUCCESS);
+        REQUIRE(count == 2);
+
+        std::array<DXGI_FORMAT, 2> formats{};
+        REQUIRE(functionList.nvOFGetSurfaceFormatD3D12(hOFInstance, NV_OF_BUFFER_USAGE_INPUT, NV_OF_MODE_OPTICALFLOW, formats.data()) == NV_OF_SUCCESS);
+        REQUIRE(formats[0] == DXGI_FORMAT_R8_UNORM);
+        REQUIRE(formats[1] == DXGI_FORMAT_B8G8R8A8_UNORM);
+
+        // Both flow vector formats map to the same DXGI format, formats without DXGI equivalent are left out
+        REQUIRE(functionList.nvOFGetSurfaceFormatCountD3D12(hOFInstance, NV_OF_BUFFER_USAGE_OUTPUT, NV_OF_MODE_OPTICALFLOW, &count) == NV_OF_SUCCESS);
+        REQUIRE(count == 1);
+        REQUIRE(functionList.nvOFGetSurfaceFormatD3D12(hOFInstance, NV_OF_BUFFER_USAGE_OUTPUT, NV_OF_MODE_OPTICALFLOW, formats.data()) == NV_OF_SUCCESS);
+        REQUIRE(formats[0] == DXGI_FORMAT_R16G16_SINT);
+
+        REQUIRE(functionList.nvOFDestroy(hOFInstance) == NV_OF_SUCCESS);
+    }
+
+    SECTION("GetSurfaceFormatCountD3D12 reports no formats for usages the driver does not support") {
+        NvOFHandle hOFInstance{};
+        REQUIRE(functionList.nvCreateOpticalFlowD3D12(static_cast<ID3D12Device*>(&device), &hOFInstance) == NV_OF_SUCCESS);
+
+        uint32_t count = 1;
+        REQUIRE(functionList.nvOFGetSurfaceFormatCountD3D12(hOFInstance, NV_OF_BUFFER_USAGE_COST, NV_OF_MODE_OPTICALFLOW, &count) == NV_OF_SUCCESS);
+        REQUIRE(count == 0);
+
+        DXGI_FORMAT format{};
+        REQUIRE(functionList.nvOFGetSurfaceFormatD3D12(hOFInstance, NV_OF_BUFFER_USAGE_COST, NV_OF_MODE_OPTICALFLOW, &format) == NV_OF_ERR_GENERIC);
+
+        REQUIRE(functionList.nvOFDestroy(hOFInstance) == NV_OF_SUCCESS);
+    }
+
+    SECTION("GetSurfaceFormatCountD3D12 falls back to one format per usage without the format query") {
+        ALLOW_CALL(*env.Vk(), GetInstanceProcAddr(_, eq(std::string_view("vkGetPhysicalDeviceOpticalFlowImageFormatsNV"))))
+            .RETURN(nullptr);
+
+        NvOFHandle hOFInstance{};
+        REQUIRE(functionList.nvCreateOpticalFlowD3D12(static_cast<ID3D12Device*>(&device), &hOFInstance) == NV_OF_SUCCESS);
+
+        uint32_t count = 0;
+        DXGI_FORMAT format{};
+        REQUIRE(functionList.nvOFGetSurfaceFormatCountD3D12(hOFInstance, NV_OF_BUFFER_USAGE_INPUT, NV_OF_MODE_OPTICALFLOW, &count) == NV_OF_SUCCESS);
+        REQUIRE(count == 1);
+        REQUIRE(functionList.nvOFGetSurfaceFormatD3D12(hOFInstance, NV_OF_BUFFER_USAGE_INPUT, NV_OF_MODE_OPTICALFLOW, &format) == NV_OF_SUCCESS);
+        REQUIRE(format == DXGI_FORMAT_R8_UNORM);
+
+        count = 0;
+        REQUIRE(functionList.nvOFGetSurfaceFormatCountD3D12(hOFInstance, NV_OF_BUFFER_USAGE_OUTPUT, NV_OF_MODE_OPTICALFLOW, &count) == NV_OF_SUCCESS);
+        REQUIRE(count == 1);
+        REQUIRE(functionList.nvOFGetSurfaceFormatD3D12(hOFInstance, NV_OF_BUFFER_USAGE_OUTPUT, NV_OF_MODE_OPTICALFLOW, &format) == NV_OF_SUCCESS);
+        REQUIRE(format == DXGI_FORMAT_R16G16_SINT);
+
+        REQUIRE(functionList.nvOFDestroy(hOFInstance) == NV_OF_SUCCESS);
+    }
+}
+
+[[nodiscard]] static std::vector<std::unique_ptr<expectation>> ConfigureResources(D3D12Vkd3dDeviceMock& device, D3D12FenceMock& fence) {
+    std::vector<std::unique_ptr<expectation>> e;
+
+    e.emplace_back(NAMED_ALLOW_CALL(device, GetVulkanResourceInfo1(_, _, _, _))
+            .SIDE_EFFECT(*_2 = reinterpret_cast<UINT64>(_1))
+            .SIDE_EFFECT(*_3 = 0)
+            .SIDE_EFFECT(*_4 = VK_FORMAT_B8G8R8A8_UNORM)
+            .RETURN(S_OK));
+    e.emplace_back(NAMED_ALLOW_CALL(fence, AddRef())
+            .RETURN(1));
+    e.emplace_back(NAMED_ALLOW_CALL(fence, Release())
+            .RETURN(0));
+
+    return e;
+}
+
+TEST_CASE("D3D12 asynchronous execution", "[.d3d12]") {
+    ::SetEnvironmentVariableA("DXVK_NVAPI_OFA_ASYNC_EXECUTE", "1");
+
+    VkTestEnvironment env;
+    D3D12Vkd3dDeviceMock device;
+    D3D12Vkd3dCommandQueueMock commandQueue;
+    D3D12Vkd3dGraphicsCommandListMock commandList;
+    D3D12FenceMock fence;
+
+    auto e = env.ConfigureExpectations();
+    auto d3d12 = ConfigureD3D12Device(device, commandQueue, commandList, env);
+    auto resources = ConfigureResources(device, fence);
+
+    NV_OF_D3D12_API_FUNCTION_LIST functionList{};
+    REQUIRE(NvOFAPICreateInstanceD3D12(80, &functionList) == NV_OF_SUCCESS);
+
+    NvOFHandle hOFInstance{};
+    REQUIRE(functionList.nvCreateOpticalFlowD3D12(static_cast<ID3D12Device*>(&device), &hOFInstance) == NV_OF_SUCCESS);
+
+    std::array<NvOFGPUBufferHandle, 3> hBuffers{};
+    for (uintptr_t i = 0; i < hBuffers.size(); i++) {
+        NV_OF_REGISTER_RESOURCE_PARAMS_D3D12 registerParams{};
+        registerParams.resource = reinterpret_cast<ID3D12Resource*>(0x1001 + i);
+        registerParams.hOFGpuBuffer = &hBuffers[i];
+        REQUIRE(functionList.nvOFRegisterResourceD3D12(hOFInstance, &registerParams) == NV_OF_SUCCESS);
+    }
+
+    NV_OF_FENCE_POINT waitPoint{&fence, 1};
+    NV_OF_FENCE_POINT signalPoint{&fence, 2};
+
+    NV_OF_EXECUTE_INPUT_PARAMS_D3D12 inParams{};
+    inParams.inputFrame = hBuffers[0];
+    inParams.referenceFrame = hBuffers[1];
+    inParams.numFencePoints = 1;
+    inParams.fencePoint = &waitPoint;
+
+    NV_OF_EXECUTE_OUTPUT_PARAMS_D3D12 outParams{};
+    outParams.outputBuffer = hBuffers[2];
+    outParams.fencePoint = &signalPoint;
+
+    SECTION("ExecuteD3D12 fails on the calling thread without session") {
+        FORBID_CALL(commandQueue, Wait(_, _));
+        FORBID_CALL(commandQueue, ExecuteCommandLists(_, _));
+
+        REQUIRE(functionList.nvOFExecuteD3D12(hOFInstance, &inParams, &outParams) == NV_OF_ERR_GENERIC);
+        REQUIRE(functionList.nvOFDestroy(hOFInstance) == NV_OF_SUCCESS);
+    }
+
+    SECTION("ExecuteD3D12 fails on the calling thread without output buffer") {
+        NV_OF_INIT_PARAMS initParams{};
+        initParams.width = 1920;
+        initParams.height = 1080;
+        initParams.outGridSize = NV_OF_OUTPUT_VECTOR_GRID_SIZE_4;
+        initParams.mode = NV_OF_MODE_OPTICALFLOW;
+        initParams.perfLevel = NV_OF_PERF_LEVEL_SLOW;
+        initParams.predDirection = NV_OF_PRED_DIRECTION_FORWARD;
+        initParams.inputBufferFormat = NV_OF_BUFFER_FORMAT_ABGR8;
+        REQUIRE(functionList.nvOFInit(hOFInstance, &initParams) == NV_OF_SUCCESS);
+
+        FORBID_CALL(commandQueue, Wait(_, _));
+        FORBID_CALL(commandQueue, ExecuteCommandLists(_, _));
+        FORBID_CALL(*env.DeviceMock(), vkBindOpticalFlowSessionImageNV(_, _, _, _, _));
+
+        outParams.outputBuffer = nullptr;
+        REQUIRE(functionList.nvOFExecuteD3D12(hOFInstance, &inParams, &outParams) == NV_OF_ERR_GENERIC);
+        REQUIRE(functionList.nvOFDestroy(hOFInstance) == NV_OF_SUCCESS);
+    }
+
+    SECTION("ExecuteD3D12 waits, submits and signals on the worker thread") {
+        NV_OF_INIT_PARAMS initParams{};
+        initParams.width = 1920;
+        initParams.height = 1080;
+        initParams.outGridSize = NV_OF_OUTPUT_VECTOR_GRID_SIZE_4;
+        initParams.mode = NV_OF_MODE_OPTICALFLOW;
+        initParams.perfLevel = NV_OF_PERF_LEVEL_SLOW;
+        initParams.predDirection = NV_OF_PRED_DIRECTION_FORWARD;
+        initParams.inputBufferFormat = NV_OF_BUFFER_FORMAT_ABGR8;
+        REQUIRE(functionList.nvOFInit(hOFInstance, &initParams) == NV_OF_SUCCESS);
+
+        auto caller = std::this_thread::get_id();
+        std::vector<std::thread::id> threads;
+
+        sequence seq;
+        REQUIRE_CALL(commandQueue, Wait(static_cast<ID3D12Fence*>(&fence), 1U))
+            .IN_SEQUENCE(seq)
+            .LR_SIDE_EFFECT(threads.push_back(std::this_thread::get_id()))
+            .RETURN(S_OK);
+        REQUIRE_CALL(*env.DeviceMock(), vkBindOpticalFlowSessionImageNV(_, _, _, _, _))
+            .TIMES(3)
+            .IN_SEQUENCE(seq)
+            .LR_SIDE_EFFECT(threads.push_back(std::this_thread::get_id()))
+            .RETURN(VK_SUCCESS);
+        REQUIRE_CALL(*env.CommandBufferMock(), vkCmdOpticalFlowExecuteNV(_, _, _))
+            .IN_SEQUENCE(seq);
+        REQUIRE_CALL(commandQueue, ExecuteCommandLists(1U, _))
+            .IN_SEQUENCE(seq)
+            .LR_SIDE_EFFECT(threads.push_back(std::this_thread::get_id()));
+        REQUIRE_CALL(commandQueue, Signal(static_cast<ID3D12Fence*>(&fence), 2U))
+            .IN_SEQUENCE(seq)
+            .LR_SIDE_EFFECT(threads.push_back(std::this_thread::get_id()))
+            .RETURN(S_OK);
+
+        REQUIRE(functionList.nvOFExecuteD3D12(hOFInstance, &inParams, &outParams) == NV_OF_SUCCESS);
+
+        // Registrations may be dropped right away, the queued execution keeps the images alive
+        for (auto hBuffer : hBuffers) {
+            NV_OF_UNREGISTER_RESOURCE_PARAMS_D3D12 unregisterParams{hBuffer};
+            REQUIRE(functionList.nvOFUnregisterResourceD3D12(&unregisterParams) == NV_OF_SUCCESS);
+        }
+
+        // Destroying the instance drains the queue before the worker stops
+        REQUIRE(functionList.nvOFDestroy(hOFInstance) == NV_OF_SUCCESS);
+
+        REQUIRE(threads.size() == 6);
+        REQUIRE(std::ranges::none_of(threads, [caller](auto id) { return id == caller; }));
+    }
+}
+
+TEST_CASE("D3D12 session pool lives as long as the device", "[.d3d12]") {
+    VkTestEnvironment env;
+    D3D12Vkd3dDeviceMock device;
+    D3D12Vkd3dCommandQueueMock commandQueue;
+    D3D12Vkd3dGraphicsCommandListMock commandList;
+    D3D12FenceMock fence;
+
+    auto e = env.ConfigureExpectations();
+    auto d3d12 = ConfigureD3D12Device(device, commandQueue, commandList, env);
+    auto resources = ConfigureResources(device, fence);
+
+    // Destroying the instance waits for its queue, only then the session may be reused
+    ALLOW_CALL(device, CreateFence(_, _, _, _))
+        .LR_SIDE_EFFECT(*_4 = static_cast<ID3D12Fence*>(&fence))
+        .RETURN(S_OK);
+    ALLOW_CALL(fence, SetEventOnCompletion(1U, _))
+        .RETURN(S_OK);
+
+    // Destroyed before the expectations of the Vulkan device, which destroys the pooled sessions
+    PrivateDataStore devicePrivateData;
+    ALLOW_CALL(device, SetPrivateDataInterface(_, _))
+        .LR_RETURN(devicePrivateData.SetPrivateDataInterface(_1, _2));
+
+    NV_OF_D3D12_API_FUNCTION_LIST functionList{};
+    REQUIRE(NvOFAPICreateInstanceD3D12(80, &functionList) == NV_OF_SUCCESS);
+
+    NV_OF_INIT_PARAMS initParams{};
+    initParams.width = 1920;
+    initParams.height = 1080;
+    initParams.outGridSize = NV_OF_OUTPUT_VECTOR_GRID_SIZE_4;
+    initParams.mode = NV_OF_MODE_OPTICALFLOW;
+    initParams.perfLevel = NV_OF_PERF_LEVEL_SLOW;
+    initParams.predDirection = NV_OF_PRED_DIRECTION_FORWARD;
+    initParams.inputBufferFormat = NV_OF_BUFFER_FORMAT_ABGR8;
+
+    auto session = reinterpret_cast<VkOpticalFlowSessionNV>(uintptr_t{1});
+
+    SECTION("Destroying the only instance keeps its idle session for the next one") {
+        NvOFHandle hFirst{};
+        REQUIRE(functionList.nvCreateOpticalFlowD3D12(static_cast<ID3D12Device*>(&device), &hFirst) == NV_OF_SUCCESS);
+        REQUIRE(functionList.nvOFInit(hFirst, &initParams) == NV_OF_SUCCESS);
+
+        {
+            FORBID_CALL(*env.DeviceMock(), vkDestroyOpticalFlowSessionNV(_, _, _));
+            REQUIRE(functionList.nvOFDestroy(hFirst) == NV_OF_SUCCESS);
+        }
+
+        NvOFHandle hSecond{};
+        REQUIRE(functionList.nvCreateOpticalFlowD3D12(static_cast<ID3D12Device*>(&device), &hSecond) == NV_OF_SUCCESS);
+
+        {
+            FORBID_CALL(*env.DeviceMock(), vkCreateOpticalFlowSessionNV(_, _, _, _));
+            FORBID_CALL(*env.DeviceMock(), vkDestroyOpticalFlowSessionNV(_, _, _));
+            REQUIRE(functionList.nvOFInit(hSecond, &initParams) == NV_OF_SUCCESS);
+            REQUIRE(functionList.nvOFDestroy(hSecond) == NV_OF_SUCCESS);
+        }
+
+        REQUIRE_CALL(*env.DeviceMock(), vkDestroyOpticalFlowSessionNV(_, session, _));
+        devicePrivateData.Destroy();
+    }
+}
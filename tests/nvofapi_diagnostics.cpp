@@ -0,0 +1,67 @@
+#include "nvofapi_tests_private.h"
+#include "../src/nvofapi/nvofapi_diagnostics.h"
+
+using namespace dxvk;
+
+TEST_CASE("Diagnostics log executions", "[.diagnostics]") {
+    std::vector<std::string> messages;
+    NvOFDiagnostics diagnostics("D3D12", [&messages](const std::string& message) { messages.push_back(message); });
+    REQUIRE(messages.size() == 1);
+    REQUIRE(messages[0] == "Optical flow diagnostics enabled for D3D12 session");
+    messages.clear();
+
+    // Far from the epoch, steady_clock starts at an unspecified point
+    auto start = std::chrono::steady_clock::time_point{std::chrono::hours(1)};
+
+    NvOFDiagnostics::ExecuteParams params{};
+    params.numRois = 2;
+    params.numWaitSyncs = 1;
+
+    SECTION("First execution logs its parameters") {
+        diagnostics.Execute(params, start);
+
+        REQUIRE(messages.size() == 1);
+        REQUIRE(messages[0].starts_with("OFExecuteD3D12 first execution:"));
+        REQUIRE(messages[0].find(" numRois: 2 numWaitSyncs: 1 ") != std::string::npos);
+    }
+
+    SECTION("Executions with unchanged parameters are not logged") {
+        diagnostics.Execute(params, start);
+        diagnostics.Execute(params, start + std::chrono::seconds(1));
+        diagnostics.Execute(params, start + std::chrono::seconds(2));
+
+        REQUIRE(messages.size() == 1);
+    }
+
+    SECTION("Changed parameters are logged once") {
+        diagnostics.Execute(params, start);
+
+        params.signalSync = true;
+        diagnostics.Execute(params, start + std::chrono::seconds(1));
+        diagnostics.Execute(params, start + std::chrono::seconds(2));
+
+        REQUIRE(messages.size() == 2);
+        REQUIRE(messages[1].starts_with("OFExecuteD3D12 parameters changed:"));
+        REQUIRE(messages[1].find(" signalSync: 1 ") != std::string::npos);
+    }
+
+    SECTION("Summary is logged once per interval") {
+        diagnostics.Execute(params, start);
+        diagnostics.Execute(params, start + std::chrono::seconds(2));
+        diagnostics.Execute(params, start + NvOFDiagnostics::summaryInterval - std::chrono::milliseconds(1));
+        REQUIRE(messages.size() == 1);
+
+        params.numRois = 6;
+        diagnostics.Execute(params, start + NvOFDiagnostics::summaryInterval);
+        REQUIRE(messages.size() == 3);
+        REQUIRE(messages[2] == "OFExecuteD3D12 summary: executions/s: 0.8 average numRois: 3 average numWaitSyncs: 1");
+
+        // The next interval starts with the summary and only counts what comes after it
+        diagnostics.Execute(params, start + NvOFDiagnostics::summaryInterval + std::chrono::seconds(1));
+        REQUIRE(messages.size() == 3);
+
+        diagnostics.Execute(params, start + 2 * NvOFDiagnostics::summaryInterval);
+        REQUIRE(messages.size() == 4);
+        REQUIRE(messages[3] == "OFExecuteD3D12 summary: executions/s: 0.4 average numRois: 6 average numWaitSyncs: 1");
+    }
+}
@@ -1,7 +1,10 @@
 #include "nvofapi_tests_private.h"
 #include "nvofapi/mock_factory.h"
+#include "nvofapi/vk_test_environment.h"
+#include "../src/nvofapi/nvofapi_session_pool.h"
 
 using namespace trompeloeil;
+using namespace dxvk;
 
 TEST_CASE("Vk methods succeed", "[.vk]") {
 
@@ -46,3 +49,451 @@ TEST_CASE("Vk methods succeed", "[.vk]") {
         }
     }
 }
+
+TEST_CASE("Vk capabilities and session parameters", "[.vk]") {
+    VkTestEnvironment env;
+    auto e = env.ConfigureExpectations();
+
+    NV_OF_VK_API_FUNCTION_LIST functionList{};
+    REQUIRE(NvOFAPICreateInstanceVk(80, &functionList) == NV_OF_SUCCESS);
+
+    NvOFHandle hOFInstance{};
+    REQUIRE(functionList.nvCreateOpticalFlowVk(VK_NULL_HANDLE, env.PhysicalDevice(), env.Device(), &hOFInstance) == NV_OF_SUCCESS);
+
+    NV_OF_INIT_PARAMS initParams{};
+    initParams.width = 1920;
+    initParams.height = 1080;
+    initParams.outGridSize = NV_OF_OUTPUT_VECTOR_GRID_SIZE_4;
+    initParams.mode = NV_OF_MODE_OPTICALFLOW;
+    initParams.perfLevel = NV_OF_PERF_LEVEL_SLOW;
+    initParams.predDirection = NV_OF_PRED_DIRECTION_FORWARD;
+    initParams.inputBufferFormat = NV_OF_BUFFER_FORMAT_ABGR8;
+
+    SECTION("GetCaps reports the supported output grid sizes") {
+        uint32_t size = 0;
+        REQUIRE(functionList.nvOFGetCaps(hOFInstance, NV_OF_CAPS_SUPPORTED_OUTPUT_GRID_SIZES, nullptr, &size) == NV_OF_SUCCESS);
+        REQUIRE(size == 2);
+
+        std::array<uint32_t, 2> gridSizes{};
+        REQUIRE(functionList.nvOFGetCaps(hOFInstance, NV_OF_CAPS_SUPPORTED_OUTPUT_GRID_SIZES, gridSizes.data(), &size) == NV_OF_SUCCESS);
+        REQUIRE(size == 2);
+        REQUIRE(gridSizes[0] == NV_OF_OUTPUT_VECTOR_GRID_SIZE_1);
+        REQUIRE(gridSizes[1] == NV_OF_OUTPUT_VECTOR_GRID_SIZE_4);
+    }
+
+    SECTION("GetCaps reports the supported hint grid sizes") {
+        std::array<uint32_t, 4> gridSizes{};
+        uint32_t size = gridSizes.size();
+        REQUIRE(functionList.nvOFGetCaps(hOFInstance, NV_OF_CAPS_SUPPORTED_HINT_GRID_SIZES, gridSizes.data(), &size) == NV_OF_SUCCESS);
+        REQUIRE(size == 2);
+        REQUIRE(gridSizes[0] == NV_OF_HINT_VECTOR_GRID_SIZE_4);
+        REQUIRE(gridSizes[1] == NV_OF_HINT_VECTOR_GRID_SIZE_8);
+    }
+
+    SECTION("GetCaps reports hint support and dimensions") {
+        uint32_t value = 0;
+        uint32_t size = 1;
+        REQUIRE(functionList.nvOFGetCaps(hOFInstance, NV_OF_CAPS_SUPPORT_HINT_WITH_OF_MODE, &value, &size) == NV_OF_SUCCESS);
+        REQUIRE(value == 1);
+        REQUIRE(functionList.nvOFGetCaps(hOFInstance, NV_OF_CAPS_SUPPORT_HINT_WITH_ST_MODE, &value, &size) == NV_OF_SUCCESS);
+        REQUIRE(value == 0);
+        REQUIRE(functionList.nvOFGetCaps(hOFInstance, NV_OF_CAPS_WIDTH_MAX, &value, &size) == NV_OF_SUCCESS);
+        REQUIRE(value == 4096);
+        REQUIRE(functionList.nvOFGetCaps(hOFInstance, NV_OF_CAPS_SUPPORT_ROI, &value, &size) == NV_OF_SUCCESS);
+        REQUIRE(value == 0);
+    }
+
+    SECTION("GetCaps fails without size") {
+        uint32_t value = 0;
+        REQUIRE(functionList.nvOFGetCaps(hOFInstance, NV_OF_CAPS_WIDTH_MAX, &value, nullptr) == NV_OF_ERR_INVALID_PTR);
+    }
+
+    SECTION("InitSession creates a session with a supported output grid size") {
+        REQUIRE_CALL(*env.DeviceMock(), vkCreateOpticalFlowSessionNV(_, _, _, _))
+            .WITH(_2->outputGridSize == VK_OPTICAL_FLOW_GRID_SIZE_4X4_BIT_NV)
+            .SIDE_EFFECT(*_4 = reinterpret_cast<VkOpticalFlowSessionNV>(uintptr_t{1}))
+            .RETURN(VK_SUCCESS);
+
+        REQUIRE(functionList.nvOFInit(hOFInstance, &initParams) == NV_OF_SUCCESS);
+    }
+
+    SECTION("InitSession uses a 4x4 output grid when none was requested") {
+        initParams.outGridSize = NV_OF_OUTPUT_VECTOR_GRID_SIZE_UNDEFINED;
+
+        REQUIRE_CALL(*env.DeviceMock(), vkCreateOpticalFlowSessionNV(_, _, _, _))
+            .WITH(_2->outputGridSize == VK_OPTICAL_FLOW_GRID_SIZE_4X4_BIT_NV)
+            .SIDE_EFFECT(*_4 = reinterpret_cast<VkOpticalFlowSessionNV>(uintptr_t{1}))
+            .RETURN(VK_SUCCESS);
+
+        REQUIRE(functionList.nvOFInit(hOFInstance, &initParams) == NV_OF_SUCCESS);
+    }
+
+    SECTION("InitSession fails with an unsupported output grid size") {
+        initParams.outGridSize = NV_OF_OUTPUT_VECTOR_GRID_SIZE_2;
+
+        FORBID_CALL(*env.DeviceMock(), vkCreateOpticalFlowSessionNV(_, _, _, _));
+
+        REQUIRE(functionList.nvOFInit(hOFInstance, &initParams) == NV_OF_ERR_GENERIC);
+    }
+
+    SECTION("InitSession creates a session with a supported hint grid size") {
+        initParams.enableExternalHints = NV_OF_TRUE;
+        initParams.hintGridSize = NV_OF_HINT_VECTOR_GRID_SIZE_8;
+
+        REQUIRE_CALL(*env.DeviceMock(), vkCreateOpticalFlowSessionNV(_, _, _, _))
+            .WITH(_2->hintGridSize == VK_OPTICAL_FLOW_GRID_SIZE_8X8_BIT_NV)
+            .SIDE_EFFECT(*_4 = reinterpret_cast<VkOpticalFlowSessionNV>(uintptr_t{1}))
+            .RETURN(VK_SUCCESS);
+
+        REQUIRE(functionList.nvOFInit(hOFInstance, &initParams) == NV_OF_SUCCESS);
+    }
+
+    SECTION("InitSession fails with an unsupported hint grid size") {
+        initParams.enableExternalHints = NV_OF_TRUE;
+        initParams.hintGridSize = NV_OF_HINT_VECTOR_GRID_SIZE_1;
+
+        FORBID_CALL(*env.DeviceMock(), vkCreateOpticalFlowSessionNV(_, _, _, _));
+
+        REQUIRE(functionList.nvOFInit(hOFInstance, &initParams) == NV_OF_ERR_GENERIC);
+    }
+
+    SECTION("InitSession fails when output cost is not supported") {
+        initParams.enableOutputCost = NV_OF_TRUE;
+
+        FORBID_CALL(*env.DeviceMock(), vkCreateOpticalFlowSessionNV(_, _, _, _));
+
+        REQUIRE(functionList.nvOFInit(hOFInstance, &initParams) == NV_OF_ERR_GENERIC);
+    }
+
+    SECTION("InitSession fails when bidirectional flow is not supported") {
+        initParams.predDirection = NV_OF_PRED_DIRECTION_BOTH;
+
+        FORBID_CALL(*env.DeviceMock(), vkCreateOpticalFlowSessionNV(_, _, _, _));
+
+        REQUIRE(functionList.nvOFInit(hOFInstance, &initParams) == NV_OF_ERR_GENERIC);
+    }
+
+    REQUIRE(functionList.nvOFDestroy(hOFInstance) == NV_OF_SUCCESS);
+}
+
+TEST_CASE("Vk surface formats", "[.vk]") {
+    VkTestEnvironment env;
+    auto e = env.ConfigureExpectations();
+
+    NV_OF_VK_API_FUNCTION_LIST functionList{};
+    REQUIRE(NvOFAPICreateInstanceVk(80, &functionList) == NV_OF_SUCCESS);
+
+    NvOFHandle hOFInstance{};
+    REQUIRE(functionList.nvCreateOpticalFlowVk(VK_NULL_HANDLE, env.PhysicalDevice(), env.Device(), &hOFInstance) == NV_OF_SUCCESS);
+
+    SECTION("GetSurfaceFormatCountVk and GetSurfaceFormatVk report the formats of the driver") {
+        uint32_t count = 0;
+        REQUIRE(functionList.nvOFGetSurfaceFormatCountVk(hOFInstance, NV_OF_BUFFER_USAGE_INPUT, NV_OF_MODE_OPTICALFLOW, &count) == NV_OF_SUCCESS);
+        REQUIRE(count == 2);
+
+        std::array<VkFormat, 2> formats{};
+        REQUIRE(functionList.nvOFGetSurfaceFormatVk(hOFInstance, NV_OF_BUFFER_USAGE_INPUT, NV_OF_MODE_OPTICALFLOW, formats.data()) == NV_OF_SUCCESS);
+        REQUIRE(formats[0] == VK_FORMAT_R8_UNORM);
+        REQUIRE(formats[1] == VK_FORMAT_B8G8R8A8_UNORM);
+    }
+
+    SECTION("GetSurfaceFormatCountVk queries the driver only once per usage") {
+        uint32_t count = 0;
+        REQUIRE(functionList.nvOFGetSurfaceFormatCountVk(hOFInstance, NV_OF_BUFFER_USAGE_OUTPUT, NV_OF_MODE_OPTICALFLOW, &count) == NV_OF_SUCCESS);
+        REQUIRE(count == 1);
+
+        FORBID_CALL(*env.PhysicalDeviceMock(), vkGetPhysicalDeviceOpticalFlowImageFormatsNV(_, _, _, _));
+
+        VkFormat format{};
+        REQUIRE(functionList.nvOFGetSurfaceFormatCountVk(hOFInstance, NV_OF_BUFFER_USAGE_OUTPUT, NV_OF_MODE_OPTICALFLOW, &count) == NV_OF_SUCCESS);
+        REQUIRE(count == 1);
+        REQUIRE(functionList.nvOFGetSurfaceFormatVk(hOFInstance, NV_OF_BUFFER_USAGE_OUTPUT, NV_OF_MODE_OPTICALFLOW, &format) == NV_OF_SUCCESS);
+        REQUIRE(format == VK_FORMAT_R16G16_S10_5_NV);
+    }
+
+    SECTION("GetSurfaceFormatCountVk reports no formats for usages the driver does not support") {
+        uint32_t count = 1;
+        REQUIRE(functionList.nvOFGetSurfaceFormatCountVk(hOFInstance, NV_OF_BUFFER_USAGE_COST, NV_OF_MODE_OPTICALFLOW, &count) == NV_OF_SUCCESS);
+        REQUIRE(count == 0);
+
+        VkFormat format{};
+        REQUIRE(functionList.nvOFGetSurfaceFormatVk(hOFInstance, NV_OF_BUFFER_USAGE_COST, NV_OF_MODE_OPTICALFLOW, &format) == NV_OF_ERR_GENERIC);
+    }
+
+    SECTION("GetSurfaceFormatCountVk reports no formats for stereo disparity") {
+        FORBID_CALL(*env.PhysicalDeviceMock(), vkGetPhysicalDeviceOpticalFlowImageFormatsNV(_, _, _, _));
+
+        uint32_t count = 1;
+        REQUIRE(functionList.nvOFGetSurfaceFormatCountVk(hOFInstance, NV_OF_BUFFER_USAGE_INPUT, NV_OF_MODE_STEREODISPARITY, &count) == NV_OF_SUCCESS);
+        REQUIRE(count == 0);
+
+        VkFormat format{};
+        REQUIRE(functionList.nvOFGetSurfaceFormatVk(hOFInstance, NV_OF_BUFFER_USAGE_INPUT, NV_OF_MODE_STEREODISPARITY, &format) == NV_OF_ERR_GENERIC);
+    }
+
+    SECTION("GetSurfaceFormatCountVk and GetSurfaceFormatVk fail without output pointer") {
+        REQUIRE(functionList.nvOFGetSurfaceFormatCountVk(hOFInstance, NV_OF_BUFFER_USAGE_INPUT, NV_OF_MODE_OPTICALFLOW, nullptr) == NV_OF_ERR_INVALID_PTR);
+        REQUIRE(functionList.nvOFGetSurfaceFormatVk(hOFInstance, NV_OF_BUFFER_USAGE_INPUT, NV_OF_MODE_OPTICALFLOW, nullptr) == NV_OF_ERR_INVALID_PTR);
+    }
+
+    REQUIRE(functionList.nvOFDestroy(hOFInstance) == NV_OF_SUCCESS);
+}
+
+TEST_CASE("Vk instance requires optical flow support of the physical device", "[.vk]") {
+    VkTestEnvironment env;
+    auto e = env.ConfigureExpectations();
+
+    NV_OF_VK_API_FUNCTION_LIST functionList{};
+    REQUIRE(NvOFAPICreateInstanceVk(80, &functionList) == NV_OF_SUCCESS);
+
+    SECTION("CreateInstanceVk fails to initialize when VK_NV_optical_flow is not supported") {
+        ALLOW_CALL(*env.Vk(), GetDeviceExtensions(_, env.PhysicalDevice()))
+            .RETURN(std::map<std::string, uint32_t>{});
+        FORBID_CALL(*env.DeviceMock(), vkGetDeviceQueue(_, _, _, _));
+
+        NvOFHandle hOFInstance{};
+        REQUIRE(functionList.nvCreateOpticalFlowVk(VK_NULL_HANDLE, env.PhysicalDevice(), env.Device(), &hOFInstance) == NV_OF_ERR_GENERIC);
+    }
+
+    SECTION("CreateInstanceVk fails to initialize without optical flow queue family") {
+        env.queueFamilies.pop_back();
+        FORBID_CALL(*env.DeviceMock(), vkGetDeviceQueue(_, _, _, _));
+
+        NvOFHandle hOFInstance{};
+        REQUIRE(functionList.nvCreateOpticalFlowVk(VK_NULL_HANDLE, env.PhysicalDevice(), env.Device(), &hOFInstance) == NV_OF_ERR_GENERIC);
+    }
+}
+
+TEST_CASE("Vk capabilities are queried per instance", "[.vk]") {
+    VkTestEnvironment env;
+    auto e = env.ConfigureExpectations();
+
+    NV_OF_VK_API_FUNCTION_LIST functionList{};
+    REQUIRE(NvOFAPICreateInstanceVk(80, &functionList) == NV_OF_SUCCESS);
+
+    NvOFHandle hFirstInstance{};
+    REQUIRE(functionList.nvCreateOpticalFlowVk(VK_NULL_HANDLE, env.PhysicalDevice(), env.Device(), &hFirstInstance) == NV_OF_SUCCESS);
+    REQUIRE(functionList.nvOFDestroy(hFirstInstance) == NV_OF_SUCCESS);
+
+    env.opticalFlowProperties.maxWidth = 2048;
+
+    NvOFHandle hSecondInstance{};
+    REQUIRE(functionList.nvCreateOpticalFlowVk(VK_NULL_HANDLE, env.PhysicalDevice(), env.Device(), &hSecondInstance) == NV_OF_SUCCESS);
+
+    uint32_t value = 0;
+    uint32_t size = 1;
+    REQUIRE(functionList.nvOFGetCaps(hSecondInstance, NV_OF_CAPS_WIDTH_MAX, &value, &size) == NV_OF_SUCCESS);
+    REQUIRE(value == 2048);
+
+    REQUIRE(functionList.nvOFDestroy(hSecondInstance) == NV_OF_SUCCESS);
+}
+
+TEST_CASE("Vk surface formats without format query", "[.vk]") {
+    VkTestEnvironment env;
+    auto e = env.ConfigureExpectations();
+
+    ALLOW_CALL(*env.Vk(), GetInstanceProcAddr(_, eq(std::string_view("vkGetPhysicalDeviceOpticalFlowImageFormatsNV"))))
+        .RETURN(nullptr);
+
+    NV_OF_VK_API_FUNCTION_LIST functionList{};
+    REQUIRE(NvOFAPICreateInstanceVk(80, &functionList) == NV_OF_SUCCESS);
+
+    NvOFHandle hOFInstance{};
+    REQUIRE(functionList.nvCreateOpticalFlowVk(VK_NULL_HANDLE, env.PhysicalDevice(), env.Device(), &hOFInstance) == NV_OF_SUCCESS);
+
+    uint32_t count = 1;
+    REQUIRE(functionList.nvOFGetSurfaceFormatCountVk(hOFInstance, NV_OF_BUFFER_USAGE_INPUT, NV_OF_MODE_OPTICALFLOW, &count) == NV_OF_SUCCESS);
+    REQUIRE(count == 0);
+
+    REQUIRE(functionList.nvOFDestroy(hOFInstance) == NV_OF_SUCCESS);
+}
+
+static std::vector<VkOpticalFlowSessionNV> destroyedSessions;
+
+static VKAPI_ATTR void VKAPI_CALL DestroyOpticalFlowSession(VkDevice, VkOpticalFlowSessionNV session, const VkAllocationCallbacks*) {
+    destroyedSessions.push_back(session);
+}
+
+TEST_CASE("Session pool reuses idle sessions", "[.vk]") {
+    destroyedSessions.clear();
+
+    auto device = reinterpret_cast<VkDevice>(uintptr_t{0x1000});
+    auto pool = NvOFSessionPool::Get(device, DestroyOpticalFlowSession, nullptr);
+    REQUIRE(NvOFSessionPool::Get(device, nullptr, nullptr) == pool);
+
+    VkOpticalFlowSessionCreateInfoNV createInfo{};
+    createInfo.width = 1920;
+    createInfo.height = 1080;
+    auto key = NvOFSessionPool::GetSessionKey(createInfo);
+
+    createInfo.width = 1280;
+    createInfo.height = 720;
+    auto otherKey = NvOFSessionPool::GetSessionKey(createInfo);
+
+    SECTION("Acquire returns a released session with the same parameters only") {
+        auto session = reinterpret_cast<VkOpticalFlowSessionNV>(uintptr_t{1});
+        pool->ReleaseSession(key, session);
+
+        REQUIRE(pool->AcquireSession(otherKey) == VK_NULL_HANDLE);
+        REQUIRE(pool->AcquireSession(key) == session);
+        REQUIRE(pool->AcquireSession(key) == VK_NULL_HANDLE);
+        REQUIRE(destroyedSessions.empty());
+    }
+
+    SECTION("Release destroys the least recently released session when full") {
+        for (uintptr_t i = 1; i <= NvOFSessionPool::maxSessions + 1; i++)
+            pool->ReleaseSession(key, reinterpret_cast<VkOpticalFlowSessionNV>(i));
+
+        REQUIRE(destroyedSessions.size() == 1);
+        REQUIRE(destroyedSessions[0] == reinterpret_cast<VkOpticalFlowSessionNV>(uintptr_t{1}));
+        REQUIRE(pool->AcquireSession(key) == reinterpret_cast<VkOpticalFlowSessionNV>(NvOFSessionPool::maxSessions + 1));
+    }
+
+    SECTION("Pool destroys its sessions together with the last instance") {
+        pool->ReleaseSession(key, reinterpret_cast<VkOpticalFlowSessionNV>(uintptr_t{1}));
+        pool->ReleaseSession(otherKey, reinterpret_cast<VkOpticalFlowSessionNV>(uintptr_t{2}));
+        pool.reset();
+
+        REQUIRE(destroyedSessions.size() == 2);
+        REQUIRE(NvOFSessionPool::Get(device, DestroyOpticalFlowSession, nullptr)->AcquireSession(key) == VK_NULL_HANDLE);
+    }
+}
+
+TEST_CASE("Instances share idle sessions through the session pool", "[.vk]") {
+    VkTestEnvironment env;
+    auto e = env.ConfigureExpectations();
+
+    NV_OF_VK_API_FUNCTION_LIST functionList{};
+    REQUIRE(NvOFAPICreateInstanceVk(80, &functionList) == NV_OF_SUCCESS);
+
+    NV_OF_INIT_PARAMS initParams{};
+    initParams.width = 1920;
+    initParams.height = 1080;
+    initParams.outGridSize = NV_OF_OUTPUT_VECTOR_GRID_SIZE_4;
+    initParams.mode = NV_OF_MODE_OPTICALFLOW;
+    initParams.perfLevel = NV_OF_PERF_LEVEL_SLOW;
+    initParams.predDirection = NV_OF_PRED_DIRECTION_FORWARD;
+    initParams.inputBufferFormat = NV_OF_BUFFER_FORMAT_ABGR8;
+
+    auto firstSession = reinterpret_cast<VkOpticalFlowSessionNV>(uintptr_t{1});
+    auto secondSession = reinterpret_cast<VkOpticalFlowSessionNV>(uintptr_t{2});
+
+    // Keeps the pool of the device alive while other instances come and go
+    NvOFHandle hKeepAlive{};
+    REQUIRE(functionList.nvCreateOpticalFlowVk(VK_NULL_HANDLE, env.PhysicalDevice(), env.Device(), &hKeepAlive) == NV_OF_SUCCESS);
+
+    SECTION("DestroySession pools an idle session for the next instance with the same parameters") {
+        NvOFHandle hFirst{};
+        REQUIRE(functionList.nvCreateOpticalFlowVk(VK_NULL_HANDLE, env.PhysicalDevice(), env.Device(), &hFirst) == NV_OF_SUCCESS);
+        REQUIRE(functionList.nvOFInit(hFirst, &initParams) == NV_OF_SUCCESS);
+
+        {
+            FORBID_CALL(*env.DeviceMock(), vkDestroyOpticalFlowSessionNV(_, _, _));
+            REQUIRE(functionList.nvOFDestroy(hFirst) == NV_OF_SUCCESS);
+        }
+
+        NvOFHandle hSecond{};
+        REQUIRE(functionList.nvCreateOpticalFlowVk(VK_NULL_HANDLE, env.PhysicalDevice(), env.Device(), &hSecond) == NV_OF_SUCCESS);
+
+        {
+            FORBID_CALL(*env.DeviceMock(), vkCreateOpticalFlowSessionNV(_, _, _, _));
+            REQUIRE(functionList.nvOFInit(hSecond, &initParams) == NV_OF_SUCCESS);
+        }
+
+        REQUIRE_CALL(*env.DeviceMock(), vkDestroyOpticalFlowSessionNV(_, firstSession, _));
+        REQUIRE(functionList.nvOFDestroy(hSecond) == NV_OF_SUCCESS);
+        REQUIRE(functionList.nvOFDestroy(hKeepAlive) == NV_OF_SUCCESS);
+    }
+
+    SECTION("InitSession keeps the previous session for a later reinitialization with the same parameters") {
+        NvOFHandle hOFInstance{};
+        REQUIRE(functionList.nvCreateOpticalFlowVk(VK_NULL_HANDLE, env.PhysicalDevice(), env.Device(), &hOFInstance) == NV_OF_SUCCESS);
+        REQUIRE(functionList.nvOFInit(hOFInstance, &initParams) == NV_OF_SUCCESS);
+
+        auto otherInitParams = initParams;
+        otherInitParams.width = 1280;
+        otherInitParams.height = 720;
+
+        {
+            FORBID_CALL(*env.DeviceMock(), vkDestroyOpticalFlowSessionNV(_, _, _));
+            REQUIRE(functionList.nvOFInit(hOFInstance, &otherInitParams) == NV_OF_SUCCESS);
+
+            FORBID_CALL(*env.DeviceMock(), vkCreateOpticalFlowSessionNV(_, _, _, _));
+            REQUIRE(functionList.nvOFInit(hOFInstance, &initParams) == NV_OF_SUCCESS);
+        }
+
+        REQUIRE_CALL(*env.DeviceMock(), vkDestroyOpticalFlowSessionNV(_, firstSession, _));
+        REQUIRE_CALL(*env.DeviceMock(), vkDestroyOpticalFlowSessionNV(_, secondSession, _));
+        REQUIRE(functionList.nvOFDestroy(hOFInstance) == NV_OF_SUCCESS);
+        REQUIRE(functionList.nvOFDestroy(hKeepAlive) == NV_OF_SUCCESS);
+    }
+
+    SECTION("DestroySession destroys a session that may still be in use although the pool is alive") {
+        NvOFHandle hOFInstance{};
+        REQUIRE(functionList.nvCreateOpticalFlowVk(VK_NULL_HANDLE, env.PhysicalDevice(), env.Device(), &hOFInstance) == NV_OF_SUCCESS);
+        REQUIRE(functionList.nvOFInit(hOFInstance, &initParams) == NV_OF_SUCCESS);
+
+        std::array<NvOFGPUBufferHandle, 3> hBuffers{};
+        for (uintptr_t i = 0; i < hBuffers.size(); i++) {
+            NV_OF_REGISTER_RESOURCE_PARAMS_VK registerParams{};
+            registerParams.image = reinterpret_cast<VkImage>(0x1001 + i);
+            registerParams.format = VK_FORMAT_B8G8R8A8_UNORM;
+            registerParams.hOFGpuBuffer = &hBuffers[i];
+            REQUIRE(functionList.nvOFRegisterResourceVk(hOFInstance, &registerParams) == NV_OF_SUCCESS);
+        }
+
+        NV_OF_EXECUTE_INPUT_PARAMS_VK inParams{};
+        inParams.inputFrame = hBuffers[0];
+        inParams.referenceFrame = hBuffers[1];
+        NV_OF_EXECUTE_OUTPUT_PARAMS_VK outParams{};
+        outParams.outputBuffer = hBuffers[2];
+        REQUIRE(functionList.nvOFExecuteVk(hOFInstance, &inParams, &outParams) == NV_OF_SUCCESS);
+
+        for (auto hBuffer : hBuffers) {
+            NV_OF_UNREGISTER_RESOURCE_PARAMS_VK unregisterParams{hBuffer};
+            REQUIRE(functionList.nvOFUnregisterResourceVk(&unregisterParams) == NV_OF_SUCCESS);
+        }
+
+        {
+            // The device got lost, so the submitted execution never finishes
+            ALLOW_CALL(*env.DeviceMock(), vkWaitSemaphores(_, _, _))
+                .RETURN(VK_ERROR_DEVICE_LOST);
+            REQUIRE_CALL(*env.DeviceMock(), vkDestroyOpticalFlowSessionNV(_, firstSession, _));
+            REQUIRE_CALL(*env.DeviceMock(), vkDestroyCommandPool(_, _, _))
+                .TIMES(AT_LEAST(1));
+            REQUIRE(functionList.nvOFDestroy(hOFInstance) == NV_OF_SUCCESS);
+        }
+
+        NvOFHandle hNext{};
+        REQUIRE(functionList.nvCreateOpticalFlowVk(VK_NULL_HANDLE, env.PhysicalDevice(), env.Device(), &hNext) == NV_OF_SUCCESS);
+
+        REQUIRE_CALL(*env.DeviceMock(), vkCreateOpticalFlowSessionNV(_, _, _, _))
+            .SIDE_EFFECT(*_4 = secondSession)
+            .RETURN(VK_SUCCESS);
+        REQUIRE(functionList.nvOFInit(hNext, &initParams) == NV_OF_SUCCESS);
+
+        REQUIRE(functionList.nvOFDestroy(hNext) == NV_OF_SUCCESS);
+        REQUIRE(functionList.nvOFDestroy(hKeepAlive) == NV_OF_SUCCESS);
+    }
+
+    SECTION("DestroySession does not pool sessions that were created with private data") {
+        // Layout of the private data header that NVOFAPI passes along to the driver
+        struct {
+            uint32_t size;
+            uint32_t id;
+            void* data;
+        } privData{};
+        initParams.hPrivData = reinterpret_cast<NvOFPrivDataHandle>(&privData);
+
+        NvOFHandle hOFInstance{};
+        REQUIRE(functionList.nvCreateOpticalFlowVk(VK_NULL_HANDLE, env.PhysicalDevice(), env.Device(), &hOFInstance) == NV_OF_SUCCESS);
+        REQUIRE(functionList.nvOFInit(hOFInstance, &initParams) == NV_OF_SUCCESS);
+
+        {
+            REQUIRE_CALL(*env.DeviceMock(), vkDestroyOpticalFlowSessionNV(_, firstSession, _));
+            REQUIRE(functionList.nvOFDestroy(hOFInstance) == NV_OF_SUCCESS);
+        }
+
+        REQUIRE(functionList.nvOFDestroy(hKeepAlive) == NV_OF_SUCCESS);
+    }
+}
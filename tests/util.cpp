@@ -277,3 +277,110 @@ TEST_CASE("Version", "[.util]") {
         REQUIRE(dxvk::nvMakeVersion(0xffff, 0xffff, 0xffff) == 0xffffffc0);
     }
 }
+
+namespace {
+    struct VirtualClockState {
+        uint64_t now{1'000'000'000};
+        uint32_t sleepCount{0};
+    };
+
+    // Advances time only when told to, sleeping jumps straight to the wakeup time
+    struct VirtualClock {
+        std::shared_ptr<VirtualClockState> state = std::make_shared<VirtualClockState>();
+
+        [[nodiscard]] uint64_t Now() const {
+            return state->now;
+        }
+
+        void SleepUntil(uint64_t timestamp) const {
+            state->sleepCount++;
+            state->now = std::max(state->now, timestamp);
+        }
+    };
+}
+
+TEST_CASE("Frame pacer", "[.util]") {
+    constexpr uint64_t ms = 1'000'000;
+    VirtualClock clock;
+    dxvk::LowLatencyFramePacer<VirtualClock> pacer{clock};
+
+    SECTION("ScheduleWakeup does not sleep without minimum interval") {
+        REQUIRE(pacer.ScheduleWakeup(10 * ms) == 10 * ms);
+        REQUIRE(pacer.ScheduleWakeup(11 * ms) == 11 * ms);
+    }
+
+    SECTION("ScheduleWakeup keeps wakeups one interval apart without markers") {
+        pacer.SetMinimumInterval(10000);
+
+        REQUIRE(pacer.ScheduleWakeup(100 * ms) == 100 * ms);
+        REQUIRE(pacer.ScheduleWakeup(104 * ms) == 110 * ms);
+        REQUIRE(pacer.ScheduleWakeup(113 * ms) == 120 * ms);
+    }
+
+    SECTION("ScheduleWakeup starts over when falling behind") {
+        pacer.SetMinimumInterval(10000);
+
+        REQUIRE(pacer.ScheduleWakeup(100 * ms) == 100 * ms);
+        REQUIRE(pacer.ScheduleWakeup(125 * ms) == 125 * ms);
+        REQUIRE(pacer.ScheduleWakeup(126 * ms) == 135 * ms);
+    }
+
+    SECTION("ScheduleWakeup predicts simulation-to-present duration from markers") {
+        pacer.SetMinimumInterval(10000);
+
+        REQUIRE(pacer.ScheduleWakeup(100 * ms) == 100 * ms);
+        pacer.SetMarker(VK_LATENCY_MARKER_SIMULATION_START_NV, 100 * ms);
+        pacer.SetMarker(VK_LATENCY_MARKER_PRESENT_START_NV, 104 * ms);
+        REQUIRE(pacer.GetPredictedFrameTime() == 4 * ms);
+
+        // Next present is expected at 114ms, simulation needs to start at 110ms
+        REQUIRE(pacer.ScheduleWakeup(105 * ms) == 110 * ms);
+        pacer.SetMarker(VK_LATENCY_MARKER_SIMULATION_START_NV, 110 * ms);
+        pacer.SetMarker(VK_LATENCY_MARKER_PRESENT_START_NV, 116 * ms);
+        REQUIRE(pacer.GetPredictedFrameTime() == 4 * ms + (2 * ms) / 8);
+
+        // Next present is expected at 126ms, simulation is predicted to take a bit longer now
+        REQUIRE(pacer.ScheduleWakeup(117 * ms) == 126 * ms - (4 * ms + (2 * ms) / 8));
+    }
+
+    SECTION("ScheduleWakeup ignores outliers") {
+        pacer.SetMinimumInterval(10000);
+
+        pacer.SetMarker(VK_LATENCY_MARKER_SIMULATION_START_NV, 100 * ms);
+        pacer.SetMarker(VK_LATENCY_MARKER_PRESENT_START_NV, 2000 * ms);
+        REQUIRE(pacer.GetPredictedFrameTime() == 0);
+    }
+
+    SECTION("Sleep honors minimum interval") {
+        pacer.SetMinimumInterval(5000);
+
+        auto begin = clock.Now();
+        for (auto i = 0; i < 5; i++)
+            pacer.Sleep();
+
+        REQUIRE(clock.Now() - begin == 20 * ms);
+        REQUIRE(clock.state->sleepCount == 4);
+    }
+
+    SECTION("Sleep does not sleep without minimum interval") {
+        for (auto i = 0; i < 5; i++)
+            pacer.Sleep();
+
+        REQUIRE(clock.state->sleepCount == 0);
+    }
+
+    SECTION("Sleep takes marker timestamps from the clock") {
+        pacer.SetMinimumInterval(10000);
+
+        pacer.Sleep();
+        pacer.SetMarker(VK_LATENCY_MARKER_SIMULATION_START_NV);
+        clock.state->now += 4 * ms;
+        pacer.SetMarker(VK_LATENCY_MARKER_PRESENT_START_NV);
+        REQUIRE(pacer.GetPredictedFrameTime() == 4 * ms);
+
+        // Present started 4ms after the first wakeup, the next one is due 10ms later
+        auto presentStart = clock.Now();
+        pacer.Sleep();
+        REQUIRE(clock.Now() == presentStart + 10 * ms - 4 * ms);
+    }
+}